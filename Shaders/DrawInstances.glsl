@@ -0,0 +1,27 @@
+/*
+ *
+ */
+
+#ifndef _DRAW_INSTANCES_GLSL_
+#define _DRAW_INSTANCES_GLSL_
+
+// Per-instance data of the multi-draw indirect path (see DeferredRenderer::BuildIndirectDraws)
+// Each indirect command sets baseInstance to its draw index, so the instanced a_DrawID attribute
+// (filled with 0..N-1) returns the draw index without ARB_shader_draw_parameters.
+// The vertex shaders declare a_DrawID themselves : the culling compute shader includes this file too.
+
+struct DrawInstance
+{
+  mat4  _Model;
+  mat4  _NormalMatrix; // transpose(inverse(_Model))
+  ivec4 _MaterialID;   // x: material ID
+  vec4  _BoundsMin;    // World-space AABB, read by the culling pass. w = 0 : unknown bounds, never culled
+  vec4  _BoundsMax;
+};
+
+layout(std430, binding = 0) readonly buffer DrawInstances
+{
+  DrawInstance u_DrawInstances[];
+};
+
+#endif
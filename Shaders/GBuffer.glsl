@@ -0,0 +1,66 @@
+/*
+ *
+ */
+
+#ifndef _GBUFFER_GLSL_
+#define _GBUFFER_GLSL_
+
+// G-buffer layout (see DeferredRenderer::InitializeFrameBuffers)
+// Full    : RGBA16F normals encoded in 0..1, RGBA16F world positions.
+// Compact : octahedral RG16 normals, no position target : positions are rebuilt from the depth buffer.
+uniform int  u_CompactGBuffer = 0;
+uniform mat4 u_GInvViewProj;
+
+vec2 SignNotZero( in vec2 iV )
+{
+  return vec2(( iV.x >= 0.0 ) ? 1.0 : -1.0, ( iV.y >= 0.0 ) ? 1.0 : -1.0);
+}
+
+// Unit vector to [0, 1]^2
+vec2 EncodeOctahedral( in vec3 iN )
+{
+  vec2 p = iN.xy / ( abs(iN.x) + abs(iN.y) + abs(iN.z) );
+  if ( iN.z < 0.0 )
+    p = ( 1.0 - abs(p.yx) ) * SignNotZero(p);
+  return p * 0.5 + 0.5;
+}
+
+vec3 DecodeOctahedral( in vec2 iE )
+{
+  vec2 f = iE * 2.0 - 1.0;
+  vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+  float t = clamp(-n.z, 0.0, 1.0);
+  n.xy -= SignNotZero(n.xy) * t;
+  return normalize(n);
+}
+
+vec4 EncodeGNormal( in vec3 iN )
+{
+  if ( u_CompactGBuffer != 0 )
+    return vec4(EncodeOctahedral(iN), 0.0, 1.0);
+  return vec4(iN * 0.5 + 0.5, 1.0);
+}
+
+vec3 FetchGNormal( in sampler2D iGNormal, in vec2 iUV )
+{
+  vec4 encoded = texture(iGNormal, iUV);
+  if ( u_CompactGBuffer != 0 )
+    return DecodeOctahedral(encoded.xy);
+  return normalize(encoded.xyz * 2.0 - 1.0);
+}
+
+vec3 ReconstructGPosition( in vec2 iUV, in float iDepth )
+{
+  vec4 world = u_GInvViewProj * vec4(vec3(iUV, iDepth) * 2.0 - 1.0, 1.0);
+  return world.xyz / world.w;
+}
+
+// iDepth : G-buffer depth at iUV, already fetched by every caller
+vec3 FetchGPosition( in sampler2D iGPosition, in vec2 iUV, in float iDepth )
+{
+  if ( u_CompactGBuffer != 0 )
+    return ReconstructGPosition(iUV, iDepth);
+  return texture(iGPosition, iUV).xyz;
+}
+
+#endif // _GBUFFER_GLSL_
@@ -0,0 +1,199 @@
+/*
+ *
+ */
+
+#ifndef _PATHTRACING_GLSL_
+#define _PATHTRACING_GLSL_
+
+// Path tracing state shared by the megakernel (fragment_PathTracer.glsl) and the wavefront kernels (compute_Wavefront*.glsl)
+
+#include Constants.glsl
+#include Globals.glsl
+#include Structures.glsl
+#include RNG.glsl
+#include Textures.glsl
+#include Material.glsl
+#include Scene.glsl
+#include Intersections.glsl
+#include Sampling.glsl
+#include RayTrace.glsl
+#include DisneyBSDF.glsl
+
+// ============================================================================
+// Uniforms
+// ============================================================================
+
+uniform vec2           u_Resolution;
+uniform vec2           u_TileOffset;
+uniform vec2           u_InvNbTiles;
+uniform float          u_Time;
+uniform int            u_FrameNum;
+uniform int            u_NbCompleteFrames;
+uniform vec3           u_BackgroundColor;
+uniform Camera         u_Camera;
+uniform int            u_TiledRendering    = 0;
+uniform int            u_RussianRoulette   = 1;
+uniform int            u_NbSamplesPerPixel = 1;
+uniform int            u_NbBounces         = 1;
+uniform int            u_EnableBackground  = 0;
+uniform int            u_EnableEnvMap      = 0;
+uniform float          u_EnvMapRotation    = 0.f;
+uniform float          u_EnvMapTotalWeight = 1.f;
+uniform float          u_EnvMapIntensity   = 1.f;
+uniform vec2           u_EnvMapRes;
+uniform sampler2D      u_EnvMap;
+uniform sampler2D      u_EnvMapAlias;
+uniform int            u_AdaptiveSampling  = 0;
+uniform sampler2D      u_SampleMoments;     // Accumulated luminance moments, w = 1 once the pixel converged
+
+// ----------------------------------------------------------------------------
+// SeedPixel
+// Image pixel of a target pixel : tiles rendered during the same frame draw different random numbers
+// ----------------------------------------------------------------------------
+vec2 SeedPixel( in vec2 iTargetPixel )
+{
+  if ( 1 == u_TiledRendering )
+    return iTargetPixel + floor(u_TileOffset * u_Resolution + .5);
+  return iTargetPixel;
+}
+
+// ----------------------------------------------------------------------------
+// GetRay
+// ----------------------------------------------------------------------------
+Ray GetRay( in vec2 iCoordUV )
+{
+  Ray ray;
+
+  float r1 = 2.0 * rand();
+  float r2 = 2.0 * rand();
+
+  vec2 jitter;
+  jitter.x = ( r1 < 1.0 ) ? ( sqrt(r1) - 1.0 ) : ( 1.0 - sqrt(2.0 - r1) ) ;
+  jitter.y = ( r2 < 1.0 ) ? ( sqrt(r2) - 1.0 ) : ( 1.0 - sqrt(2.0 - r2) ) ;
+  jitter /= (u_Resolution * 0.5);
+
+  vec2 centeredUV = ( 2. * iCoordUV - 1. ) + jitter;
+
+  float scale = tan(u_Camera._FOV * .5);
+  centeredUV.x *= scale;
+  centeredUV.y *= ( u_Resolution.y / u_Resolution.x ) * scale;
+
+  if ( u_Camera._LensRadius > EPSILON )
+  {
+    // FocalDist/Aperture
+    vec2 randDisk = u_Camera._LensRadius * RandomInUnitDisk();
+    vec3 randOffset = u_Camera._Right * randDisk.x + u_Camera._Up * randDisk.y;
+
+    vec3 focalPoint = u_Camera._Pos + u_Camera._FocalDist * ( u_Camera._Right * centeredUV.x + u_Camera._Up * centeredUV.y + u_Camera._Forward );
+    //vec3 focalPoint = u_Camera._Pos + u_Camera._FocalDist * normalize( u_Camera._Right * centeredUV.x + u_Camera._Up * centeredUV.y + u_Camera._Forward );
+    ray._Orig = u_Camera._Pos + randOffset;
+    ray._Dir = normalize(focalPoint - ray._Orig);
+  }
+  else
+  {
+    ray._Orig = u_Camera._Pos;
+    ray._Dir = normalize(u_Camera._Right * centeredUV.x + u_Camera._Up * centeredUV.y + u_Camera._Forward);
+  }
+
+  return ray;
+}
+
+// ----------------------------------------------------------------------------
+// SampleEnvMapLight
+// Direct lighting from the environment map, oShadowRay must be unoccluded for oLd to count.
+// ----------------------------------------------------------------------------
+bool SampleEnvMapLight( in Ray iRay, in HitPoint iClosestHit, in Material iMat, in float iEta, out Ray oShadowRay, out vec3 oLd )
+{
+  oLd = vec3(0.);
+  vec3 scatterPos = iClosestHit._Pos + iClosestHit._Normal * RESOLUTION;
+
+  vec3 lightDir;
+  vec4 envMapColPdf = SampleEnvMap(u_EnvMap, u_EnvMapRotation , u_EnvMapRes, u_EnvMapAlias, u_EnvMapTotalWeight, lightDir);
+  float lightPdf = envMapColPdf.w;
+
+  oShadowRay = Ray(scatterPos, lightDir);
+
+  float cosTheta = dot(iClosestHit._Normal, lightDir);
+  if ( ( cosTheta > 0. ) && ( lightPdf > EPSILON ) )
+  {
+    //float pdf = cosTheta / PI;
+    //vec3 f = BRDF(iClosestHit._Normal, -iRay._Dir, lightDir, iMat) * cosTheta;
+    float pdf = 0.f;
+    vec3 f =  DisneyEval( iClosestHit, iMat, iEta, -iRay._Dir, lightDir, pdf );
+
+    float misWeight = PowerHeuristic(lightPdf, pdf);
+    if ( misWeight > 0. )
+    {
+      oLd = misWeight * envMapColPdf.rgb * f * u_EnvMapIntensity / lightPdf;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// SampleLightSource
+// Direct lighting from a randomly chosen light, oShadowRay must be unoccluded up to oDistToLight for oLd to count.
+// ----------------------------------------------------------------------------
+bool SampleLightSource( in Ray iRay, in HitPoint iClosestHit, in Material iMat, in float iEta, out Ray oShadowRay, out float oDistToLight, out vec3 oLd )
+{
+  oLd = vec3(0.);
+  vec3 scatterPos = iClosestHit._Pos + iClosestHit._Normal * RESOLUTION;
+
+  // Choose a light source randomly
+  int lightInd = int(rand() * u_NbLights);
+
+  // Get direction to it
+  vec3 lightDir = GetLightDirSample(scatterPos, u_Lights[lightInd]);
+
+  oDistToLight = length(lightDir);
+  lightDir = normalize(lightDir);
+
+  oShadowRay = Ray(scatterPos, lightDir);
+
+  float cosTheta = dot(iClosestHit._Normal, lightDir);
+  if ( cosTheta > 0. )
+  {
+    // Get the pdf value for this direction
+    float lightPdf = 0.0f;
+    for ( int j = 0; j < u_NbLights; ++j )
+    {
+      lightPdf += LightPDF(u_Lights[j], oShadowRay);
+    }
+    lightPdf /= u_NbLights;
+
+    if ( lightPdf > EPSILON )
+    {
+      float pdf = 0.f;
+      vec3 f = DisneyEval( iClosestHit, iMat, iEta, -iRay._Dir, lightDir, pdf );
+
+      float misWeight = PowerHeuristic(lightPdf, pdf);
+      if ( misWeight > 0. )
+      {
+        oLd = misWeight * u_Lights[lightInd]._Emission * f / lightPdf;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// Scatter
+// ----------------------------------------------------------------------------
+bool Scatter( in Ray iRay, in HitPoint iClosestHit, in Material iMat, in float iEta, out ScatterRecord oScatterRecord )
+{
+  oScatterRecord = ScatterRecord(SCATTER_NONE, vec3(0.f), 0.f, vec3(0.f));
+
+  oScatterRecord._Attenuation = DisneySample( iClosestHit, iMat, iEta, -iRay._Dir, oScatterRecord._Dir, oScatterRecord._P );
+
+  if ( oScatterRecord._P < EPSILON )
+    return false;
+
+  oScatterRecord._Type = SCATTER_RANDOM;
+  return true;
+}
+
+#endif // _PATHTRACING_GLSL_
@@ -34,6 +34,7 @@ mat3 ComputeTangentSpaceMatrix( in vec3 iN )
   return mat3(T, BT, iN);
 }
 
+#ifndef _COMPUTE_SHADER_ // Screen space derivatives : fragment shaders only
 // ----------------------------------------------------------------------------
 // ComputeTangentFrame
 // Tangent frame matching the local UV parameterization, for normal maps.
@@ -56,6 +57,7 @@ void ComputeTangentFrame( in vec3 iNormal, in vec3 iPosition, in vec2 iUV, out v
   oTangent = normalize(oTangent - iNormal * dot(iNormal, oTangent));
   oBitangent = normalize(cross(iNormal, oTangent)) * sign(determinant);
 }
+#endif
 
 // ----------------------------------------------------------------------------
 // ToWorld
@@ -230,6 +232,16 @@ vec3 SampleSkybox( in vec3 iRayDir, in sampler2D iSkyboxTex, in float iSkyboxRot
   return texture(iSkyboxTex, uv).rgb;
 }
 
+// ----------------------------------------------------------------------------
+// EnvMapTexelProbability
+// Texel weights are luminance * sin(theta) of the row center (see EnvMap::BuildCDF)
+// ----------------------------------------------------------------------------
+float EnvMapTexelProbability( in sampler2D iEnvMap, in ivec2 iTexel, in vec2 iEnvMapRes, in float iTotalWeight )
+{
+  float sinTheta = sin(( float(iTexel.y) + .5 ) / iEnvMapRes.y * PI);
+  return max(Luminance(texelFetch(iEnvMap, iTexel, 0).rgb), 0.) * sinTheta / iTotalWeight;
+}
+
 // ----------------------------------------------------------------------------
 // SampleEnvMap
 // UV mapping : https://en.wikipedia.org/wiki/UV_mapping
@@ -244,9 +256,10 @@ vec4 SampleEnvMap( in vec3 iRayDir, in sampler2D iEnvMap, in float iRotation, in
   
   vec3 color = texture(iEnvMap, uv).rgb;
   float pdf = 0.;
-  if ( sin( theta ) != 0. )
+  if ( ( sin( theta ) > 0. ) && ( iTotalWeight > 0. ) )
   {
-    pdf = Luminance(color) / iTotalWeight;
+    ivec2 texel = min(ivec2(vec2(fract(uv.x), uv.y) * iEnvMapRes), ivec2(iEnvMapRes) - 1);
+    pdf = EnvMapTexelProbability(iEnvMap, texel, iEnvMapRes, iTotalWeight);
     pdf *= ( iEnvMapRes.x * iEnvMapRes.y ) / ( TWO_PI * PI * sin(theta) );
   }
   
@@ -254,46 +267,40 @@ vec4 SampleEnvMap( in vec3 iRayDir, in sampler2D iEnvMap, in float iRotation, in
 }
 
 // ----------------------------------------------------------------------------
-// BinarySearch
+// SampleAliasTable
+// Entry of the alias table stored in row iRow, ioRand is remapped to [0, 1)
+// so that it can place the sample inside the selected texel.
 // ----------------------------------------------------------------------------
-vec2 BinarySearch( in float iValue, in sampler2D iEnvMap, in vec2 iEnvMapRes, in sampler2D iEnvMapCDF )
+int SampleAliasTable( in sampler2D iAliasTable, in int iRow, in int iCount, inout float ioRand )
 {
-  ivec2 envMapRes = ivec2(iEnvMapRes);
+  float scaled = ioRand * float(iCount);
+  int index = min(int(scaled), iCount - 1);
+  float frac = scaled - float(index);
 
-  int lower = 0;
-  int upper = envMapRes.y - 1;
-  while ( lower < upper )
+  vec2 entry = texelFetch(iAliasTable, ivec2(index, iRow), 0).rg; // threshold, alias
+  if ( frac < entry.x )
   {
-    int mid = ( lower + upper ) >> 1;
-    if ( iValue < texelFetch( iEnvMapCDF, ivec2( envMapRes.x - 1, mid ), 0 ).r )
-      upper = mid;
-    else
-      lower = mid + 1;
+    ioRand = frac / entry.x;
+    return index;
   }
-  int y = clamp( lower, 0, envMapRes.y - 1 );
 
-  lower = 0;
-  upper = envMapRes.x - 1;
-  while ( lower < upper )
-  {
-    int mid = ( lower + upper ) >> 1;
-    if ( iValue < texelFetch( iEnvMapCDF, ivec2( mid, y ), 0 ).r )
-      upper = mid;
-    else
-      lower = mid + 1;
-  }
-
-  int x = clamp( lower, 0, envMapRes.x - 1 );
-
-  return vec2( x, y ) / iEnvMapRes;
+  ioRand = min(( frac - entry.x ) / max(1. - entry.x, 1e-6), 0.99999);
+  return int(entry.y);
 }
 
 // ----------------------------------------------------------------------------
 // SampleEnvMap
+// Row then column from the alias tables (see EnvMap::BuildCDF)
 // ----------------------------------------------------------------------------
-vec4 SampleEnvMap( in sampler2D iEnvMap, in float iRotation, in vec2 iEnvMapRes, in sampler2D iEnvMapCDF, in float iTotalWeight, out vec3 oDir )
+vec4 SampleEnvMap( in sampler2D iEnvMap, in float iRotation, in vec2 iEnvMapRes, in sampler2D iEnvMapAlias, in float iTotalWeight, out vec3 oDir )
 {
-  vec2 uv = BinarySearch(rand() * iTotalWeight, iEnvMap, iEnvMapRes, iEnvMapCDF);
+  ivec2 envMapRes = ivec2(iEnvMapRes);
+  vec2 jitter;
+  jitter.y = rand();
+  jitter.x = rand();
+  int y = SampleAliasTable(iEnvMapAlias, envMapRes.y, envMapRes.y, jitter.y);
+  int x = SampleAliasTable(iEnvMapAlias, y, envMapRes.x, jitter.x);
+  vec2 uv = ( vec2(x, y) + jitter ) / iEnvMapRes;
   
   float phi = ( uv.x - iRotation ) * TWO_PI;
   float theta = uv.y * PI;
@@ -304,9 +311,9 @@ vec4 SampleEnvMap( in sampler2D iEnvMap, in float iRotation, in vec2 iEnvMapRes,
   vec3 color = texture(iEnvMap, uv).rgb;
 
   float pdf = 0.;
-  if ( sin( theta ) != 0. )
+  if ( ( sin( theta ) > 0. ) && ( iTotalWeight > 0. ) )
   {
-    pdf = Luminance(color) / iTotalWeight;
+    pdf = EnvMapTexelProbability(iEnvMap, ivec2(x, y), iEnvMapRes, iTotalWeight);
     pdf *= ( iEnvMapRes.x * iEnvMapRes.y ) / ( TWO_PI * PI * sin(theta) );
   }
 
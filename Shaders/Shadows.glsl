@@ -2,6 +2,7 @@
 #define _SHADOWS_GLSL_
 
 #define MAX_SHADOW_CASTER_COUNT 8
+#define MAX_SHADOW_2D_LAYER_COUNT 16
 
 struct ShadowCaster
 {
@@ -11,7 +12,8 @@ struct ShadowCaster
   float _Far;
   vec3  _Pos;
   vec3  _Dir;
-  mat4  _DirectionalViewProj;
+  int   _NbCascades;    // Distant lights : consecutive 2D layers from _Layer
+  vec4  _CascadeSplits; // Camera depth where each cascade ends
   mat4  _CubeViewProj[6];
 };
 
@@ -21,6 +23,9 @@ uniform int              u_EnableShadowMapping = 0;
 uniform int              u_NbShadowCasters = 0;
 uniform ShadowCaster     u_ShadowCasters[MAX_SHADOW_CASTER_COUNT];
 uniform float            u_ShadowBias = 0.02;
+uniform mat4             u_Shadow2DViewProj[MAX_SHADOW_2D_LAYER_COUNT]; // Per 2D layer
+uniform vec3             u_ShadowViewPos;
+uniform vec3             u_ShadowViewDir;
 
 int FindShadowCaster( int iLightIndex, int iLightType )
 {
@@ -70,7 +75,15 @@ float ComputeLocalShadow( int iCasterIndex, vec3 iFragPos )
 float ComputeDistantShadow( int iCasterIndex, vec3 iFragPos, vec3 iNormal, vec3 iLightDir )
 {
   ShadowCaster caster = u_ShadowCasters[iCasterIndex];
-  vec4 shadowPos = caster._DirectionalViewProj * vec4(iFragPos, 1.0);
+
+  // First cascade covering the fragment camera depth
+  float viewDepth = dot(iFragPos - u_ShadowViewPos, u_ShadowViewDir);
+  int cascade = 0;
+  while ( ( cascade < caster._NbCascades - 1 ) && ( viewDepth > caster._CascadeSplits[cascade] ) )
+    cascade++;
+  int layer = caster._Layer + cascade;
+
+  vec4 shadowPos = u_Shadow2DViewProj[layer] * vec4(iFragPos, 1.0);
   vec3 projCoords = shadowPos.xyz / shadowPos.w;
 
   if ( ( projCoords.x < -1.0 ) || ( projCoords.x > 1.0 )
@@ -88,7 +101,7 @@ float ComputeDistantShadow( int iCasterIndex, vec3 iFragPos, vec3 iNormal, vec3
   {
     for ( int x = -1; x <= 1; ++x )
     {
-      float closestDepth = texture( u_Shadow2DMaps, vec3(uv + vec2(x, y) * texelSize, float(caster._Layer)) ).r;
+      float closestDepth = texture( u_Shadow2DMaps, vec3(uv + vec2(x, y) * texelSize, float(layer)) ).r;
       if ( currentDepth - bias > closestDepth )
         shadow += 1.0;
     }
@@ -0,0 +1,192 @@
+/*
+ *
+ */
+
+#ifndef _WAVEFRONT_GLSL_
+#define _WAVEFRONT_GLSL_
+
+#define _COMPUTE_SHADER_
+
+#include PathTracing.glsl
+
+// Wavefront path tracing queues (see PathTracer::PathTraceWavefront)
+// One path per pixel of the current target, rays move between the stages through compacted index queues.
+
+#define WAVEFRONT_GROUP_SIZE 64
+#define WAVEFRONT_MAX_GROUPS 32768u // Queue dispatches wrap to a second dimension past this group count
+
+// Shadow ray kinds : one of each at most per path and bounce
+#define SHADOW_ENVMAP 0
+#define SHADOW_LIGHT  1
+
+struct WavefrontPath
+{
+  vec4  _Orig;              // xyz : ray origin, w : pdf of the previous scatter
+  vec4  _Dir;               // xyz : ray direction
+  vec4  _Throughput;        // xyz : path throughput
+  vec4  _Radiance;          // xyz : radiance gathered by the shading stage, over all the samples of the frame
+  vec4  _ShadowRadiance[2]; // xyz : radiance gathered by the shadow stage, per shadow ray kind
+  uvec4 _Seed;              // RNG state between the stages
+  ivec4 _Info;              // x : depth, y : scatter type of the previous bounce
+};
+
+struct WavefrontHit
+{
+  vec4  _PosDist;           // xyz : position, w : distance (< 0 when missed)
+  vec4  _Normal;
+  vec4  _Tangent;
+  vec4  _Bitangent;
+  vec4  _UV;
+  ivec4 _IDs;               // x : material, y : light, z : front face, w : emitter
+};
+
+struct WavefrontShadowRay
+{
+  vec4  _Orig;              // xyz : origin, w : max distance
+  vec4  _Dir;
+  vec4  _Radiance;          // xyz : contribution when unoccluded, throughput included
+  ivec4 _Info;              // x : path index, y : kind
+};
+
+layout(std430, binding = 0) buffer WavefrontPaths
+{
+  WavefrontPath u_Paths[];
+};
+
+layout(std430, binding = 1) buffer WavefrontHits
+{
+  WavefrontHit u_Hits[];
+};
+
+// Two ray queues ping-ponged every bounce : queue q starts at q * u_PathCapacity
+layout(std430, binding = 2) buffer WavefrontRayQueues
+{
+  uint u_RayQueues[];
+};
+
+// Ray queue indices sorted by material
+layout(std430, binding = 3) buffer WavefrontMaterialQueue
+{
+  uint u_MaterialQueue[];
+};
+
+layout(std430, binding = 4) buffer WavefrontShadowRays
+{
+  WavefrontShadowRay u_ShadowRays[];
+};
+
+// Also bound as GL_DISPATCH_INDIRECT_BUFFER
+layout(std430, binding = 5) buffer WavefrontCounters
+{
+  uvec4 u_ExtendArgs;
+  uvec4 u_ShadeArgs;
+  uvec4 u_ShadowArgs;
+  uint  u_RayCount[2];
+  uint  u_ShadowCount;
+};
+
+// Material buckets : counts in [0, u_NbBuckets), write cursors in [u_NbBuckets, 2 * u_NbBuckets)
+// Bucket 0 gathers the misses and the emitters, bucket i + 1 the hits on material i.
+layout(std430, binding = 6) buffer WavefrontBuckets
+{
+  uint u_Buckets[];
+};
+
+uniform int   u_PathCapacity;
+uniform int   u_NbBuckets;
+uniform int   u_RayQueue;     // Queue read by the current bounce
+uniform ivec2 u_TargetSize;   // Pixels of the current target : full resolution, tile or low resolution
+
+// ----------------------------------------------------------------------------
+// QueueIndex
+// ----------------------------------------------------------------------------
+uint QueueIndex()
+{
+  return gl_GlobalInvocationID.x + gl_GlobalInvocationID.y * gl_NumWorkGroups.x * WAVEFRONT_GROUP_SIZE;
+}
+
+// ----------------------------------------------------------------------------
+// DispatchArgs
+// Indirect arguments covering iCount queue entries
+// ----------------------------------------------------------------------------
+uvec4 DispatchArgs( in uint iCount )
+{
+  uint nbGroups = ( iCount + WAVEFRONT_GROUP_SIZE - 1 ) / WAVEFRONT_GROUP_SIZE;
+  uint nbGroupsX = min(nbGroups, WAVEFRONT_MAX_GROUPS);
+  return uvec4(nbGroupsX, ( nbGroups + nbGroupsX - 1u ) / max(nbGroupsX, 1u), 1u, 0u);
+}
+
+// ----------------------------------------------------------------------------
+// StoreHit
+// ----------------------------------------------------------------------------
+void StoreHit( in uint iPathIndex, in bool iHit, in HitPoint iClosestHit )
+{
+  WavefrontHit hit;
+  hit._PosDist   = vec4(iClosestHit._Pos, iHit ? iClosestHit._Dist : -1.f);
+  hit._Normal    = vec4(iClosestHit._Normal, 0.f);
+  hit._Tangent   = vec4(iClosestHit._Tangent, 0.f);
+  hit._Bitangent = vec4(iClosestHit._Bitangent, 0.f);
+  hit._UV        = vec4(iClosestHit._UV, 0.f, 0.f);
+  hit._IDs       = ivec4(iClosestHit._MaterialID, iClosestHit._LightID, iClosestHit._FrontFace ? 1 : 0, iClosestHit._IsEmitter ? 1 : 0);
+  u_Hits[iPathIndex] = hit;
+}
+
+// ----------------------------------------------------------------------------
+// LoadHit
+// ----------------------------------------------------------------------------
+bool LoadHit( in uint iPathIndex, out HitPoint oClosestHit )
+{
+  WavefrontHit hit = u_Hits[iPathIndex];
+  oClosestHit._Dist       = hit._PosDist.w;
+  oClosestHit._Pos        = hit._PosDist.xyz;
+  oClosestHit._Normal     = hit._Normal.xyz;
+  oClosestHit._Tangent    = hit._Tangent.xyz;
+  oClosestHit._Bitangent  = hit._Bitangent.xyz;
+  oClosestHit._UV         = hit._UV.xy;
+  oClosestHit._MaterialID = hit._IDs.x;
+  oClosestHit._LightID    = hit._IDs.y;
+  oClosestHit._FrontFace  = ( 0 != hit._IDs.z );
+  oClosestHit._IsEmitter  = ( 0 != hit._IDs.w );
+  return ( hit._PosDist.w >= 0.f );
+}
+
+// ----------------------------------------------------------------------------
+// HitBucket
+// ----------------------------------------------------------------------------
+int HitBucket( in uint iPathIndex )
+{
+  WavefrontHit hit = u_Hits[iPathIndex];
+  if ( ( hit._PosDist.w < 0.f ) || ( 0 != hit._IDs.w ) || ( hit._IDs.x < 0 ) )
+    return 0;
+  return min(hit._IDs.x + 1, u_NbBuckets - 1);
+}
+
+// ----------------------------------------------------------------------------
+// PixelCoord
+// ----------------------------------------------------------------------------
+ivec2 PixelCoord( in uint iPathIndex )
+{
+  return ivec2(int(iPathIndex) % u_TargetSize.x, int(iPathIndex) / u_TargetSize.x);
+}
+
+// ----------------------------------------------------------------------------
+// PixelUV
+// Same mapping as fragUV in the megakernel, tiles included
+// ----------------------------------------------------------------------------
+vec2 PixelUV( in ivec2 iPixel )
+{
+  vec2 coordUV = ( vec2(iPixel) + 0.5 ) / vec2(u_TargetSize);
+  if( 1 == u_TiledRendering )
+    coordUV = mix(u_TileOffset, u_TileOffset + u_InvNbTiles, coordUV);
+  return coordUV;
+}
+
+// ----------------------------------------------------------------------------
+// PixelSkipped
+// ----------------------------------------------------------------------------
+bool PixelSkipped( in vec2 iCoordUV )
+{
+  return ( ( 1 == u_AdaptiveSampling ) && ( texture(u_SampleMoments, iCoordUV).w > .5f ) );
+}
+
+#endif // _WAVEFRONT_GLSL_
@@ -0,0 +1,133 @@
+#version 430 core
+
+// Per-instance culling for the multi-draw indirect path (see DeferredRenderer::CullOpaqueInstances)
+// Visible commands are appended to a compacted command list, u_DrawCount receives their number.
+
+#include DrawInstances.glsl
+
+layout(local_size_x = 64) in;
+
+struct DrawCommand
+{
+  uint _Count;
+  uint _InstanceCount;
+  uint _FirstIndex;
+  int  _BaseVertex;
+  uint _BaseInstance; // Draw index : kept as is so a_DrawID still selects the instance entry
+};
+
+layout(std430, binding = 1) readonly buffer SourceCommands
+{
+  DrawCommand u_SourceCommands[];
+};
+
+layout(std430, binding = 2) writeonly buffer CulledCommands
+{
+  DrawCommand u_CulledCommands[];
+};
+
+layout(std430, binding = 3) buffer DrawCount
+{
+  uint u_DrawCount;
+};
+
+layout(std430, binding = 4) buffer CullStats
+{
+  uint u_VisibleCounts[];
+};
+
+uniform int  u_NbDraws;
+uniform int  u_StatsSlot;
+uniform vec4 u_FrustumPlanes[6]; // Pointing inside : left, right, bottom, top, near, far
+
+// Occlusion against the max-depth pyramid of the previous frame
+uniform int       u_EnableOcclusion;
+uniform mat4      u_HiZViewProj;
+uniform sampler2D u_HiZ;
+uniform ivec2     u_HiZSize;
+uniform int       u_HiZMaxLevel;
+
+// ----------------------------------------------------------------------------
+// IsOutsideFrustum
+// ----------------------------------------------------------------------------
+bool IsOutsideFrustum( in vec3 iLow, in vec3 iHigh )
+{
+  for ( int i = 0; i < 6; ++i )
+  {
+    vec3 farthest = mix(iLow, iHigh, greaterThanEqual(u_FrustumPlanes[i].xyz, vec3(0.0)));
+    if ( dot(u_FrustumPlanes[i].xyz, farthest) + u_FrustumPlanes[i].w < 0.0 )
+      return true;
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// IsOccluded
+// ----------------------------------------------------------------------------
+bool IsOccluded( in vec3 iLow, in vec3 iHigh )
+{
+  vec2 uvMin = vec2(1.0);
+  vec2 uvMax = vec2(0.0);
+  float minDepth = 1.0;
+
+  for ( int i = 0; i < 8; ++i )
+  {
+    vec3 corner = vec3(( 0 != ( i & 1 ) ) ? iHigh.x : iLow.x,
+                       ( 0 != ( i & 2 ) ) ? iHigh.y : iLow.y,
+                       ( 0 != ( i & 4 ) ) ? iHigh.z : iLow.z);
+    vec4 clip = u_HiZViewProj * vec4(corner, 1.0);
+
+    // Crosses the camera plane : keep it
+    if ( clip.w <= 1e-5 )
+      return false;
+
+    vec3 ndc = clip.xyz / clip.w;
+    vec2 uv = ndc.xy * 0.5 + 0.5;
+    uvMin = min(uvMin, uv);
+    uvMax = max(uvMax, uv);
+    minDepth = min(minDepth, ndc.z * 0.5 + 0.5);
+  }
+
+  if ( minDepth <= 0.0 )
+    return false;
+
+  // Partly outside the previous frame : no depth there, keep it
+  if ( any(lessThan(uvMin, vec2(0.0))) || any(greaterThan(uvMax, vec2(1.0))) )
+    return false;
+
+  // Pick the level where the projected box spans at most 2x2 texels
+  vec2 extent = ( uvMax - uvMin ) * vec2(u_HiZSize);
+  int level = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, u_HiZMaxLevel);
+  ivec2 levelSize = max(u_HiZSize >> level, ivec2(1));
+  ivec2 p0 = clamp(ivec2(uvMin * vec2(u_HiZSize)) >> level, ivec2(0), levelSize - 1);
+  ivec2 p1 = clamp(ivec2(uvMax * vec2(u_HiZSize)) >> level, ivec2(0), levelSize - 1);
+
+  float maxDepth = max(max(texelFetch(u_HiZ, p0, level).r, texelFetch(u_HiZ, ivec2(p1.x, p0.y), level).r),
+                       max(texelFetch(u_HiZ, ivec2(p0.x, p1.y), level).r, texelFetch(u_HiZ, p1, level).r));
+
+  return ( minDepth > maxDepth );
+}
+
+void main()
+{
+  uint drawIndex = gl_GlobalInvocationID.x;
+  if ( drawIndex >= uint(u_NbDraws) )
+    return;
+
+  DrawCommand command = u_SourceCommands[drawIndex];
+  DrawInstance inst = u_DrawInstances[command._BaseInstance];
+
+  // w = 0 : unknown bounds, always visible
+  if ( inst._BoundsMin.w > 0.5 )
+  {
+    if ( IsOutsideFrustum(inst._BoundsMin.xyz, inst._BoundsMax.xyz) )
+      return;
+
+    if ( ( 0 != u_EnableOcclusion ) && IsOccluded(inst._BoundsMin.xyz, inst._BoundsMax.xyz) )
+      return;
+  }
+
+  uint slot = atomicAdd(u_DrawCount, 1u);
+  u_CulledCommands[slot] = command;
+  atomicAdd(u_VisibleCounts[u_StatsSlot], 1u);
+}
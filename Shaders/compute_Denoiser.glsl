@@ -2,11 +2,22 @@
  * Designed with ChatGPT & MistralAI
  */
 
-#version 450
+#version 430
 
 #include Constants.glsl
 
-layout(local_size_x = 16, local_size_y = 16) in;
+// Shared memory tiling (see PathTracer::DenoiseOutput)
+// Every group loads its pixels and an apron around them once, the 5x5 kernels then read their
+// neighbourhood from the tile. The apron covers two edge-aware a-trous iterations (steps 1 and 2),
+// which run in the same dispatch. Wider kernels (multi-scale wavelet, later a-trous steps) read the images.
+
+#define DENOISER_GROUP_SIZE   16
+#define DENOISER_APRON        6
+#define DENOISER_TILE_SIZE    ( DENOISER_GROUP_SIZE + 2 * DENOISER_APRON )
+#define DENOISER_TILE_TEXELS  ( DENOISER_TILE_SIZE * DENOISER_TILE_SIZE )
+#define DENOISER_GROUP_TEXELS ( DENOISER_GROUP_SIZE * DENOISER_GROUP_SIZE )
+
+layout(local_size_x = DENOISER_GROUP_SIZE, local_size_y = DENOISER_GROUP_SIZE) in;
 
 layout(rgba32f, binding = 0) uniform image2D u_InputImage;
 layout(rgba32f, binding = 1) uniform image2D u_InputNormals;
@@ -25,6 +36,81 @@ uniform float u_ColorPhi    = 0.9f;
 uniform float u_NormalPhi   = 0.3f;
 uniform float u_PositionPhi = 0.6f;
 
+uniform int u_FirstIteration = 0; // Edge-aware : a-trous iteration of the dispatch, step 2^iteration
+uniform int u_NbIterations   = 1; // Edge-aware : 2 only from the first iteration
+
+// Normals are packed to keep the tile under the 32 KB of shared memory every GL 4.3 implementation offers
+shared vec4 s_Color[DENOISER_TILE_TEXELS];
+shared vec4 s_Pos[DENOISER_TILE_TEXELS];
+shared uint s_Normal[DENOISER_TILE_TEXELS];
+
+// ----------------------------------------------------------------------------
+// PackNormal
+// Octahedral encoding
+// ----------------------------------------------------------------------------
+uint PackNormal( in vec3 iN )
+{
+  vec2 p = iN.xy / max(abs(iN.x) + abs(iN.y) + abs(iN.z), EPSILON);
+  if ( iN.z < 0. )
+    p = ( 1. - abs(p.yx) ) * vec2(( p.x >= 0. ) ? 1. : -1., ( p.y >= 0. ) ? 1. : -1.);
+  return packSnorm2x16(p);
+}
+
+// ----------------------------------------------------------------------------
+// UnpackNormal
+// ----------------------------------------------------------------------------
+vec3 UnpackNormal( in uint iPacked )
+{
+  vec2 f = unpackSnorm2x16(iPacked);
+  vec3 n = vec3(f, 1. - abs(f.x) - abs(f.y));
+  float t = clamp(-n.z, 0., 1.);
+  n.xy -= vec2(( n.x >= 0. ) ? t : -t, ( n.y >= 0. ) ? t : -t);
+  return normalize(n);
+}
+
+// ----------------------------------------------------------------------------
+// TileOrigin
+// ----------------------------------------------------------------------------
+ivec2 TileOrigin()
+{
+  return ivec2(gl_WorkGroupID.xy) * DENOISER_GROUP_SIZE - DENOISER_APRON;
+}
+
+// ----------------------------------------------------------------------------
+// TileIndex
+// ----------------------------------------------------------------------------
+int TileIndex( in ivec2 iPixelCoord )
+{
+  ivec2 local = iPixelCoord - TileOrigin();
+  return local.y * DENOISER_TILE_SIZE + local.x;
+}
+
+// ----------------------------------------------------------------------------
+// LoadTile
+// Texels outside the image hold the nearest border texel, as clamped fetches would
+// ----------------------------------------------------------------------------
+void LoadTile( in ivec2 iImageSize )
+{
+  ivec2 origin = TileOrigin();
+  for ( int i = int(gl_LocalInvocationIndex); i < DENOISER_TILE_TEXELS; i += DENOISER_GROUP_TEXELS )
+  {
+    ivec2 coord = clamp(origin + ivec2(i % DENOISER_TILE_SIZE, i / DENOISER_TILE_SIZE), ivec2(0), iImageSize - ivec2(1));
+    s_Color[i]  = imageLoad(u_InputImage, coord);
+    s_Pos[i]    = imageLoad(u_InputPos, coord);
+    s_Normal[i] = PackNormal(imageLoad(u_InputNormals, coord).xyz);
+  }
+
+  barrier();
+}
+
+// ----------------------------------------------------------------------------
+// TileColor
+// ----------------------------------------------------------------------------
+vec4 TileColor( in ivec2 iPixelCoord )
+{
+  return s_Color[TileIndex(iPixelCoord)];
+}
+
 // ----------------------------------------------------------------------------
 // Soft thresholding function (similar to wavelet denoising)
 // ----------------------------------------------------------------------------
@@ -39,10 +125,10 @@ vec4 SoftThreshold( in vec4 iValue, in float iThreshold )
 vec4 SingleScaleDenoiser( in ivec2 iPixelCoord )
 {
   // Load the original color
-  vec4 c00 = imageLoad(u_InputImage, iPixelCoord);
-  vec4 c10 = imageLoad(u_InputImage, iPixelCoord + ivec2(1, 0));
-  vec4 c01 = imageLoad(u_InputImage, iPixelCoord + ivec2(0, 1));
-  vec4 c11 = imageLoad(u_InputImage, iPixelCoord + ivec2(1, 1));
+  vec4 c00 = TileColor(iPixelCoord);
+  vec4 c10 = TileColor(iPixelCoord + ivec2(1, 0));
+  vec4 c01 = TileColor(iPixelCoord + ivec2(0, 1));
+  vec4 c11 = TileColor(iPixelCoord + ivec2(1, 1));
 
   // Haar Wavelet Transform (Decomposition)
   vec4 average          = (c00 + c10 + c01 + c11) * 0.25;
@@ -118,7 +204,7 @@ vec4 MultiScaleDenoiser( in ivec2 iPixelCoord, in ivec2 iImageSize )
 // ----------------------------------------------------------------------------
 vec4 BilateralFilter( in ivec2 iPixelCoord )
 {
-  vec4 centerColor = imageLoad( u_InputImage, iPixelCoord );
+  vec4 centerColor = TileColor( iPixelCoord );
 
   vec4 sum = vec4( 0.0 );
   float weightSum = 0.0;
@@ -127,7 +213,7 @@ vec4 BilateralFilter( in ivec2 iPixelCoord )
     for ( int x = -2; x <= 2; ++x )
     {
       ivec2 neighborCoord = iPixelCoord + ivec2( x, y );
-      vec4 neighborColor = imageLoad( u_InputImage, neighborCoord );
+      vec4 neighborColor = TileColor( neighborCoord );
 
       float spatialWeight = exp( -dot( vec2( x, y ), vec2( x, y ) ) / ( 2.0 * u_SigmaSpatial * u_SigmaSpatial ) );
       float rangeWeight = exp( -dot( neighborColor.rgb - centerColor.rgb, neighborColor.rgb - centerColor.rgb ) / ( 2.0 * u_SigmaRange * u_SigmaRange ) );
@@ -142,60 +228,111 @@ vec4 BilateralFilter( in ivec2 iPixelCoord )
   return denoisedColor;
 }
 
+// ----------------------------------------------------------------------------
+// FetchTexel
+// ----------------------------------------------------------------------------
+void FetchTexel( in ivec2 iPixelCoord, in bool iFromTile, in ivec2 iImageSize, out vec3 oColor, out vec3 oNormal, out vec3 oPos )
+{
+  if ( iFromTile )
+  {
+    int index = TileIndex(iPixelCoord);
+    oColor  = s_Color[index].rgb;
+    oNormal = UnpackNormal(s_Normal[index]);
+    oPos    = s_Pos[index].xyz;
+    return;
+  }
+
+  ivec2 coord = clamp(iPixelCoord, ivec2(0), iImageSize - ivec2(1));
+  oColor  = imageLoad(u_InputImage, coord).rgb;
+  oNormal = imageLoad(u_InputNormals, coord).xyz;
+  oPos    = imageLoad(u_InputPos, coord).xyz;
+}
+
 // ----------------------------------------------------------------------------
 // EdgeAwareDenoiser
+// A-trous iteration : 5x5 B3 kernel dilated by 2^iIteration, color phi halved at every iteration
 // ----------------------------------------------------------------------------
-vec4 EdgeAwareDenoiser( in ivec2 iPixelCoord )
+vec4 EdgeAwareDenoiser( in ivec2 iPixelCoord, in int iIteration, in bool iFromTile, in ivec2 iImageSize )
 {
-  const float Kernel[25] = float[25](
-    1.0/256.0, 1.0/64.0, 3.0/128.0, 1.0/64.0, 1.0/256.0,
-    1.0/64.0,  1.0/16.0, 3.0/32.0,  1.0/16.0, 1.0/64.0,
-    3.0/128.0, 3.0/32.0, 9.0/64.0,  3.0/32.0, 3.0/128.0,
-    1.0/64.0,  1.0/16.0, 3.0/32.0,  1.0/16.0, 1.0/64.0,
-    1.0/256.0, 1.0/64.0, 3.0/128.0, 1.0/64.0, 1.0/256.0 );
-
-  const ivec2 Offset[25] = ivec2[25](
-    ivec2(-2,-2), ivec2(-1,-2), ivec2(0,-2), ivec2(1,-2), ivec2(2,-2),
-    ivec2(-2,-1), ivec2(-1,-1), ivec2(0,-2), ivec2(1,-1), ivec2(2,-1),
-    ivec2(-2, 0), ivec2(-1, 0), ivec2(0, 0), ivec2(1, 0), ivec2(2, 0),
-    ivec2(-2, 1), ivec2(-1, 1), ivec2(0, 1), ivec2(1, 1), ivec2(2, 1),
-    ivec2(-2, 2), ivec2(-1, 2), ivec2(0, 2), ivec2(1, 2), ivec2(2, 2) );
-  
-  vec3 cval = imageLoad(u_InputImage, iPixelCoord).rgb;   // Albedo
-  vec3 nval = imageLoad(u_InputNormals, iPixelCoord).rgb; // Normal
-  vec3 pval = imageLoad(u_InputPos, iPixelCoord).rgb;     // Position
+  const float Kernel[3] = float[3](3.0/8.0, 1.0/4.0, 1.0/16.0);
+
+  int step = 1 << iIteration;
+  float colorPhi = u_ColorPhi / float(step);
+
+  vec3 cval, nval, pval; // Albedo, normal, position
+  FetchTexel(iPixelCoord, iFromTile, iImageSize, cval, nval, pval);
 
   vec3 sum = vec3(0.0);
   float cum_w = 0.0;
-  
-  for ( uint i = 0; i < 25; ++i )
+
+  for ( int y = -2; y <= 2; ++y )
   {
-    ivec2 uv = iPixelCoord + Offset[i];
-    
-    // Albedo
-    vec3 ctmp = imageLoad(u_InputImage, uv).rgb;
-    vec3 t = cval - ctmp;                             // Ip - Iq      (color difference)
-    float dist2 = dot(t, t);                          // ||Ip - Iq||  (distance squared)
-    float c_w = min(exp(-(dist2) / u_ColorPhi), 1.0); // w(p,q)       (weight function)
-    
-    // Normals
-    vec3 ntmp = imageLoad(u_InputNormals, uv).rgb;
-    t = nval - ntmp;
-    dist2 = dot(t, t);
-    float n_w = min(exp(-(dist2) / u_NormalPhi), 1.0);
-    
-    // Positions
-    vec3 ptmp = imageLoad(u_InputPos, uv).rgb;
-    t = pval - ptmp;
-    dist2 = dot(t, t);
-    float p_w = min(exp(-(dist2) / u_PositionPhi), 1.0);
-    
-    float weight = c_w * n_w * p_w * Kernel[i];
-    sum += ctmp * weight;
-    cum_w += weight;
+    for ( int x = -2; x <= 2; ++x )
+    {
+      vec3 ctmp, ntmp, ptmp;
+      FetchTexel(iPixelCoord + ivec2(x, y) * step, iFromTile, iImageSize, ctmp, ntmp, ptmp);
+
+      // Albedo
+      vec3 t = cval - ctmp;                          // Ip - Iq      (color difference)
+      float dist2 = dot(t, t);                       // ||Ip - Iq||  (distance squared)
+      float c_w = min(exp(-(dist2) / colorPhi), 1.0); // w(p,q)       (weight function)
+
+      // Normals
+      t = nval - ntmp;
+      dist2 = dot(t, t);
+      float n_w = min(exp(-(dist2) / u_NormalPhi), 1.0);
+
+      // Positions
+      t = pval - ptmp;
+      dist2 = dot(t, t);
+      float p_w = min(exp(-(dist2) / u_PositionPhi), 1.0);
+
+      float weight = c_w * n_w * p_w * Kernel[abs(x)] * Kernel[abs(y)];
+      sum += ctmp * weight;
+      cum_w += weight;
+    }
   }
-  
-  return vec4(sum / cum_w, 0.f);
+
+  return vec4(sum / max(cum_w, EPSILON), 1.f);
+}
+
+// ----------------------------------------------------------------------------
+// EdgeAwareTwoIterations
+// The first iteration covers the group and the footprint of the second one, its result replaces the tile colors
+// ----------------------------------------------------------------------------
+vec4 EdgeAwareTwoIterations( in ivec2 iPixelCoord, in ivec2 iImageSize )
+{
+  const int RegionApron = 4; // 5x5 kernel with step 2
+  const int RegionSize = DENOISER_GROUP_SIZE + 2 * RegionApron;
+  const int RegionTexels = RegionSize * RegionSize;
+  const int TexelsPerInvocation = ( RegionTexels + DENOISER_GROUP_TEXELS - 1 ) / DENOISER_GROUP_TEXELS;
+
+  ivec2 regionOrigin = ivec2(gl_WorkGroupID.xy) * DENOISER_GROUP_SIZE - RegionApron;
+
+  // Texels outside the image take the result of the nearest border texel
+  vec4 firstIteration[TexelsPerInvocation];
+  for ( int k = 0; k < TexelsPerInvocation; ++k )
+  {
+    int i = int(gl_LocalInvocationIndex) + k * DENOISER_GROUP_TEXELS;
+    if ( i < RegionTexels )
+    {
+      ivec2 coord = clamp(regionOrigin + ivec2(i % RegionSize, i / RegionSize), ivec2(0), iImageSize - ivec2(1));
+      firstIteration[k] = EdgeAwareDenoiser(coord, u_FirstIteration, true, iImageSize);
+    }
+  }
+
+  barrier();
+
+  for ( int k = 0; k < TexelsPerInvocation; ++k )
+  {
+    int i = int(gl_LocalInvocationIndex) + k * DENOISER_GROUP_TEXELS;
+    if ( i < RegionTexels )
+      s_Color[TileIndex(regionOrigin + ivec2(i % RegionSize, i / RegionSize))] = firstIteration[k];
+  }
+
+  barrier();
+
+  return EdgeAwareDenoiser(iPixelCoord, u_FirstIteration + 1, true, iImageSize);
 }
 
 // ----------------------------------------------------------------------------
@@ -206,21 +343,35 @@ void main()
   ivec2 pixelCoord = ivec2(gl_GlobalInvocationID.xy);
   ivec2 size = imageSize( u_InputImage );
 
-  if ( pixelCoord.x >= size.x || pixelCoord.y >= size.y )
-    return; // Do not read/write outside limits
+  // The kernels reaching past the apron read the images
+  bool multiScale = ( 1 == u_DenoisingMethod ) && ( u_WaveletScale > 1 );
+  bool wideAtrous = ( 2 == u_DenoisingMethod ) && ( 2 * ( 1 << ( u_FirstIteration + u_NbIterations - 1 ) ) > DENOISER_APRON );
+  bool useTile = !multiScale && !wideAtrous;
+
+  // Every invocation takes part in the tile load, even outside the image
+  if ( useTile )
+    LoadTile(size);
 
-  // Select the denoising method
+  vec4 result = vec4(0.0);
   if ( 0 == u_DenoisingMethod )
-    imageStore(u_OutputImage, pixelCoord, BilateralFilter(pixelCoord));
+    result = BilateralFilter(pixelCoord);
   else if ( 1 == u_DenoisingMethod )
   {
-    if ( u_WaveletScale > 1 )
-      imageStore(u_OutputImage, pixelCoord, MultiScaleDenoiser(pixelCoord, size));
+    if ( multiScale )
+      result = MultiScaleDenoiser(pixelCoord, size);
     else
-      imageStore(u_OutputImage, pixelCoord, SingleScaleDenoiser(pixelCoord));
+      result = SingleScaleDenoiser(pixelCoord);
   }
   else if ( 2 == u_DenoisingMethod )
-    imageStore(u_OutputImage, pixelCoord, EdgeAwareDenoiser(pixelCoord));
-  else
-    imageStore(u_OutputImage, pixelCoord, vec4(0.0));
+  {
+    if ( useTile && ( u_NbIterations > 1 ) )
+      result = EdgeAwareTwoIterations(pixelCoord, size);
+    else
+      result = EdgeAwareDenoiser(pixelCoord, u_FirstIteration, useTile, size);
+  }
+
+  if ( pixelCoord.x >= size.x || pixelCoord.y >= size.y )
+    return; // Do not write outside limits
+
+  imageStore(u_OutputImage, pixelCoord, result);
 }
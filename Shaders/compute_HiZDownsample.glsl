@@ -0,0 +1,47 @@
+#version 430 core
+
+// Max-depth pyramid used by the occlusion culling (see DeferredRenderer::BuildHiZ)
+// Level 0 copies the G-buffer depth, every other level keeps the farthest depth of its source footprint.
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform int       u_CopyDepth;
+uniform sampler2D u_Depth;
+uniform ivec2     u_SrcSize;
+
+layout(r32f, binding = 0) readonly uniform image2D u_Src;
+layout(r32f, binding = 1) writeonly uniform image2D u_Dst;
+
+void main()
+{
+  ivec2 dstSize = imageSize(u_Dst);
+  ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+  if ( any(greaterThanEqual(coord, dstSize)) )
+    return;
+
+  if ( 0 != u_CopyDepth )
+  {
+    imageStore(u_Dst, coord, vec4(texelFetch(u_Depth, coord, 0).r));
+    return;
+  }
+
+  // Odd source sizes : the last texel also covers the extra row / column
+  ivec2 srcBase = coord * 2;
+  ivec2 footprint = ivec2(2);
+  if ( ( coord.x == dstSize.x - 1 ) && ( 0 != ( u_SrcSize.x & 1 ) ) && ( u_SrcSize.x > 1 ) )
+    footprint.x = 3;
+  if ( ( coord.y == dstSize.y - 1 ) && ( 0 != ( u_SrcSize.y & 1 ) ) && ( u_SrcSize.y > 1 ) )
+    footprint.y = 3;
+
+  float maxDepth = 0.0;
+  for ( int y = 0; y < footprint.y; ++y )
+  {
+    for ( int x = 0; x < footprint.x; ++x )
+    {
+      ivec2 srcCoord = min(srcBase + ivec2(x, y), u_SrcSize - 1);
+      maxDepth = max(maxDepth, imageLoad(u_Src, srcCoord).r);
+    }
+  }
+
+  imageStore(u_Dst, coord, vec4(maxDepth));
+}
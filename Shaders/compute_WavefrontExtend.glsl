@@ -0,0 +1,44 @@
+#version 430 core
+
+// Wavefront path tracing : closest hit of the queued rays (see PathTracer::PathTraceWavefront)
+// Hits are counted per material bucket for the sort stage, camera hits fill the normal and position targets.
+
+#include Wavefront.glsl
+
+layout(local_size_x = WAVEFRONT_GROUP_SIZE) in;
+
+layout(rgba32f, binding = 1) uniform writeonly image2D u_OutNormals;
+layout(rgba32f, binding = 2) uniform writeonly image2D u_OutPos;
+
+uniform int u_StoreGeometry = 1; // The low resolution target has no normal / position attachment
+
+void main()
+{
+  uint queueIndex = QueueIndex();
+  if ( queueIndex >= u_RayCount[u_RayQueue] )
+    return;
+
+  uint pathIndex = u_RayQueues[u_RayQueue * u_PathCapacity + queueIndex];
+  Ray ray = Ray(u_Paths[pathIndex]._Orig.xyz, u_Paths[pathIndex]._Dir.xyz);
+
+  HitPoint closestHit;
+  bool hit = TraceRay(ray, closestHit);
+
+  if ( ( 0 == u_Paths[pathIndex]._Info.x ) && ( 1 == u_StoreGeometry ) )
+  {
+    ivec2 pixel = PixelCoord(pathIndex);
+    if ( !hit )
+    {
+      imageStore(u_OutPos, pixel, vec4(INFINITY, INFINITY, INFINITY, 1.f));
+      imageStore(u_OutNormals, pixel, vec4(-ray._Dir, 1.f));
+    }
+    else
+    {
+      imageStore(u_OutPos, pixel, vec4(closestHit._Pos, 1.f));
+      imageStore(u_OutNormals, pixel, vec4(closestHit._Normal, 1.f));
+    }
+  }
+
+  StoreHit(pathIndex, hit, closestHit);
+  atomicAdd(u_Buckets[HitBucket(pathIndex)], 1u);
+}
@@ -0,0 +1,50 @@
+#version 430 core
+
+// Wavefront path tracing : camera rays of one sample per pixel (see PathTracer::PathTraceWavefront)
+// The first sample of the frame resets the path radiance, the next ones continue its RNG sequence.
+
+#include Wavefront.glsl
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform int u_SampleIndex;
+
+void main()
+{
+  ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+  if ( any(greaterThanEqual(pixel, u_TargetSize)) )
+    return;
+
+  uint pathIndex = uint(pixel.y * u_TargetSize.x + pixel.x);
+  vec2 coordUV = PixelUV(pixel);
+
+  WavefrontPath path = u_Paths[pathIndex];
+  if ( 0 == u_SampleIndex )
+  {
+    // Same seed as the megakernel fragment at this pixel
+    InitRNG(SeedPixel(vec2(pixel) + 0.5), u_FrameNum);
+    path._Radiance = vec4(0.f);
+    path._ShadowRadiance[SHADOW_ENVMAP] = vec4(0.f);
+    path._ShadowRadiance[SHADOW_LIGHT] = vec4(0.f);
+  }
+  else
+    g_Seed = path._Seed;
+
+  if ( PixelSkipped(coordUV) )
+  {
+    u_Paths[pathIndex] = path;
+    return;
+  }
+
+  Ray ray = GetRay(coordUV);
+
+  path._Orig       = vec4(ray._Orig, 0.f);
+  path._Dir        = vec4(ray._Dir, 0.f);
+  path._Throughput = vec4(1.f);
+  path._Seed       = g_Seed;
+  path._Info       = ivec4(0, SCATTER_RANDOM, 0, 0);
+  u_Paths[pathIndex] = path;
+
+  uint slot = atomicAdd(u_RayCount[0], 1u);
+  u_RayQueues[slot] = pathIndex;
+}
@@ -0,0 +1,62 @@
+#version 430 core
+
+// Wavefront path tracing : queue bookkeeping and material sort (see PathTracer::PathTraceWavefront)
+// The bookkeeping stages run on a single invocation and write the indirect dispatch arguments of the next stage.
+
+#include Wavefront.glsl
+
+layout(local_size_x = WAVEFRONT_GROUP_SIZE) in;
+
+#define QUEUE_RESET         0 // Empty the generate queue
+#define QUEUE_BEGIN_BOUNCE  1 // Extend arguments, empty the next ray queue and the shadow queue
+#define QUEUE_SCAN_BUCKETS  2 // Material bucket offsets, shade arguments
+#define QUEUE_SORT          3 // Scatter the ray queue into the material queue
+#define QUEUE_SHADOW        4 // Shadow arguments
+
+uniform int u_Stage;
+
+void main()
+{
+  if ( QUEUE_SORT == u_Stage )
+  {
+    uint queueIndex = QueueIndex();
+    if ( queueIndex >= u_RayCount[u_RayQueue] )
+      return;
+
+    uint pathIndex = u_RayQueues[u_RayQueue * u_PathCapacity + queueIndex];
+    uint slot = atomicAdd(u_Buckets[u_NbBuckets + HitBucket(pathIndex)], 1u);
+    u_MaterialQueue[slot] = pathIndex;
+    return;
+  }
+
+  if ( 0 != QueueIndex() )
+    return;
+
+  if ( QUEUE_RESET == u_Stage )
+  {
+    u_RayCount[0] = 0u;
+  }
+  else if ( QUEUE_BEGIN_BOUNCE == u_Stage )
+  {
+    u_ExtendArgs = DispatchArgs(u_RayCount[u_RayQueue]);
+    u_RayCount[1 - u_RayQueue] = 0u;
+    u_ShadowCount = 0u;
+  }
+  else if ( QUEUE_SCAN_BUCKETS == u_Stage )
+  {
+    // Exclusive prefix sum, the counts are cleared for the next bounce
+    uint offset = 0u;
+    for ( int i = 0; i < u_NbBuckets; ++i )
+    {
+      uint count = u_Buckets[i];
+      u_Buckets[i] = 0u;
+      u_Buckets[u_NbBuckets + i] = offset;
+      offset += count;
+    }
+    u_ShadeArgs = DispatchArgs(u_RayCount[u_RayQueue]);
+  }
+  else if ( QUEUE_SHADOW == u_Stage )
+  {
+    u_ShadowArgs = DispatchArgs(u_ShadowCount);
+  }
+}
@@ -0,0 +1,40 @@
+#version 430 core
+
+// Wavefront path tracing : averages the samples of the frame into the color target (see PathTracer::PathTraceWavefront)
+
+#include Wavefront.glsl
+#include ToneMapping.glsl
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(rgba32f, binding = 0) uniform writeonly image2D u_OutColor;
+
+void main()
+{
+  ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+  if ( any(greaterThanEqual(pixel, u_TargetSize)) )
+    return;
+
+  // Converged pixels are kept by the accumulate pass
+  if ( PixelSkipped(PixelUV(pixel)) )
+  {
+    imageStore(u_OutColor, pixel, vec4(0.f));
+    return;
+  }
+
+  uint pathIndex = uint(pixel.y * u_TargetSize.x + pixel.x);
+  WavefrontPath path = u_Paths[pathIndex];
+
+  vec3 radiance = path._Radiance.xyz + path._ShadowRadiance[SHADOW_ENVMAP].xyz + path._ShadowRadiance[SHADOW_LIGHT].xyz;
+  radiance /= u_NbSamplesPerPixel;
+
+  if ( 0 != u_ToneMapping )
+  {
+    radiance = ReinhardToneMapping_Luminance( radiance );
+    radiance = GammaCorrection( radiance );
+  }
+  else
+    radiance = clamp(radiance, 0.f, 1.f);
+
+  imageStore(u_OutColor, pixel, vec4(radiance, 1.f));
+}
@@ -0,0 +1,163 @@
+#version 430 core
+
+// Wavefront path tracing : one bounce of the megakernel loop over the material sorted queue (see PathTracer::PathTraceWavefront)
+// Direct lighting is deferred to the shadow stage, surviving paths are appended to the next ray queue.
+
+#include Wavefront.glsl
+
+layout(local_size_x = WAVEFRONT_GROUP_SIZE) in;
+
+const int MaxPathSegments = 128;
+
+// ----------------------------------------------------------------------------
+// PushShadowRay
+// ----------------------------------------------------------------------------
+void PushShadowRay( in uint iPathIndex, in int iKind, in Ray iRay, in float iMaxDist, in vec3 iRadiance )
+{
+  uint slot = atomicAdd(u_ShadowCount, 1u);
+  u_ShadowRays[slot]._Orig     = vec4(iRay._Orig, iMaxDist);
+  u_ShadowRays[slot]._Dir      = vec4(iRay._Dir, 0.f);
+  u_ShadowRays[slot]._Radiance = vec4(iRadiance, 0.f);
+  u_ShadowRays[slot]._Info     = ivec4(int(iPathIndex), iKind, 0, 0);
+}
+
+void main()
+{
+  uint queueIndex = QueueIndex();
+  if ( queueIndex >= u_RayCount[u_RayQueue] )
+    return;
+
+  uint pathIndex = u_MaterialQueue[queueIndex];
+  WavefrontPath path = u_Paths[pathIndex];
+
+  g_Seed = path._Seed;
+
+  Ray ray = Ray(path._Orig.xyz, path._Dir.xyz);
+  vec3 throughput = path._Throughput.xyz;
+  vec3 radiance = vec3(0.f);
+  int depth = path._Info.x;
+  ScatterRecord scatterSample = ScatterRecord(uint(path._Info.y), vec3(0.f), path._Orig.w, vec3(0.f));
+  bool alive = false;
+
+  HitPoint closestHit;
+  if ( !LoadHit(pathIndex, closestHit) )
+  {
+    // NO HIT
+    if ( ( depth > 0 ) || ( 1 == u_EnableBackground ) )
+    {
+      if ( u_EnableEnvMap > 0 )
+      {
+        vec4 envMapColPdf = SampleEnvMap(ray._Dir, u_EnvMap, u_EnvMapRotation , u_EnvMapRes, u_EnvMapTotalWeight);
+
+        float misWeight = 1.;
+        if ( depth > 0 )
+          misWeight = PowerHeuristic(scatterSample._P, envMapColPdf.w);
+
+        if( misWeight > 0. )
+          radiance += misWeight * envMapColPdf.rgb * throughput * u_EnvMapIntensity;
+      }
+      else
+        radiance += u_BackgroundColor * throughput;
+    }
+  }
+  else if ( closestHit._IsEmitter )
+  {
+    // EMITTER
+    float misWeight = 1.;
+    if ( ( depth > 0 ) && ( closestHit._LightID >= 0 ) )
+    {
+      float lightP = LightPDF(u_Lights[closestHit._LightID], ray);
+      misWeight = PowerHeuristic(scatterSample._P, lightP);
+    }
+
+    if ( misWeight > 0. )
+      radiance += misWeight * u_Lights[closestHit._LightID]._Emission * throughput;
+  }
+  else
+  {
+    // MATERIAL PROPERTIES
+    Material mat;
+    LoadMaterial(closestHit, mat);
+    float eta = ( closestHit._FrontFace ) ? ( 1.f / mat._IOR ) : ( mat._IOR );
+
+    radiance += mat._Emission * throughput; // Emission from meshes is not importance sampled
+
+    if ( depth < MaxPathSegments )
+    {
+      alive = true;
+
+      if ( IsOpaque(mat) )
+      {
+        // DIRECT LIGHT : traced by the shadow stage
+        if ( SCATTER_RANDOM == scatterSample._Type )
+        {
+          Ray shadowRay;
+          vec3 lightLd;
+          if ( ( u_EnableEnvMap > 0 ) && SampleEnvMapLight(ray, closestHit, mat, eta, shadowRay, lightLd) )
+            PushShadowRay(pathIndex, SHADOW_ENVMAP, shadowRay, INFINITY, lightLd * throughput);
+
+          float distToLight = 0.f;
+          if ( SampleLightSource(ray, closestHit, mat, eta, shadowRay, distToLight, lightLd) )
+            PushShadowRay(pathIndex, SHADOW_LIGHT, shadowRay, distToLight, lightLd * throughput);
+        }
+
+        // SCATTER
+        Scatter(ray, closestHit, mat, eta, scatterSample);
+        if ( SCATTER_NONE == scatterSample._Type )
+          alive = false;
+        else
+          throughput *= scatterSample._Attenuation / ( scatterSample._P + EPSILON );
+      }
+      else
+      {
+        // Ignore intersection and continue ray based on alpha test
+        scatterSample._Dir = ray._Dir;
+        depth--;
+      }
+    }
+
+    if ( alive )
+    {
+      // NEXT RAY
+      ray._Orig = closestHit._Pos + scatterSample._Dir * RESOLUTION;
+      ray._Dir = scatterSample._Dir;
+
+      if ( depth >= u_NbBounces )
+      {
+        // Russian Roulette
+        if ( u_RussianRoulette > 0 )
+        {
+          float maxThroughput = max( throughput.x, max( throughput.y, throughput.z ) );
+          float q = min( maxThroughput + EPSILON, 0.95 ); // Lower throughput will lead to higher probability to cancel the path
+          if ( rand() > q )
+            alive = false;
+          else
+            throughput *= 1.0f / q;
+        }
+        else
+          alive = false;
+      }
+    }
+  }
+
+  path._Radiance.xyz += radiance;
+  path._Seed = g_Seed;
+
+  if ( alive )
+  {
+    path._Orig       = vec4(ray._Orig, scatterSample._P);
+    path._Dir        = vec4(ray._Dir, 0.f);
+    path._Throughput = vec4(throughput, 0.f);
+    path._Info       = ivec4(depth + 1, int(scatterSample._Type), 0, 0);
+
+    uint slot = atomicAdd(u_RayCount[1 - u_RayQueue], 1u);
+    u_RayQueues[( 1 - u_RayQueue ) * u_PathCapacity + slot] = pathIndex;
+  }
+
+  u_Paths[pathIndex]._Orig       = path._Orig;
+  u_Paths[pathIndex]._Dir        = path._Dir;
+  u_Paths[pathIndex]._Throughput = path._Throughput;
+  u_Paths[pathIndex]._Radiance   = path._Radiance;
+  u_Paths[pathIndex]._Seed       = path._Seed;
+  u_Paths[pathIndex]._Info       = path._Info;
+}
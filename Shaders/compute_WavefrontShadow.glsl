@@ -0,0 +1,24 @@
+#version 430 core
+
+// Wavefront path tracing : occlusion of the direct lighting samples (see PathTracer::PathTraceWavefront)
+// A path emits at most one shadow ray of each kind per bounce, so each invocation owns its radiance slot.
+
+#include Wavefront.glsl
+
+layout(local_size_x = WAVEFRONT_GROUP_SIZE) in;
+
+void main()
+{
+  uint queueIndex = QueueIndex();
+  if ( queueIndex >= u_ShadowCount )
+    return;
+
+  WavefrontShadowRay shadowRay = u_ShadowRays[queueIndex];
+  Ray ray = Ray(shadowRay._Orig.xyz, shadowRay._Dir.xyz);
+  if ( AnyHit(ray, shadowRay._Orig.w) )
+    return;
+
+  int pathIndex = shadowRay._Info.x;
+  int kind = shadowRay._Info.y;
+  u_Paths[pathIndex]._ShadowRadiance[kind].xyz += shadowRay._Radiance.xyz;
+}
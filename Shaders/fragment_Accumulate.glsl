@@ -8,6 +8,7 @@ in vec2 fragUV;
 layout(location = 0) out vec4 fragColor;
 layout(location = 1) out vec4 fragNormal;
 layout(location = 2) out vec4 fragPosition;
+layout(location = 3) out vec4 fragMoments;
 
 // ============================================================================
 // Uniforms
@@ -19,24 +20,66 @@ uniform int       u_TiledRendering;
 uniform vec2      u_TileOffset;
 uniform vec2      u_InvNbTiles;
 uniform sampler2D u_PreviousFrame;
+uniform sampler2D u_PreviousNormals;
+uniform sampler2D u_PreviousPos;
+uniform sampler2D u_PreviousMoments;
 uniform sampler2D u_NewFrame;
 uniform sampler2D u_NewFrameNormals;
 uniform sampler2D u_NewFramePos;
 
+// Adaptive sampling
+uniform int       u_AdaptiveSampling     = 0;
+uniform int       u_AdaptiveMinFrames    = 16;
+uniform float     u_ConvergenceThreshold = 0.02f;
+
+// Moments : x = mean luminance, y = mean squared luminance, z = accumulated frames, w = 1 once converged
 void main()
 {
+  vec2 realFragUV = fragUV;
+  if( 1 == u_TiledRendering )
+    realFragUV = mix(u_TileOffset, u_TileOffset + u_InvNbTiles, fragUV);
+
+  bool accumulate = ( ( 1 == u_Accumulate ) && ( u_NbCompleteFrames > 0 ) );
+
+  // Converged pixels were skipped by the path tracing pass : keep everything
+  if ( accumulate && ( 1 == u_AdaptiveSampling ) )
+  {
+    vec4 previousMoments = texture(u_PreviousMoments, realFragUV);
+    if ( previousMoments.w > .5f )
+    {
+      fragColor = texture(u_PreviousFrame, realFragUV);
+      fragNormal = texture(u_PreviousNormals, realFragUV);
+      fragPosition = texture(u_PreviousPos, realFragUV);
+      fragMoments = previousMoments;
+      return;
+    }
+  }
+
   fragColor = texture(u_NewFrame, fragUV);
   fragNormal = texture(u_NewFrameNormals, fragUV);
   fragPosition = texture(u_NewFramePos, fragUV);
 
-  if ( ( 1 == u_Accumulate ) && ( u_NbCompleteFrames > 0 ) )
+  float lum = Luminance(fragColor.xyz);
+  fragMoments = vec4(lum, lum * lum, 1.f, 0.f);
+
+  if ( accumulate )
   {
-    vec2 realFragUV = fragUV;
-    if( 1 == u_TiledRendering )
-      realFragUV = mix(u_TileOffset, u_TileOffset + u_InvNbTiles, fragUV);
+    vec4 previousMoments = texture(u_PreviousMoments, realFragUV);
+
+    // Every pixel holds u_NbCompleteFrames frames unless some of them were skipped
+    float nbFrames = ( 1 == u_AdaptiveSampling ) ? ( previousMoments.z ) : ( float(u_NbCompleteFrames) );
+
+    float multiplier = 1. / ( nbFrames + 1 );
+    fragColor.xyz = ( texture(u_PreviousFrame, realFragUV).xyz * nbFrames + fragColor.xyz ) * multiplier;
+
+    fragMoments.xy = ( previousMoments.xy * previousMoments.z + fragMoments.xy ) / ( previousMoments.z + 1.f );
+    fragMoments.z = previousMoments.z + 1.f;
 
-    float multiplier = 1. / ( u_NbCompleteFrames + 1 );
-    fragColor.xyz = ( texture(u_PreviousFrame, realFragUV).xyz * u_NbCompleteFrames + fragColor.xyz ) * multiplier;
+    // Relative standard error of the mean, dark pixels are compared to a small floor
+    float variance = max(fragMoments.y - fragMoments.x * fragMoments.x, 0.f);
+    float stdError = sqrt(variance / fragMoments.z);
+    if ( ( fragMoments.z >= float(u_AdaptiveMinFrames) ) && ( stdError <= u_ConvergenceThreshold * max(fragMoments.x, 0.01f) ) )
+      fragMoments.w = 1.f;
   }
 
   if ( ( 1 == u_DebugMode ) && ( 1 == u_TiledRendering ) )
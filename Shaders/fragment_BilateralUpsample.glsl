@@ -0,0 +1,63 @@
+#version 410 core
+
+#include GBuffer.glsl
+
+in vec2 fragUV;
+out vec4 fragColor;
+
+// Reduced resolution effect, guided by the full resolution G-buffer
+uniform sampler2D u_Input;
+uniform sampler2D u_GDepth;
+uniform sampler2D u_GNormal;
+uniform sampler2D u_GPosition;
+uniform vec2 u_InputResolution;
+uniform vec3 u_CameraPos;
+uniform vec4 u_Background = vec4(0.0);
+
+void main()
+{
+  float centerDepth = texture(u_GDepth, fragUV).r;
+  if ( centerDepth >= 1.0 )
+  {
+    fragColor = u_Background;
+    return;
+  }
+
+  vec3 centerNormal = FetchGNormal(u_GNormal, fragUV);
+  vec3 centerPos = FetchGPosition(u_GPosition, fragUV, centerDepth);
+  float planeTolerance = 0.02 * length(centerPos - u_CameraPos) + 0.001;
+
+  // 2x2 bilinear footprint in the low resolution grid, reweighted by geometric similarity
+  vec2 lowPos = fragUV * u_InputResolution - 0.5;
+  vec2 base = floor(lowPos);
+  vec2 frac = lowPos - base;
+
+  vec4 sum = vec4(0.0);
+  float weightSum = 0.0;
+  for ( int y = 0; y <= 1; ++y )
+  {
+    for ( int x = 0; x <= 1; ++x )
+    {
+      vec2 tapUV = clamp(( base + vec2(x, y) + 0.5 ) / u_InputResolution, vec2(0.0), vec2(1.0));
+
+      // The effect sampled the G-buffer at the low resolution texel center
+      float tapDepth = texture(u_GDepth, tapUV).r;
+      if ( tapDepth >= 1.0 )
+        continue;
+
+      vec3 tapNormal = FetchGNormal(u_GNormal, tapUV);
+      vec3 tapPos = FetchGPosition(u_GPosition, tapUV, tapDepth);
+
+      float bilinearWeight = ( ( x == 0 ) ? ( 1.0 - frac.x ) : frac.x ) * ( ( y == 0 ) ? ( 1.0 - frac.y ) : frac.y );
+      float planeDistance = abs(dot(tapPos - centerPos, centerNormal));
+      float depthWeight = 1.0 / ( 1.0 + planeDistance / planeTolerance );
+      float normalWeight = pow(max(dot(centerNormal, tapNormal), 0.0), 8.0);
+      float weight = ( bilinearWeight + 1e-3 ) * depthWeight * normalWeight;
+
+      sum += texture(u_Input, tapUV) * weight;
+      weightSum += weight;
+    }
+  }
+
+  fragColor = ( weightSum > 1e-4 ) ? ( sum / weightSum ) : texture(u_Input, fragUV);
+}
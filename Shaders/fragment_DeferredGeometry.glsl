@@ -3,6 +3,7 @@
 #include Material.glsl
 #include Lights.glsl
 #include Sampling.glsl
+#include GBuffer.glsl
 
 // Inputs from vertex shader (expected to provide world-space position, normal and uv)
 in vec3 fragWorldPos;
@@ -12,9 +13,9 @@ flat in int v_MaterialID; // optional: present if vertex shader provides it
 
 // G-buffer MRT outputs
 layout(location = 0) out vec4 gAlbedo;   // RGB: albedo, A: unused / opacity
-layout(location = 1) out vec4 gNormal;   // RGB: normal encoded in 0..1, A: unused
-layout(location = 2) out vec4 gPosition; // RGB: world position, A: unused
-layout(location = 3) out vec4 gMaterial; // R: roughness, G: metallic, B: reflectance, A: unused
+layout(location = 1) out vec4 gNormal;   // RGB: normal encoded in 0..1, compact layout RG: octahedral normal
+layout(location = 2) out vec4 gPosition; // RGB: world position, A: unused. No target in the compact layout
+layout(location = 3) out vec4 gMaterial; // R: roughness, G: metallic, B: reflectance, A: unused. RGBA8 in the compact layout
 layout(location = 4) out vec4 gEmission; // RGB: emission, A: unused
 
 // Optional fallback uniform (simple default albedo if no material sampling)
@@ -56,7 +57,7 @@ void main()
   }
 
   gAlbedo = vec4(albedo, 1.0);
-  gNormal = vec4(hitPoint._Normal * 0.5 + 0.5, 1.0);
+  gNormal = EncodeGNormal(hitPoint._Normal);
   gPosition = vec4(fragWorldPos, 1.0);
   gMaterial = vec4(roughness, metallic, reflectance, 1.0);
   gEmission = vec4(emission, 1.0);
@@ -7,6 +7,7 @@
 #include Structures.glsl
 #include Intersections.glsl
 #include DeferredPBRLighting.glsl
+#include GBuffer.glsl
 
 in vec2 fragUV;
 out vec4 fragColor;
@@ -44,6 +45,13 @@ uniform float u_SpecularIBLMaxRoughness = 0.5;
 uniform int   u_EnablePBRDirectLighting = 1;
 uniform float u_DirectLightIntensity = 1.0;
 
+// Clustered lighting (see DeferredRenderer::BuildLightClusters)
+uniform int            u_EnableLightClusters = 0;
+uniform ivec3          u_LightClusterGrid;     // Screen tiles along x and y, depth slices
+uniform vec2           u_LightClusterDepth;    // Near plane, slices / log(far / near)
+uniform isamplerBuffer u_LightClusters;        // Per cluster : first index, light count
+uniform isamplerBuffer u_LightClusterIndices;
+
 vec3 GetCameraRayDir()
 {
   vec2 centeredUV = fragUV * 2.0 - 1.0;
@@ -83,6 +91,14 @@ vec3 SampleEnvMapNoSeamLod( in vec3 iDir, in float iLod )
   return textureLod(u_EnvMap, uv, iLod).rgb;
 }
 
+ivec2 FetchLightCluster( in vec3 iPos )
+{
+  ivec2 tile = clamp(ivec2(gl_FragCoord.xy / u_Resolution * vec2(u_LightClusterGrid.xy)), ivec2(0), u_LightClusterGrid.xy - 1);
+  float viewDepth = max(dot(iPos - u_Camera._Pos, u_Camera._Forward), u_LightClusterDepth.x);
+  int slice = clamp(int(log(viewDepth / u_LightClusterDepth.x) * u_LightClusterDepth.y), 0, u_LightClusterGrid.z - 1);
+  return texelFetch(u_LightClusters, ( slice * u_LightClusterGrid.y + tile.y ) * u_LightClusterGrid.x + tile.x).rg;
+}
+
 bool TraceVisibleLight( in Ray iRay, in float iSceneDist, out vec3 oLightColor )
 {
   float closestLightDist = iSceneDist;
@@ -112,12 +128,12 @@ bool TraceVisibleLight( in Ray iRay, in float iSceneDist, out vec3 oLightColor )
 
 void main()
 {
+  float depth  = texture(u_GDepth, fragUV).x;
   vec3 albedo  = texture(u_GAlbedo, fragUV).rgb;
-  vec3 N       = normalize(texture(u_GNormal, fragUV).xyz * 2.0 - 1.0);
-  vec3 pos     = texture(u_GPosition, fragUV).xyz;
+  vec3 N       = FetchGNormal(u_GNormal, fragUV);
+  vec3 pos     = FetchGPosition(u_GPosition, fragUV, depth);
   vec3 material = texture(u_GMaterial, fragUV).rgb;
   vec3 emission = texture(u_GEmission, fragUV).rgb;
-  float depth  = texture(u_GDepth, fragUV).x;
   float aoRaw  = texture(u_SSAOMap, fragUV).r;
   float ao     = ( u_EnableSSAO != 0 ) ? clamp(1.0 - (1.0 - aoRaw) * u_SSAOIntensity, 0.0, 1.0) : 1.0;
   float roughness = clamp(material.r, 0.001, 1.0);
@@ -223,8 +239,16 @@ void main()
   vec3 legacyLighting = vec3(0.0);
   float shadowFactorDebug = 0.0;
   int shadowFactorCount = 0;
-  for ( int i = 0; i < u_NbLights; ++i )
+
+  // Without clusters, every light is evaluated
+  ivec2 clusterLights = ivec2(0, u_NbLights);
+  if ( u_EnableLightClusters != 0 )
+    clusterLights = FetchLightCluster(pos);
+
+  for ( int k = 0; k < clusterLights.y; ++k )
   {
+    int i = ( u_EnableLightClusters != 0 ) ? texelFetch(u_LightClusterIndices, clusterLights.x + k).r : k;
+
     vec3 L;
     if ( u_Lights[i]._Type == DISTANT_LIGHT )
       L = normalize(u_Lights[i]._Pos);
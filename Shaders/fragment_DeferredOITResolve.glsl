@@ -0,0 +1,22 @@
+#version 410 core
+
+in vec2 fragUV;
+out vec4 fragColor;
+
+uniform sampler2D u_OITAccum;
+uniform sampler2D u_OITRevealage;
+
+// Weighted blended OIT resolve : blended over the lighting target with (1 - src.a, src.a)
+void main()
+{
+  float revealage = texture(u_OITRevealage, fragUV).r;
+  if ( revealage >= 0.9999 )
+    discard;
+
+  vec4 accum = texture(u_OITAccum, fragUV);
+  if ( any(isinf(accum.rgb)) )
+    accum.rgb = vec3(accum.a);
+
+  vec3 averageColor = accum.rgb / max(accum.a, 1e-5);
+  fragColor = vec4(averageColor, revealage);
+}
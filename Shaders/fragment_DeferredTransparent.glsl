@@ -14,7 +14,8 @@ in vec3 fragNormal;
 in vec2 fragUV;
 flat in int v_MaterialID;
 
-out vec4 fragColor;
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec4 fragRevealage; // Weighted blended OIT only
 
 uniform sampler2D   u_GDepth;
 uniform sampler2D   u_EnvMap;
@@ -26,6 +27,7 @@ uniform int         u_EnableEnvMap = 0;
 uniform int         u_EnablePBRDirectLighting = 1;
 uniform float       u_DirectLightIntensity = 1.0;
 uniform float       u_SpecularIBLMaxRoughness = 0.5;
+uniform int         u_WeightedOIT = 0;
 
 uniform Camera      u_Camera;
 
@@ -149,5 +151,18 @@ void main()
   if ( ( alpha <= 0.001 ) && ( max(max(premultipliedColor.r, premultipliedColor.g), premultipliedColor.b) <= 0.001 ) )
     discard;
 
-  fragColor = vec4( max(premultipliedColor, vec3(0.0)), alpha );
+  premultipliedColor = max(premultipliedColor, vec3(0.0));
+  if ( u_WeightedOIT != 0 )
+  {
+    // Weighted blended OIT (McGuire & Bavoil) : closer layers weigh more in the accumulated average.
+    // The coverage floor keeps transmissive surfaces from vanishing in the resolve division.
+    float coverage = max(alpha, 0.01);
+    float viewDepth = hitPoint._Dist;
+    float weight = coverage * clamp(10.0 / (1e-5 + pow(viewDepth / 5.0, 2.0) + pow(viewDepth / 200.0, 6.0)), 1e-2, 3e3);
+    fragColor = vec4(premultipliedColor, coverage) * weight;
+    fragRevealage = vec4(coverage);
+    return;
+  }
+
+  fragColor = vec4( premultipliedColor, alpha );
 }
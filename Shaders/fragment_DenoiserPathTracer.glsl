@@ -22,6 +22,8 @@ uniform float u_ColorPhi    = 0.9f;
 uniform float u_NormalPhi   = 0.3f;
 uniform float u_PositionPhi = 0.6f;
 
+uniform int u_Iteration = 0; // Edge-aware : a-trous iteration, step 2^iteration
+
 // ----------------------------------------------------------------------------
 // LoadClamped
 // ----------------------------------------------------------------------------
@@ -131,6 +133,7 @@ vec4 BilateralFilter( in ivec2 iPixelCoord )
 
 // ----------------------------------------------------------------------------
 // EdgeAwareDenoiser
+// A-trous iteration : 5x5 kernel dilated by 2^u_Iteration, color phi halved at every iteration
 // ----------------------------------------------------------------------------
 vec4 EdgeAwareDenoiser( in ivec2 iPixelCoord )
 {
@@ -143,11 +146,14 @@ vec4 EdgeAwareDenoiser( in ivec2 iPixelCoord )
 
   const ivec2 Offset[25] = ivec2[25](
     ivec2(-2,-2), ivec2(-1,-2), ivec2(0,-2), ivec2(1,-2), ivec2(2,-2),
-    ivec2(-2,-1), ivec2(-1,-1), ivec2(0,-2), ivec2(1,-1), ivec2(2,-1),
+    ivec2(-2,-1), ivec2(-1,-1), ivec2(0,-1), ivec2(1,-1), ivec2(2,-1),
     ivec2(-2, 0), ivec2(-1, 0), ivec2(0, 0), ivec2(1, 0), ivec2(2, 0),
     ivec2(-2, 1), ivec2(-1, 1), ivec2(0, 1), ivec2(1, 1), ivec2(2, 1),
     ivec2(-2, 2), ivec2(-1, 2), ivec2(0, 2), ivec2(1, 2), ivec2(2, 2) );
 
+  int step = 1 << u_Iteration;
+  float colorPhi = u_ColorPhi / float(step);
+
   vec3 cval = LoadClamped(u_InputImage, iPixelCoord).rgb;
   vec3 nval = LoadClamped(u_InputNormals, iPixelCoord).rgb;
   vec3 pval = LoadClamped(u_InputPos, iPixelCoord).rgb;
@@ -157,12 +163,12 @@ vec4 EdgeAwareDenoiser( in ivec2 iPixelCoord )
 
   for ( int i = 0; i < 25; ++i )
   {
-    ivec2 uv = iPixelCoord + Offset[i];
+    ivec2 uv = iPixelCoord + Offset[i] * step;
 
     vec3 ctmp = LoadClamped(u_InputImage, uv).rgb;
     vec3 t = cval - ctmp;
     float dist2 = dot(t, t);
-    float c_w = min(exp(-(dist2) / u_ColorPhi), 1.0);
+    float c_w = min(exp(-(dist2) / colorPhi), 1.0);
 
     vec3 ntmp = LoadClamped(u_InputNormals, uv).rgb;
     t = nval - ntmp;
@@ -18,31 +18,7 @@ layout(location = 2) out vec4 fragPosition;
 #include BRDF.glsl
 #include ToneMapping.glsl
 #include DisneyBSDF.glsl
-
-// ============================================================================
-// Uniforms
-// ============================================================================
-
-uniform vec2           u_Resolution;
-uniform vec2           u_TileOffset;
-uniform vec2           u_InvNbTiles;
-uniform float          u_Time;
-uniform int            u_FrameNum;
-uniform int            u_NbCompleteFrames;
-uniform vec3           u_BackgroundColor;
-uniform Camera         u_Camera;
-uniform int            u_TiledRendering    = 0;
-uniform int            u_RussianRoulette   = 1;
-uniform int            u_NbSamplesPerPixel = 1;
-uniform int            u_NbBounces         = 1;
-uniform int            u_EnableBackground  = 0;
-uniform int            u_EnableEnvMap      = 0;
-uniform float          u_EnvMapRotation    = 0.f;
-uniform float          u_EnvMapTotalWeight = 1.f;
-uniform float          u_EnvMapIntensity   = 1.f;
-uniform vec2           u_EnvMapRes;
-uniform sampler2D      u_EnvMap;
-uniform sampler2D      u_EnvMapCDF;
+#include PathTracing.glsl
 
 // ----------------------------------------------------------------------------
 // DebugColor
@@ -82,138 +58,32 @@ vec3 DebugColor( in Ray iRay, in HitPoint iClosestHit )
   return outColor;
 }
 
-// ----------------------------------------------------------------------------
-// GetRay
-// ----------------------------------------------------------------------------
-Ray GetRay( in vec2 iCoordUV )
-{
-  Ray ray;
-
-  float r1 = 2.0 * rand();
-  float r2 = 2.0 * rand();
-
-  vec2 jitter;
-  jitter.x = ( r1 < 1.0 ) ? ( sqrt(r1) - 1.0 ) : ( 1.0 - sqrt(2.0 - r1) ) ;
-  jitter.y = ( r2 < 1.0 ) ? ( sqrt(r2) - 1.0 ) : ( 1.0 - sqrt(2.0 - r2) ) ;
-  jitter /= (u_Resolution * 0.5);
-
-  vec2 centeredUV = ( 2. * iCoordUV - 1. ) + jitter;
-
-  float scale = tan(u_Camera._FOV * .5);
-  centeredUV.x *= scale;
-  centeredUV.y *= ( u_Resolution.y / u_Resolution.x ) * scale;
-
-  if ( u_Camera._LensRadius > EPSILON )
-  {
-    // FocalDist/Aperture
-    vec2 randDisk = u_Camera._LensRadius * RandomInUnitDisk();
-    vec3 randOffset = u_Camera._Right * randDisk.x + u_Camera._Up * randDisk.y;
-
-    vec3 focalPoint = u_Camera._Pos + u_Camera._FocalDist * ( u_Camera._Right * centeredUV.x + u_Camera._Up * centeredUV.y + u_Camera._Forward );
-    //vec3 focalPoint = u_Camera._Pos + u_Camera._FocalDist * normalize( u_Camera._Right * centeredUV.x + u_Camera._Up * centeredUV.y + u_Camera._Forward );
-    ray._Orig = u_Camera._Pos + randOffset;
-    ray._Dir = normalize(focalPoint - ray._Orig);
-  }
-  else
-  {
-    ray._Orig = u_Camera._Pos;
-    ray._Dir = normalize(u_Camera._Right * centeredUV.x + u_Camera._Up * centeredUV.y + u_Camera._Forward);
-  }
-
-  return ray;
-}
-
 // ----------------------------------------------------------------------------
 // DirectLight
 // ----------------------------------------------------------------------------
 vec3 DirectLight( in Ray iRay, in HitPoint iClosestHit, in Material iMat, float iEta )
 {
   vec3 Ld = vec3(0.);
-  vec3 scatterPos = iClosestHit._Pos + iClosestHit._Normal * RESOLUTION;
+  Ray shadowRay;
+  vec3 lightLd;
 
   // Environment Mapping
   if ( u_EnableEnvMap > 0 )
   {
-    vec3 lightDir;
-    vec4 envMapColPdf = SampleEnvMap(u_EnvMap, u_EnvMapRotation , u_EnvMapRes, u_EnvMapCDF, u_EnvMapTotalWeight, lightDir);
-    float lightPdf = envMapColPdf.w;
-
-    float cosTheta = dot(iClosestHit._Normal, lightDir);
-    if ( ( cosTheta > 0. ) && ( lightPdf > EPSILON ) )
-    {
-      Ray shadowRay = Ray(scatterPos, lightDir);
-      if ( !AnyHit( shadowRay, INFINITY ) )
-      {
-        //float pdf = cosTheta / PI;
-        //vec3 f = BRDF(iClosestHit._Normal, -iRay._Dir, lightDir, iMat) * cosTheta;
-        float pdf = 0.f;
-        vec3 f =  DisneyEval( iClosestHit, iMat, iEta, -iRay._Dir, lightDir, pdf );
-    
-        float misWeight = PowerHeuristic(lightPdf, pdf);
-        if ( misWeight > 0. )
-          Ld += misWeight * envMapColPdf.rgb * f * u_EnvMapIntensity / lightPdf;
-      }
-    }
+    if ( SampleEnvMapLight(iRay, iClosestHit, iMat, iEta, shadowRay, lightLd) && !AnyHit(shadowRay, INFINITY) )
+      Ld += lightLd;
   }
 
   // Lights sampling
   {
-    // Choose a light source randomly
-    int lightInd = int(rand() * u_NbLights);
-
-    // Get direction to it
-    vec3 lightDir = GetLightDirSample(scatterPos, u_Lights[lightInd]);
-
-    float distToLight = length(lightDir);
-    lightDir = normalize(lightDir);
-
-    float cosTheta = dot(iClosestHit._Normal, lightDir);
-    if ( cosTheta > 0. )
-    {
-      Ray shadowRay = Ray(scatterPos, lightDir);
-
-      // Get the pdf value for this direction
-      float lightPdf = 0.0f;
-      for ( int j = 0; j < u_NbLights; ++j )
-      {
-        lightPdf += LightPDF(u_Lights[j], shadowRay);
-      }
-      lightPdf /= u_NbLights;
-
-      if ( lightPdf > EPSILON )
-      {
-        if ( !AnyHit(shadowRay, distToLight) )
-        {
-          float pdf = 0.f;
-          vec3 f = DisneyEval( iClosestHit, iMat, iEta, -iRay._Dir, lightDir, pdf );
-    
-          float misWeight = PowerHeuristic(lightPdf, pdf);
-          if ( misWeight > 0. )
-            Ld += misWeight * u_Lights[lightInd]._Emission * f / lightPdf;
-        }
-      }
-    }
+    float distToLight = 0.f;
+    if ( SampleLightSource(iRay, iClosestHit, iMat, iEta, shadowRay, distToLight, lightLd) && !AnyHit(shadowRay, distToLight) )
+      Ld += lightLd;
   }
 
   return Ld;
 }
 
-// ----------------------------------------------------------------------------
-// Scatter
-// ----------------------------------------------------------------------------
-bool Scatter( in Ray iRay, in HitPoint iClosestHit, in Material iMat, in float iEta, out ScatterRecord oScatterRecord )
-{
-  oScatterRecord = ScatterRecord(SCATTER_NONE, vec3(0.f), 0.f, vec3(0.f));
-
-  oScatterRecord._Attenuation = DisneySample( iClosestHit, iMat, iEta, -iRay._Dir, oScatterRecord._Dir, oScatterRecord._P );
-
-  if ( oScatterRecord._P < EPSILON )
-    return false;
-
-  oScatterRecord._Type = SCATTER_RANDOM;
-  return true;
-}
-
 // ----------------------------------------------------------------------------
 // PathSample
 // ----------------------------------------------------------------------------
@@ -273,7 +143,7 @@ vec3 PathSample( in Ray iStartRay )
     }
 
     // DEBUG
-    if ( u_DebugMode > 1 )
+    if ( ( u_DebugMode > 1 ) && ( u_DebugMode < 8 ) )
     {
       radiance += DebugColor( ray, closestHit );
       break;
@@ -356,12 +226,21 @@ vec3 PathSample( in Ray iStartRay )
 void main()
 {
   // Initialization
-  InitRNG(gl_FragCoord.xy, u_FrameNum);
+  InitRNG(SeedPixel(gl_FragCoord.xy), u_FrameNum);
 
   vec2 coordUV = fragUV;
   if( 1 == u_TiledRendering )
     coordUV = mix(u_TileOffset, u_TileOffset + u_InvNbTiles, fragUV);
 
+  // Adaptive sampling : the accumulate pass keeps the previous value of converged pixels
+  if ( ( 1 == u_AdaptiveSampling ) && ( texture(u_SampleMoments, coordUV).w > .5f ) )
+  {
+    fragColor = vec4(0.f);
+    fragNormal = vec4(0.f);
+    fragPosition = vec4(0.f);
+    return;
+  }
+
   vec3 radiance = vec3(0.f);
   for ( int i = 0; i < u_NbSamplesPerPixel; ++i )
   {
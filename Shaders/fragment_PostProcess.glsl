@@ -10,6 +10,16 @@ out vec4 fragColor;
 uniform sampler2D u_ScreenTexture;
 uniform vec2      u_RenderRes;
 uniform int       u_FXAA;
+uniform sampler2D u_SampleMoments;
+uniform int       u_NbCompleteFrames;
+
+// Adaptive sampling heatmap : blue for pixels that stopped early, red for pixels still sampled every frame
+vec3 SampleHeatmap( in vec4 iMoments )
+{
+  float ratio = clamp(iMoments.z / max(float(u_NbCompleteFrames), 1.f), 0.f, 1.f);
+  vec3 heat = clamp(vec3(2.f * ratio - 1.f, 1.f - abs(2.f * ratio - 1.f), 1.f - 2.f * ratio), 0.f, 1.f);
+  return ( iMoments.w > .5f ) ? ( heat * .5f ) : ( heat );
+}
 
 void main()
 {
@@ -31,5 +41,8 @@ void main()
     color = GammaCorrection( color );
   }
 
+  if ( 8 == u_DebugMode )
+    color = SampleHeatmap(texture(u_SampleMoments, fragUV));
+
   fragColor = vec4( color , alpha);
 }
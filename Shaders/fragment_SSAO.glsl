@@ -1,5 +1,7 @@
 #version 410 core
 
+#include GBuffer.glsl
+
 in vec2 fragUV;
 out vec4 fragColor;
 
@@ -26,8 +28,8 @@ void main()
     return;
   }
 
-  vec3 normalWS = normalize(texture(u_GNormal, fragUV).xyz * 2.0 - 1.0);
-  vec3 fragPosWS = texture(u_GPosition, fragUV).xyz;
+  vec3 normalWS = FetchGNormal(u_GNormal, fragUV);
+  vec3 fragPosWS = FetchGPosition(u_GPosition, fragUV, depth);
   vec3 fragPosVS = (u_View * vec4(fragPosWS, 1.0)).xyz;
   // View matrix is orthonormal (rotation + translation), so inverse-transpose == rotation for normals here.
   vec3 normalVS = normalize(mat3(u_View) * normalWS);
@@ -61,7 +63,7 @@ void main()
     if ( sampleDepth >= 1.0 )
       continue;
 
-    vec3 sampleWorldPos = texture(u_GPosition, sampleUV).xyz;
+    vec3 sampleWorldPos = FetchGPosition(u_GPosition, sampleUV, sampleDepth);
     vec3 samplePosFetchedVS = (u_View * vec4(sampleWorldPos, 1.0)).xyz;
 
     float rangeCheck = smoothstep(0.0, 1.0, u_SSAORadius / (abs(fragPosVS.z - samplePosFetchedVS.z) + 0.0001));
@@ -1,5 +1,7 @@
 #version 410 core
 
+#include GBuffer.glsl
+
 in vec2 fragUV;
 out vec4 fragColor;
 
@@ -25,7 +27,7 @@ void main()
     return;
   }
 
-  vec3 centerNormal = normalize(texture(u_GNormal, fragUV).xyz * 2.0 - 1.0);
+  vec3 centerNormal = FetchGNormal(u_GNormal, fragUV);
   vec2 texel = 1.0 / u_Resolution;
 
   float sum = 0.0;
@@ -40,7 +42,7 @@ void main()
       if ( sampleDepth >= 1.0 )
         continue;
 
-      vec3 sampleNormal = normalize(texture(u_GNormal, sampleUV).xyz * 2.0 - 1.0);
+      vec3 sampleNormal = FetchGNormal(u_GNormal, sampleUV);
       float sampleAO = texture(u_SSAOInput, sampleUV).r;
       float depthWeight = 1.0 / (1.0 + abs(sampleDepth - centerDepth) * 200.0);
       float normalWeight = pow(max(dot(centerNormal, sampleNormal), 0.0), 16.0);
@@ -1,6 +1,7 @@
 #version 410 core
 
 #include Structures.glsl
+#include GBuffer.glsl
 
 in vec2 fragUV;
 out vec4 fragColor;
@@ -28,6 +29,11 @@ uniform float u_SSRMaxDistance = 35.0;
 uniform float u_SSRThickness = 0.25;
 uniform float u_SSRMaxRoughness = 0.55;
 uniform float u_SSRFade = 0.18;
+uniform int   u_SSRTraceMode = 0; // 0 : linear march, 1 : hierarchical min-depth tracing
+
+uniform sampler2D u_HiZ;
+uniform vec2      u_HiZSize;
+uniform int       u_HiZMaxLevel = 0;
 
 const float PI = 3.14159265358979323846;
 const float INV_PI = 0.31830988618379067154;
@@ -83,7 +89,7 @@ bool IsValidHit( in vec2 iUV, in vec3 iPrevRayViewPos, in vec3 iRayViewPos, out
   if ( depth >= 1.0 )
     return false;
 
-  oScenePos = texture(u_GPosition, iUV).xyz;
+  oScenePos = FetchGPosition(u_GPosition, iUV, depth);
   vec3 sceneViewPos = (u_View * vec4(oScenePos, 1.0)).xyz;
   float prevDelta = sceneViewPos.z - iPrevRayViewPos.z;
   float curDelta = sceneViewPos.z - iRayViewPos.z;
@@ -91,43 +97,21 @@ bool IsValidHit( in vec2 iUV, in vec3 iPrevRayViewPos, in vec3 iRayViewPos, out
   return crossedSurface && ( curDelta <= max(u_SSRThickness, 0.0001) );
 }
 
-void main()
+bool TraceLinear( in vec3 iPos, in vec3 iDir, in float iMaxDistance, out vec2 oHitUV, out vec3 oHitScenePos )
 {
-  fragColor = vec4(0.0);
-
-  float depth = texture(u_GDepth, fragUV).r;
-  if ( ( u_EnableSSR == 0 ) || ( depth >= 1.0 ) )
-    return;
-
-  vec3 material = texture(u_GMaterial, fragUV).rgb;
-  float roughness = clamp(material.r, 0.0, 1.0);
-  if ( roughness >= u_SSRMaxRoughness )
-    return;
-
-  vec3 pos = texture(u_GPosition, fragUV).xyz;
-  vec3 N = normalize(texture(u_GNormal, fragUV).xyz * 2.0 - 1.0);
-  vec3 V = normalize(u_Camera._Pos - pos);
-  vec3 R = normalize(reflect(-V, N));
-
-  if ( dot(R, N) <= 0.0001 )
-    return;
+  oHitUV = fragUV;
+  oHitScenePos = vec3(0.0);
 
   float stepSize = max(u_SSRStepSize, 0.001);
-  float maxDistance = max(u_SSRMaxDistance, stepSize);
   int maxSteps = clamp(u_SSRMaxSteps, 4, 128);
 
   float jitter = InterleavedGradientNoise(gl_FragCoord.xy);
   float startDistance = max(u_SSRThickness * 2.0, stepSize) + jitter * stepSize;
-  vec3 prevPos = pos + R * startDistance;
+  vec3 prevPos = iPos + iDir * startDistance;
   vec2 prevUV;
   vec3 prevViewPos;
   if ( !ProjectWorldPos(prevPos, prevUV, prevViewPos) )
-    return;
-
-  vec2 hitUV = fragUV;
-  vec3 hitViewPos = vec3(0.0);
-  vec3 hitScenePos = vec3(0.0);
-  bool hit = false;
+    return false;
 
   for ( int i = 1; i <= 128; ++i )
   {
@@ -135,16 +119,16 @@ void main()
       break;
 
     float dist = startDistance + float(i) * stepSize;
-    if ( dist > maxDistance )
+    if ( dist > iMaxDistance )
       break;
 
-    vec3 rayPos = pos + R * dist;
+    vec3 rayPos = iPos + iDir * dist;
     vec2 rayUV;
     vec3 rayViewPos;
     if ( !ProjectWorldPos(rayPos, rayUV, rayViewPos) )
       break;
 
-    if ( IsValidHit(rayUV, prevViewPos, rayViewPos, hitScenePos) )
+    if ( IsValidHit(rayUV, prevViewPos, rayViewPos, oHitScenePos) )
     {
       vec3 lo = prevPos;
       vec3 hi = rayPos;
@@ -153,25 +137,169 @@ void main()
         vec3 mid = (lo + hi) * 0.5;
         vec2 midUV;
         vec3 midViewPos;
-        if ( ProjectWorldPos(mid, midUV, midViewPos) && IsValidHit(midUV, prevViewPos, midViewPos, hitScenePos) )
+        if ( ProjectWorldPos(mid, midUV, midViewPos) && IsValidHit(midUV, prevViewPos, midViewPos, oHitScenePos) )
         {
           hi = mid;
-          hitUV = midUV;
-          hitViewPos = midViewPos;
+          oHitUV = midUV;
         }
         else
         {
           lo = mid;
         }
       }
-      hit = true;
-      break;
+      return true;
     }
 
     prevPos = rayPos;
     prevViewPos = rayViewPos;
   }
 
+  return false;
+}
+
+// View space z (negative) of a [0,1] depth buffer value
+float ViewDepthFromDepth( in float iDepth )
+{
+  return -u_Proj[3][2] / ( iDepth * 2.0 - 1.0 + u_Proj[2][2] );
+}
+
+vec3 ProjectToScreen( in vec3 iViewPos )
+{
+  vec4 clipPos = u_Proj * vec4(iViewPos, 1.0);
+  return clipPos.xyz / clipPos.w * 0.5 + 0.5;
+}
+
+// Screen space march over the min-depth pyramid : empty cells are skipped at the coarsest level
+// where the ray stays in front of every surface, and refined down to the pixel where it may cross one.
+bool TraceHiZ( in vec3 iPos, in vec3 iDir, in float iMaxDistance, out vec2 oHitUV, out vec3 oHitScenePos )
+{
+  oHitUV = vec2(0.0);
+  oHitScenePos = vec3(0.0);
+
+  vec3 viewPos = (u_View * vec4(iPos, 1.0)).xyz;
+  vec3 viewDir = mat3(u_View) * iDir;
+
+  // Clip the ray against the near plane
+  float nearPlane = u_Proj[3][2] / ( u_Proj[2][2] - 1.0 );
+  float rayLength = iMaxDistance;
+  if ( viewDir.z > 0.0 )
+    rayLength = min(rayLength, 0.99 * ( -nearPlane - viewPos.z ) / viewDir.z);
+  if ( rayLength <= 0.0 )
+    return false;
+
+  vec3 startSS = ProjectToScreen(viewPos);
+  vec3 endSS = ProjectToScreen(viewPos + viewDir * rayLength);
+  vec3 dirSS = endSS - startSS;
+
+  float pixelLength = length(dirSS.xy * u_HiZSize);
+  if ( pixelLength < 1.0 )
+    return false;
+
+  vec2 safeDir = vec2(( abs(dirSS.x) > 1e-7 ) ? dirSS.x : 1e-7, ( abs(dirSS.y) > 1e-7 ) ? dirSS.y : 1e-7);
+  vec2 crossStep = step(vec2(0.0), safeDir);
+  float cellNudge = 0.01 / pixelLength;
+  float thickness = max(u_SSRThickness, 0.0001);
+  int maxSteps = clamp(u_SSRMaxSteps, 4, 128);
+
+  // Start past the reflecting pixel so the surface does not hit itself
+  float t = ( 1.5 + InterleavedGradientNoise(gl_FragCoord.xy) ) / pixelLength;
+  int level = 0;
+
+  for ( int i = 0; i < 128; ++i )
+  {
+    if ( ( i >= maxSteps ) || ( t > 1.0 ) )
+      break;
+
+    vec3 p = startSS + dirSS * t;
+    if ( any(lessThan(p.xy, vec2(0.0))) || any(greaterThan(p.xy, vec2(1.0))) )
+      break;
+
+    // Level texels cover 2^level pixels, the last one also covers the odd remainder
+    float cellScale = exp2(float(level));
+    vec2 levelSize = max(floor(u_HiZSize / cellScale), vec2(1.0));
+    vec2 cell = min(floor(p.xy * u_HiZSize / cellScale), levelSize - 1.0);
+    float minDepth = texelFetch(u_HiZ, ivec2(cell), level).r;
+
+    vec2 boundary = ( cell + crossStep ) * cellScale / u_HiZSize;
+    if ( cell.x + crossStep.x >= levelSize.x )
+      boundary.x = 1.0;
+    if ( cell.y + crossStep.y >= levelSize.y )
+      boundary.y = 1.0;
+    vec2 tBoundary = ( boundary - startSS.xy ) / safeDir;
+    float tExit = min(tBoundary.x, tBoundary.y) + cellNudge;
+
+    if ( p.z < minDepth )
+    {
+      float tDepth = ( dirSS.z > 0.0 ) ? ( ( minDepth - startSS.z ) / dirSS.z ) : 2.0;
+      if ( tDepth < tExit )
+      {
+        // The ray reaches the nearest surface of the cell : refine
+        t = max(t, tDepth);
+        if ( level > 0 )
+          level--;
+        else if ( minDepth < 1.0 )
+        {
+          oHitUV = p.xy;
+          oHitScenePos = FetchGPosition(u_GPosition, oHitUV, texture(u_GDepth, oHitUV).r);
+          return true;
+        }
+        else
+          break;
+      }
+      else
+      {
+        t = tExit;
+        level = min(level + 1, u_HiZMaxLevel);
+      }
+    }
+    else if ( level > 0 )
+      level--;
+    else
+    {
+      if ( minDepth >= 1.0 )
+        break;
+
+      // Behind the pixel surface : a hit within the thickness, otherwise the ray passes behind it
+      if ( ViewDepthFromDepth(minDepth) - ViewDepthFromDepth(p.z) <= thickness )
+      {
+        oHitUV = p.xy;
+        oHitScenePos = FetchGPosition(u_GPosition, oHitUV, texture(u_GDepth, oHitUV).r);
+        return true;
+      }
+      t = tExit;
+    }
+  }
+
+  return false;
+}
+
+void main()
+{
+  fragColor = vec4(0.0);
+
+  float depth = texture(u_GDepth, fragUV).r;
+  if ( ( u_EnableSSR == 0 ) || ( depth >= 1.0 ) )
+    return;
+
+  vec3 material = texture(u_GMaterial, fragUV).rgb;
+  float roughness = clamp(material.r, 0.0, 1.0);
+  if ( roughness >= u_SSRMaxRoughness )
+    return;
+
+  vec3 pos = FetchGPosition(u_GPosition, fragUV, depth);
+  vec3 N = FetchGNormal(u_GNormal, fragUV);
+  vec3 V = normalize(u_Camera._Pos - pos);
+  vec3 R = normalize(reflect(-V, N));
+
+  if ( dot(R, N) <= 0.0001 )
+    return;
+
+  float maxDistance = max(u_SSRMaxDistance, max(u_SSRStepSize, 0.001));
+
+  vec2 hitUV = fragUV;
+  vec3 hitScenePos = vec3(0.0);
+  bool hit = ( u_SSRTraceMode == 1 ) ? TraceHiZ(pos, R, maxDistance, hitUV, hitScenePos) : TraceLinear(pos, R, maxDistance, hitUV, hitScenePos);
+
   if ( !hit )
   {
     if ( u_EnableEnvMap != 0 )
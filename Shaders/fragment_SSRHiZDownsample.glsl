@@ -0,0 +1,42 @@
+#version 410 core
+
+// Min-depth pyramid used by the hierarchical SSR tracing (see DeferredRenderer::BuildSSRHiZ)
+// Level 0 copies the G-buffer depth, every other level keeps the nearest depth of its source footprint.
+
+out vec4 fragColor;
+
+uniform int       u_CopyDepth;
+uniform sampler2D u_Depth;
+uniform sampler2D u_Src;     // Base level restricted to the source level by the caller
+uniform ivec2     u_SrcSize;
+
+void main()
+{
+  ivec2 coord = ivec2(gl_FragCoord.xy);
+  if ( 0 != u_CopyDepth )
+  {
+    fragColor = vec4(texelFetch(u_Depth, coord, 0).r);
+    return;
+  }
+
+  // Odd source sizes : the last texel also covers the extra row / column
+  ivec2 dstSize = max(u_SrcSize / 2, ivec2(1));
+  ivec2 srcBase = coord * 2;
+  ivec2 footprint = ivec2(2);
+  if ( ( coord.x == dstSize.x - 1 ) && ( 0 != ( u_SrcSize.x & 1 ) ) && ( u_SrcSize.x > 1 ) )
+    footprint.x = 3;
+  if ( ( coord.y == dstSize.y - 1 ) && ( 0 != ( u_SrcSize.y & 1 ) ) && ( u_SrcSize.y > 1 ) )
+    footprint.y = 3;
+
+  float minDepth = 1.0;
+  for ( int y = 0; y < footprint.y; ++y )
+  {
+    for ( int x = 0; x < footprint.x; ++x )
+    {
+      ivec2 srcCoord = min(srcBase + ivec2(x, y), u_SrcSize - 1);
+      minDepth = min(minDepth, texelFetch(u_Src, srcCoord, 0).r);
+    }
+  }
+
+  fragColor = vec4(minDepth);
+}
@@ -0,0 +1,92 @@
+#version 410 core
+
+#include ToneMapping.glsl
+
+// A-trous wavelet iteration of the SVGF denoiser (see PathTracer::DenoiseTemporal)
+// 5x5 B3 spline kernel dilated by u_StepSize. The taps are stopped by the normals, the distance to the
+// tangent plane and the luminance difference scaled by the local standard deviation.
+// The variance stored in alpha is filtered along with the color, with the squared weights.
+
+in vec2 fragUV;
+out vec4 fragColor;
+
+uniform sampler2D u_Input;            // rgb : color, a : luminance variance
+uniform sampler2D u_Normals;
+uniform sampler2D u_Pos;
+uniform ivec2     u_ImageSize;
+uniform int       u_StepSize;
+uniform vec3      u_CameraPos;
+uniform float     u_PixelSpread;      // Pixel footprint at unit distance from the camera
+uniform float     u_LuminancePhi = 4.;
+uniform float     u_NormalPhi = 128.;
+uniform float     u_PositionPhi = 1.;
+
+void main()
+{
+  ivec2 coord = ivec2(gl_FragCoord.xy);
+  vec4 center = texelFetch(u_Input, coord, 0);
+  vec3 normal = texelFetch(u_Normals, coord, 0).xyz;
+  vec3 pos    = texelFetch(u_Pos, coord, 0).xyz;
+
+  // Background
+  if ( pos.x > 1e30 )
+  {
+    fragColor = center;
+    return;
+  }
+
+  // 3x3 gaussian prefiltered variance : steadier luminance edge stopping
+  float variance = 0.;
+  for ( int y = -1; y <= 1; ++y )
+  {
+    for ( int x = -1; x <= 1; ++x )
+    {
+      ivec2 tap = clamp(coord + ivec2(x, y), ivec2(0), u_ImageSize - 1);
+      float weight = ( ( x == 0 ) ? .5 : .25 ) * ( ( y == 0 ) ? .5 : .25 );
+      variance += texelFetch(u_Input, tap, 0).a * weight;
+    }
+  }
+
+  float centerLum = Luminance(center.rgb);
+  float lumScale = u_LuminancePhi * sqrt(max(variance, 0.)) + 1e-4;
+  float posScale = u_PositionPhi * float(u_StepSize) * u_PixelSpread * length(pos - u_CameraPos) + 1e-3;
+
+  const float kernel[3] = float[3](3. / 8., 1. / 4., 1. / 16.);
+
+  vec3 colorSum = vec3(0.);
+  float varianceSum = 0.;
+  float weightSum = 0.;
+  for ( int y = -2; y <= 2; ++y )
+  {
+    for ( int x = -2; x <= 2; ++x )
+    {
+      ivec2 tap = coord + ivec2(x, y) * u_StepSize;
+      if ( any(lessThan(tap, ivec2(0))) || any(greaterThanEqual(tap, u_ImageSize)) )
+        continue;
+
+      vec3 tapPos = texelFetch(u_Pos, tap, 0).xyz;
+      if ( tapPos.x > 1e30 )
+        continue;
+
+      vec4 tapColor = texelFetch(u_Input, tap, 0);
+      vec3 tapNormal = texelFetch(u_Normals, tap, 0).xyz;
+
+      float normalWeight = pow(max(dot(normal, tapNormal), 0.), u_NormalPhi);
+      float posWeight = exp(-abs(dot(tapPos - pos, normal)) / posScale);
+      float lumWeight = exp(-abs(Luminance(tapColor.rgb) - centerLum) / lumScale);
+      float weight = kernel[abs(x)] * kernel[abs(y)] * normalWeight * posWeight * lumWeight;
+
+      colorSum += tapColor.rgb * weight;
+      varianceSum += tapColor.a * weight * weight;
+      weightSum += weight;
+    }
+  }
+
+  if ( weightSum < 1e-6 )
+  {
+    fragColor = center;
+    return;
+  }
+
+  fragColor = vec4(colorSum / weightSum, varianceSum / ( weightSum * weightSum ));
+}
@@ -0,0 +1,175 @@
+#version 410 core
+
+#include Constants.glsl
+#include ToneMapping.glsl
+
+// Temporal accumulation of the SVGF denoiser (see PathTracer::DenoiseTemporal)
+// The history is reprojected with the previous camera, the bilinear taps lying on another surface are rejected.
+// Colors and luminance moments are blended with the new frame : exponentially while the scene changes,
+// as a plain average once it is still, so the history keeps converging like the accumulation buffer.
+
+in vec2 fragUV;
+layout(location = 0) out vec4 fragColor;    // rgb : integrated color, a : variance of the integrated luminance
+layout(location = 1) out vec4 fragMoments;  // x : luminance mean, y : squared luminance mean, z : history length
+layout(location = 2) out vec4 fragNormal;   // Geometry of the frame, matched by the next reprojection
+layout(location = 3) out vec4 fragPosition;
+
+uniform sampler2D u_NewFrame;
+uniform sampler2D u_NewFrameNormals;
+uniform sampler2D u_NewFramePos;
+uniform sampler2D u_HistoryColor;
+uniform sampler2D u_HistoryMoments;
+uniform sampler2D u_HistoryNormals;
+uniform sampler2D u_HistoryPos;
+uniform int       u_HistoryValid;
+uniform int       u_Dirty;          // Camera or scene changed since the previous frame
+uniform float     u_Alpha = .2;     // Minimum weight of the new frame while dirty
+uniform vec2      u_Resolution;
+uniform vec3      u_CameraPos;
+
+// Camera of the previous frame
+uniform vec3  u_PrevCameraPos;
+uniform vec3  u_PrevCameraRight;
+uniform vec3  u_PrevCameraUp;
+uniform vec3  u_PrevCameraForward;
+uniform float u_PrevCameraScale;    // tan(fov / 2)
+
+// Under this history length the variance comes from the spatial neighbourhood
+const float MinTemporalVarianceLength = 4.;
+
+// ----------------------------------------------------------------------------
+// IsBackground
+// The path tracer stores an infinite position for the primary rays missing the scene
+// ----------------------------------------------------------------------------
+bool IsBackground( in vec3 iPos )
+{
+  return ( iPos.x > 1e30 );
+}
+
+// ----------------------------------------------------------------------------
+// PreviousUV
+// Inverse of GetRay with the previous camera. Background pixels are reprojected by direction.
+// ----------------------------------------------------------------------------
+bool PreviousUV( in vec3 iPos, in vec3 iNormal, out vec2 oUV )
+{
+  vec3 dir = IsBackground(iPos) ? ( -iNormal ) : ( iPos - u_PrevCameraPos );
+
+  float depth = dot(dir, u_PrevCameraForward);
+  if ( depth <= EPSILON )
+    return false;
+
+  vec2 centeredUV = vec2(dot(dir, u_PrevCameraRight), dot(dir, u_PrevCameraUp)) / depth;
+  centeredUV.x /= u_PrevCameraScale;
+  centeredUV.y /= ( u_Resolution.y / u_Resolution.x ) * u_PrevCameraScale;
+
+  oUV = centeredUV * .5 + .5;
+  return ( all(greaterThanEqual(oUV, vec2(0.))) && all(lessThan(oUV, vec2(1.))) );
+}
+
+// ----------------------------------------------------------------------------
+// ConsistentTap
+// ----------------------------------------------------------------------------
+bool ConsistentTap( in vec3 iPos, in vec3 iNormal, in vec3 iPrevPos, in vec3 iPrevNormal )
+{
+  if ( IsBackground(iPos) || IsBackground(iPrevPos) )
+    return ( IsBackground(iPos) && IsBackground(iPrevPos) );
+
+  if ( dot(iNormal, iPrevNormal) < .9 )
+    return false;
+
+  float planeTolerance = .02 * length(iPos - u_CameraPos) + .001;
+  return ( abs(dot(iPrevPos - iPos, iNormal)) < planeTolerance );
+}
+
+// ----------------------------------------------------------------------------
+// SpatialVariance
+// Luminance variance over the 3x3 neighbourhood, restricted to similar normals
+// ----------------------------------------------------------------------------
+float SpatialVariance( in ivec2 iCoord, in vec3 iNormal )
+{
+  vec2 moments = vec2(0.);
+  float weightSum = 0.;
+  for ( int y = -1; y <= 1; ++y )
+  {
+    for ( int x = -1; x <= 1; ++x )
+    {
+      ivec2 tap = clamp(iCoord + ivec2(x, y), ivec2(0), ivec2(u_Resolution) - 1);
+      float weight = max(dot(iNormal, texelFetch(u_NewFrameNormals, tap, 0).xyz), 0.);
+      float lum = Luminance(texelFetch(u_NewFrame, tap, 0).rgb);
+      moments += vec2(lum, lum * lum) * weight;
+      weightSum += weight;
+    }
+  }
+  moments /= max(weightSum, 1e-4);
+  return max(moments.y - moments.x * moments.x, 0.);
+}
+
+void main()
+{
+  ivec2 coord = ivec2(gl_FragCoord.xy);
+  vec3 color  = texelFetch(u_NewFrame, coord, 0).rgb;
+  vec3 normal = texelFetch(u_NewFrameNormals, coord, 0).xyz;
+  vec3 pos    = texelFetch(u_NewFramePos, coord, 0).xyz;
+
+  fragNormal   = vec4(normal, 1.);
+  fragPosition = vec4(pos, 1.);
+
+  float lum = Luminance(color);
+  vec2 moments = vec2(lum, lum * lum);
+
+  // Reprojected history : 2x2 bilinear footprint, disoccluded taps dropped
+  vec3 historyColor = vec3(0.);
+  vec3 historyMoments = vec3(0.);
+  float weightSum = 0.;
+
+  vec2 prevUV;
+  if ( ( 1 == u_HistoryValid ) && PreviousUV(pos, normal, prevUV) )
+  {
+    vec2 prevPixel = prevUV * u_Resolution - .5;
+    ivec2 base = ivec2(floor(prevPixel));
+    vec2 frac = prevPixel - vec2(base);
+
+    for ( int y = 0; y <= 1; ++y )
+    {
+      for ( int x = 0; x <= 1; ++x )
+      {
+        ivec2 tap = base + ivec2(x, y);
+        if ( any(lessThan(tap, ivec2(0))) || any(greaterThanEqual(tap, ivec2(u_Resolution))) )
+          continue;
+
+        if ( !ConsistentTap(pos, normal, texelFetch(u_HistoryPos, tap, 0).xyz, texelFetch(u_HistoryNormals, tap, 0).xyz) )
+          continue;
+
+        float weight = ( ( x == 0 ) ? ( 1. - frac.x ) : frac.x ) * ( ( y == 0 ) ? ( 1. - frac.y ) : frac.y );
+        historyColor   += texelFetch(u_HistoryColor, tap, 0).rgb * weight;
+        historyMoments += texelFetch(u_HistoryMoments, tap, 0).xyz * weight;
+        weightSum += weight;
+      }
+    }
+  }
+
+  float historyLength = 0.;
+  if ( weightSum > 1e-3 )
+  {
+    historyColor /= weightSum;
+    historyMoments /= weightSum;
+    historyLength = historyMoments.z;
+  }
+
+  // While dirty the history length is capped at 1 / u_Alpha : the new frame weighs at least u_Alpha
+  float newLength = historyLength + 1.;
+  if ( 1 == u_Dirty )
+    newLength = min(newLength, 1. / max(u_Alpha, 1e-3));
+  float alpha = 1. / newLength;
+
+  vec3 outColor = mix(historyColor, color, alpha);
+  vec2 outMoments = mix(historyMoments.xy, moments, alpha);
+
+  float variance = ( newLength < MinTemporalVarianceLength ) ? SpatialVariance(coord, normal) : max(outMoments.y - outMoments.x * outMoments.x, 0.);
+
+  // Variance of the blended estimate rather than of a single sample : the filter fades out as the history converges
+  variance *= alpha;
+
+  fragColor   = vec4(outColor, variance);
+  fragMoments = vec4(outMoments, newLength, 0.);
+}
@@ -0,0 +1,38 @@
+#version 430 core
+
+// Multi-draw indirect variant of vertex_DeferredGeometry.glsl
+
+#include DrawInstances.glsl
+
+// Per-vertex attributes (must match VBO layout: location 0 pos, 1 normal, 2 uv)
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec3 a_Normal;
+layout(location = 2) in vec2 a_UV;
+layout(location = 3) in uint a_DrawID;
+
+uniform mat4 u_View;
+uniform mat4 u_Proj;
+
+// Outputs to fragment shader
+out vec3 fragWorldPos;
+out vec3 fragNormal;
+out vec2 fragUV;
+flat out int v_MaterialID;
+
+void main()
+{
+  DrawInstance inst = u_DrawInstances[a_DrawID];
+
+  // World-space position
+  vec4 worldPos = inst._Model * vec4(a_Position, 1.0);
+  fragWorldPos = worldPos.xyz;
+
+  // Normal matrix is computed once per instance on the CPU
+  fragNormal = normalize(mat3(inst._NormalMatrix) * a_Normal);
+
+  fragUV = a_UV;
+  v_MaterialID = inst._MaterialID.x;
+
+  // Clip-space position
+  gl_Position = u_Proj * u_View * worldPos;
+}
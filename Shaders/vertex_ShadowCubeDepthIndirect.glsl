@@ -0,0 +1,19 @@
+#version 430 core
+
+// Multi-draw indirect variant of vertex_ShadowCubeDepth.glsl
+
+#include DrawInstances.glsl
+
+layout(location = 0) in vec3 a_Position;
+layout(location = 3) in uint a_DrawID;
+
+uniform mat4  u_LightViewProj;
+
+out vec3 fragWorldPos;
+
+void main()
+{
+  vec4 worldPos = u_DrawInstances[a_DrawID]._Model * vec4(a_Position, 1.0);
+  fragWorldPos = worldPos.xyz;
+  gl_Position = u_LightViewProj * worldPos;
+}
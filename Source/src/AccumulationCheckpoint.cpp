@@ -0,0 +1,245 @@
+#include "AccumulationCheckpoint.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace fs = std::filesystem;
+
+namespace RTRT
+{
+
+static const uint32_t S_CheckpointMagic   = 0x43415452; // "RTAC"
+static const uint32_t S_CheckpointVersion = 2;
+static const int      S_MaxResolution     = 1 << 16;
+static const float    S_CameraTolerance   = 1e-4f;
+
+// ----------------------------------------------------------------------------
+// Checksum
+// FNV-1a of a layer, detects a truncated or damaged file
+// ----------------------------------------------------------------------------
+static uint32_t Checksum( const float * iData, size_t iNbFloats )
+{
+  const unsigned char * bytes = reinterpret_cast<const unsigned char *>(iData);
+  uint32_t hash = 2166136261u;
+  for ( size_t i = 0; i < iNbFloats * sizeof(float); ++i )
+    hash = ( hash ^ bytes[i] ) * 16777619u;
+  return hash;
+}
+
+template <typename T>
+static void Write( std::ofstream & ioFile, const T & iValue )
+{
+  ioFile.write(reinterpret_cast<const char *>(&iValue), sizeof(T));
+}
+
+template <typename T>
+static bool Read( std::ifstream & ioFile, T & oValue )
+{
+  return !!ioFile.read(reinterpret_cast<char *>(&oValue), sizeof(T));
+}
+
+// ----------------------------------------------------------------------------
+// IsCompatible
+// ----------------------------------------------------------------------------
+bool AccumulationCheckpoint::IsCompatible( const AccumulationCheckpoint & iCurrent, std::string & oReason ) const
+{
+  oReason.clear();
+
+  if ( _Resolution != iCurrent._Resolution )
+    oReason = "render resolution " + std::to_string(_Resolution.x) + "x" + std::to_string(_Resolution.y);
+  else if ( _NbSamplesPerPixel != iCurrent._NbSamplesPerPixel )
+    oReason = "samples per pixel " + std::to_string(_NbSamplesPerPixel);
+  else if ( _Bounces != iCurrent._Bounces )
+    oReason = "bounces " + std::to_string(_Bounces);
+  else if ( ( _TiledRendering != iCurrent._TiledRendering ) || ( _TiledRendering && ( _NbTiles != iCurrent._NbTiles ) ) )
+    oReason = "tile layout";
+  else if ( ( glm::length(_CameraPos - iCurrent._CameraPos) > S_CameraTolerance * std::max(1.f, glm::length(iCurrent._CameraPos)) )
+         || ( glm::length(_CameraForward - iCurrent._CameraForward) > S_CameraTolerance )
+         || ( std::fabs(_CameraFOV - iCurrent._CameraFOV) > S_CameraTolerance ) )
+    oReason = "camera";
+
+  return oReason.empty();
+}
+
+// ----------------------------------------------------------------------------
+// AccumulationCheckpointWriter::DTOR
+// ----------------------------------------------------------------------------
+AccumulationCheckpointWriter::~AccumulationCheckpointWriter()
+{
+  // Never closed : the previous checkpoint stays
+  if ( _File.is_open() )
+  {
+    _File.close();
+    std::error_code error;
+    fs::remove(_TemporaryPath, error);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// AccumulationCheckpointWriter::Open
+// ----------------------------------------------------------------------------
+bool AccumulationCheckpointWriter::Open( const fs::path & iPath, const AccumulationCheckpoint & iCheckpoint )
+{
+  const int nbTiles = ( iCheckpoint._TiledRendering ) ? ( iCheckpoint._NbTiles.x * iCheckpoint._NbTiles.y ) : ( 0 );
+  if ( ( iCheckpoint._Resolution.x <= 0 ) || ( iCheckpoint._Resolution.y <= 0 )
+    || ( ( nbTiles > 0 ) && ( ( iCheckpoint._TileSamples.size() != static_cast<size_t>(nbTiles) ) || ( iCheckpoint._TileErrors.size() != static_cast<size_t>(nbTiles) ) ) ) )
+    return false;
+
+  std::error_code error;
+  if ( iPath.has_parent_path() )
+    fs::create_directories(iPath.parent_path(), error);
+
+  _Path = iPath;
+  _TemporaryPath = iPath;
+  _TemporaryPath += ".tmp";
+  _File.open(_TemporaryPath, std::ios::binary | std::ios::trunc);
+  if ( !_File )
+    return false;
+
+  Write(_File, S_CheckpointMagic);
+  Write(_File, S_CheckpointVersion);
+  Write(_File, static_cast<int32_t>(iCheckpoint._Resolution.x));
+  Write(_File, static_cast<int32_t>(iCheckpoint._Resolution.y));
+  Write(_File, static_cast<int32_t>(AccumulationCheckpoint::_NbLayers));
+  Write(_File, static_cast<uint32_t>(iCheckpoint._NbCompleteFrames));
+  Write(_File, static_cast<uint32_t>(iCheckpoint._FrameNum));
+  Write(_File, static_cast<uint32_t>(iCheckpoint._NbRenderedFrames));
+  Write(_File, static_cast<int32_t>(iCheckpoint._NbSamplesPerPixel));
+  Write(_File, static_cast<int32_t>(iCheckpoint._Bounces));
+  Write(_File, static_cast<uint32_t>(( iCheckpoint._TiledRendering ) ? ( 1 ) : ( 0 )));
+  Write(_File, static_cast<int32_t>(iCheckpoint._NbTiles.x));
+  Write(_File, static_cast<int32_t>(iCheckpoint._NbTiles.y));
+  Write(_File, static_cast<int32_t>(iCheckpoint._TileCursor));
+  Write(_File, static_cast<int32_t>(nbTiles));
+  for ( int i = 0; i < 3; ++i )
+    Write(_File, iCheckpoint._CameraPos[i]);
+  for ( int i = 0; i < 3; ++i )
+    Write(_File, iCheckpoint._CameraForward[i]);
+  Write(_File, iCheckpoint._CameraFOV);
+  for ( int i = 0; i < nbTiles; ++i )
+    Write(_File, static_cast<uint32_t>(iCheckpoint._TileSamples[i]));
+  for ( int i = 0; i < nbTiles; ++i )
+    Write(_File, iCheckpoint._TileErrors[i]);
+
+  _LayerSize = iCheckpoint.GetLayerSize();
+  _NbLayers = 0;
+  return _File.good();
+}
+
+// ----------------------------------------------------------------------------
+// AccumulationCheckpointWriter::WriteLayer
+// ----------------------------------------------------------------------------
+bool AccumulationCheckpointWriter::WriteLayer( const float * iPixels )
+{
+  if ( !_File.is_open() || !iPixels || ( _NbLayers >= AccumulationCheckpoint::_NbLayers ) )
+    return false;
+
+  Write(_File, static_cast<uint32_t>(_NbLayers));
+  Write(_File, static_cast<uint64_t>(_LayerSize * sizeof(float)));
+  _File.write(reinterpret_cast<const char *>(iPixels), _LayerSize * sizeof(float));
+  Write(_File, Checksum(iPixels, _LayerSize));
+  _NbLayers++;
+
+  return _File.good();
+}
+
+// ----------------------------------------------------------------------------
+// AccumulationCheckpointWriter::Close
+// ----------------------------------------------------------------------------
+bool AccumulationCheckpointWriter::Close()
+{
+  if ( !_File.is_open() )
+    return false;
+
+  _File.close();
+  const bool complete = !_File.fail() && ( AccumulationCheckpoint::_NbLayers == _NbLayers );
+
+  std::error_code error;
+  if ( complete )
+  {
+    // Replaces the previous checkpoint in one step
+    fs::rename(_TemporaryPath, _Path, error);
+    if ( !error )
+      return true;
+  }
+  fs::remove(_TemporaryPath, error);
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// AccumulationCheckpointReader::Open
+// ----------------------------------------------------------------------------
+bool AccumulationCheckpointReader::Open( const fs::path & iPath, AccumulationCheckpoint & oCheckpoint )
+{
+  _File.open(iPath, std::ios::binary);
+  if ( !_File )
+    return false;
+
+  uint32_t magic = 0, version = 0, nbCompleteFrames = 0, frameNum = 0, nbRenderedFrames = 0, tiled = 0;
+  int32_t width = 0, height = 0, nbLayers = 0, nbSamples = 0, bounces = 0, nbTilesX = 0, nbTilesY = 0, tileCursor = 0, nbTiles = 0;
+  if ( !Read(_File, magic) || ( S_CheckpointMagic != magic ) || !Read(_File, version) || ( S_CheckpointVersion != version )
+    || !Read(_File, width) || !Read(_File, height) || !Read(_File, nbLayers) || !Read(_File, nbCompleteFrames) || !Read(_File, frameNum)
+    || !Read(_File, nbRenderedFrames) || !Read(_File, nbSamples) || !Read(_File, bounces) || !Read(_File, tiled) || !Read(_File, nbTilesX)
+    || !Read(_File, nbTilesY) || !Read(_File, tileCursor) || !Read(_File, nbTiles) )
+    return false;
+
+  if ( ( width <= 0 ) || ( height <= 0 ) || ( width > S_MaxResolution ) || ( height > S_MaxResolution )
+    || ( AccumulationCheckpoint::_NbLayers != nbLayers ) || ( nbTiles < 0 ) || ( nbTiles > width * height )
+    || ( tiled && ( ( nbTilesX <= 0 ) || ( nbTilesY <= 0 ) || ( nbTiles != nbTilesX * nbTilesY ) ) ) )
+    return false;
+
+  oCheckpoint = AccumulationCheckpoint();
+  oCheckpoint._Resolution = Vec2i(width, height);
+  oCheckpoint._NbCompleteFrames = nbCompleteFrames;
+  oCheckpoint._FrameNum = frameNum;
+  oCheckpoint._NbRenderedFrames = nbRenderedFrames;
+  oCheckpoint._NbSamplesPerPixel = nbSamples;
+  oCheckpoint._Bounces = bounces;
+  oCheckpoint._TiledRendering = ( 0 != tiled );
+  oCheckpoint._NbTiles = Vec2i(nbTilesX, nbTilesY);
+  oCheckpoint._TileCursor = tileCursor;
+
+  bool valid = true;
+  for ( int i = 0; i < 3; ++i )
+    valid = valid && Read(_File, oCheckpoint._CameraPos[i]);
+  for ( int i = 0; i < 3; ++i )
+    valid = valid && Read(_File, oCheckpoint._CameraForward[i]);
+  valid = valid && Read(_File, oCheckpoint._CameraFOV);
+
+  oCheckpoint._TileSamples.resize(nbTiles);
+  oCheckpoint._TileErrors.resize(nbTiles);
+  for ( int i = 0; valid && ( i < nbTiles ); ++i )
+  {
+    uint32_t samples = 0;
+    valid = Read(_File, samples);
+    oCheckpoint._TileSamples[i] = samples;
+  }
+  for ( int i = 0; valid && ( i < nbTiles ); ++i )
+    valid = Read(_File, oCheckpoint._TileErrors[i]);
+
+  _LayerSize = oCheckpoint.GetLayerSize();
+  _NbLayers = 0;
+  return valid;
+}
+
+// ----------------------------------------------------------------------------
+// AccumulationCheckpointReader::ReadLayer
+// ----------------------------------------------------------------------------
+bool AccumulationCheckpointReader::ReadLayer( std::vector<float> & oPixels )
+{
+  uint32_t layer = 0, checksum = 0;
+  uint64_t size = 0;
+  if ( !_File.is_open() || ( _NbLayers >= AccumulationCheckpoint::_NbLayers )
+    || !Read(_File, layer) || ( _NbLayers != static_cast<int>(layer) )
+    || !Read(_File, size) || ( _LayerSize * sizeof(float) != size ) )
+    return false;
+
+  oPixels.resize(_LayerSize);
+  if ( !_File.read(reinterpret_cast<char *>(oPixels.data()), size) || !Read(_File, checksum) || ( Checksum(oPixels.data(), _LayerSize) != checksum ) )
+    return false;
+
+  _NbLayers++;
+  return true;
+}
+
+}
@@ -0,0 +1,75 @@
+#ifndef _AccumulationCheckpoint_
+#define _AccumulationCheckpoint_
+
+#include "MathUtil.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace RTRT
+{
+
+// Progressive PathTracer state : enough to continue an accumulation with the same result.
+// File : this header, then every layer as one chunk of float32 RGBA rows from the bottom of the image, each followed by its checksum.
+// Layers are written and read one at a time, a checkpoint never needs more memory than a single layer.
+struct AccumulationCheckpoint
+{
+  static const int _NbLayers = 4;  // Color, normals, positions, luminance moments : the attachments of the accumulation frame buffer
+
+  Vec2i                     _Resolution        = Vec2i(0);
+  unsigned int              _NbCompleteFrames  = 0;        // Accumulated frames. Tiled rendering : fewest samples of a tile.
+  unsigned int              _FrameNum          = 1;        // Rendered frames + 1
+  unsigned int              _NbRenderedFrames  = 0;        // Frames of this accumulation, tiled rendering included : where a batch job resumes
+  int                       _NbSamplesPerPixel = 1;
+  int                       _Bounces           = 1;
+  bool                      _TiledRendering    = false;
+  Vec2i                     _NbTiles           = Vec2i(0);
+  std::vector<unsigned int> _TileSamples;                  // Accumulated frames of each tile, the RNG frame index of its next sample
+  std::vector<float>        _TileErrors;
+  int                       _TileCursor        = -1;       // Scanline order
+  Vec3                      _CameraPos         = Vec3(0.f);
+  Vec3                      _CameraForward     = Vec3(0.f);
+  float                     _CameraFOV         = 0.f;
+
+  // Same image, sampling and view. oReason tells the first difference.
+  bool IsCompatible( const AccumulationCheckpoint & iCurrent, std::string & oReason ) const;
+
+  size_t GetLayerSize() const { return static_cast<size_t>(_Resolution.x) * _Resolution.y * 4; }
+};
+
+// Written next to the target then renamed : an interrupted write keeps the previous checkpoint
+class AccumulationCheckpointWriter
+{
+public:
+  ~AccumulationCheckpointWriter();
+
+  bool Open( const std::filesystem::path & iPath, const AccumulationCheckpoint & iCheckpoint );
+  bool WriteLayer( const float * iPixels );
+  bool Close();
+
+protected:
+  std::filesystem::path _Path;
+  std::filesystem::path _TemporaryPath;
+  std::ofstream         _File;
+  size_t                _LayerSize = 0;
+  int                   _NbLayers = 0;
+};
+
+class AccumulationCheckpointReader
+{
+public:
+  bool Open( const std::filesystem::path & iPath, AccumulationCheckpoint & oCheckpoint );
+  bool ReadLayer( std::vector<float> & oPixels );
+
+protected:
+  std::ifstream _File;
+  size_t        _LayerSize = 0;
+  int           _NbLayers = 0;
+};
+
+}
+
+#endif /* _AccumulationCheckpoint_ */
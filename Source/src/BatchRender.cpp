@@ -0,0 +1,640 @@
+#include "BatchRender.h"
+
+#include "Loader.h"
+#include "PathTracer.h"
+#include "PathUtils.h"
+#include "RenderSettings.h"
+#include "Renderer.h"
+#include "Scene.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace RTRT
+{
+
+namespace
+{
+
+struct BatchPassTiming
+{
+  std::string _Name;
+  double      _Seconds = 0.;
+};
+
+struct BatchJobTiming
+{
+  std::string                  _Scene;
+  int                          _Camera = 0;
+  std::string                  _Output;
+  std::string                  _Checkpoint;
+  std::string                  _Error;
+  Vec2i                        _Resolution = Vec2i(0);
+  int                          _Frames = 0;
+  int                          _ResumedFrames = 0;     // Frames restored from the checkpoint
+  double                       _SceneLoadSeconds = 0.; // Load and renderer initialization, charged to the first camera
+  double                       _RenderSeconds = 0.;
+  double                       _WriteSeconds = 0.;
+  double                       _CheckpointSeconds = 0.;
+  std::vector<BatchPassTiming> _Passes;                // Summed over the frames
+};
+
+std::string JsonEscape( const std::string & iText )
+{
+  std::string result;
+  result.reserve(iText.size());
+  for ( char c : iText )
+  {
+    if ( '"' == c )
+      result += "\\\"";
+    else if ( '\\' == c )
+      result += "\\\\";
+    else if ( '\n' == c )
+      result += "\\n";
+    else if ( '\t' == c )
+      result += "\\t";
+    else
+      result += c;
+  }
+  return result;
+}
+
+std::string GLString( GLenum iName )
+{
+  const GLubyte * value = glGetString(iName);
+  return value ? reinterpret_cast<const char *>(value) : "";
+}
+
+double SecondsSince( const std::chrono::steady_clock::time_point & iStart )
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - iStart).count();
+}
+
+bool ParsePositiveInt( const std::string & iText, int & oValue )
+{
+  char * end = nullptr;
+  const long value = std::strtol(iText.c_str(), &end, 10);
+  if ( !end || *end || ( value <= 0 ) || ( value > 1 << 20 ) )
+    return false;
+  oValue = static_cast<int>(value);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// BatchContext
+// Hidden window or headless context, GLFW null platform for the latter (GLFW 3.4)
+// ----------------------------------------------------------------------------
+class BatchContext
+{
+public:
+  ~BatchContext() { Release(); }
+
+  bool Initialize( BatchContextAPI iAPI )
+  {
+    if ( BatchContextAPI::Auto != iAPI )
+      return TryCreate(iAPI);
+
+    const BatchContextAPI candidates[2][3] =
+    {
+      { BatchContextAPI::EGL,    BatchContextAPI::OSMesa, BatchContextAPI::Window },
+      { BatchContextAPI::Window, BatchContextAPI::EGL,    BatchContextAPI::OSMesa }
+    };
+    for ( BatchContextAPI api : candidates[( HasDisplay() ) ? ( 1 ) : ( 0 )] )
+    {
+      if ( TryCreate(api) )
+        return true;
+    }
+    return false;
+  }
+
+  const char * GetName() const
+  {
+    if ( BatchContextAPI::EGL == _API )
+      return "egl";
+    if ( BatchContextAPI::OSMesa == _API )
+      return "osmesa";
+    return "window";
+  }
+
+private:
+
+  static bool HasDisplay()
+  {
+#if defined(_WIN32) || defined(__APPLE__)
+    return true;
+#else
+    return ( std::getenv("DISPLAY") || std::getenv("WAYLAND_DISPLAY") );
+#endif
+  }
+
+  bool TryCreate( BatchContextAPI iAPI )
+  {
+#if ( GLFW_VERSION_MAJOR > 3 ) || ( ( GLFW_VERSION_MAJOR == 3 ) && ( GLFW_VERSION_MINOR >= 4 ) )
+    glfwInitHint(GLFW_PLATFORM, ( BatchContextAPI::Window == iAPI ) ? ( GLFW_ANY_PLATFORM ) : ( GLFW_PLATFORM_NULL ));
+#else
+    if ( BatchContextAPI::Window != iAPI )
+      return false;
+#endif
+    if ( !glfwInit() )
+      return false;
+    _Initialized = true;
+
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    if ( BatchContextAPI::EGL == iAPI )
+      glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+    else if ( BatchContextAPI::OSMesa == iAPI )
+      glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+
+    _Window = glfwCreateWindow(64, 64, "RenderLab - Batch", nullptr, nullptr);
+    if ( !_Window )
+    {
+      Release();
+      return false;
+    }
+    glfwMakeContextCurrent(_Window);
+    glfwSwapInterval(0);
+
+    // Headless contexts have no GLX display : GLEW loads the GL entry points, then fails on GLX only
+    glewExperimental = GL_TRUE;
+    const GLenum glewStatus = glewInit();
+    if ( ( GLEW_OK != glewStatus ) && ( ( BatchContextAPI::Window == iAPI ) || ( GLEW_ERROR_NO_GLX_DISPLAY != glewStatus ) ) )
+    {
+      Release();
+      return false;
+    }
+    glGetError();
+
+    _API = iAPI;
+    return true;
+  }
+
+  void Release()
+  {
+    if ( _Window )
+      glfwDestroyWindow(_Window);
+    if ( _Initialized )
+      glfwTerminate();
+    _Window = nullptr;
+    _Initialized = false;
+  }
+
+  GLFWwindow    * _Window = nullptr;
+  bool            _Initialized = false;
+  BatchContextAPI _API = BatchContextAPI::Window;
+};
+
+// ----------------------------------------------------------------------------
+// RenderCamera
+// ----------------------------------------------------------------------------
+bool RenderCamera( Renderer & ioRenderer, const BatchRenderOptions & iOptions, BatchJobTiming & ioJob, int & ioNbBatchFrames )
+{
+  std::vector<RenderPassTiming> timings;
+  std::error_code error;
+
+  // Only the PathTracer accumulates across frames
+  PathTracer * pathTracer = ( ioJob._Checkpoint.empty() ) ? ( nullptr ) : ( ioRenderer.AsPathTracer() );
+  int firstFrame = 0;
+  if ( pathTracer && iOptions._Resume && fs::exists(ioJob._Checkpoint, error) )
+  {
+    if ( 0 != pathTracer -> LoadCheckpoint(ioJob._Checkpoint) )
+    {
+      ioJob._Error = "unable to resume from " + ioJob._Checkpoint;
+      return false;
+    }
+    // The frame index is global to the renderer, shared by every camera of the scene : the job resumes from its own frame count
+    firstFrame = std::min(static_cast<int>(pathTracer -> GetNbRenderedFrames()), iOptions._Frames);
+    ioJob._ResumedFrames = firstFrame;
+  }
+
+  const auto renderStart = std::chrono::steady_clock::now();
+  for ( int frame = firstFrame; frame < iOptions._Frames; ++frame )
+  {
+    if ( ( iOptions._InterruptAfterFrames > 0 ) && ( ioNbBatchFrames >= iOptions._InterruptAfterFrames ) )
+    {
+      ioJob._Error = "interrupted at frame " + std::to_string(frame);
+      return false;
+    }
+    ioNbBatchFrames++;
+
+    if ( ( 0 != ioRenderer.Update() ) || ( 0 != ioRenderer.RenderToTexture() ) )
+    {
+      ioJob._Error = "render failed at frame " + std::to_string(frame);
+      return false;
+    }
+
+    // No swap operation submits the queued GPU work
+    glFlush();
+    if ( 0 != ioRenderer.Done() )
+    {
+      ioJob._Error = "finalization failed at frame " + std::to_string(frame);
+      return false;
+    }
+
+    ioRenderer.GetRenderPassTimings(timings);
+    for ( const RenderPassTiming & timing : timings )
+    {
+      if ( !timing._Enabled )
+        continue;
+
+      auto pass = std::find_if(ioJob._Passes.begin(), ioJob._Passes.end(), [&timing]( const BatchPassTiming & iPass ) { return ( iPass._Name == timing._Name ); });
+      if ( pass == ioJob._Passes.end() )
+        pass = ioJob._Passes.insert(ioJob._Passes.end(), { timing._Name, 0. });
+      pass -> _Seconds += timing._Seconds;
+    }
+
+    // A failed checkpoint does not stop the render, the previous one stays
+    if ( pathTracer && ( ( 0 == ( frame + 1 ) % iOptions._CheckpointInterval ) || ( frame + 1 == iOptions._Frames ) ) )
+    {
+      const auto checkpointStart = std::chrono::steady_clock::now();
+      pathTracer -> SaveCheckpoint(ioJob._Checkpoint);
+      ioJob._CheckpointSeconds += SecondsSince(checkpointStart);
+    }
+  }
+  glFinish();
+  ioJob._RenderSeconds = SecondsSince(renderStart) - ioJob._CheckpointSeconds;
+  ioJob._Frames = iOptions._Frames - firstFrame;
+
+  // RenderToFile reports a failed write on the console only : check the file instead
+  const auto writeStart = std::chrono::steady_clock::now();
+  const fs::path outputPath(ioJob._Output);
+  if ( outputPath.has_parent_path() )
+    fs::create_directories(outputPath.parent_path(), error);
+  fs::remove(outputPath, error);
+  ioRenderer.RenderToFile(outputPath);
+  glFinish();
+  ioJob._WriteSeconds = SecondsSince(writeStart);
+
+  if ( !fs::exists(outputPath, error) )
+  {
+    ioJob._Error = "output write failed";
+    return false;
+  }
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// WriteTimings
+// ----------------------------------------------------------------------------
+bool WriteTimings( const BatchRenderOptions & iOptions, const BatchContext & iContext, const std::vector<BatchJobTiming> & iJobs, double iTotalSeconds )
+{
+  std::error_code error;
+  const fs::path timingsPath(iOptions._TimingsPath);
+  if ( timingsPath.has_parent_path() )
+    fs::create_directories(timingsPath.parent_path(), error);
+
+  std::ofstream file(timingsPath);
+  if ( !file.is_open() )
+    return false;
+
+  file << "{\n";
+  file << "  \"schema_version\": 1,\n";
+  file << "  \"backend\": \"" << GetBatchBackendName(iOptions._Backend) << "\",\n";
+  file << "  \"context\": \"" << iContext.GetName() << "\",\n";
+  file << "  \"gl_renderer\": \"" << JsonEscape(GLString(GL_RENDERER)) << "\",\n";
+  file << "  \"gl_version\": \"" << JsonEscape(GLString(GL_VERSION)) << "\",\n";
+  file << "  \"total_ms\": " << iTotalSeconds * 1000. << ",\n";
+  file << "  \"jobs\": [";
+  for ( size_t i = 0; i < iJobs.size(); ++i )
+  {
+    const BatchJobTiming & job = iJobs[i];
+    file << ( ( i ) ? ( ",\n" ) : ( "\n" ) );
+    file << "    {\n";
+    file << "      \"scene\": \"" << JsonEscape(job._Scene) << "\",\n";
+    file << "      \"camera\": " << job._Camera << ",\n";
+    file << "      \"output\": \"" << JsonEscape(job._Output) << "\",\n";
+    file << "      \"status\": \"" << ( ( job._Error.empty() ) ? ( "ok" ) : ( "failed" ) ) << "\",\n";
+    if ( !job._Error.empty() )
+      file << "      \"error\": \"" << JsonEscape(job._Error) << "\",\n";
+    file << "      \"resolution\": [" << job._Resolution.x << ", " << job._Resolution.y << "],\n";
+    file << "      \"frames\": " << job._Frames << ",\n";
+    if ( !job._Checkpoint.empty() )
+    {
+      file << "      \"checkpoint\": \"" << JsonEscape(job._Checkpoint) << "\",\n";
+      file << "      \"resumed_frames\": " << job._ResumedFrames << ",\n";
+      file << "      \"checkpoint_ms\": " << job._CheckpointSeconds * 1000. << ",\n";
+    }
+    file << "      \"scene_load_ms\": " << job._SceneLoadSeconds * 1000. << ",\n";
+    file << "      \"render_ms\": " << job._RenderSeconds * 1000. << ",\n";
+    file << "      \"frame_ms\": " << ( ( job._Frames ) ? ( job._RenderSeconds * 1000. / job._Frames ) : ( 0. ) ) << ",\n";
+    file << "      \"write_ms\": " << job._WriteSeconds * 1000. << ",\n";
+    file << "      \"passes_ms\": {";
+    for ( size_t j = 0; j < job._Passes.size(); ++j )
+      file << ( ( j ) ? ( ", " ) : ( " " ) ) << "\"" << JsonEscape(job._Passes[j]._Name) << "\": " << job._Passes[j]._Seconds * 1000.;
+    file << ( ( job._Passes.empty() ) ? ( "}\n" ) : ( " }\n" ) );
+    file << "    }";
+  }
+  file << "\n  ]\n";
+  file << "}\n";
+
+  return file.good();
+}
+
+}
+
+// ----------------------------------------------------------------------------
+// GetBatchBackendName
+// ----------------------------------------------------------------------------
+const char * GetBatchBackendName( RendererBackend iBackend )
+{
+  if ( RendererBackend::SoftwareRasterizer == iBackend )
+    return "software";
+  if ( RendererBackend::DeferredRenderer == iBackend )
+    return "deferred";
+  return "pathtracer";
+}
+
+// ----------------------------------------------------------------------------
+// ParseBatchArgs
+// ----------------------------------------------------------------------------
+bool ParseBatchArgs( int iArgc, const char * const * iArgv, int iFirstArg, BatchRenderOptions & oOptions, std::string & oError )
+{
+  oOptions = BatchRenderOptions();
+  oError.clear();
+
+  for ( int i = iFirstArg; i < iArgc; ++i )
+  {
+    const std::string argument = ( iArgv[i] ) ? ( iArgv[i] ) : ( "" );
+    const bool hasValue = ( i + 1 < iArgc ) && iArgv[i + 1];
+    const std::string value = ( hasValue ) ? ( iArgv[i + 1] ) : ( "" );
+
+    if ( ( 0 != argument.rfind("--", 0) ) )
+    {
+      oOptions._Scenes.push_back(argument);
+      continue;
+    }
+    if ( "--resume" == argument )
+    {
+      oOptions._Resume = true;
+      continue;
+    }
+    if ( !hasValue )
+    {
+      oError = "missing value for " + argument;
+      return false;
+    }
+    ++i;
+
+    if ( "--backend" == argument )
+    {
+      if ( "pathtracer" == value )
+        oOptions._Backend = RendererBackend::PathTracer;
+      else if ( "deferred" == value )
+        oOptions._Backend = RendererBackend::DeferredRenderer;
+      else if ( "software" == value )
+        oOptions._Backend = RendererBackend::SoftwareRasterizer;
+      else
+      {
+        oError = "unknown backend " + value;
+        return false;
+      }
+    }
+    else if ( "--context" == argument )
+    {
+      if ( "auto" == value )
+        oOptions._Context = BatchContextAPI::Auto;
+      else if ( "window" == value )
+        oOptions._Context = BatchContextAPI::Window;
+      else if ( "egl" == value )
+        oOptions._Context = BatchContextAPI::EGL;
+      else if ( "osmesa" == value )
+        oOptions._Context = BatchContextAPI::OSMesa;
+      else
+      {
+        oError = "unknown context " + value;
+        return false;
+      }
+    }
+    else if ( "--resolution" == argument )
+    {
+      const size_t separator = value.find('x');
+      if ( ( std::string::npos == separator )
+        || !ParsePositiveInt(value.substr(0, separator), oOptions._Resolution.x)
+        || !ParsePositiveInt(value.substr(separator + 1), oOptions._Resolution.y) )
+      {
+        oError = "invalid resolution " + value + ", expected WIDTHxHEIGHT";
+        return false;
+      }
+    }
+    else if ( ( "--frames" == argument ) || ( "--spp" == argument ) || ( "--cameras" == argument ) )
+    {
+      int & count = ( "--frames" == argument ) ? ( oOptions._Frames ) : ( ( "--spp" == argument ) ? ( oOptions._SamplesPerPixel ) : ( oOptions._NbCameras ) );
+      if ( !ParsePositiveInt(value, count) )
+      {
+        oError = "invalid value " + value + " for " + argument;
+        return false;
+      }
+    }
+    else if ( "--output" == argument )
+      oOptions._OutputPattern = value;
+    else if ( "--timings" == argument )
+      oOptions._TimingsPath = value;
+    else if ( "--checkpoint" == argument )
+      oOptions._CheckpointPattern = value;
+    else if ( "--checkpoint-every" == argument )
+    {
+      if ( !ParsePositiveInt(value, oOptions._CheckpointInterval) )
+      {
+        oError = "invalid value " + value + " for " + argument;
+        return false;
+      }
+    }
+    else
+    {
+      oError = "unknown option " + argument;
+      return false;
+    }
+  }
+
+  if ( oOptions._Scenes.empty() )
+  {
+    oError = "no scene to render";
+    return false;
+  }
+
+  // Several cameras or scenes written to the same file
+  const size_t nbJobs = oOptions._Scenes.size() * oOptions._NbCameras;
+  if ( ( nbJobs > 1 ) && ( std::string::npos == oOptions._OutputPattern.find("{camera}") ) && ( std::string::npos == oOptions._OutputPattern.find("{scene}") ) )
+  {
+    oError = "the output pattern needs {scene} or {camera} to render several jobs";
+    return false;
+  }
+
+  if ( !oOptions._CheckpointPattern.empty() )
+  {
+    if ( RendererBackend::PathTracer != oOptions._Backend )
+    {
+      oError = "checkpoints need the pathtracer backend";
+      return false;
+    }
+    if ( ( nbJobs > 1 ) && ( std::string::npos == oOptions._CheckpointPattern.find("{camera}") ) && ( std::string::npos == oOptions._CheckpointPattern.find("{scene}") ) )
+    {
+      oError = "the checkpoint pattern needs {scene} or {camera} to render several jobs";
+      return false;
+    }
+  }
+  else if ( oOptions._Resume )
+  {
+    oError = "--resume needs --checkpoint";
+    return false;
+  }
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// FormatBatchOutputPath
+// ----------------------------------------------------------------------------
+std::string FormatBatchOutputPath( const std::string & iPattern, const std::string & iScenePath, int iCamera, RendererBackend iBackend )
+{
+  std::ostringstream camera;
+  camera << std::setw(4) << std::setfill('0') << iCamera;
+
+  const std::pair<std::string, std::string> tokens[] =
+  {
+    { "{scene}",   fs::path(iScenePath).stem().string() },
+    { "{camera}",  camera.str() },
+    { "{backend}", GetBatchBackendName(iBackend) }
+  };
+
+  std::string path = iPattern;
+  for ( const auto & token : tokens )
+  {
+    for ( size_t pos = path.find(token.first); std::string::npos != pos; pos = path.find(token.first, pos + token.second.size()) )
+      path.replace(pos, token.first.size(), token.second);
+  }
+  return path;
+}
+
+// ----------------------------------------------------------------------------
+// RunBatchRender
+// ----------------------------------------------------------------------------
+int RunBatchRender( const BatchRenderOptions & iOptions )
+{
+  const auto batchStart = std::chrono::steady_clock::now();
+
+  BatchContext context;
+  if ( !context.Initialize(iOptions._Context) )
+  {
+    std::cout << "Batch : ERROR. Unable to create an OpenGL context" << std::endl;
+    return 1;
+  }
+  std::cout << "Batch : " << context.GetName() << " context, " << GLString(GL_RENDERER) << " (" << GLString(GL_VERSION) << ")" << std::endl;
+
+  std::vector<BatchJobTiming> jobs;
+  int failures = 0;
+  int nbBatchFrames = 0;
+  for ( const std::string & sceneName : iOptions._Scenes )
+  {
+    BatchJobTiming sceneJob;
+    sceneJob._Scene = sceneName;
+
+    // The scene is loaded and compiled once, every camera reuses the initialized renderer
+    const auto loadStart = std::chrono::steady_clock::now();
+    std::error_code error;
+    const std::string scenePath = ( fs::exists(sceneName, error) ) ? ( sceneName ) : ( PathUtils::GetAssetPath(sceneName) );
+    Scene scene;
+    RenderSettings settings;
+    if ( !Loader::LoadScene(scenePath, scene, settings) )
+    {
+      sceneJob._Error = "scene load failed";
+      jobs.push_back(sceneJob);
+      failures++;
+      continue;
+    }
+
+    if ( iOptions._Resolution.x > 0 )
+      settings._WindowResolution = iOptions._Resolution;
+    if ( iOptions._SamplesPerPixel > 0 )
+      settings._NbSamplesPerPixel = iOptions._SamplesPerPixel;
+
+    std::unique_ptr<Renderer> renderer = CreateRenderer(iOptions._Backend, scene, settings);
+    if ( !renderer || ( 0 != renderer -> Initialize() ) )
+    {
+      sceneJob._Error = "renderer initialization failed";
+      jobs.push_back(sceneJob);
+      failures++;
+      continue;
+    }
+    glFinish();
+    const double loadSeconds = SecondsSince(loadStart);
+
+    if ( iOptions._NbCameras > 1 )
+      scene.GetCamera().SetCameraMode(CameraMode::Orbit);
+
+    for ( int camera = 0; camera < iOptions._NbCameras; ++camera )
+    {
+      if ( camera > 0 )
+      {
+        scene.GetCamera().Yaw(360.f / iOptions._NbCameras);
+        renderer -> Notify(DirtyState::SceneCamera);
+      }
+
+      BatchJobTiming job = sceneJob;
+      job._Camera = camera;
+      job._Output = FormatBatchOutputPath(iOptions._OutputPattern, sceneName, camera, iOptions._Backend);
+      if ( !iOptions._CheckpointPattern.empty() )
+        job._Checkpoint = FormatBatchOutputPath(iOptions._CheckpointPattern, sceneName, camera, iOptions._Backend);
+      job._Resolution = settings._WindowResolution;
+      job._SceneLoadSeconds = ( 0 == camera ) ? ( loadSeconds ) : ( 0. );
+
+      const bool rendered = RenderCamera(*renderer, iOptions, job, nbBatchFrames);
+      if ( !rendered )
+        failures++;
+
+      std::cout << "Batch : [" << ( ( rendered ) ? ( "OK" ) : ( "FAIL" ) ) << "] " << sceneName << " camera " << camera
+                << " -> " << job._Output << " (" << job._RenderSeconds << " s)";
+      if ( !rendered )
+        std::cout << " - " << job._Error;
+      std::cout << std::endl;
+
+      jobs.push_back(job);
+    }
+  }
+
+  if ( !WriteTimings(iOptions, context, jobs, SecondsSince(batchStart)) )
+  {
+    std::cout << "Batch : ERROR. Unable to write the timings in " << iOptions._TimingsPath << std::endl;
+    return 1;
+  }
+
+  return ( failures ) ? ( 1 ) : ( 0 );
+}
+
+// ----------------------------------------------------------------------------
+// PrintBatchUsage
+// ----------------------------------------------------------------------------
+void PrintBatchUsage( const char * iExeName )
+{
+  std::cout << "Usage: " << iExeName << " --batch [options] SCENE..." << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "  --backend pathtracer|deferred|software   (default pathtracer)" << std::endl;
+  std::cout << "  --context auto|window|egl|osmesa         (default auto : headless when no display is available)" << std::endl;
+  std::cout << "  --resolution WIDTHxHEIGHT                (default : scene settings)" << std::endl;
+  std::cout << "  --frames N                               Frames rendered per camera (default 64)" << std::endl;
+  std::cout << "  --spp N                                  PathTracer samples per pixel and frame (default : scene settings)" << std::endl;
+  std::cout << "  --cameras N                              Turntable cameras around the scene camera pivot (default 1)" << std::endl;
+  std::cout << "  --output PATTERN                         PNG path, {scene} {camera} {backend} (default {scene}_{camera}.png)" << std::endl;
+  std::cout << "  --timings FILE                           Per-job timings JSON (default batch_timings.json)" << std::endl;
+  std::cout << "  --checkpoint PATTERN                     PathTracer accumulation checkpoint, same tokens as --output (default : none)" << std::endl;
+  std::cout << "  --checkpoint-every N                     Frames between two checkpoints (default 16)" << std::endl;
+  std::cout << "  --resume                                 Continue every job from its checkpoint, up to --frames" << std::endl;
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef _BatchRender_
+#define _BatchRender_
+
+#include "MathUtil.h"
+#include "RendererFactory.h"
+
+#include <string>
+#include <vector>
+
+namespace RTRT
+{
+
+// Context used by the batch mode.
+// Auto : a hidden window when a display is available, otherwise EGL surfaceless then OSMesa (GLFW null platform).
+enum class BatchContextAPI
+{
+  Auto,
+  Window,
+  EGL,
+  OSMesa
+};
+
+struct BatchRenderOptions
+{
+  std::vector<std::string> _Scenes;
+  RendererBackend          _Backend         = RendererBackend::PathTracer;
+  BatchContextAPI          _Context         = BatchContextAPI::Auto;
+  Vec2i                    _Resolution      = Vec2i(0);  // 0 : scene settings
+  int                      _Frames          = 64;        // Rendered frames per camera
+  int                      _SamplesPerPixel = 0;         // 0 : scene settings
+  int                      _NbCameras       = 1;         // > 1 : turntable around the scene camera pivot
+  std::string              _OutputPattern   = "{scene}_{camera}.png";
+  std::string              _TimingsPath     = "batch_timings.json";
+  std::string              _CheckpointPattern;           // PathTracer accumulation checkpoints, same tokens as the output. Empty : none.
+  int                      _CheckpointInterval = 16;     // Frames between two checkpoints, the last frame is always saved
+  bool                     _Resume          = false;     // Continues every job from its checkpoint when there is one
+  int                      _InterruptAfterFrames = 0;    // Tests only, > 0 : every job fails once the batch rendered that many frames, as a killed batch
+};
+
+// Arguments following "--batch" : [options] scene...
+bool ParseBatchArgs( int iArgc, const char * const * iArgv, int iFirstArg, BatchRenderOptions & oOptions, std::string & oError );
+
+// Replaces {scene} (file name without extension), {camera} (zero padded index) and {backend}. Output and checkpoint patterns.
+std::string FormatBatchOutputPath( const std::string & iPattern, const std::string & iScenePath, int iCamera, RendererBackend iBackend );
+
+const char * GetBatchBackendName( RendererBackend iBackend );
+
+// Renders every camera of every scene, then writes the per-job timings. Returns 0 when every job succeeded.
+int RunBatchRender( const BatchRenderOptions & iOptions );
+
+void PrintBatchUsage( const char * iExeName );
+
+}
+
+#endif /* _BatchRender_ */
@@ -269,6 +269,7 @@ int BoidSceneBinding::Detach( Scene & iScene )
     if ( ( instanceID >= 0 ) && ( instanceID < static_cast<int>(meshInstances.size()) ) )
       meshInstances.erase(meshInstances.begin() + instanceID);
   }
+  iScene.MarkAllMeshInstancesDirty();
 
   _InstanceIDs.clear();
   return 0;
@@ -279,18 +280,25 @@ int BoidSceneBinding::Detach( Scene & iScene )
 // ----------------------------------------------------------------------------
 int BoidSceneBinding::SyncTransforms( Scene & iScene, const BoidSimulation & iSimulation, const BoidSettings & iSettings )
 {
-  const std::vector<BoidState> & boids = iSimulation.GetBoids();
+  return SyncTransforms(iScene, iSimulation.GetBoids(), iSettings);
+}
+
+// ----------------------------------------------------------------------------
+// SyncTransforms
+// ----------------------------------------------------------------------------
+int BoidSceneBinding::SyncTransforms( Scene & iScene, const std::vector<BoidState> & iBoids, const BoidSettings & iSettings )
+{
+  const std::vector<BoidState> & boids = iBoids;
 
-  std::vector<MeshInstance> & meshInstances = iScene.GetMeshInstances();
   for ( int i = 0; i < static_cast<int>(_InstanceIDs.size()); ++i )
   {
     const int instanceID = _InstanceIDs[i];
-    if ( ( instanceID < 0 ) || ( instanceID >= static_cast<int>(meshInstances.size()) ) )
+    if ( ( instanceID < 0 ) || ( instanceID >= iScene.GetNbMeshInstances() ) )
       return 1;
 
-    meshInstances[instanceID]._Visible = i < static_cast<int>(boids.size());
+    iScene.SetMeshInstanceVisible(instanceID, i < static_cast<int>(boids.size()));
     if ( i < static_cast<int>(boids.size()) )
-      meshInstances[instanceID]._Transform = BuildTransform(boids[i], iSettings._Scale);
+      iScene.SetMeshInstanceTransform(instanceID, BuildTransform(boids[i], iSettings._Scale));
   }
 
   return 0;
@@ -325,12 +333,11 @@ int BoidSceneBinding::SyncMaterial( Scene & iScene, const BoidSettings & iSettin
 // ----------------------------------------------------------------------------
 int BoidSceneBinding::SetInstancesVisible( Scene & iScene, bool iVisible )
 {
-  std::vector<MeshInstance> & meshInstances = iScene.GetMeshInstances();
   for ( int instanceID : _InstanceIDs )
   {
-    if ( ( instanceID < 0 ) || ( instanceID >= static_cast<int>(meshInstances.size()) ) )
+    if ( ( instanceID < 0 ) || ( instanceID >= iScene.GetNbMeshInstances() ) )
       return 1;
-    meshInstances[instanceID]._Visible = iVisible;
+    iScene.SetMeshInstanceVisible(instanceID, iVisible);
   }
   return 0;
 }
@@ -402,15 +409,10 @@ int BoidSceneBinding::ResizeInstances( Scene & iScene, const BoidSettings & iSet
   if ( ( _MeshID < 0 ) || ( _MaterialID < 0 ) )
     return 1;
 
-  std::vector<MeshInstance> & meshInstances = iScene.GetMeshInstances();
   const int targetCount = std::max(iSettings._Count, 0);
 
   for ( int i = targetCount; i < static_cast<int>(_InstanceIDs.size()); ++i )
-  {
-    const int instanceID = _InstanceIDs[i];
-    if ( ( instanceID >= 0 ) && ( instanceID < static_cast<int>(meshInstances.size()) ) )
-      meshInstances[instanceID]._Visible = false;
-  }
+    iScene.SetMeshInstanceVisible(_InstanceIDs[i], false);
 
   while ( static_cast<int>(_InstanceIDs.size()) < targetCount )
   {
@@ -29,6 +29,7 @@ struct BoidSettings
   float        _Scale            = 0.12f;
   Vec3         _Color            = Vec3(0.95f, 0.35f, 0.12f);
   bool         _Paused           = false;
+  bool         _CollideWithWorld = false;  // Bounce off collidable objects and prop colliders
 };
 
 struct BoidState
@@ -46,6 +47,7 @@ public:
   int Update( float iDeltaTime, const BoidSettings & iSettings );
 
   const std::vector<BoidState> & GetBoids() const { return _Boids; }
+  std::vector<BoidState> & GetBoids() { return _Boids; }
 
 protected:
   Vec3 RandomPosition( const BoidSettings & iSettings );
@@ -69,6 +71,7 @@ public:
   int SyncMaterial( Scene & iScene, const BoidSettings & iSettings );
   int SetInstancesVisible( Scene & iScene, bool iVisible );
   int SyncTransforms( Scene & iScene, const BoidSimulation & iSimulation, const BoidSettings & iSettings );
+  int SyncTransforms( Scene & iScene, const std::vector<BoidState> & iBoids, const BoidSettings & iSettings );
   bool ContainsInstanceID( int iInstanceID ) const;
   bool Attached() const { return !_InstanceIDs.empty(); }
   void Reset();
@@ -7,6 +7,7 @@
 #include "Material.h"
 #include "MathUtil.h"
 #include "Light.h"
+#include "JobSystem.h"
 
 #include <iostream>
 #include <vector>
@@ -15,6 +16,7 @@
 #include <algorithm>
 #include <numeric>
 #include <cfloat>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <random>
@@ -29,6 +31,9 @@ namespace RTRT
 
 static Vec3 S_WireColor = Vec3(1.f, 0.f, 0.f);
 static float S_WireWidth = 3.0f;
+static const int S_TransparentInsertionSortMax = 256; // Below, an insertion sort of the previous order beats the radix passes
+static const int S_TransparentSortKeyBits = 24;
+static const int S_MaxShadowDirtyBounds = 512; // Beyond, testing every layer costs more than redrawing them
 // ----------------------------------------------------------------------------
 // HELPER TYPES
 // ----------------------------------------------------------------------------
@@ -39,6 +44,119 @@ struct GPUMeshVertex
   Vec2 _UV;
 };
 
+// Matches DrawInstance in DrawInstances.glsl (std430)
+struct GPUDrawInstance
+{
+  Mat4x4 _Model;
+  Mat4x4 _NormalMatrix;
+  Vec4i  _MaterialID; // x: material ID
+  Vec4   _BoundsMin;  // World-space AABB
+  Vec4   _BoundsMax;
+};
+static_assert(sizeof(GPUDrawInstance) == 176, "GPUDrawInstance must match the std430 DrawInstance layout");
+
+// Layout expected by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+  GLuint _Count;
+  GLuint _InstanceCount;
+  GLuint _FirstIndex;
+  GLint  _BaseVertex;
+  GLuint _BaseInstance;
+};
+
+// ----------------------------------------------------------------------------
+// Culling helpers
+// ----------------------------------------------------------------------------
+static AABB<Vec3> TransformBounds( const AABB<Vec3> & iBounds, const Mat4x4 & iTransform )
+{
+  Vec3 corners[8];
+  iBounds.Corners(corners);
+
+  AABB<Vec3> bounds;
+  for ( const Vec3 & corner : corners )
+    bounds.Insert(MathUtil::TransformPoint(corner, iTransform));
+  return bounds;
+}
+
+// Clip planes, pointing inside : left, right, bottom, top, near, far
+static void ExtractFrustumPlanes( const Mat4x4 & iViewProj, Vec4 oPlanes[6] )
+{
+  const Vec4 row0(iViewProj[0][0], iViewProj[1][0], iViewProj[2][0], iViewProj[3][0]);
+  const Vec4 row1(iViewProj[0][1], iViewProj[1][1], iViewProj[2][1], iViewProj[3][1]);
+  const Vec4 row2(iViewProj[0][2], iViewProj[1][2], iViewProj[2][2], iViewProj[3][2]);
+  const Vec4 row3(iViewProj[0][3], iViewProj[1][3], iViewProj[2][3], iViewProj[3][3]);
+  oPlanes[0] = row3 + row0;
+  oPlanes[1] = row3 - row0;
+  oPlanes[2] = row3 + row1;
+  oPlanes[3] = row3 - row1;
+  oPlanes[4] = row3 + row2;
+  oPlanes[5] = row3 - row2;
+}
+
+static bool IsBoxOutsidePlanes( const Vec4 iPlanes[6], const AABB<Vec3> & iBounds )
+{
+  for ( int i = 0; i < 6; ++i )
+  {
+    const Vec3 normal(iPlanes[i]);
+    const Vec3 farthest(( normal.x >= 0.f ) ? iBounds._High.x : iBounds._Low.x,
+                        ( normal.y >= 0.f ) ? iBounds._High.y : iBounds._Low.y,
+                        ( normal.z >= 0.f ) ? iBounds._High.z : iBounds._Low.z);
+    if ( glm::dot(normal, farthest) + iPlanes[i].w < 0.f )
+      return true;
+  }
+  return false;
+}
+
+// Empty bounds : unknown extent
+static bool HasBounds( const AABB<Vec3> & iBounds )
+{
+  return ( iBounds._Low.x <= iBounds._High.x ) && ( iBounds._Low.y <= iBounds._High.y ) && ( iBounds._Low.z <= iBounds._High.z );
+}
+
+// Empty when the instance is hidden : it casts no shadow
+static AABB<Vec3> InstanceShadowBounds( const MeshInstance & iInstance, const std::vector<Mesh*> & iMeshes )
+{
+  AABB<Vec3> bounds;
+  if ( !iInstance._Visible )
+    return bounds;
+
+  // Unknown bounds touch every shadow layer
+  bounds._Low = Vec3(-MAX_FLOAT);
+  bounds._High = Vec3(MAX_FLOAT);
+  if ( ( iInstance._MeshID >= 0 ) && ( iInstance._MeshID < static_cast<int>(iMeshes.size()) ) && iMeshes[iInstance._MeshID] && iMeshes[iInstance._MeshID] -> GetNbFaces() )
+    bounds = TransformBounds(iMeshes[iInstance._MeshID] -> GetBoundingBox(), iInstance._Transform);
+  return bounds;
+}
+
+// Distance where the deferred PBR falloff brings the light radiance below iThreshold
+static float LightInfluenceRadius( const Light & iLight, float iDirectIntensity, float iThreshold, Vec3 & oCenter )
+{
+  const Vec3 emission = iLight._Emission * iLight._Intensity * iDirectIntensity;
+  const float maxEmission = std::max(emission.x, std::max(emission.y, emission.z));
+  const float threshold = std::max(iThreshold, 1e-6f);
+
+  if ( LightType::RectLight == (LightType) iLight._Type )
+  {
+    // Attenuation : area / d^2, d measured from the closest point of the quad
+    oCenter = iLight._Pos + ( iLight._DirU + iLight._DirV ) * .5f;
+    const float halfDiagonal = .5f * std::max(glm::length(iLight._DirU + iLight._DirV), glm::length(iLight._DirU - iLight._DirV));
+    return halfDiagonal + std::sqrt(std::max(iLight._Area, 0.f) * maxEmission / threshold);
+  }
+
+  // Subtended solid angle : about PI * r^2 / d^2 away from the sphere
+  oCenter = iLight._Pos;
+  const float radius = std::max(iLight._Radius, 0.001f);
+  return std::max(radius, radius * std::sqrt(static_cast<float>(M_PI) * maxEmission / threshold));
+}
+
+// Squared distance from iPoint to the box
+static float DistanceToBox2( const Vec3 & iPoint, const Vec3 & iLow, const Vec3 & iHigh )
+{
+  const Vec3 delta = glm::max(glm::max(iLow - iPoint, iPoint - iHigh), Vec3(0.f));
+  return glm::dot(delta, delta);
+}
+
 struct IndexTriplet
 {
   int v, n, u;
@@ -86,12 +204,16 @@ DeferredRenderer::~DeferredRenderer()
 
   GLUtil::DeleteFBO(_GBufferFBO);
   GLUtil::DeleteFBO(_LightingFBO);
+  GLUtil::DeleteFBO(_OITFBO);
   GLUtil::DeleteFBO(_BRDFFBO);
   GLUtil::DeleteFBO(_ShadowFBO);
   GLUtil::DeleteFBO(_SSAOFBO);
   GLUtil::DeleteFBO(_SSAOBlurFBO);
   GLUtil::DeleteFBO(_SSRFBO);
   GLUtil::DeleteFBO(_SSRSourceFBO);
+  GLUtil::DeleteFBO(_SSAOUpsampleFBO);
+  GLUtil::DeleteFBO(_SSRUpsampleFBO);
+  GLUtil::DeleteFBO(_SSRHiZFBO);
 
   GLUtil::DeleteTEX(_GAlbedoTEX);
   GLUtil::DeleteTEX(_GNormalTEX);
@@ -99,16 +221,24 @@ DeferredRenderer::~DeferredRenderer()
   GLUtil::DeleteTEX(_GMaterialTEX);
   GLUtil::DeleteTEX(_GEmissionTEX);
   GLUtil::DeleteTEX(_GDepthTEX);
+  GLUtil::DeleteTEX(_OITAccumTEX);
+  GLUtil::DeleteTEX(_OITRevealageTEX);
   GLUtil::DeleteTEX(_SSAOTEX);
   GLUtil::DeleteTEX(_SSAOBlurTEX);
   GLUtil::DeleteTEX(_SSAONoiseTEX);
   GLUtil::DeleteTEX(_SSRTEX);
   GLUtil::DeleteTEX(_SSRSourceTEX);
+  GLUtil::DeleteTEX(_SSAOUpsampleTEX);
+  GLUtil::DeleteTEX(_SSRUpsampleTEX);
+  GLUtil::DeleteTEX(_SSRHiZTEX);
   GLUtil::DeleteTEX(_ShadowCubeMapTEX);
   GLUtil::DeleteTEX(_Shadow2DMapTEX);
   GLUtil::DeleteTEX(_BRDFLUTTEX);
+  GLUtil::DeleteTEX(_HiZTEX);
 
   GLUtil::DeleteTBO(_TexIndTBO);
+  GLUtil::DeleteTBO(_LightClustersTBO);
+  GLUtil::DeleteTBO(_LightIndicesTBO);
   GLUtil::DeleteTEX(_TexArrayTEX);
   GLUtil::DeleteTEX(_MaterialsTEX);
   GLUtil::DeleteTEX(_EnvMapTEX);
@@ -121,6 +251,10 @@ DeferredRenderer::~DeferredRenderer()
 // ----------------------------------------------------------------------------
 int DeferredRenderer::Initialize()
 {
+  // Large transparent meshes split their triangle sort over the job system
+  if ( !JobSystem::Get().IsInitialized() && ( _Settings._NbThreads > 1 ) )
+    JobSystem::Get().Initialize(std::min(_Settings._NbThreads, std::thread::hardware_concurrency()));
+
   if ( 0 != ReloadScene() )
   {
     std::cout << "DeferredRenderer : Failed to load scene !" << std::endl;
@@ -194,17 +328,30 @@ int DeferredRenderer::Update()
   if ( _DirtyStates & (unsigned long)DirtyState::SceneEnvMap )
     this -> ReloadEnvMap();
 
-  if ( _DirtyStates & ( (unsigned long)DirtyState::SceneMaterials | (unsigned long)DirtyState::SceneInstances ) )
+  // Draw lists and bounds only depend on mesh instances the scene flagged since the last sync
+  bool instancesChanged = false;
+  if ( _DirtyStates & (unsigned long)DirtyState::SceneInstances )
+  {
+    instancesChanged = ( _Scene.GetMeshInstanceGeneration() != _SyncedMeshInstanceGeneration );
+    if ( instancesChanged )
+      UpdateShadowCasterBounds();
+    _SyncedMeshInstanceGeneration = _Scene.GetMeshInstanceGeneration();
+  }
+
+  if ( _DirtyStates & (unsigned long)DirtyState::SceneMaterials )
+    InvalidateShadowCache();
+
+  if ( ( _DirtyStates & (unsigned long)DirtyState::SceneMaterials ) || instancesChanged )
     BuildDeferredDrawLists();
 
-  if ( _DirtyStates & (unsigned long)DirtyState::SceneInstances )
+  if ( instancesChanged )
     ComputeSceneBounds(false);
 
   UpdateShadowState();
   int shadowMapSize = std::clamp(_Settings._ShadowMapResolution, 256, 4096);
   if ( ( _ShadowMapSize != shadowMapSize )
     || ( _ShadowLocalCapacity != _LocalShadowCasterCount )
-    || ( _ShadowDirectionalCapacity != _DirectionalShadowCasterCount ) )
+    || ( _ShadowDirectionalCapacity != _DirectionalShadowLayerCount ) )
   {
     if ( 0 != InitializeShadowMap() )
       return 1;
@@ -347,10 +494,13 @@ void DeferredRenderer::SetTimingEnabled( int iTimerID, bool iEnabled )
 int DeferredRenderer::GetRenderPassTimings( std::vector<RenderPassTiming> & oTimings ) const
 {
   oTimings.clear();
-  oTimings.push_back({ "Shadow map", _PassTimes[TimingShadowMap], true, _PassEnabled[TimingShadowMap] });
-  oTimings.push_back({ "G-buffer", _PassTimes[TimingGBuffer], true, _PassEnabled[TimingGBuffer] });
+  oTimings.push_back({ "Shadow map", _PassTimes[TimingShadowMap], true, _PassEnabled[TimingShadowMap], false, _CullTestedStats[CullPassShadow], _CullCulledStats[CullPassShadow] });
+  oTimings.push_back({ "G-buffer", _PassTimes[TimingGBuffer], true, _PassEnabled[TimingGBuffer], false, _CullTestedStats[CullPassCamera], _CullCulledStats[CullPassCamera] });
   oTimings.push_back({ "SSAO", _PassTimes[TimingSSAO], true, _PassEnabled[TimingSSAO] });
+  oTimings.push_back({ "SSAO upsample", _PassTimes[TimingSSAOUpsample], true, _PassEnabled[TimingSSAOUpsample] });
+  oTimings.push_back({ "SSR HiZ", _PassTimes[TimingSSRHiZ], true, _PassEnabled[TimingSSRHiZ] });
   oTimings.push_back({ "SSR", _PassTimes[TimingSSR], true, _PassEnabled[TimingSSR] });
+  oTimings.push_back({ "SSR upsample", _PassTimes[TimingSSRUpsample], true, _PassEnabled[TimingSSRUpsample] });
   oTimings.push_back({ "Lighting", _PassTimes[TimingLighting], true, _PassEnabled[TimingLighting] });
   oTimings.push_back({ "Transparency", _PassTimes[TimingTransparency], true, _PassEnabled[TimingTransparency] });
   oTimings.push_back({ "Wireframe", _PassTimes[TimingWireframe], true, _PassEnabled[TimingWireframe] });
@@ -366,31 +516,40 @@ int DeferredRenderer::UnloadScene()
 {
   _FrameNum = 0;
 
-  const size_t nb = _MeshVAOs.size();
-  for ( size_t i = 0; i < nb; ++i )
+  GLUtil::DeleteMeshBuffers(_MeshVAO, _MeshVBO, _MeshEBO);
+  GLUtil::DeleteBuffer(_DrawIDVBO);
+  GLUtil::DeleteBuffer(_IndirectCommandBuffer);
+  GLUtil::DeleteBuffer(_InstanceDataSSBO);
+  for ( int i = 0; i < CullListCount; ++i )
   {
-    GLuint vao = _MeshVAOs[i];
-    GLuint vbo = _MeshVBOs[i];
-    GLuint ebo = _MeshEBOs[i];
-    GLUtil::DeleteMeshBuffers(vao, vbo, ebo);
+    GLUtil::DeleteBuffer(_CulledCommandBuffers[i]);
+    GLUtil::DeleteBuffer(_CulledCountBuffers[i]);
+    _CPUVisibleDraws[i].clear();
   }
-
-  _MeshVAOs.clear();
-  _MeshVBOs.clear();
-  _MeshEBOs.clear();
+  ReleaseCullStats();
+  _DrawIDCapacity = 0;
+  _NbIndirectDraws = 0;
+  _CulledCommandCapacity = 0;
+  _CullListActive.fill(false);
+  _HiZValid = false;
+
+  _MeshFirstIndex.clear();
+  _MeshBaseVertex.clear();
   _MeshIndexCount.clear();
   _TransparentMeshBaseIndices.clear();
   _TransparentMeshLocalTriCenters.clear();
   _TransparentMeshSortedIndices.clear();
   _TransparentMeshSortedTriOrder.clear();
   _TransparentMeshTriDepths.clear();
+  _TransparentMeshSortAxis.clear();
   _OpaqueMeshInstanceIDs.clear();
+  _OpaqueWorldBounds.clear();
   _TransparentMeshInstanceIDs.clear();
 
   _HasShadowLight = false;
   _ShadowCasters.clear();
   _LocalShadowCasterCount = 0;
-  _DirectionalShadowCasterCount = 0;
+  _DirectionalShadowLayerCount = 0;
   _ShadowSceneBoundsInitialized = false;
 
   return 0;
@@ -491,10 +650,13 @@ bool DeferredRenderer::IsTransparentMaterial( int iMaterialID )
 void DeferredRenderer::BuildDeferredDrawLists()
 {
   _OpaqueMeshInstanceIDs.clear();
+  _OpaqueWorldBounds.clear();
   _TransparentMeshInstanceIDs.clear();
 
   const std::vector<MeshInstance> & instances = _Scene.GetMeshInstances();
+  const std::vector<Mesh*> & meshes = _Scene.GetMeshes();
   _OpaqueMeshInstanceIDs.reserve(instances.size());
+  _OpaqueWorldBounds.reserve(instances.size());
   _TransparentMeshInstanceIDs.reserve(instances.size());
 
   for ( int i = 0; i < static_cast<int>(instances.size()); ++i )
@@ -506,8 +668,506 @@ void DeferredRenderer::BuildDeferredDrawLists()
     if ( IsTransparentMaterial( inst._MaterialID ) )
       _TransparentMeshInstanceIDs.push_back(i);
     else
+    {
       _OpaqueMeshInstanceIDs.push_back(i);
+
+      // Unknown bounds stay empty : the instance is never culled
+      AABB<Vec3> worldBounds;
+      if ( ( inst._MeshID >= 0 ) && ( inst._MeshID < static_cast<int>(meshes.size()) ) && meshes[inst._MeshID] && meshes[inst._MeshID] -> GetNbFaces() )
+        worldBounds = TransformBounds(meshes[inst._MeshID] -> GetBoundingBox(), inst._Transform);
+      _OpaqueWorldBounds.push_back(worldBounds);
+    }
+  }
+
+  BuildIndirectDraws();
+}
+
+// ----------------------------------------------------------------------------
+// BuildIndirectDraws
+// One indirect command per opaque instance. baseInstance is the draw index :
+// it selects both the draw ID attribute and the instance entry in the SSBO.
+// ----------------------------------------------------------------------------
+void DeferredRenderer::BuildIndirectDraws()
+{
+  _NbIndirectDraws = 0;
+  if ( !GLEW_VERSION_4_3 || !_MeshVAO || !_DrawIDVBO )
+    return;
+
+  const std::vector<MeshInstance> & instances = _Scene.GetMeshInstances();
+
+  std::vector<DrawElementsIndirectCommand> commands;
+  std::vector<GPUDrawInstance> drawInstances;
+  commands.reserve(_OpaqueMeshInstanceIDs.size());
+  drawInstances.reserve(_OpaqueMeshInstanceIDs.size());
+
+  for ( int k = 0; k < static_cast<int>(_OpaqueMeshInstanceIDs.size()); ++k )
+  {
+    const int instID = _OpaqueMeshInstanceIDs[k];
+    if ( ( instID < 0 ) || ( static_cast<size_t>(instID) >= instances.size() ) )
+      continue;
+
+    const MeshInstance & inst = instances[instID];
+    const int meshID = inst._MeshID;
+    if ( ( meshID < 0 ) || ( static_cast<size_t>(meshID) >= _MeshIndexCount.size() ) || ( _MeshIndexCount[meshID] <= 0 ) )
+      continue;
+
+    DrawElementsIndirectCommand command;
+    command._Count         = static_cast<GLuint>(_MeshIndexCount[meshID]);
+    command._InstanceCount = 1;
+    command._FirstIndex    = static_cast<GLuint>(_MeshFirstIndex[meshID]);
+    command._BaseVertex    = _MeshBaseVertex[meshID];
+    command._BaseInstance  = static_cast<GLuint>(commands.size());
+    commands.push_back(command);
+
+    GPUDrawInstance drawInstance;
+    drawInstance._Model        = inst._Transform;
+    drawInstance._NormalMatrix = glm::transpose(glm::inverse(inst._Transform));
+    drawInstance._MaterialID   = Vec4i(inst._MaterialID, 0, 0, 0);
+    // w = 0 : unknown bounds, the culling pass keeps the draw without projecting them
+    const bool hasBounds = HasBounds(_OpaqueWorldBounds[k]);
+    drawInstance._BoundsMin    = ( hasBounds ) ? ( Vec4(_OpaqueWorldBounds[k]._Low, 1.f) ) : ( Vec4(0.f) );
+    drawInstance._BoundsMax    = ( hasBounds ) ? ( Vec4(_OpaqueWorldBounds[k]._High, 1.f) ) : ( Vec4(0.f) );
+    drawInstances.push_back(drawInstance);
+  }
+
+  _NbIndirectDraws = static_cast<int>(commands.size());
+  if ( !_NbIndirectDraws )
+    return;
+
+  if ( _NbIndirectDraws > _DrawIDCapacity )
+  {
+    _DrawIDCapacity = std::max(_NbIndirectDraws, _DrawIDCapacity * 2);
+    std::vector<GLuint> drawIDs(_DrawIDCapacity);
+    std::iota(drawIDs.begin(), drawIDs.end(), 0u);
+    GLUtil::UploadArrayBuffer(_DrawIDVBO, static_cast<GLsizeiptr>(drawIDs.size() * sizeof(GLuint)), drawIDs.data());
+  }
+
+  // Same-size updates reuse the buffer storage
+  GLBufferDesc commandsDesc;
+  commandsDesc._Target = GL_DRAW_INDIRECT_BUFFER;
+  commandsDesc._Size   = static_cast<GLsizeiptr>(commands.size() * sizeof(DrawElementsIndirectCommand));
+  commandsDesc._Data   = commands.data();
+  commandsDesc._Usage  = GL_DYNAMIC_DRAW;
+  if ( !GLUtil::UpdateBuffer(_IndirectCommandBuffer, commandsDesc) )
+    GLUtil::CreateBuffer(commandsDesc, _IndirectCommandBuffer);
+
+  GLBufferDesc instancesDesc;
+  instancesDesc._Target = GL_SHADER_STORAGE_BUFFER;
+  instancesDesc._Size   = static_cast<GLsizeiptr>(drawInstances.size() * sizeof(GPUDrawInstance));
+  instancesDesc._Data   = drawInstances.data();
+  instancesDesc._Usage  = GL_DYNAMIC_DRAW;
+  if ( !GLUtil::UpdateBuffer(_InstanceDataSSBO, instancesDesc) )
+    GLUtil::CreateBuffer(instancesDesc, _InstanceDataSSBO);
+}
+
+// ----------------------------------------------------------------------------
+// UseIndirectDraws
+// ----------------------------------------------------------------------------
+bool DeferredRenderer::UseIndirectDraws() const
+{
+  return _EnableMultiDrawIndirect && _MultiDrawIndirectSupported && _IndirectCommandBuffer && _InstanceDataSSBO;
+}
+
+// ----------------------------------------------------------------------------
+// DrawOpaqueInstances
+// iShader must be the indirect variant when iIndirect is set.
+// iCullList selects the output of the last CullOpaqueInstances call for that list.
+// ----------------------------------------------------------------------------
+void DeferredRenderer::DrawOpaqueInstances( ShaderProgram & iShader, bool iIndirect, bool iSetMaterial, int iCullList )
+{
+  if ( !_MeshVAO )
+    return;
+
+  const bool culled = ( iCullList >= 0 ) && ( iCullList < CullListCount ) && _CullListActive[iCullList];
+
+  glBindVertexArray(_MeshVAO);
+
+  if ( iIndirect )
+  {
+    if ( _NbIndirectDraws > 0 )
+    {
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _InstanceDataSSBO);
+      if ( culled )
+      {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _CulledCommandBuffers[iCullList]);
+        if ( GLEW_ARB_indirect_parameters )
+        {
+          glBindBuffer(GL_PARAMETER_BUFFER_ARB, _CulledCountBuffers[iCullList]);
+          glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, _NbIndirectDraws, 0);
+          glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+        }
+        else // The command list was cleared before culling : the tail past the visible count draws nothing
+          glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, _NbIndirectDraws, 0);
+      }
+      else
+      {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _IndirectCommandBuffer);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, _NbIndirectDraws, 0);
+      }
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+      _NbDrawCalls++;
+    }
+  }
+  else
+  {
+    const std::vector<MeshInstance> & instances = _Scene.GetMeshInstances();
+    const std::vector<unsigned char> * visibleDraws = culled ? &_CPUVisibleDraws[iCullList] : nullptr;
+    for ( int k = 0; k < static_cast<int>(_OpaqueMeshInstanceIDs.size()); ++k )
+    {
+      const int instID = _OpaqueMeshInstanceIDs[k];
+      if ( ( instID < 0 ) || ( static_cast<size_t>(instID) >= instances.size() ) )
+        continue;
+      if ( visibleDraws && ( k < static_cast<int>(visibleDraws -> size()) ) && !( *visibleDraws )[k] )
+        continue;
+
+      const MeshInstance & inst = instances[instID];
+      int meshID = inst._MeshID;
+      if ( ( meshID < 0 ) || ( static_cast<size_t>(meshID) >= _MeshIndexCount.size() ) )
+        continue;
+
+      int idxCount = _MeshIndexCount[meshID];
+      if ( idxCount <= 0 )
+        continue;
+
+      // Per-instance uniforms expected by the vertex shaders
+      iShader.SetUniform("u_Model", inst._Transform);
+      if ( iSetMaterial )
+        iShader.SetUniform("u_MaterialID", inst._MaterialID);
+
+      void * firstIndex = reinterpret_cast<void *>(static_cast<size_t>(_MeshFirstIndex[meshID]) * sizeof(uint32_t));
+      glDrawElementsBaseVertex(GL_TRIANGLES, idxCount, GL_UNSIGNED_INT, firstIndex, _MeshBaseVertex[meshID]);
+      _NbDrawCalls++;
+    }
+  }
+
+  glBindVertexArray(0);
+}
+
+// ----------------------------------------------------------------------------
+// BeginCulling
+// Publishes the culling counts of a completed frame and resets the current ones.
+// ----------------------------------------------------------------------------
+void DeferredRenderer::BeginCulling( bool iIndirect )
+{
+  if ( _CullStatsPending )
+  {
+    // The GPU counts of the last frame are published once its fence signaled
+    _CullStatsFences[_CullStatsSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _CullStatsTested[_CullStatsSlot] = _NbCullTested;
+    _CullStatsSlot = ( _CullStatsSlot + 1 ) % S_NbCullStatsSlots;
+  }
+  else
+  {
+    for ( int i = 0; i < CullPassCount; ++i )
+    {
+      _CullTestedStats[i] = _NbCullTested[i];
+      _CullCulledStats[i] = std::max(0, _NbCullTested[i] - _NbCullVisible[i]);
+    }
+  }
+  ReadCullStats();
+
+  _NbCullTested.fill(0);
+  _NbCullVisible.fill(0);
+  _CullListActive.fill(false);
+  _CullStatsPending = false;
+
+  if ( iIndirect && _GpuCullingSupported )
+  {
+    GLuint & statsBuffer = _CullStatsBuffers[_CullStatsSlot];
+    if ( !statsBuffer )
+    {
+      GLBufferDesc statsDesc;
+      statsDesc._Target = GL_SHADER_STORAGE_BUFFER;
+      statsDesc._Size   = static_cast<GLsizeiptr>(CullPassCount * sizeof(GLuint));
+      statsDesc._Usage  = GL_DYNAMIC_COPY;
+      GLUtil::CreateBuffer(statsDesc, statsBuffer);
+    }
+
+    // The GPU is still behind on this slot : its counts are dropped rather than waited for
+    if ( _CullStatsFences[_CullStatsSlot] )
+    {
+      glDeleteSync(_CullStatsFences[_CullStatsSlot]);
+      _CullStatsFences[_CullStatsSlot] = nullptr;
+    }
+
+    const GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, statsBuffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ReadCullStats
+// Oldest slot first, stops at the first frame the GPU has not finished.
+// ----------------------------------------------------------------------------
+void DeferredRenderer::ReadCullStats()
+{
+  for ( int i = 0; i < S_NbCullStatsSlots; ++i )
+  {
+    const int slot = ( _CullStatsSlot + i ) % S_NbCullStatsSlots;
+    GLsync & fence = _CullStatsFences[slot];
+    if ( !fence )
+      continue;
+
+    const GLenum status = glClientWaitSync(fence, 0, 0);
+    if ( ( GL_ALREADY_SIGNALED != status ) && ( GL_CONDITION_SATISFIED != status ) )
+      break;
+
+    GLuint visibleCounts[CullPassCount] = {};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _CullStatsBuffers[slot]);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(visibleCounts), visibleCounts);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    for ( int pass = 0; pass < CullPassCount; ++pass )
+    {
+      _CullTestedStats[pass] = _CullStatsTested[slot][pass];
+      _CullCulledStats[pass] = std::max(0, _CullStatsTested[slot][pass] - static_cast<int>(visibleCounts[pass]));
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ReleaseCullStats
+// ----------------------------------------------------------------------------
+void DeferredRenderer::ReleaseCullStats()
+{
+  for ( int i = 0; i < S_NbCullStatsSlots; ++i )
+  {
+    if ( _CullStatsFences[i] )
+      glDeleteSync(_CullStatsFences[i]);
+    _CullStatsFences[i] = nullptr;
+    GLUtil::DeleteBuffer(_CullStatsBuffers[i]);
+  }
+  _CullStatsSlot = 0;
+  _CullStatsPending = false;
+}
+
+// ----------------------------------------------------------------------------
+// CullOpaqueInstances
+// Tests the opaque instance bounds against iViewProj and, with iOcclusion, the HiZ pyramid.
+// The multi-draw indirect path compacts the visible commands on the GPU, the per-instance path
+// flags the visible draws on the CPU (frustum only).
+// ----------------------------------------------------------------------------
+void DeferredRenderer::CullOpaqueInstances( int iCullList, int iCullPass, const Mat4x4 & iViewProj, bool iIndirect, bool iOcclusion )
+{
+  _CullListActive[iCullList] = false;
+
+  iOcclusion = iOcclusion && _EnableOcclusionCulling && _HiZValid && _HiZTEX._Handle;
+  if ( !_EnableFrustumCulling && !iOcclusion )
+    return;
+
+  Vec4 planes[6];
+  ExtractFrustumPlanes(iViewProj, planes);
+
+  if ( iIndirect )
+  {
+    if ( !_GpuCullingSupported || !_CullStatsBuffers[_CullStatsSlot] || ( _NbIndirectDraws <= 0 ) )
+      return;
+
+    if ( _CulledCommandCapacity < _NbIndirectDraws )
+    {
+      _CulledCommandCapacity = std::max(_NbIndirectDraws, _CulledCommandCapacity * 2);
+
+      GLBufferDesc commandsDesc;
+      commandsDesc._Target = GL_SHADER_STORAGE_BUFFER;
+      commandsDesc._Size   = static_cast<GLsizeiptr>(_CulledCommandCapacity * sizeof(DrawElementsIndirectCommand));
+      commandsDesc._Usage  = GL_DYNAMIC_COPY;
+
+      GLBufferDesc countDesc;
+      countDesc._Target = GL_SHADER_STORAGE_BUFFER;
+      countDesc._Size   = static_cast<GLsizeiptr>(sizeof(GLuint));
+      countDesc._Usage  = GL_DYNAMIC_COPY;
+
+      for ( int i = 0; i < CullListCount; ++i )
+      {
+        GLUtil::CreateBuffer(commandsDesc, _CulledCommandBuffers[i]);
+        GLUtil::CreateBuffer(countDesc, _CulledCountBuffers[i]);
+      }
+    }
+
+    const GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _CulledCountBuffers[iCullList]);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    if ( !GLEW_ARB_indirect_parameters )
+    {
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, _CulledCommandBuffers[iCullList]);
+      glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Frustum culling disabled : planes that reject nothing
+    if ( !_EnableFrustumCulling )
+    {
+      for ( Vec4 & plane : planes )
+        plane = Vec4(0.f, 0.f, 0.f, 1.f);
+    }
+
+    _CullingShader -> Use();
+    _CullingShader -> SetUniform("u_NbDraws", _NbIndirectDraws);
+    _CullingShader -> SetUniform("u_StatsSlot", iCullPass);
+    for ( int i = 0; i < 6; ++i )
+      _CullingShader -> SetUniform("u_FrustumPlanes[" + std::to_string(i) + "]", planes[i]);
+    _CullingShader -> SetUniform("u_EnableOcclusion", iOcclusion ? 1 : 0);
+    if ( iOcclusion )
+    {
+      GLUtil::ActivateTexture(_HiZTEX);
+      _CullingShader -> SetUniform("u_HiZViewProj", _HiZViewProj);
+      _CullingShader -> SetUniform("u_HiZ", (int)DeferredTexSlot::_HiZ);
+      _CullingShader -> SetUniform("u_HiZSize", Vec2i(RenderWidth(), RenderHeight()));
+      _CullingShader -> SetUniform("u_HiZMaxLevel", _HiZNbLevels - 1);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _InstanceDataSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _IndirectCommandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _CulledCommandBuffers[iCullList]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _CulledCountBuffers[iCullList]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _CullStatsBuffers[_CullStatsSlot]);
+
+    const int workGroupSize = 64;
+    glDispatchCompute(static_cast<GLuint>(( _NbIndirectDraws + workGroupSize - 1 ) / workGroupSize), 1, 1);
+
+    // The draws read the compacted commands and their count
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    for ( GLuint binding = 0; binding <= 4; ++binding )
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+    _CullingShader -> StopUsing();
+
+    _NbCullTested[iCullPass] += _NbIndirectDraws;
+    _CullStatsPending = true;
+  }
+  else
+  {
+    const int nbDraws = static_cast<int>(_OpaqueMeshInstanceIDs.size());
+    std::vector<unsigned char> & visibleDraws = _CPUVisibleDraws[iCullList];
+    visibleDraws.assign(nbDraws, 1);
+
+    int nbVisible = 0;
+    for ( int k = 0; k < nbDraws; ++k )
+    {
+      if ( _EnableFrustumCulling && ( k < static_cast<int>(_OpaqueWorldBounds.size()) ) && HasBounds(_OpaqueWorldBounds[k]) && IsBoxOutsidePlanes(planes, _OpaqueWorldBounds[k]) )
+        visibleDraws[k] = 0;
+      else
+        nbVisible++;
+    }
+
+    _NbCullTested[iCullPass] += nbDraws;
+    _NbCullVisible[iCullPass] += nbVisible;
+  }
+
+  _CullListActive[iCullList] = true;
+}
+
+// ----------------------------------------------------------------------------
+// BuildHiZ
+// Max-depth pyramid of the G-buffer depth, used to cull the next frame draws.
+// ----------------------------------------------------------------------------
+void DeferredRenderer::BuildHiZ( const Mat4x4 & iViewProj )
+{
+  _HiZValid = false;
+  if ( !_HiZShader || !_HiZTEX._Handle || ( _HiZNbLevels <= 0 ) )
+    return;
+
+  const int workGroupSize = 8;
+  int width = RenderWidth();
+  int height = RenderHeight();
+
+  _HiZShader -> Use();
+
+  // Level 0 : copy of the depth buffer
+  GLUtil::ActivateTexture(_GDepthTEX);
+  _HiZShader -> SetUniform("u_CopyDepth", 1);
+  _HiZShader -> SetUniform("u_Depth", (int)DeferredTexSlot::_GDepth);
+  _HiZShader -> SetUniform("u_SrcSize", Vec2i(width, height));
+  glBindImageTexture(0, _HiZTEX._Handle, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+  glBindImageTexture(1, _HiZTEX._Handle, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+  glDispatchCompute(( width + workGroupSize - 1 ) / workGroupSize, ( height + workGroupSize - 1 ) / workGroupSize, 1);
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+  _HiZShader -> SetUniform("u_CopyDepth", 0);
+  for ( int level = 1; level < _HiZNbLevels; ++level )
+  {
+    _HiZShader -> SetUniform("u_SrcSize", Vec2i(width, height));
+    width = std::max(1, width / 2);
+    height = std::max(1, height / 2);
+
+    glBindImageTexture(0, _HiZTEX._Handle, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+    glBindImageTexture(1, _HiZTEX._Handle, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute(( width + workGroupSize - 1 ) / workGroupSize, ( height + workGroupSize - 1 ) / workGroupSize, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+  }
+
+  glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+  glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+  _HiZShader -> StopUsing();
+
+  _HiZViewProj = iViewProj;
+  _HiZValid = true;
+}
+
+// ----------------------------------------------------------------------------
+// BuildSSRHiZ
+// Min-depth pyramid of the G-buffer depth, traversed by the HiZ SSR tracing.
+// Fragment passes : each level reads the previous one through a base/max level restriction.
+// ----------------------------------------------------------------------------
+void DeferredRenderer::BuildSSRHiZ()
+{
+  if ( !_SSRHiZShader || !_SSRHiZFBO._Handle || ( _SSRHiZNbLevels <= 0 ) )
+    return;
+
+  glBindFramebuffer(GL_FRAMEBUFFER, _SSRHiZFBO._Handle);
+  glDisable(GL_DEPTH_TEST);
+  glDepthMask(GL_FALSE);
+  glDisable(GL_CULL_FACE);
+  glDisable(GL_BLEND);
+
+  _SSRHiZShader -> Use();
+  _SSRHiZShader -> SetUniform("u_Depth", (int)DeferredTexSlot::_GDepth);
+  _SSRHiZShader -> SetUniform("u_Src", (int)DeferredTexSlot::_SSRHiZ);
+
+  int width = RenderWidth();
+  int height = RenderHeight();
+  for ( int level = 0; level < _SSRHiZNbLevels; ++level )
+  {
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _SSRHiZTEX._Handle, level);
+
+    if ( 0 == level )
+    {
+      // Level 0 : copy of the depth buffer, the pyramid is not bound while it is written
+      glActiveTexture(GL_TEXTURE0 + DeferredTexSlot::_SSRHiZ);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      GLUtil::ActivateTexture(_GDepthTEX);
+      _SSRHiZShader -> SetUniform("u_CopyDepth", 1);
+    }
+    else
+    {
+      _SSRHiZShader -> SetUniform("u_CopyDepth", 0);
+      _SSRHiZShader -> SetUniform("u_SrcSize", Vec2i(width, height));
+      width = std::max(1, width / 2);
+      height = std::max(1, height / 2);
+
+      GLUtil::ActivateTexture(_SSRHiZTEX);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+    }
+
+    glViewport(0, 0, width, height);
+    _Quad.Render(*_SSRHiZShader);
   }
+  _SSRHiZShader -> StopUsing();
+
+  GLUtil::ActivateTexture(_SSRHiZTEX);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, _SSRHiZNbLevels - 1);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _SSRHiZTEX._Handle, 0);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 // ----------------------------------------------------------------------------
@@ -601,22 +1261,27 @@ void DeferredRenderer::BuildTransparentMeshTriangleData( size_t iMeshID, const s
   sortedTriOrder.resize(localCenters.size(), 0);
   triDepths.resize(localCenters.size(), 0.f);
   std::iota(sortedTriOrder.begin(), sortedTriOrder.end(), 0);
+  if ( iMeshID < _TransparentMeshSortAxis.size() )
+    _TransparentMeshSortAxis[iMeshID] = Vec3(0.f);
 }
 
 // ----------------------------------------------------------------------------
 // UpdateSortedTransparentMeshIndices
+// Sorts the mesh triangles back to front. Returns true when the sorted indices changed
+// and the mesh range of the index buffer must be uploaded again.
+// View depth is linear in the triangle center : the order only depends on the view axis
+// expressed in mesh space, so camera translations never require a new sort.
 // ----------------------------------------------------------------------------
 bool DeferredRenderer::UpdateSortedTransparentMeshIndices( int iMeshID, const Mat4x4 & iModel, const Mat4x4 & iView )
 {
-  if ( ( iMeshID < 0 ) || ( static_cast<size_t>(iMeshID) >= _MeshEBOs.size() ) )
-    return false;
-  if ( static_cast<size_t>(iMeshID) >= _MeshVAOs.size() )
+  if ( ( iMeshID < 0 ) || ( static_cast<size_t>(iMeshID) >= _MeshIndexCount.size() ) )
     return false;
   if ( ( static_cast<size_t>(iMeshID) >= _TransparentMeshBaseIndices.size() )
     || ( static_cast<size_t>(iMeshID) >= _TransparentMeshLocalTriCenters.size() )
     || ( static_cast<size_t>(iMeshID) >= _TransparentMeshSortedIndices.size() )
     || ( static_cast<size_t>(iMeshID) >= _TransparentMeshSortedTriOrder.size() )
-    || ( static_cast<size_t>(iMeshID) >= _TransparentMeshTriDepths.size() ) )
+    || ( static_cast<size_t>(iMeshID) >= _TransparentMeshTriDepths.size() )
+    || ( static_cast<size_t>(iMeshID) >= _TransparentMeshSortAxis.size() ) )
     return false;
 
   const std::vector<uint32_t> & baseIndices = _TransparentMeshBaseIndices[iMeshID];
@@ -645,17 +1310,71 @@ bool DeferredRenderer::UpdateSortedTransparentMeshIndices( int iMeshID, const Ma
   if ( sortedIndices.size() != baseIndices.size() )
     sortedIndices.resize(baseIndices.size(), 0u);
 
+  // View z of a mesh-space point p : dot(transpose(M) * viewRow2, p) + constant
+  const Vec3 viewRow2(iView[0][2], iView[1][2], iView[2][2]);
+  const Vec3 sortAxis = glm::transpose(glm::mat3(iModel)) * viewRow2;
+  const float sortAxisLength = glm::length(sortAxis);
+  if ( sortAxisLength <= 0.f )
+    return false;
+
+  Vec3 & lastSortAxis = _TransparentMeshSortAxis[iMeshID];
+  const Vec3 sortDir = sortAxis / sortAxisLength;
+  if ( glm::length(lastSortAxis) > 0.f )
+  {
+    const float cosThreshold = std::cos(MathUtil::ToRadians(std::min(_TransparentSortThreshold, 90.f)));
+    if ( ( lastSortAxis == sortDir ) || ( ( _TransparentSortThreshold > 0.f ) && ( glm::dot(lastSortAxis, sortDir) >= cosThreshold ) ) )
+      return false;
+  }
+  lastSortAxis = sortDir;
+
   for ( size_t ti = 0; ti < triCount; ++ti )
+    triDepths[ti] = glm::dot(sortAxis, localCenters[ti]);
+
+  // The previous order is the starting point : it is often still sorted
+  bool sorted = true;
+  for ( size_t i = 1; ( i < triCount ) && sorted; ++i )
+    sorted = ( triDepths[sortedTriOrder[i - 1]] <= triDepths[sortedTriOrder[i]] );
+  if ( sorted )
+    return false;
+
+  _NbTransparentSorts++;
+
+  if ( static_cast<int>(triCount) <= S_TransparentInsertionSortMax )
   {
-    Vec3 worldCenter = MathUtil::TransformPoint(localCenters[ti], iModel);
-    triDepths[ti] = ( iView * Vec4(worldCenter, 1.f) ).z;
+    for ( size_t i = 1; i < triCount; ++i )
+    {
+      const int tri = sortedTriOrder[i];
+      const float depth = triDepths[tri];
+      size_t j = i;
+      for ( ; ( j > 0 ) && ( triDepths[sortedTriOrder[j - 1]] > depth ); --j )
+        sortedTriOrder[j] = sortedTriOrder[j - 1];
+      sortedTriOrder[j] = tri;
+    }
   }
+  else
+  {
+    float minDepth = MAX_FLOAT;
+    float maxDepth = -MAX_FLOAT;
+    for ( float depth : triDepths )
+    {
+      minDepth = std::min(minDepth, depth);
+      maxDepth = std::max(maxDepth, depth);
+    }
 
-  std::sort( sortedTriOrder.begin(), sortedTriOrder.end(),
-    [&]( int iLhs, int iRhs )
+    // Quantized keys, gathered in the previous order so equal keys keep it
+    const float keyScale = ( maxDepth > minDepth ) ? ( static_cast<float>(( 1u << S_TransparentSortKeyBits ) - 1u) / ( maxDepth - minDepth ) ) : ( 0.f );
+    _TransparentSortKeys.resize(triCount);
+    _TransparentSortValues.resize(triCount);
+    for ( size_t i = 0; i < triCount; ++i )
     {
-      return triDepths[iLhs] < triDepths[iRhs];
-    } );
+      const int tri = sortedTriOrder[i];
+      _TransparentSortKeys[i] = static_cast<uint32_t>(( triDepths[tri] - minDepth ) * keyScale);
+      _TransparentSortValues[i] = tri;
+    }
+
+    _TransparentSorter.Sort(_TransparentSortKeys, _TransparentSortValues, S_TransparentSortKeyBits);
+    std::copy(_TransparentSortValues.begin(), _TransparentSortValues.end(), sortedTriOrder.begin());
+  }
 
   for ( size_t sortedIdx = 0; sortedIdx < triCount; ++sortedIdx )
   {
@@ -677,7 +1396,7 @@ int DeferredRenderer::UpdateShadowState()
 {
   _ShadowCasters.clear();
   _LocalShadowCasterCount = 0;
-  _DirectionalShadowCasterCount = 0;
+  _DirectionalShadowLayerCount = 0;
   _HasShadowLight = false;
   _ShadowFar = ( _Settings._ShadowFar > 0.f ) ? ( _Settings._ShadowFar ) : ( std::max( _ShadowSceneBoundsRadius * 2.f, 25.f ) );
 
@@ -770,6 +1489,16 @@ int DeferredRenderer::UpdateShadowState()
   int maxShadowCasters = std::clamp(_Settings._MaxShadowCastingLights, 1, S_MaxDeferredShadowCasters);
   int selectedCount = std::min(maxShadowCasters, static_cast<int>(candidates.size()));
   _ShadowCasters.reserve(selectedCount);
+
+  // Every distant caster keeps at least one 2D layer : cascades only use the remaining budget
+  int remainingDistantCasters = 0;
+  for ( int i = 0; i < selectedCount; ++i )
+  {
+    if ( LightType::DistantLight == candidates[i]._Type )
+      remainingDistantCasters++;
+  }
+  const int requestedCascades = std::clamp(_Settings._ShadowCascades, 1, S_MaxDeferredShadowCascades);
+
   for ( int i = 0; i < selectedCount; ++i )
   {
     const ShadowCandidate & candidate = candidates[i];
@@ -782,7 +1511,17 @@ int DeferredRenderer::UpdateShadowState()
 
     if ( LightType::DistantLight == caster._Type )
     {
-      caster._Layer = _DirectionalShadowCasterCount++;
+      remainingDistantCasters--;
+      caster._Layer = _DirectionalShadowLayerCount;
+      caster._NbCascades = std::max(1, std::min(requestedCascades, S_MaxDeferredShadow2DLayers - _DirectionalShadowLayerCount - remainingDistantCasters));
+      _DirectionalShadowLayerCount += caster._NbCascades;
+
+      if ( caster._NbCascades > 1 )
+      {
+        FitShadowCascades(caster);
+        _ShadowCasters.push_back(caster);
+        continue;
+      }
 
       float lightDistance = std::max( _ShadowSceneBoundsRadius * 2.f, 10.f );
       Vec3 lightPos = _ShadowSceneBounds.Center() + caster._Dir * lightDistance;
@@ -807,7 +1546,7 @@ int DeferredRenderer::UpdateShadowState()
       Mat4x4 shadowProj = glm::ortho(lightSpaceLow.x - padXY, lightSpaceHigh.x + padXY,
                                      lightSpaceLow.y - padXY, lightSpaceHigh.y + padXY,
                                      nearPlane, farPlane);
-      caster._DirectionalViewProj = shadowProj * lightView;
+      caster._CascadeViewProj[0] = shadowProj * lightView;
     }
     else
     {
@@ -828,6 +1567,189 @@ int DeferredRenderer::UpdateShadowState()
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// FitShadowCascades
+// Practical split scheme over the camera depth range. Each cascade bounds its frustum slice
+// with a sphere, so its extent does not change with the camera orientation, and is snapped
+// to the shadow map texels in light space : static shadows do not shimmer while moving.
+// ----------------------------------------------------------------------------
+void DeferredRenderer::FitShadowCascades( ShadowCaster & ioCaster )
+{
+  Camera & camera = _Scene.GetCamera();
+  const Vec3 cameraPos = camera.GetPos();
+  const Vec3 cameraForward = camera.GetForward();
+  const Vec3 cameraRight = camera.GetRight();
+  const Vec3 cameraUp = camera.GetUp();
+
+  float zNear = 0.1f, zFar = 1000.f;
+  camera.GetZNearFar(zNear, zFar);
+  zNear = std::max(zNear, 0.001f);
+
+  float top = 1.f, right = 1.f;
+  Mat4x4 cameraProj;
+  camera.ComputePerspectiveProjMatrix(RenderWidth() / float(std::max(RenderHeight(), 1)), cameraProj, &top, &right);
+  const float tanHalfY = top / zNear;
+  const float tanHalfX = right / zNear;
+
+  Vec3 sceneCorners[8];
+  _ShadowSceneBounds.Corners(sceneCorners);
+
+  float cascadeFar = _Settings._ShadowCascadeDistance;
+  if ( cascadeFar <= 0.f )
+  {
+    cascadeFar = zNear;
+    for ( const Vec3 & corner : sceneCorners )
+      cascadeFar = std::max(cascadeFar, glm::dot(corner - cameraPos, cameraForward));
+  }
+  cascadeFar = std::clamp(cascadeFar, zNear * 2.f, std::max(zFar, zNear * 2.f));
+
+  // Fixed orientation : only the snapped translation follows the camera
+  const Vec3 up = ( std::abs(glm::dot(ioCaster._Dir, Vec3(0.f, 1.f, 0.f))) > 0.99f ) ? ( Vec3(0.f, 0.f, 1.f) ) : ( Vec3(0.f, 1.f, 0.f) );
+  const Mat4x4 lightView = glm::lookAt(Vec3(0.f), -ioCaster._Dir, up);
+
+  // Casters between the light and a slice must stay in its depth range
+  float sceneMinZ = MAX_FLOAT;
+  float sceneMaxZ = -MAX_FLOAT;
+  for ( const Vec3 & corner : sceneCorners )
+  {
+    const float z = ( lightView * Vec4(corner, 1.f) ).z;
+    sceneMinZ = std::min(sceneMinZ, z);
+    sceneMaxZ = std::max(sceneMaxZ, z);
+  }
+
+  const float shadowMapSize = static_cast<float>(std::clamp(_Settings._ShadowMapResolution, 256, 4096));
+  const float lambda = std::clamp(_Settings._ShadowCascadeSplitLambda, 0.f, 1.f);
+  const float padZ = std::max(_ShadowSceneBoundsRadius * 0.1f, 1.f);
+
+  ioCaster._CascadeSplits = Vec4(MAX_FLOAT);
+  float sliceNear = zNear;
+  for ( int cascade = 0; cascade < ioCaster._NbCascades; ++cascade )
+  {
+    const float ratio = float(cascade + 1) / float(ioCaster._NbCascades);
+    const float logSplit = zNear * std::pow(cascadeFar / zNear, ratio);
+    const float uniformSplit = zNear + ( cascadeFar - zNear ) * ratio;
+    const float sliceFar = lambda * logSplit + ( 1.f - lambda ) * uniformSplit;
+    ioCaster._CascadeSplits[cascade] = sliceFar;
+
+    Vec3 sliceCorners[8];
+    const float sliceDepths[2] = { sliceNear, sliceFar };
+    for ( int corner = 0; corner < 8; ++corner )
+    {
+      const float depth = sliceDepths[corner >> 2];
+      const float sx = ( corner & 1 ) ? 1.f : -1.f;
+      const float sy = ( corner & 2 ) ? 1.f : -1.f;
+      sliceCorners[corner] = cameraPos + cameraForward * depth + cameraRight * ( sx * depth * tanHalfX ) + cameraUp * ( sy * depth * tanHalfY );
+    }
+
+    Vec3 center(0.f);
+    for ( const Vec3 & corner : sliceCorners )
+      center += corner;
+    center /= 8.f;
+
+    float radius = 0.f;
+    for ( const Vec3 & corner : sliceCorners )
+      radius = std::max(radius, glm::length(corner - center));
+    radius = std::ceil(radius * 16.f) / 16.f;
+
+    Vec3 centerLS = Vec3(lightView * Vec4(center, 1.f));
+    const float texelSize = 2.f * radius / shadowMapSize;
+    centerLS.x = std::floor(centerLS.x / texelSize) * texelSize;
+    centerLS.y = std::floor(centerLS.y / texelSize) * texelSize;
+
+    const float maxZ = std::max(sceneMaxZ, centerLS.z + radius);
+    const float minZ = std::min(sceneMinZ, centerLS.z - radius);
+    const Mat4x4 shadowProj = glm::ortho(centerLS.x - radius, centerLS.x + radius,
+                                         centerLS.y - radius, centerLS.y + radius,
+                                         -maxZ - padZ, -minZ + padZ);
+    ioCaster._CascadeViewProj[cascade] = shadowProj * lightView;
+
+    sliceNear = sliceFar;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// InvalidateShadowCache
+// ----------------------------------------------------------------------------
+void DeferredRenderer::InvalidateShadowCache()
+{
+  for ( ShadowCacheEntry & entry : _LocalShadowCache )
+    entry._Valid.fill(false);
+  for ( ShadowCacheEntry & entry : _DirectionalShadowCache )
+    entry._Valid.fill(false);
+  _ShadowDirtyBounds.clear();
+
+  const std::vector<MeshInstance> & instances = _Scene.GetMeshInstances();
+  const std::vector<Mesh*> & meshes = _Scene.GetMeshes();
+  _ShadowCasterBounds.resize(instances.size());
+  for ( size_t i = 0; i < instances.size(); ++i )
+    _ShadowCasterBounds[i] = InstanceShadowBounds(instances[i], meshes);
+}
+
+// ----------------------------------------------------------------------------
+// UpdateShadowCasterBounds
+// Collects where the instances changed since the last sync were and are now.
+// ----------------------------------------------------------------------------
+void DeferredRenderer::UpdateShadowCasterBounds()
+{
+  const std::vector<MeshInstance> & instances = _Scene.GetMeshInstances();
+  if ( ( _ShadowCasterBounds.size() != instances.size() ) || !_Scene.GetDirtyMeshInstances(_SyncedMeshInstanceGeneration, _ShadowDirtyInstanceIDs) )
+  {
+    InvalidateShadowCache();
+    return;
+  }
+
+  const std::vector<Mesh*> & meshes = _Scene.GetMeshes();
+  for ( int instanceID : _ShadowDirtyInstanceIDs )
+  {
+    const AABB<Vec3> & oldBounds = _ShadowCasterBounds[instanceID];
+    if ( oldBounds._Low.x <= oldBounds._High.x )
+      _ShadowDirtyBounds.push_back(oldBounds);
+
+    _ShadowCasterBounds[instanceID] = InstanceShadowBounds(instances[instanceID], meshes);
+    const AABB<Vec3> & newBounds = _ShadowCasterBounds[instanceID];
+    if ( newBounds._Low.x <= newBounds._High.x )
+      _ShadowDirtyBounds.push_back(newBounds);
+  }
+
+  if ( static_cast<int>(_ShadowDirtyBounds.size()) > S_MaxShadowDirtyBounds )
+    InvalidateShadowCache();
+}
+
+// ----------------------------------------------------------------------------
+// IsShadowLayerCached
+// When the layer must be redrawn, its key is updated for the coming render.
+// ----------------------------------------------------------------------------
+bool DeferredRenderer::IsShadowLayerCached( ShadowCacheEntry & ioEntry, int iFace, int iLightIndex, float iFar, const Mat4x4 & iViewProj )
+{
+  bool cached = _EnableShadowCache && ioEntry._Valid[iFace]
+             && ( ioEntry._LightIndex == iLightIndex ) && ( ioEntry._Far == iFar ) && ( ioEntry._ViewProj[iFace] == iViewProj );
+
+  if ( cached && !_ShadowDirtyBounds.empty() )
+  {
+    Vec4 planes[6];
+    ExtractFrustumPlanes(iViewProj, planes);
+    for ( const AABB<Vec3> & bounds : _ShadowDirtyBounds )
+    {
+      if ( !IsBoxOutsidePlanes(planes, bounds) )
+      {
+        cached = false;
+        break;
+      }
+    }
+  }
+
+  if ( cached )
+    return true;
+
+  if ( ( ioEntry._LightIndex != iLightIndex ) || ( ioEntry._Far != iFar ) )
+    ioEntry._Valid.fill(false);
+  ioEntry._LightIndex = iLightIndex;
+  ioEntry._Far = iFar;
+  ioEntry._ViewProj[iFace] = iViewProj;
+  ioEntry._Valid[iFace] = _EnableShadowCache;
+  return false;
+}
+
 // ----------------------------------------------------------------------------
 // InitializeShadowMap
 // ----------------------------------------------------------------------------
@@ -840,7 +1762,7 @@ int DeferredRenderer::InitializeShadowMap()
   int shadowMapSize = std::clamp(_Settings._ShadowMapResolution, 256, 4096);
   _ShadowMapSize = shadowMapSize;
   _ShadowLocalCapacity = _LocalShadowCasterCount;
-  _ShadowDirectionalCapacity = _DirectionalShadowCasterCount;
+  _ShadowDirectionalCapacity = _DirectionalShadowLayerCount;
 
   GLTextureDesc shadowCubeDesc;
   shadowCubeDesc._Target         = _ShadowCubeMapTEX._Target;
@@ -866,6 +1788,10 @@ int DeferredRenderer::InitializeShadowMap()
   shadow2DDesc._Depth  = std::max(1, _ShadowDirectionalCapacity);
   GLUtil::CreateTexture(shadow2DDesc, _Shadow2DMapTEX);
 
+  _LocalShadowCache.assign(_ShadowLocalCapacity, ShadowCacheEntry());
+  _DirectionalShadowCache.assign(_ShadowDirectionalCapacity, ShadowCacheEntry());
+  InvalidateShadowCache();
+
   if ( !_HasShadowLight )
     return 0;
 
@@ -896,15 +1822,19 @@ int DeferredRenderer::InitializeSSAO()
 {
   GLUtil::DeleteFBO(_SSAOFBO);
   GLUtil::DeleteFBO(_SSAOBlurFBO);
+  GLUtil::DeleteFBO(_SSAOUpsampleFBO);
   GLUtil::DeleteTEX(_SSAOTEX);
   GLUtil::DeleteTEX(_SSAOBlurTEX);
+  GLUtil::DeleteTEX(_SSAOUpsampleTEX);
   GLUtil::DeleteTEX(_SSAONoiseTEX);
 
+  const Vec2i ssaoSize = EffectSize(_Settings._SSAOResolution);
+
   GLTextureDesc ssaoDesc;
   ssaoDesc._Target         = _SSAOTEX._Target;
   ssaoDesc._Slot           = _SSAOTEX._Slot;
-  ssaoDesc._Width          = RenderWidth();
-  ssaoDesc._Height         = RenderHeight();
+  ssaoDesc._Width          = ssaoSize.x;
+  ssaoDesc._Height         = ssaoSize.y;
   ssaoDesc._InternalFormat = _SSAOTEX._InternalFormat;
   ssaoDesc._DataFormat     = _SSAOTEX._DataFormat;
   ssaoDesc._DataType       = _SSAOTEX._DataType;
@@ -934,6 +1864,22 @@ int DeferredRenderer::InitializeSSAO()
     return 1;
   }
 
+  ssaoDesc._Slot           = _SSAOUpsampleTEX._Slot;
+  ssaoDesc._Width          = RenderWidth();
+  ssaoDesc._Height         = RenderHeight();
+  ssaoDesc._InternalFormat = _SSAOUpsampleTEX._InternalFormat;
+  ssaoDesc._DataFormat     = _SSAOUpsampleTEX._DataFormat;
+  ssaoDesc._DataType       = _SSAOUpsampleTEX._DataType;
+  GLUtil::CreateTexture(ssaoDesc, _SSAOUpsampleTEX);
+
+  GLFrameBufferDesc ssaoUpsampleFBODesc;
+  ssaoUpsampleFBODesc._Attachments.push_back({ GL_COLOR_ATTACHMENT0, &_SSAOUpsampleTEX });
+  if ( !GLUtil::CreateFrameBuffer(ssaoUpsampleFBODesc, _SSAOUpsampleFBO) )
+  {
+    std::cout << "DeferredRenderer : SSAO upsample framebuffer not complete !" << std::endl;
+    return 1;
+  }
+
   std::mt19937 rng(1337u);
   std::uniform_real_distribution<float> dist01(0.f, 1.f);
   std::uniform_real_distribution<float> dist11(-1.f, 1.f);
@@ -985,14 +1931,18 @@ int DeferredRenderer::InitializeSSR()
 {
   GLUtil::DeleteFBO(_SSRFBO);
   GLUtil::DeleteFBO(_SSRSourceFBO);
+  GLUtil::DeleteFBO(_SSRUpsampleFBO);
   GLUtil::DeleteTEX(_SSRTEX);
   GLUtil::DeleteTEX(_SSRSourceTEX);
+  GLUtil::DeleteTEX(_SSRUpsampleTEX);
+
+  const Vec2i ssrSize = EffectSize(_Settings._SSRResolution);
 
   GLTextureDesc ssrDesc;
   ssrDesc._Target         = _SSRTEX._Target;
   ssrDesc._Slot           = _SSRTEX._Slot;
-  ssrDesc._Width          = RenderWidth();
-  ssrDesc._Height         = RenderHeight();
+  ssrDesc._Width          = ssrSize.x;
+  ssrDesc._Height         = ssrSize.y;
   ssrDesc._InternalFormat = _SSRTEX._InternalFormat;
   ssrDesc._DataFormat     = _SSRTEX._DataFormat;
   ssrDesc._DataType       = _SSRTEX._DataType;
@@ -1011,6 +1961,8 @@ int DeferredRenderer::InitializeSSR()
   }
 
   ssrDesc._Slot           = _SSRSourceTEX._Slot;
+  ssrDesc._Width          = RenderWidth();
+  ssrDesc._Height         = RenderHeight();
   ssrDesc._InternalFormat = _SSRSourceTEX._InternalFormat;
   ssrDesc._DataFormat     = _SSRSourceTEX._DataFormat;
   ssrDesc._DataType       = _SSRSourceTEX._DataType;
@@ -1024,12 +1976,63 @@ int DeferredRenderer::InitializeSSR()
     return 1;
   }
 
+  ssrDesc._Slot           = _SSRUpsampleTEX._Slot;
+  ssrDesc._InternalFormat = _SSRUpsampleTEX._InternalFormat;
+  ssrDesc._DataFormat     = _SSRUpsampleTEX._DataFormat;
+  ssrDesc._DataType       = _SSRUpsampleTEX._DataType;
+  GLUtil::CreateTexture(ssrDesc, _SSRUpsampleTEX);
+
+  GLFrameBufferDesc ssrUpsampleFBODesc;
+  ssrUpsampleFBODesc._Attachments.push_back({ GL_COLOR_ATTACHMENT0, &_SSRUpsampleTEX });
+  if ( !GLUtil::CreateFrameBuffer(ssrUpsampleFBODesc, _SSRUpsampleFBO) )
+  {
+    std::cout << "DeferredRenderer : SSR upsample framebuffer not complete !" << std::endl;
+    return 1;
+  }
+
   glBindFramebuffer(GL_FRAMEBUFFER, _SSRSourceFBO._Handle);
   glViewport(0, 0, RenderWidth(), RenderHeight());
   glClearColor(0.f, 0.f, 0.f, 1.f);
   glClear(GL_COLOR_BUFFER_BIT);
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+  return InitializeSSRHiZ();
+}
+
+// ----------------------------------------------------------------------------
+// InitializeSSRHiZ
+// ----------------------------------------------------------------------------
+int DeferredRenderer::InitializeSSRHiZ()
+{
+  GLUtil::DeleteFBO(_SSRHiZFBO);
+  GLUtil::DeleteTEX(_SSRHiZTEX);
+  _SSRHiZNbLevels = 0;
+
+  GLTextureDesc hizDesc;
+  hizDesc._Target         = _SSRHiZTEX._Target;
+  hizDesc._Slot           = _SSRHiZTEX._Slot;
+  hizDesc._Width          = RenderWidth();
+  hizDesc._Height         = RenderHeight();
+  hizDesc._InternalFormat = _SSRHiZTEX._InternalFormat;
+  hizDesc._DataFormat     = _SSRHiZTEX._DataFormat;
+  hizDesc._DataType       = _SSRHiZTEX._DataType;
+  hizDesc._MinFilter      = GL_NEAREST_MIPMAP_NEAREST;
+  hizDesc._MagFilter      = GL_NEAREST;
+  hizDesc._WrapS          = GL_CLAMP_TO_EDGE;
+  hizDesc._WrapT          = GL_CLAMP_TO_EDGE;
+  hizDesc._GenerateMipMap = true; // Allocates the whole chain
+  GLUtil::CreateTexture(hizDesc, _SSRHiZTEX);
+
+  GLFrameBufferDesc hizFBODesc;
+  hizFBODesc._Attachments.push_back({ GL_COLOR_ATTACHMENT0, &_SSRHiZTEX });
+  if ( !GLUtil::CreateFrameBuffer(hizFBODesc, _SSRHiZFBO) )
+  {
+    std::cout << "DeferredRenderer : SSR HiZ framebuffer not complete !" << std::endl;
+    return 1;
+  }
+
+  _SSRHiZNbLevels = 1 + static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(std::max(RenderWidth(), RenderHeight()), 1)))));
+
   return 0;
 }
 
@@ -1080,9 +2083,41 @@ int DeferredRenderer::InitializeBRDFLUT()
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// InitializeHiZ
+// ----------------------------------------------------------------------------
+int DeferredRenderer::InitializeHiZ()
+{
+  GLUtil::DeleteTEX(_HiZTEX);
+  _HiZNbLevels = 0;
+  _HiZValid = false;
+
+  if ( !_HiZShader )
+    return 0;
+
+  GLTextureDesc hizDesc;
+  hizDesc._Target         = _HiZTEX._Target;
+  hizDesc._Slot           = _HiZTEX._Slot;
+  hizDesc._Width          = RenderWidth();
+  hizDesc._Height         = RenderHeight();
+  hizDesc._InternalFormat = _HiZTEX._InternalFormat;
+  hizDesc._DataFormat     = _HiZTEX._DataFormat;
+  hizDesc._DataType       = _HiZTEX._DataType;
+  hizDesc._MinFilter      = GL_NEAREST_MIPMAP_NEAREST;
+  hizDesc._MagFilter      = GL_NEAREST;
+  hizDesc._WrapS          = GL_CLAMP_TO_EDGE;
+  hizDesc._WrapT          = GL_CLAMP_TO_EDGE;
+  hizDesc._GenerateMipMap = true; // Allocates the whole chain
+  GLUtil::CreateTexture(hizDesc, _HiZTEX);
+
+  _HiZNbLevels = 1 + static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(std::max(RenderWidth(), RenderHeight()), 1)))));
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // ReloadScene
-// Build GPU buffers (VAO/VBO/EBO) for every mesh found in the Scene.
+// Build one merged VAO/VBO/EBO holding every mesh found in the Scene.
 // ----------------------------------------------------------------------------
 int DeferredRenderer::ReloadScene()
 {
@@ -1094,15 +2129,18 @@ int DeferredRenderer::ReloadScene()
   const std::vector<Mesh*> & meshes = _Scene.GetMeshes();
   const size_t meshCount = meshes.size();
 
-  _MeshVAOs.assign(meshCount, 0u);
-  _MeshVBOs.assign(meshCount, 0u);
-  _MeshEBOs.assign(meshCount, 0u);
+  _MeshFirstIndex.assign(meshCount, 0);
+  _MeshBaseVertex.assign(meshCount, 0);
   _MeshIndexCount.assign(meshCount, 0);
   _TransparentMeshBaseIndices.assign(meshCount, {});
   _TransparentMeshLocalTriCenters.assign(meshCount, {});
   _TransparentMeshSortedIndices.assign(meshCount, {});
   _TransparentMeshSortedTriOrder.assign(meshCount, {});
   _TransparentMeshTriDepths.assign(meshCount, {});
+  _TransparentMeshSortAxis.assign(meshCount, Vec3(0.f));
+
+  std::vector<GPUMeshVertex> allVertices;
+  std::vector<uint32_t> allIndices;
 
   for ( size_t mi = 0; mi < meshCount; ++mi )
   {
@@ -1163,9 +2201,22 @@ int DeferredRenderer::ReloadScene()
     if ( outIndices.empty() || outVertices.empty() )
       continue;
 
-    // Create GPU buffers and VAO
-    GLuint vao = 0, vbo = 0, ebo = 0;
+    // Indices stay local to the mesh : draws offset them with the mesh base vertex
+    _MeshFirstIndex[mi] = static_cast<int>(allIndices.size());
+    _MeshBaseVertex[mi] = static_cast<int>(allVertices.size());
+    _MeshIndexCount[mi] = static_cast<int>(outIndices.size());
+    allVertices.insert(allVertices.end(), outVertices.begin(), outVertices.end());
+    allIndices.insert(allIndices.end(), outIndices.begin(), outIndices.end());
+
+    std::vector<Vec3> gpuPositions;
+    gpuPositions.reserve(outVertices.size());
+    for ( const GPUMeshVertex & vertex : outVertices )
+      gpuPositions.push_back(vertex._Pos);
+    BuildTransparentMeshTriangleData(mi, gpuPositions, outIndices);
+  }
 
+  if ( !allIndices.empty() )
+  {
     // Attributes: location 0 = position (vec3), 1 = normal (vec3), 2 = uv (vec2)
     const GLsizei stride = static_cast<GLsizei>(sizeof(GPUMeshVertex));
     std::vector<std::tuple<GLuint, GLint, GLenum, GLboolean, GLsizei, std::size_t>> attrs;
@@ -1173,24 +2224,35 @@ int DeferredRenderer::ReloadScene()
     attrs.emplace_back(1u, 3, GL_FLOAT, GL_FALSE, stride, offsetof(GPUMeshVertex, _Normal));
     attrs.emplace_back(2u, 2, GL_FLOAT, GL_FALSE, stride, offsetof(GPUMeshVertex, _UV));
 
-    GLUtil::CreateMeshBuffers( static_cast<GLsizeiptr>(outVertices.size() * sizeof(GPUMeshVertex)), outVertices.data(),
-                               static_cast<GLsizeiptr>(outIndices.size() * sizeof(uint32_t)), outIndices.data(),
+    GLUtil::CreateMeshBuffers( static_cast<GLsizeiptr>(allVertices.size() * sizeof(GPUMeshVertex)), allVertices.data(),
+                               static_cast<GLsizeiptr>(allIndices.size() * sizeof(uint32_t)), allIndices.data(),
                                attrs,
-                               vao, vbo, ebo);
-
-    _MeshVAOs[mi] = vao;
-    _MeshVBOs[mi] = vbo;
-    _MeshEBOs[mi] = ebo;
-    _MeshIndexCount[mi] = static_cast<int>(outIndices.size());
+                               _MeshVAO, _MeshVBO, _MeshEBO);
 
-    std::vector<Vec3> gpuPositions;
-    gpuPositions.reserve(outVertices.size());
-    for ( const GPUMeshVertex & vertex : outVertices )
-      gpuPositions.push_back(vertex._Pos);
-    BuildTransparentMeshTriangleData(mi, gpuPositions, outIndices);
+    // Location 3 = draw ID (uint, one per instance) for the multi-draw indirect shaders
+    if ( GLEW_VERSION_4_3 )
+    {
+      _DrawIDVBO = GLUtil::GenBuffer();
+      _DrawIDCapacity = std::max(1, _Scene.GetNbMeshInstances());
+      std::vector<GLuint> drawIDs(_DrawIDCapacity);
+      std::iota(drawIDs.begin(), drawIDs.end(), 0u);
+      GLUtil::UploadArrayBuffer(_DrawIDVBO, static_cast<GLsizeiptr>(drawIDs.size() * sizeof(GLuint)), drawIDs.data());
+
+      GLVertexAttribDesc drawIDAttr;
+      drawIDAttr._Index   = 3;
+      drawIDAttr._Size    = 1;
+      drawIDAttr._Type    = GL_UNSIGNED_INT;
+      drawIDAttr._Integer = true;
+      GLUtil::SetupVertexAttribPointers(_MeshVAO, _DrawIDVBO, 0, { drawIDAttr });
+
+      glBindVertexArray(_MeshVAO);
+      glVertexAttribDivisor(3, 1);
+      glBindVertexArray(0);
+    }
   }
 
   ComputeSceneBounds(true);
+  InvalidateShadowCache();
 
   // Materials
   if ( _Scene.GetTextureArrayIDs().size() )
@@ -1304,17 +2366,30 @@ int DeferredRenderer::InitializeFrameBuffers()
   targetDesc._DataType       = _GAlbedoTEX._DataType;
   GLUtil::CreateTexture(targetDesc, _GAlbedoTEX);
 
+  // Compact layout : 4 + 4 + 4 + 8 bytes of color per pixel instead of 4 + 8 + 8 + 8 + 8
+  _CompactGBuffer = _Settings._CompactGBuffer;
+  _GNormalTEX._InternalFormat   = _CompactGBuffer ? GL_RG16 : GL_RGBA16F;
+  _GNormalTEX._DataFormat       = _CompactGBuffer ? GL_RG : GL_RGBA;
+  _GNormalTEX._DataType         = _CompactGBuffer ? GL_UNSIGNED_SHORT : GL_FLOAT;
+  _GMaterialTEX._InternalFormat = _CompactGBuffer ? GL_RGBA8 : GL_RGBA16F;
+  _GMaterialTEX._DataType       = _CompactGBuffer ? GL_UNSIGNED_BYTE : GL_FLOAT;
+
   targetDesc._Slot           = _GNormalTEX._Slot;
   targetDesc._InternalFormat = _GNormalTEX._InternalFormat;
   targetDesc._DataFormat     = _GNormalTEX._DataFormat;
   targetDesc._DataType       = _GNormalTEX._DataType;
   GLUtil::CreateTexture(targetDesc, _GNormalTEX);
 
-  targetDesc._Slot           = _GPositionTEX._Slot;
-  targetDesc._InternalFormat = _GPositionTEX._InternalFormat;
-  targetDesc._DataFormat     = _GPositionTEX._DataFormat;
-  targetDesc._DataType       = _GPositionTEX._DataType;
-  GLUtil::CreateTexture(targetDesc, _GPositionTEX);
+  if ( _CompactGBuffer )
+    GLUtil::DeleteTEX(_GPositionTEX);
+  else
+  {
+    targetDesc._Slot           = _GPositionTEX._Slot;
+    targetDesc._InternalFormat = _GPositionTEX._InternalFormat;
+    targetDesc._DataFormat     = _GPositionTEX._DataFormat;
+    targetDesc._DataType       = _GPositionTEX._DataType;
+    GLUtil::CreateTexture(targetDesc, _GPositionTEX);
+  }
 
   targetDesc._Slot           = _GMaterialTEX._Slot;
   targetDesc._InternalFormat = _GMaterialTEX._InternalFormat;
@@ -1339,10 +2414,13 @@ int DeferredRenderer::InitializeFrameBuffers()
   GLFrameBufferDesc gBufferDesc;
   gBufferDesc._Attachments.push_back({ GL_COLOR_ATTACHMENT0, &_GAlbedoTEX });
   gBufferDesc._Attachments.push_back({ GL_COLOR_ATTACHMENT1, &_GNormalTEX });
-  gBufferDesc._Attachments.push_back({ GL_COLOR_ATTACHMENT2, &_GPositionTEX });
+  if ( !_CompactGBuffer )
+    gBufferDesc._Attachments.push_back({ GL_COLOR_ATTACHMENT2, &_GPositionTEX });
   gBufferDesc._Attachments.push_back({ GL_COLOR_ATTACHMENT3, &_GMaterialTEX });
   gBufferDesc._Attachments.push_back({ GL_COLOR_ATTACHMENT4, &_GEmissionTEX });
   gBufferDesc._Attachments.push_back({ GL_DEPTH_ATTACHMENT, &_GDepthTEX });
+  // Draw buffers follow the fragment output locations : the position output is dropped in the compact layout
+  gBufferDesc._DrawBuffers = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, _CompactGBuffer ? GLenum(GL_NONE) : GLenum(GL_COLOR_ATTACHMENT2), GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4 };
   if ( !GLUtil::CreateFrameBuffer(gBufferDesc, _GBufferFBO) )
   {
     std::cout << "DeferredRenderer : G-buffer framebuffer not complete !" << std::endl;
@@ -1367,7 +2445,32 @@ int DeferredRenderer::InitializeFrameBuffers()
     return 1;
   }
 
-  return 0;
+  // Weighted blended OIT targets : accumulation and revealage, resolved 1:1 over the lighting target
+  targetDesc._Slot           = _OITAccumTEX._Slot;
+  targetDesc._InternalFormat = _OITAccumTEX._InternalFormat;
+  targetDesc._DataFormat     = _OITAccumTEX._DataFormat;
+  targetDesc._DataType       = _OITAccumTEX._DataType;
+  targetDesc._MinFilter      = GL_NEAREST;
+  targetDesc._MagFilter      = GL_NEAREST;
+  GLUtil::CreateTexture(targetDesc, _OITAccumTEX);
+
+  targetDesc._Slot           = _OITRevealageTEX._Slot;
+  targetDesc._InternalFormat = _OITRevealageTEX._InternalFormat;
+  targetDesc._DataFormat     = _OITRevealageTEX._DataFormat;
+  targetDesc._DataType       = _OITRevealageTEX._DataType;
+  GLUtil::CreateTexture(targetDesc, _OITRevealageTEX);
+
+  GLFrameBufferDesc oitDesc;
+  oitDesc._Attachments.push_back({ GL_COLOR_ATTACHMENT0, &_OITAccumTEX });
+  oitDesc._Attachments.push_back({ GL_COLOR_ATTACHMENT1, &_OITRevealageTEX });
+  oitDesc._Attachments.push_back({ GL_DEPTH_ATTACHMENT, &_GDepthTEX, GL_TEXTURE_2D, 0, false });
+  if ( !GLUtil::CreateFrameBuffer(oitDesc, _OITFBO) )
+  {
+    std::cout << "DeferredRenderer : OIT framebuffer not complete !" << std::endl;
+    return 1;
+  }
+
+  return InitializeHiZ();
 }
 
 // ----------------------------------------------------------------------------
@@ -1378,14 +2481,30 @@ int DeferredRenderer::ResizeRenderTarget()
   _Settings._RenderResolution.x = int(_Settings._WindowResolution.x * RenderScale());
   _Settings._RenderResolution.y = int(_Settings._WindowResolution.y * RenderScale());
 
-  GLUtil::ResizeFBO(_GBufferFBO, RenderWidth(), RenderHeight());
-  GLUtil::ResizeFBO(_LightingFBO, RenderWidth(), RenderHeight());
-  GLUtil::ResizeFBO(_SSAOFBO, RenderWidth(), RenderHeight());
-  GLUtil::ResizeFBO(_SSAOBlurFBO, RenderWidth(), RenderHeight());
-  GLUtil::ResizeFBO(_SSRFBO, RenderWidth(), RenderHeight());
+  if ( _Settings._CompactGBuffer != _CompactGBuffer )
+  {
+    // Target formats change : rebuild the G-buffer and the targets sharing its depth
+    if ( 0 != InitializeFrameBuffers() )
+      return 1;
+  }
+  else
+  {
+    GLUtil::ResizeFBO(_GBufferFBO, RenderWidth(), RenderHeight());
+    GLUtil::ResizeFBO(_LightingFBO, RenderWidth(), RenderHeight());
+    GLUtil::ResizeFBO(_OITFBO, RenderWidth(), RenderHeight());
+  }
+  const Vec2i ssaoSize = EffectSize(_Settings._SSAOResolution);
+  const Vec2i ssrSize = EffectSize(_Settings._SSRResolution);
+  GLUtil::ResizeFBO(_SSAOFBO, ssaoSize.x, ssaoSize.y);
+  GLUtil::ResizeFBO(_SSAOBlurFBO, ssaoSize.x, ssaoSize.y);
+  GLUtil::ResizeFBO(_SSAOUpsampleFBO, RenderWidth(), RenderHeight());
+  GLUtil::ResizeFBO(_SSRFBO, ssrSize.x, ssrSize.y);
+  GLUtil::ResizeFBO(_SSRUpsampleFBO, RenderWidth(), RenderHeight());
   GLUtil::ResizeFBO(_SSRSourceFBO, RenderWidth(), RenderHeight());
 
-  return 0;
+  if ( 0 != InitializeHiZ() )
+    return 1;
+  return InitializeSSRHiZ();
 }
 // ----------------------------------------------------------------------------
 // RecompileShaders
@@ -1426,6 +2545,18 @@ int DeferredRenderer::RecompileShaders()
     return 1;
   _SSRShader.reset(ssrProg);
 
+  ShaderSource ssrHiZFrag = Shader::LoadShader(PathUtils::GetShaderPath("fragment_SSRHiZDownsample.glsl"));
+  ShaderProgram* ssrHiZProg = ShaderProgram::LoadShaders(defaultVert, ssrHiZFrag);
+  if (!ssrHiZProg)
+    return 1;
+  _SSRHiZShader.reset(ssrHiZProg);
+
+  ShaderSource upsampleFrag = Shader::LoadShader(PathUtils::GetShaderPath("fragment_BilateralUpsample.glsl"));
+  ShaderProgram* upsampleProg = ShaderProgram::LoadShaders(defaultVert, upsampleFrag);
+  if (!upsampleProg)
+    return 1;
+  _BilateralUpsampleShader.reset(upsampleProg);
+
   ShaderSource brdfLutFrag = Shader::LoadShader(PathUtils::GetShaderPath("fragment_BRDFLUT.glsl"));
   ShaderProgram* brdfLutProg = ShaderProgram::LoadShaders(defaultVert, brdfLutFrag);
   if (!brdfLutProg)
@@ -1465,6 +2596,51 @@ int DeferredRenderer::RecompileShaders()
   if ( !transparentProg )
     return 1;
   _TransparentShader.reset(transparentProg);
+
+  ShaderSource oitResolveFrag = Shader::LoadShader(PathUtils::GetShaderPath("fragment_DeferredOITResolve.glsl"));
+  ShaderProgram* oitResolveProg = ShaderProgram::LoadShaders(defaultVert, oitResolveFrag);
+  if ( !oitResolveProg )
+    return 1;
+  _OITResolveShader.reset(oitResolveProg);
+
+  // Multi-draw indirect variants are optional : without GL 4.3 the per-instance draws are kept
+  _MultiDrawIndirectSupported = false;
+  _GeometryIndirectShader.reset();
+  _WireframeIndirectShader.reset();
+  _ShadowCubeIndirectShader.reset();
+  _ShadowDirectionalIndirectShader.reset();
+  if ( GLEW_VERSION_4_3 )
+  {
+    ShaderSource geomIndirectVert = Shader::LoadShader(PathUtils::GetShaderPath("vertex_DeferredGeometryIndirect.glsl"));
+    ShaderSource shadowCubeIndirectVert = Shader::LoadShader(PathUtils::GetShaderPath("vertex_ShadowCubeDepthIndirect.glsl"));
+    ShaderSource shadowDirIndirectVert = Shader::LoadShader(PathUtils::GetShaderPath("vertex_ShadowDirectionalDepthIndirect.glsl"));
+    _GeometryIndirectShader.reset(ShaderProgram::LoadShaders(geomIndirectVert, geomFrag));
+    _WireframeIndirectShader.reset(ShaderProgram::LoadShaders(geomIndirectVert, wireFrag));
+    _ShadowCubeIndirectShader.reset(ShaderProgram::LoadShaders(shadowCubeIndirectVert, shadowCubeFrag));
+    _ShadowDirectionalIndirectShader.reset(ShaderProgram::LoadShaders(shadowDirIndirectVert, shadowDirFrag));
+
+    _MultiDrawIndirectSupported = _GeometryIndirectShader && _WireframeIndirectShader && _ShadowCubeIndirectShader && _ShadowDirectionalIndirectShader;
+    if ( !_MultiDrawIndirectSupported )
+      std::cout << "DeferredRenderer : Multi-draw indirect shaders unavailable, using per-instance draws" << std::endl;
+  }
+
+  // GPU culling compacts the indirect commands : without it, the per-instance path culls on the CPU
+  _GpuCullingSupported = false;
+  _CullingShader.reset();
+  _HiZShader.reset();
+  if ( _MultiDrawIndirectSupported )
+  {
+    ShaderSource cullingComp = Shader::LoadShader(PathUtils::GetShaderPath("compute_DeferredCulling.glsl"));
+    ShaderSource hizComp = Shader::LoadShader(PathUtils::GetShaderPath("compute_HiZDownsample.glsl"));
+    _CullingShader.reset(ShaderProgram::LoadShaders(cullingComp));
+    _HiZShader.reset(ShaderProgram::LoadShaders(hizComp));
+
+    _GpuCullingSupported = ( nullptr != _CullingShader );
+    if ( !_GpuCullingSupported )
+      std::cout << "DeferredRenderer : Culling compute shader unavailable, culling on the CPU" << std::endl;
+    if ( !_HiZShader )
+      std::cout << "DeferredRenderer : HiZ compute shader unavailable, occlusion culling disabled" << std::endl;
+  }
  
   return 0;
 }
@@ -1498,6 +2674,8 @@ int DeferredRenderer::BindSSRPassTextures()
   GLUtil::ActivateTextures(_GBufferFBO);
   GLUtil::ActivateTexture(_SSRSourceTEX);
   GLUtil::ActivateTexture(_EnvMapTEX);
+  if ( SSRTraceMode::HiZ == _Settings._SSRTraceMode )
+    GLUtil::ActivateTexture(_SSRHiZTEX);
 
   return 0;
 }
@@ -1517,8 +2695,14 @@ int DeferredRenderer::BindLightingTextures()
   GLUtil::ActivateTexture(_BRDFLUTTEX);
   GLUtil::ActivateTexture(_ShadowCubeMapTEX);
   GLUtil::ActivateTexture(_Shadow2DMapTEX);
-  GLUtil::ActivateTexture(_SSAOBlurTEX);
-  GLUtil::ActivateTexture(_SSRTEX);
+  GLUtil::ActivateTexture(( EffectResolution::Full != _Settings._SSAOResolution ) ? _SSAOUpsampleTEX : _SSAOBlurTEX);
+  GLUtil::ActivateTexture(( EffectResolution::Full != _Settings._SSRResolution ) ? _SSRUpsampleTEX : _SSRTEX);
+
+  if ( _Settings._LightClustering && _LightClustersTBO._Handle && _LightIndicesTBO._Handle )
+  {
+    GLUtil::ActivateTexture(_LightClustersTBO._Tex);
+    GLUtil::ActivateTexture(_LightIndicesTBO._Tex);
+  }
 
   return 0;
 }
@@ -1546,6 +2730,7 @@ int DeferredRenderer::UpdateUniforms()
   float top, right;
   Mat4x4 P;
   _Scene.GetCamera().ComputePerspectiveProjMatrix(ratio, P, &top, &right);
+  _CameraViewProj = P * V;
 
   Vec3 camPos = _Scene.GetCamera().GetPos();
   Vec3 camUp = _Scene.GetCamera().GetUp();
@@ -1569,16 +2754,33 @@ int DeferredRenderer::UpdateUniforms()
     GLUtil::CreateTexture(materialsDesc, _MaterialsTEX);
   }
 
-  if ( _GeometryShader )
+  for ( ShaderProgram * geometryShader : { _GeometryShader.get(), _GeometryIndirectShader.get() } )
+  {
+    if ( !geometryShader )
+      continue;
+
+    geometryShader -> Use();
+    geometryShader -> SetUniform("u_CompactGBuffer", _CompactGBuffer ? 1 : 0);
+    geometryShader -> SetUniform("u_CameraPos", camPos);
+    geometryShader -> SetUniform("u_View", V);
+    geometryShader -> SetUniform("u_Proj", P);
+    geometryShader -> SetUniform("u_TexIndTexture",    (int)DeferredTexSlot::_TexInd);
+    geometryShader -> SetUniform("u_TexArrayTexture",  (int)DeferredTexSlot::_TexArray);
+    geometryShader -> SetUniform("u_MaterialsTexture", (int)DeferredTexSlot::_Materials);
+    geometryShader -> StopUsing();
+  }
+
+  // Passes reading the G-buffer rebuild world positions from depth in the compact layout
+  const Mat4x4 invViewProj = glm::inverse(_CameraViewProj);
+  for ( ShaderProgram * gBufferShader : { _LightingShader.get(), _SSAOShader.get(), _SSAOBlurShader.get(), _SSRShader.get(), _BilateralUpsampleShader.get() } )
   {
-    _GeometryShader -> Use();
-    _GeometryShader -> SetUniform("u_CameraPos", camPos);
-    _GeometryShader -> SetUniform("u_View", V);
-    _GeometryShader -> SetUniform("u_Proj", P);
-    _GeometryShader -> SetUniform("u_TexIndTexture",    (int)DeferredTexSlot::_TexInd);
-    _GeometryShader -> SetUniform("u_TexArrayTexture",  (int)DeferredTexSlot::_TexArray);
-    _GeometryShader -> SetUniform("u_MaterialsTexture", (int)DeferredTexSlot::_Materials);
-    _GeometryShader -> StopUsing();
+    if ( !gBufferShader )
+      continue;
+
+    gBufferShader -> Use();
+    gBufferShader -> SetUniform("u_CompactGBuffer", _CompactGBuffer ? 1 : 0);
+    gBufferShader -> SetUniform("u_GInvViewProj", invViewProj);
+    gBufferShader -> StopUsing();
   }
 
   if ( _SSAOShader )
@@ -1592,7 +2794,8 @@ int DeferredRenderer::UpdateUniforms()
     _SSAOShader -> SetUniform("u_Proj", P);
     if ( _DirtyStates & (unsigned long)DirtyState::RenderSettings )
     {
-      _SSAOShader -> SetUniform("u_Resolution", float(RenderWidth()), float(RenderHeight()));
+      const Vec2i ssaoSize = EffectSize(_Settings._SSAOResolution);
+      _SSAOShader -> SetUniform("u_Resolution", float(ssaoSize.x), float(ssaoSize.y));
       _SSAOShader -> SetUniform("u_EnableSSAO", _Settings._SSAO ? 1 : 0);
       _SSAOShader -> SetUniform("u_SSAORadius", _Settings._SSAORadius);
       _SSAOShader -> SetUniform("u_SSAOBias", _Settings._SSAOBias);
@@ -1609,7 +2812,8 @@ int DeferredRenderer::UpdateUniforms()
     _SSAOBlurShader -> SetUniform("u_SSAOInput", (int)DeferredTexSlot::_SSAO);
     _SSAOBlurShader -> SetUniform("u_GDepth", (int)DeferredTexSlot::_GDepth);
     _SSAOBlurShader -> SetUniform("u_GNormal", (int)DeferredTexSlot::_GNormal);
-    _SSAOBlurShader -> SetUniform("u_Resolution", float(RenderWidth()), float(RenderHeight()));
+    const Vec2i ssaoSize = EffectSize(_Settings._SSAOResolution);
+    _SSAOBlurShader -> SetUniform("u_Resolution", float(ssaoSize.x), float(ssaoSize.y));
     _SSAOBlurShader -> SetUniform("u_EnableBlur", _Settings._SSAOBlur ? 1 : 0);
     _SSAOBlurShader -> StopUsing();
   }
@@ -1623,6 +2827,7 @@ int DeferredRenderer::UpdateUniforms()
     _SSRShader -> SetUniform("u_GDepth", (int)DeferredTexSlot::_GDepth);
     _SSRShader -> SetUniform("u_SSRSource", (int)DeferredTexSlot::_SSRSource);
     _SSRShader -> SetUniform("u_EnvMap", (int)DeferredTexSlot::_EnvMap);
+    _SSRShader -> SetUniform("u_HiZ", (int)DeferredTexSlot::_SSRHiZ);
     _SSRShader -> SetUniform("u_View", V);
     _SSRShader -> SetUniform("u_Proj", P);
     _SSRShader -> SetUniform("u_Camera._Pos", camPos);
@@ -1632,7 +2837,8 @@ int DeferredRenderer::UpdateUniforms()
     _SSRShader -> SetUniform("u_Camera._FOV", camFov);
     if ( _DirtyStates & (unsigned long)DirtyState::RenderSettings )
     {
-      _SSRShader -> SetUniform("u_Resolution", float(RenderWidth()), float(RenderHeight()));
+      const Vec2i ssrSize = EffectSize(_Settings._SSRResolution);
+      _SSRShader -> SetUniform("u_Resolution", float(ssrSize.x), float(ssrSize.y));
       _SSRShader -> SetUniform("u_EnableSSR", _Settings._SSR ? 1 : 0);
       _SSRShader -> SetUniform("u_SSRMaxSteps", std::min(std::max(_Settings._SSRMaxSteps, 4), 128));
       _SSRShader -> SetUniform("u_SSRStepSize", _Settings._SSRStepSize);
@@ -1640,6 +2846,9 @@ int DeferredRenderer::UpdateUniforms()
       _SSRShader -> SetUniform("u_SSRThickness", _Settings._SSRThickness);
       _SSRShader -> SetUniform("u_SSRMaxRoughness", _Settings._SSRMaxRoughness);
       _SSRShader -> SetUniform("u_SSRFade", _Settings._SSRFade);
+      _SSRShader -> SetUniform("u_SSRTraceMode", ( ( SSRTraceMode::HiZ == _Settings._SSRTraceMode ) && ( _SSRHiZNbLevels > 0 ) ) ? 1 : 0);
+      _SSRShader -> SetUniform("u_HiZSize", float(RenderWidth()), float(RenderHeight()));
+      _SSRShader -> SetUniform("u_HiZMaxLevel", std::max(_SSRHiZNbLevels - 1, 0));
       _SSRShader -> SetUniform("u_EnableEnvMap", (int)_Settings._EnableSkybox);
       _SSRShader -> SetUniform("u_EnvMapRotation", _Settings._SkyBoxRotation / 360.f);
       _SSRShader -> SetUniform("u_EnvMapRes", (float)_Scene.GetEnvMap().GetWidth(), (float)_Scene.GetEnvMap().GetHeight());
@@ -1684,6 +2893,8 @@ int DeferredRenderer::UpdateUniforms()
       _LightingShader -> SetUniform("u_EnableShadowMapping", ( _Settings._ShadowMapping && _HasShadowLight ) ? ( 1 ) : ( 0 ));
       _LightingShader -> SetUniform("u_NbShadowCasters", static_cast<int>(_ShadowCasters.size()));
       _LightingShader -> SetUniform("u_ShadowBias", _Settings._ShadowBias);
+      _LightingShader -> SetUniform("u_ShadowViewPos", camPos);
+      _LightingShader -> SetUniform("u_ShadowViewDir", camForward);
       for ( int i = 0; i < static_cast<int>(_ShadowCasters.size()); ++i )
       {
         const ShadowCaster & caster = _ShadowCasters[i];
@@ -1693,7 +2904,13 @@ int DeferredRenderer::UpdateUniforms()
         _LightingShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_Far"), caster._Far);
         _LightingShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_Pos"), caster._Pos);
         _LightingShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_Dir"), caster._Dir);
-        _LightingShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_DirectionalViewProj"), caster._DirectionalViewProj);
+        _LightingShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_NbCascades"), caster._NbCascades);
+        _LightingShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_CascadeSplits"), caster._CascadeSplits);
+        if ( LightType::DistantLight == caster._Type )
+        {
+          for ( int cascade = 0; cascade < caster._NbCascades; ++cascade )
+            _LightingShader -> SetUniform("u_Shadow2DViewProj[" + std::to_string(caster._Layer + cascade) + "]", caster._CascadeViewProj[cascade]);
+        }
         for ( int face = 0; face < 6; ++face )
           _LightingShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_CubeViewProj[" + std::to_string(face) + "]"), caster._CubeViewProj[face]);
       }
@@ -1732,6 +2949,30 @@ int DeferredRenderer::UpdateUniforms()
       _LightingShader -> SetUniform("u_ShowLights", (int)_Settings._ShowLights);
     }
 
+    if ( ( _DirtyStates & (unsigned long)DirtyState::RenderSettings )
+      || ( _DirtyStates & (unsigned long)DirtyState::SceneLights )
+      || ( _DirtyStates & (unsigned long)DirtyState::SceneCamera ) )
+    {
+      _NbLightClusterRefs = 0;
+      _MaxLightsPerCluster = 0;
+
+      const bool clustered = _Settings._LightClustering && ( 0 == BuildLightClusters(V, top, right) );
+      _LightingShader -> SetUniform("u_EnableLightClusters", clustered ? 1 : 0);
+      _LightingShader -> SetUniform("u_LightClusters", (int)DeferredTexSlot::_LightClusters);
+      _LightingShader -> SetUniform("u_LightClusterIndices", (int)DeferredTexSlot::_LightIndices);
+      if ( clustered )
+      {
+        float zNear = 0.1f, zFar = 1000.f;
+        _Scene.GetCamera().GetZNearFar(zNear, zFar);
+        zNear = std::max(zNear, 0.001f);
+        zFar = std::max(zFar, zNear * 2.f);
+
+        const Vec3i grid = glm::clamp(_Settings._LightClusterGrid, Vec3i(1), Vec3i(S_MaxDeferredLightClusterDim));
+        _LightingShader -> SetUniform("u_LightClusterGrid", grid);
+        _LightingShader -> SetUniform("u_LightClusterDepth", zNear, grid.z / std::log(zFar / zNear));
+      }
+    }
+
     if ( _DirtyStates & (unsigned long)DirtyState::RenderSettings )
     {
       _LightingShader -> SetUniform("u_BackgroundColor", _Settings._BackgroundColor);
@@ -1755,14 +2996,17 @@ int DeferredRenderer::UpdateUniforms()
     _LightingShader -> StopUsing();
   }
 
-  if ( _WireframeShader )
+  for ( ShaderProgram * wireframeShader : { _WireframeShader.get(), _WireframeIndirectShader.get() } )
   {
-    _WireframeShader -> Use();
-    _WireframeShader -> SetUniform("u_CameraPos", camPos);
-    _WireframeShader -> SetUniform("u_View", V);
-    _WireframeShader -> SetUniform("u_Proj", P);
-    _WireframeShader -> SetUniform("u_WireColor", S_WireColor);
-    _WireframeShader -> StopUsing();
+    if ( !wireframeShader )
+      continue;
+
+    wireframeShader -> Use();
+    wireframeShader -> SetUniform("u_CameraPos", camPos);
+    wireframeShader -> SetUniform("u_View", V);
+    wireframeShader -> SetUniform("u_Proj", P);
+    wireframeShader -> SetUniform("u_WireColor", S_WireColor);
+    wireframeShader -> StopUsing();
   }
 
   if ( _TransparentShader )
@@ -1815,6 +3059,7 @@ int DeferredRenderer::UpdateUniforms()
       _TransparentShader -> SetUniform("u_EnablePBRDirectLighting", _Settings._PBRDirectLighting ? 1 : 0);
       _TransparentShader -> SetUniform("u_DirectLightIntensity", _Settings._DirectLightIntensity);
       _TransparentShader -> SetUniform("u_SpecularIBLMaxRoughness", _Settings._SpecularIBLMaxRoughness);
+      _TransparentShader -> SetUniform("u_WeightedOIT", ( TransparencyMode::WeightedBlended == _Settings._TransparencyMode ) ? 1 : 0);
       float transparentEnvMipCount = 1.f;
       if ( _Scene.GetEnvMap().GetWidth() > 0 && _Scene.GetEnvMap().GetHeight() > 0 )
       {
@@ -1835,6 +3080,8 @@ int DeferredRenderer::UpdateUniforms()
       _TransparentShader -> SetUniform("u_EnableShadowMapping", ( _Settings._ShadowMapping && _HasShadowLight ) ? ( 1 ) : ( 0 ));
       _TransparentShader -> SetUniform("u_NbShadowCasters", static_cast<int>(_ShadowCasters.size()));
       _TransparentShader -> SetUniform("u_ShadowBias", _Settings._ShadowBias);
+      _TransparentShader -> SetUniform("u_ShadowViewPos", camPos);
+      _TransparentShader -> SetUniform("u_ShadowViewDir", camForward);
       for ( int i = 0; i < static_cast<int>(_ShadowCasters.size()); ++i )
       {
         const ShadowCaster & caster = _ShadowCasters[i];
@@ -1844,7 +3091,13 @@ int DeferredRenderer::UpdateUniforms()
         _TransparentShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_Far"), caster._Far);
         _TransparentShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_Pos"), caster._Pos);
         _TransparentShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_Dir"), caster._Dir);
-        _TransparentShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_DirectionalViewProj"), caster._DirectionalViewProj);
+        _TransparentShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_NbCascades"), caster._NbCascades);
+        _TransparentShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_CascadeSplits"), caster._CascadeSplits);
+        if ( LightType::DistantLight == caster._Type )
+        {
+          for ( int cascade = 0; cascade < caster._NbCascades; ++cascade )
+            _TransparentShader -> SetUniform("u_Shadow2DViewProj[" + std::to_string(caster._Layer + cascade) + "]", caster._CascadeViewProj[cascade]);
+        }
         for ( int face = 0; face < 6; ++face )
           _TransparentShader -> SetUniform(GLUtil::UniformArrayElementName("u_ShadowCasters", i, "_CubeViewProj[" + std::to_string(face) + "]"), caster._CubeViewProj[face]);
       }
@@ -1853,6 +3106,24 @@ int DeferredRenderer::UpdateUniforms()
     _TransparentShader -> StopUsing();
   }
 
+  if ( _BilateralUpsampleShader )
+  {
+    _BilateralUpsampleShader -> Use();
+    _BilateralUpsampleShader -> SetUniform("u_GDepth", (int)DeferredTexSlot::_GDepth);
+    _BilateralUpsampleShader -> SetUniform("u_GNormal", (int)DeferredTexSlot::_GNormal);
+    _BilateralUpsampleShader -> SetUniform("u_GPosition", (int)DeferredTexSlot::_GPosition);
+    _BilateralUpsampleShader -> SetUniform("u_CameraPos", camPos);
+    _BilateralUpsampleShader -> StopUsing();
+  }
+
+  if ( _OITResolveShader )
+  {
+    _OITResolveShader -> Use();
+    _OITResolveShader -> SetUniform("u_OITAccum", (int)DeferredTexSlot::_OITAccum);
+    _OITResolveShader -> SetUniform("u_OITRevealage", (int)DeferredTexSlot::_OITRevealage);
+    _OITResolveShader -> StopUsing();
+  }
+
   if ( _CompositeShader )
   {
     _CompositeShader -> Use();
@@ -1889,29 +3160,9 @@ int DeferredRenderer::RenderShadowMap()
   glDisable(GL_BLEND);
   glDisable(GL_CULL_FACE);
 
-  const std::vector<MeshInstance> & instances = _Scene.GetMeshInstances();
-  auto renderOpaqueInstances = [&]( ShaderProgram * iShader )
-  {
-    for ( int instID : _OpaqueMeshInstanceIDs )
-    {
-      if ( ( instID < 0 ) || ( static_cast<size_t>(instID) >= instances.size() ) )
-        continue;
-
-      const MeshInstance & inst = instances[instID];
-      int meshID = inst._MeshID;
-      if ( ( meshID < 0 ) || ( static_cast<size_t>(meshID) >= _MeshVAOs.size() ) )
-        continue;
-
-      GLuint vao = _MeshVAOs[meshID];
-      int idxCount = _MeshIndexCount[meshID];
-      if ( !vao || idxCount <= 0 )
-        continue;
-
-      iShader -> SetUniform("u_Model", inst._Transform);
-      glBindVertexArray(vao);
-      glDrawElements(GL_TRIANGLES, idxCount, GL_UNSIGNED_INT, 0);
-    }
-  };
+  const bool indirect = UseIndirectDraws();
+  ShaderProgram * directionalShader = indirect ? _ShadowDirectionalIndirectShader.get() : _ShadowDirectionalShader.get();
+  ShaderProgram * cubeShader = indirect ? _ShadowCubeIndirectShader.get() : _ShadowCubeShader.get();
 
   for ( const ShadowCaster & caster : _ShadowCasters )
   {
@@ -1920,41 +3171,221 @@ int DeferredRenderer::RenderShadowMap()
       if ( !_Shadow2DMapTEX._Handle )
         continue;
 
-      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _Shadow2DMapTEX._Handle, 0, caster._Layer);
-      glClear(GL_DEPTH_BUFFER_BIT);
+      for ( int cascade = 0; cascade < caster._NbCascades; ++cascade )
+      {
+        const int layer = caster._Layer + cascade;
+        const Mat4x4 & viewProj = caster._CascadeViewProj[cascade];
+        if ( ( layer < static_cast<int>(_DirectionalShadowCache.size()) )
+          && IsShadowLayerCached(_DirectionalShadowCache[layer], 0, caster._LightIndex, caster._Far, viewProj) )
+        {
+          _NbShadowCacheHits++;
+          continue;
+        }
+        _NbShadowLayersRendered++;
+
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _Shadow2DMapTEX._Handle, 0, layer);
+        glClear(GL_DEPTH_BUFFER_BIT);
 
-      _ShadowDirectionalShader -> Use();
-      _ShadowDirectionalShader -> SetUniform("u_LightViewProj", caster._DirectionalViewProj);
-      renderOpaqueInstances(_ShadowDirectionalShader.get());
-      _ShadowDirectionalShader -> StopUsing();
+        CullOpaqueInstances(CullListShadow, CullPassShadow, viewProj, indirect, false);
+
+        directionalShader -> Use();
+        directionalShader -> SetUniform("u_LightViewProj", viewProj);
+        DrawOpaqueInstances(*directionalShader, indirect, false, CullListShadow);
+        directionalShader -> StopUsing();
+      }
     }
     else
     {
       if ( !_ShadowCubeMapTEX._Handle )
         continue;
 
-      _ShadowCubeShader -> Use();
-      _ShadowCubeShader -> SetUniform("u_LightPos", caster._Pos);
-      _ShadowCubeShader -> SetUniform("u_FarPlane", caster._Far);
-
       for ( int face = 0; face < 6; ++face )
       {
+        if ( ( caster._Layer < static_cast<int>(_LocalShadowCache.size()) )
+          && IsShadowLayerCached(_LocalShadowCache[caster._Layer], face, caster._LightIndex, caster._Far, caster._CubeViewProj[face]) )
+        {
+          _NbShadowCacheHits++;
+          continue;
+        }
+        _NbShadowLayersRendered++;
+
         glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _ShadowCubeMapTEX._Handle, 0, caster._Layer * 6 + face);
         glClear(GL_DEPTH_BUFFER_BIT);
-        _ShadowCubeShader -> SetUniform("u_LightViewProj", caster._CubeViewProj[face]);
-        renderOpaqueInstances(_ShadowCubeShader.get());
-      }
 
-      _ShadowCubeShader -> StopUsing();
+        // The culling dispatch binds its own program
+        CullOpaqueInstances(CullListShadow, CullPassShadow, caster._CubeViewProj[face], indirect, false);
+
+        cubeShader -> Use();
+        cubeShader -> SetUniform("u_LightPos", caster._Pos);
+        cubeShader -> SetUniform("u_FarPlane", caster._Far);
+        cubeShader -> SetUniform("u_LightViewProj", caster._CubeViewProj[face]);
+        DrawOpaqueInstances(*cubeShader, indirect, false, CullListShadow);
+        cubeShader -> StopUsing();
+      }
     }
   }
 
+  // Every selected layer saw the moved instances, the unselected ones may be reassigned later
+  _ShadowDirtyBounds.clear();
+  for ( size_t layer = _LocalShadowCasterCount; layer < _LocalShadowCache.size(); ++layer )
+    _LocalShadowCache[layer]._Valid.fill(false);
+  for ( size_t layer = _DirectionalShadowLayerCount; layer < _DirectionalShadowCache.size(); ++layer )
+    _DirectionalShadowCache[layer]._Valid.fill(false);
+
   glBindVertexArray(0);
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// BuildLightClusters
+// Assigns the lights to the froxels of the camera frustum : screen tiles split in exponential depth slices.
+// Distant lights reach every cluster, local lights the clusters touched by their influence sphere.
+// ----------------------------------------------------------------------------
+int DeferredRenderer::BuildLightClusters( const Mat4x4 & iView, float iTop, float iRight )
+{
+  const Vec3i grid = glm::clamp(_Settings._LightClusterGrid, Vec3i(1), Vec3i(S_MaxDeferredLightClusterDim));
+  const int nbClusters = grid.x * grid.y * grid.z;
+
+  float zNear = 0.1f, zFar = 1000.f;
+  _Scene.GetCamera().GetZNearFar(zNear, zFar);
+  zNear = std::max(zNear, 0.001f);
+  zFar = std::max(zFar, zNear * 2.f);
+  const float tanHalfX = iRight / zNear;
+  const float tanHalfY = iTop / zNear;
+  const float logDepthRatio = std::log(zFar / zNear);
+
+  auto sliceDepth = [&]( int iSlice ) { return zNear * std::exp(logDepthRatio * iSlice / grid.z); };
+  auto depthSlice = [&]( float iDepth )
+  {
+    const float slice = std::log(std::max(iDepth, zNear) / zNear) / logDepthRatio * grid.z;
+    return std::clamp(static_cast<int>(slice), 0, grid.z - 1);
+  };
+
+  // Screen range [0, 1] of the view space interval [iLow, iHigh] between the depths iNear and iFar
+  auto screenRange = [&]( float iLow, float iHigh, float iTanHalf, float iNear, float iFar, float & oLow, float & oHigh )
+  {
+    oLow = .5f + .5f * iLow / ( ( ( iLow < 0.f ) ? iNear : iFar ) * iTanHalf );
+    oHigh = .5f + .5f * iHigh / ( ( ( iHigh > 0.f ) ? iNear : iFar ) * iTanHalf );
+  };
+
+  _LightClusterRefs.clear();
+  int nbDistantLights = 0;
+
+  const int nbLights = std::min(_Scene.GetNbLights(), S_MaxDeferredLights);
+  for ( int i = 0; i < nbLights; ++i )
+  {
+    const Light * curLight = _Scene.GetLight(i);
+    if ( !curLight )
+      continue;
+
+    if ( LightType::DistantLight == (LightType) curLight -> _Type )
+    {
+      _LightClusterRefs.push_back(Vec2i(-1, i));
+      nbDistantLights++;
+      continue;
+    }
+
+    Vec3 center;
+    const float radius = LightInfluenceRadius(*curLight, _Settings._DirectLightIntensity, _Settings._LightClusterThreshold, center);
+    const Vec3 viewCenter = MathUtil::TransformPoint(center, iView);
+    const float depth = -viewCenter.z;
+    if ( ( depth + radius < zNear ) || ( depth - radius > zFar ) )
+      continue;
+
+    const int firstSlice = depthSlice(depth - radius);
+    const int lastSlice = depthSlice(depth + radius);
+    for ( int z = firstSlice; z <= lastSlice; ++z )
+    {
+      const float sliceNear = sliceDepth(z);
+      const float sliceFar = sliceDepth(z + 1);
+      const float sphereNear = std::max(sliceNear, depth - radius);
+      const float sphereFar = std::min(sliceFar, depth + radius);
+
+      float lowX, highX, lowY, highY;
+      screenRange(viewCenter.x - radius, viewCenter.x + radius, tanHalfX, sphereNear, sphereFar, lowX, highX);
+      screenRange(viewCenter.y - radius, viewCenter.y + radius, tanHalfY, sphereNear, sphereFar, lowY, highY);
+      if ( ( highX < 0.f ) || ( lowX > 1.f ) || ( highY < 0.f ) || ( lowY > 1.f ) )
+        continue;
+
+      const int firstX = std::clamp(static_cast<int>(lowX * grid.x), 0, grid.x - 1);
+      const int lastX = std::clamp(static_cast<int>(highX * grid.x), 0, grid.x - 1);
+      const int firstY = std::clamp(static_cast<int>(lowY * grid.y), 0, grid.y - 1);
+      const int lastY = std::clamp(static_cast<int>(highY * grid.y), 0, grid.y - 1);
+      for ( int y = firstY; y <= lastY; ++y )
+      {
+        const float tileLowY = ( 2.f * y / grid.y - 1.f ) * tanHalfY;
+        const float tileHighY = ( 2.f * ( y + 1 ) / grid.y - 1.f ) * tanHalfY;
+        for ( int x = firstX; x <= lastX; ++x )
+        {
+          const float tileLowX = ( 2.f * x / grid.x - 1.f ) * tanHalfX;
+          const float tileHighX = ( 2.f * ( x + 1 ) / grid.x - 1.f ) * tanHalfX;
+
+          // View space box of the froxel
+          const Vec3 low(std::min(tileLowX * sliceNear, tileLowX * sliceFar), std::min(tileLowY * sliceNear, tileLowY * sliceFar), -sliceFar);
+          const Vec3 high(std::max(tileHighX * sliceNear, tileHighX * sliceFar), std::max(tileHighY * sliceNear, tileHighY * sliceFar), -sliceNear);
+          if ( DistanceToBox2(viewCenter, low, high) > radius * radius )
+            continue;
+
+          _LightClusterRefs.push_back(Vec2i(( z * grid.y + y ) * grid.x + x, i));
+        }
+      }
+    }
+  }
+
+  // Counting sort of the references : each cluster list keeps the light order
+  _LightClusterData.assign(nbClusters * 2, 0);
+  for ( const Vec2i & ref : _LightClusterRefs )
+  {
+    if ( ref.x >= 0 )
+      _LightClusterData[ref.x * 2 + 1]++;
+  }
+
+  int nbRefs = 0;
+  _MaxLightsPerCluster = 0;
+  for ( int c = 0; c < nbClusters; ++c )
+  {
+    const int count = nbDistantLights + _LightClusterData[c * 2 + 1];
+    _LightClusterData[c * 2] = nbRefs;
+    _LightClusterData[c * 2 + 1] = 0;
+    nbRefs += count;
+    _MaxLightsPerCluster = std::max(_MaxLightsPerCluster, count);
+  }
+  _NbLightClusterRefs = nbRefs;
+
+  bool reallocateIndices = !_LightIndicesTBO._Handle;
+  if ( nbRefs > static_cast<int>(_LightClusterIndices.size()) )
+  {
+    _LightClusterIndices.resize(std::max(nbRefs, 2 * static_cast<int>(_LightClusterIndices.size())));
+    reallocateIndices = true;
+  }
+  if ( _LightClusterIndices.empty() )
+    _LightClusterIndices.resize(1);
+
+  for ( const Vec2i & ref : _LightClusterRefs )
+  {
+    const int firstCluster = ( ref.x >= 0 ) ? ( ref.x ) : ( 0 );
+    const int lastCluster = ( ref.x >= 0 ) ? ( ref.x ) : ( nbClusters - 1 );
+    for ( int c = firstCluster; c <= lastCluster; ++c )
+    {
+      int & count = _LightClusterData[c * 2 + 1];
+      _LightClusterIndices[_LightClusterData[c * 2] + count] = ref.y;
+      count++;
+    }
+  }
+
+  const GLsizeiptr clusterBytes = sizeof(int) * _LightClusterData.size();
+  if ( !GLUtil::UpdateTBO(_LightClustersTBO, clusterBytes, _LightClusterData.data()) )
+    GLUtil::InitializeTBO(_LightClustersTBO, clusterBytes, _LightClusterData.data(), GL_RG32I);
+
+  const GLsizeiptr indicesBytes = sizeof(int) * _LightClusterIndices.size();
+  if ( reallocateIndices || !GLUtil::UpdateTBO(_LightIndicesTBO, indicesBytes, _LightClusterIndices.data()) )
+    GLUtil::InitializeTBO(_LightIndicesTBO, indicesBytes, _LightClusterIndices.data(), GL_R32I);
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // RenderSSAO
 // ----------------------------------------------------------------------------
@@ -1968,8 +3399,9 @@ int DeferredRenderer::RenderSSAO()
   glDisable(GL_CULL_FACE);
   glDisable(GL_BLEND);
 
+  const Vec2i ssaoSize = EffectSize(_Settings._SSAOResolution);
   glBindFramebuffer(GL_FRAMEBUFFER, _SSAOFBO._Handle);
-  glViewport(0, 0, RenderWidth(), RenderHeight());
+  glViewport(0, 0, ssaoSize.x, ssaoSize.y);
   glClearColor(1.f, 1.f, 1.f, 1.f);
   glClear(GL_COLOR_BUFFER_BIT);
 
@@ -1979,7 +3411,7 @@ int DeferredRenderer::RenderSSAO()
   _SSAOShader -> StopUsing();
 
   glBindFramebuffer(GL_FRAMEBUFFER, _SSAOBlurFBO._Handle);
-  glViewport(0, 0, RenderWidth(), RenderHeight());
+  glViewport(0, 0, ssaoSize.x, ssaoSize.y);
   glClearColor(1.f, 1.f, 1.f, 1.f);
   glClear(GL_COLOR_BUFFER_BIT);
 
@@ -2003,8 +3435,9 @@ int DeferredRenderer::RenderSSR()
   if ( !_SSRFBO._Handle || !_SSRShader )
     return 1;
 
+  const Vec2i ssrSize = EffectSize(_Settings._SSRResolution);
   glBindFramebuffer(GL_FRAMEBUFFER, _SSRFBO._Handle);
-  glViewport(0, 0, RenderWidth(), RenderHeight());
+  glViewport(0, 0, ssrSize.x, ssrSize.y);
 
   glDisable(GL_DEPTH_TEST);
   glDepthMask(GL_FALSE);
@@ -2022,6 +3455,48 @@ int DeferredRenderer::RenderSSR()
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// EffectSize
+// ----------------------------------------------------------------------------
+Vec2i DeferredRenderer::EffectSize( EffectResolution iResolution ) const
+{
+  const int divisor = ( EffectResolution::Quarter == iResolution ) ? 4 : ( ( EffectResolution::Half == iResolution ) ? 2 : 1 );
+  return Vec2i(std::max(( RenderWidth() + divisor - 1 ) / divisor, 1), std::max(( RenderHeight() + divisor - 1 ) / divisor, 1));
+}
+
+// ----------------------------------------------------------------------------
+// UpsampleEffect
+// ----------------------------------------------------------------------------
+int DeferredRenderer::UpsampleEffect( const GLTexture & iInput, GLFrameBuffer & ioTarget, EffectResolution iResolution, const Vec4 & iBackground )
+{
+  if ( !ioTarget._Handle || !_BilateralUpsampleShader )
+    return 1;
+
+  glBindFramebuffer(GL_FRAMEBUFFER, ioTarget._Handle);
+  glViewport(0, 0, RenderWidth(), RenderHeight());
+
+  glDisable(GL_DEPTH_TEST);
+  glDepthMask(GL_FALSE);
+  glDisable(GL_CULL_FACE);
+  glDisable(GL_BLEND);
+
+  // Joint bilateral upsample : the full resolution depth and normals reject taps across edges
+  const Vec2i inputSize = EffectSize(iResolution);
+  _BilateralUpsampleShader -> Use();
+  _BilateralUpsampleShader -> SetUniform("u_Input", (int)iInput._Slot);
+  _BilateralUpsampleShader -> SetUniform("u_InputResolution", float(inputSize.x), float(inputSize.y));
+  _BilateralUpsampleShader -> SetUniform("u_Background", iBackground);
+  GLUtil::ActivateTexture(iInput);
+  GLUtil::ActivateTexture(_GDepthTEX);
+  GLUtil::ActivateTexture(_GNormalTEX);
+  GLUtil::ActivateTexture(_GPositionTEX);
+  _Quad.Render(*_BilateralUpsampleShader);
+  _BilateralUpsampleShader -> StopUsing();
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // UpdateSSRSource
 // ----------------------------------------------------------------------------
@@ -2054,6 +3529,9 @@ int DeferredRenderer::RenderTransparent()
   if ( _TransparentMeshInstanceIDs.empty() || instances.empty() )
     return 0;
 
+  if ( ( TransparencyMode::WeightedBlended == _Settings._TransparencyMode ) && _OITFBO._Handle && _OITResolveShader )
+    return RenderTransparentWeightedBlended();
+
   SortTransparentInstances();
   
   Mat4x4 view;
@@ -2083,26 +3561,30 @@ int DeferredRenderer::RenderTransparent()
 
     const MeshInstance & inst = instances[instID];
     int meshID = inst._MeshID;
-    if ( ( meshID < 0 ) || ( static_cast<size_t>(meshID) >= _MeshVAOs.size() ) )
+    if ( ( meshID < 0 ) || ( static_cast<size_t>(meshID) >= _MeshIndexCount.size() ) )
       continue;
 
-    GLuint vao = _MeshVAOs[meshID];
-    GLuint ebo = _MeshEBOs[meshID];
     int idxCount = _MeshIndexCount[meshID];
-    if ( !vao || !ebo || ( idxCount <= 0 ) )
+    if ( !_MeshVAO || !_MeshEBO || ( idxCount <= 0 ) )
       continue;
 
-    this -> UpdateSortedTransparentMeshIndices(meshID, inst._Transform, view);
+    const bool orderChanged = this -> UpdateSortedTransparentMeshIndices(meshID, inst._Transform, view);
 
     std::vector<uint32_t> & sortedIndices = _TransparentMeshSortedIndices[meshID];
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(sortedIndices.size() * sizeof(uint32_t)), sortedIndices.data());
+    // Rewrites the mesh range of the merged index buffer, only when the order changed
+    const size_t firstIndexOffset = static_cast<size_t>(_MeshFirstIndex[meshID]) * sizeof(uint32_t);
+    glBindVertexArray(_MeshVAO);
+    if ( orderChanged )
+    {
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _MeshEBO);
+      glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(firstIndexOffset), static_cast<GLsizeiptr>(sortedIndices.size() * sizeof(uint32_t)), sortedIndices.data());
+    }
 
     _TransparentShader -> SetUniform("u_Model", inst._Transform);
     _TransparentShader -> SetUniform("u_MaterialID", inst._MaterialID);
-    glDrawElements(GL_TRIANGLES, idxCount, GL_UNSIGNED_INT, 0);
+    glDrawElementsBaseVertex(GL_TRIANGLES, idxCount, GL_UNSIGNED_INT, reinterpret_cast<void *>(firstIndexOffset), _MeshBaseVertex[meshID]);
+    _NbDrawCalls++;
     glBindVertexArray(0);
   }
 
@@ -2118,12 +3600,90 @@ int DeferredRenderer::RenderTransparent()
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// RenderTransparentWeightedBlended
+// ----------------------------------------------------------------------------
+int DeferredRenderer::RenderTransparentWeightedBlended()
+{
+  const std::vector<MeshInstance> & instances = _Scene.GetMeshInstances();
+
+  glBindFramebuffer(GL_FRAMEBUFFER, _OITFBO._Handle);
+  glViewport(0, 0, RenderWidth(), RenderHeight());
+
+  const GLfloat accumClear[4] = { 0.f, 0.f, 0.f, 0.f };
+  const GLfloat revealageClear[4] = { 1.f, 1.f, 1.f, 1.f };
+  glClearBufferfv(GL_COLOR, 0, accumClear);
+  glClearBufferfv(GL_COLOR, 1, revealageClear);
+
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LEQUAL);
+  glDepthMask(GL_FALSE);
+  glEnable(GL_CULL_FACE);
+  glCullFace(GL_BACK);
+  glEnable(GL_BLEND);
+  glBlendFunci(0, GL_ONE, GL_ONE);
+  glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+
+  _TransparentShader -> Use();
+  BindLightingTextures();
+
+  // Blending is commutative : instances and triangles are drawn in their stored order
+  glBindVertexArray(_MeshVAO);
+  for ( int instID : _TransparentMeshInstanceIDs )
+  {
+    if ( ( instID < 0 ) || ( static_cast<size_t>(instID) >= instances.size() ) )
+      continue;
+
+    const MeshInstance & inst = instances[instID];
+    int meshID = inst._MeshID;
+    if ( ( meshID < 0 ) || ( static_cast<size_t>(meshID) >= _MeshIndexCount.size() ) )
+      continue;
+
+    int idxCount = _MeshIndexCount[meshID];
+    if ( !_MeshVAO || !_MeshEBO || ( idxCount <= 0 ) )
+      continue;
+
+    const size_t firstIndexOffset = static_cast<size_t>(_MeshFirstIndex[meshID]) * sizeof(uint32_t);
+    _TransparentShader -> SetUniform("u_Model", inst._Transform);
+    _TransparentShader -> SetUniform("u_MaterialID", inst._MaterialID);
+    glDrawElementsBaseVertex(GL_TRIANGLES, idxCount, GL_UNSIGNED_INT, reinterpret_cast<void *>(firstIndexOffset), _MeshBaseVertex[meshID]);
+    _NbDrawCalls++;
+  }
+  glBindVertexArray(0);
+  _TransparentShader -> StopUsing();
+
+  // Resolve : average color over the lighting target, weighted by the total revealage
+  glBindFramebuffer(GL_FRAMEBUFFER, _LightingFBO._Handle);
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_CULL_FACE);
+  glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+
+  _OITResolveShader -> Use();
+  GLUtil::ActivateTexture(_OITAccumTEX);
+  GLUtil::ActivateTexture(_OITRevealageTEX);
+  _Quad.Render(*_OITResolveShader);
+  _OITResolveShader -> StopUsing();
+
+  glDisable(GL_BLEND);
+  glDepthMask(GL_TRUE);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // RenderToTexture
 // ----------------------------------------------------------------------------
 int DeferredRenderer::RenderToTexture()
 {
   _PassEnabled.fill(false);
+  _NbDrawCalls = 0;
+  _NbTransparentSorts = 0;
+  _NbShadowLayersRendered = 0;
+  _NbShadowCacheHits = 0;
+
+  const bool indirect = UseIndirectDraws();
+  BeginCulling(indirect);
 
   if ( _Settings._ShadowMapping && _HasShadowLight )
   {
@@ -2132,7 +3692,8 @@ int DeferredRenderer::RenderToTexture()
     EndTimer(TimingShadowMap);
   }
 
-  if (_GeometryShader)
+  ShaderProgram * geometryShader = indirect ? _GeometryIndirectShader.get() : _GeometryShader.get();
+  if ( geometryShader )
   {
     BeginTimer(TimingGBuffer);
 
@@ -2149,38 +3710,18 @@ int DeferredRenderer::RenderToTexture()
     glClearColor(0.f, 0.f, 0.f, 1.f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // now actually clears depth
 
-    _GeometryShader -> Use();
+    // Occlusion is tested against the previous frame pyramid, reprojected with its own view-projection
+    CullOpaqueInstances(CullListCamera, CullPassCamera, _CameraViewProj, indirect, true);
+
+    geometryShader -> Use();
 
     GLUtil::ActivateTexture(_TexIndTBO._Tex);
     GLUtil::ActivateTexture(_TexArrayTEX);
     GLUtil::ActivateTexture(_MaterialsTEX);
 
-    const std::vector<MeshInstance> & instances = _Scene.GetMeshInstances();
-    for ( int instID : _OpaqueMeshInstanceIDs )
-    {
-      if ( ( instID < 0 ) || ( static_cast<size_t>(instID) >= instances.size() ) )
-        continue;
-
-      const MeshInstance & inst = instances[instID];
-      int meshID = inst._MeshID;
-      if ( ( meshID < 0 ) || ( static_cast<size_t>(meshID) >= _MeshVAOs.size() ) )
-        continue;
-
-      // Per-instance uniforms expected by geometry shader
-      _GeometryShader -> SetUniform("u_Model", inst._Transform);
-      _GeometryShader -> SetUniform("u_MaterialID", inst._MaterialID);
-
-      GLuint vao = _MeshVAOs[meshID];
-      int idxCount = _MeshIndexCount[meshID];
-      if ( vao && ( idxCount > 0 ) )
-      {
-        glBindVertexArray(vao);
-        glDrawElements(GL_TRIANGLES, idxCount, GL_UNSIGNED_INT, 0);
-      }
-    }
+    DrawOpaqueInstances(*geometryShader, indirect, true, CullListCamera);
 
-    glBindVertexArray(0);
-    _GeometryShader -> StopUsing();
+    geometryShader -> StopUsing();
 
     // Disable depth writes and depth test for subsequent fullscreen passes.
     glDepthMask(GL_FALSE);   // stop writing depth for fullscreen passes
@@ -2189,6 +3730,11 @@ int DeferredRenderer::RenderToTexture()
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    if ( indirect && _GpuCullingSupported && _EnableOcclusionCulling )
+      BuildHiZ(_CameraViewProj);
+    else
+      _HiZValid = false;
+
     EndTimer(TimingGBuffer);
   }
   else
@@ -2202,13 +3748,34 @@ int DeferredRenderer::RenderToTexture()
     BeginTimer(TimingSSAO);
     RenderSSAO();
     EndTimer(TimingSSAO);
+
+    if ( EffectResolution::Full != _Settings._SSAOResolution )
+    {
+      BeginTimer(TimingSSAOUpsample);
+      UpsampleEffect(_SSAOBlurTEX, _SSAOUpsampleFBO, _Settings._SSAOResolution, Vec4(1.f, 0.f, 0.f, 1.f));
+      EndTimer(TimingSSAOUpsample);
+    }
   }
 
   if ( ssrPassEnabled )
   {
+    if ( SSRTraceMode::HiZ == _Settings._SSRTraceMode )
+    {
+      BeginTimer(TimingSSRHiZ);
+      BuildSSRHiZ();
+      EndTimer(TimingSSRHiZ);
+    }
+
     BeginTimer(TimingSSR);
     RenderSSR();
     EndTimer(TimingSSR);
+
+    if ( EffectResolution::Full != _Settings._SSRResolution )
+    {
+      BeginTimer(TimingSSRUpsample);
+      UpsampleEffect(_SSRTEX, _SSRUpsampleFBO, _Settings._SSRResolution, Vec4(0.f));
+      EndTimer(TimingSSRUpsample);
+    }
   }
 
   if (_LightingShader)
@@ -2244,7 +3811,8 @@ int DeferredRenderer::RenderToTexture()
     SetTimingEnabled(TimingTransparency, false);
 
   // DEBUG : Wireframe overlay. Render lines into lighting target on top of shaded image
-  if ( ( _DebugMode & (int)DeferredDebugModes::Wires ) && _WireframeShader )
+  ShaderProgram * wireframeShader = indirect ? _WireframeIndirectShader.get() : _WireframeShader.get();
+  if ( ( _DebugMode & (int)DeferredDebugModes::Wires ) && wireframeShader )
   { 
     BeginTimer(TimingWireframe);
 
@@ -2264,33 +3832,13 @@ int DeferredRenderer::RenderToTexture()
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    _WireframeShader -> Use();
+    wireframeShader -> Use();
 
     this -> BindLightingTextures();
 
-    const std::vector<MeshInstance> & instances2 = _Scene.GetMeshInstances();
-    for ( int instID : _OpaqueMeshInstanceIDs )
-    {
-      if ( ( instID < 0 ) || ( static_cast<size_t>(instID) >= instances2.size() ) )
-        continue;
-
-      const MeshInstance& inst = instances2[instID];
-      int meshID = inst._MeshID;
-      if ( ( meshID < 0 ) || ( static_cast<size_t>(meshID) >= _MeshVAOs.size() ) )
-        continue;
-
-      _WireframeShader -> SetUniform("u_Model", inst._Transform);
-
-      GLuint vao = _MeshVAOs[meshID];
-      int idxCount = _MeshIndexCount[meshID];
-      if ( vao && ( idxCount > 0 ) )
-      {
-        glBindVertexArray(vao);
-        glDrawElements(GL_TRIANGLES, idxCount, GL_UNSIGNED_INT, 0);
-      }
-    }
+    DrawOpaqueInstances(*wireframeShader, indirect, false, CullListCamera);
 
-    _WireframeShader -> StopUsing();
+    wireframeShader -> StopUsing();
 
     // Restore state
     glDisable(GL_BLEND);
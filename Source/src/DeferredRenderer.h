@@ -8,6 +8,7 @@
 #include "ShaderProgram.h"
 #include "PathUtils.h"
 #include "Light.h"
+#include "RadixSort.h"
 
 #include <array>
 #include <cstdint>
@@ -18,6 +19,10 @@ namespace RTRT
 {
 
 static const int S_MaxDeferredShadowCasters = 8;
+static const int S_MaxDeferredShadowCascades = 4;
+static const int S_MaxDeferredShadow2DLayers = 16; // Cascades of every distant light caster
+static const int S_MaxDeferredLights = 32;
+static const int S_MaxDeferredLightClusterDim = 64;
 
 struct DeferredTexSlot
 {
@@ -26,6 +31,7 @@ struct DeferredTexSlot
   static constexpr TextureSlot _GPosition     = 2;
   static constexpr TextureSlot _GMaterial     = 3;
   static constexpr TextureSlot _GDepth        = 4;
+  static constexpr TextureSlot _HiZ           = 4;  // Reuses the G-buffer depth slot : only sampled by the culling pass.
   static constexpr TextureSlot _GEmission     = 5; // Reuses the lighting slot while the lighting target is not sampled.
   static constexpr TextureSlot _Lighting      = 5;
   static constexpr TextureSlot _TexInd        = 6;
@@ -35,11 +41,16 @@ struct DeferredTexSlot
   static constexpr TextureSlot _ShadowCubeMap = 10;
   static constexpr TextureSlot _Shadow2DMap   = 11;
   static constexpr TextureSlot _SSAO          = 12;
+  static constexpr TextureSlot _SSRHiZ        = 12; // Reuses the SSAO slot : only sampled by the SSR pass.
   static constexpr TextureSlot _SSAOBlur      = 13;
   static constexpr TextureSlot _SSAONoise     = 14;
   static constexpr TextureSlot _SSR           = 14; // Reuses the SSAO noise slot outside the SSAO pass.
   static constexpr TextureSlot _SSRSource     = 5;  // Reuses the lighting slot outside the lighting/composite passes.
   static constexpr TextureSlot _BRDFLUT       = 15;
+  static constexpr TextureSlot _OITAccum      = 0;  // Reuses the G-buffer slots once the lighting pass is done.
+  static constexpr TextureSlot _OITRevealage  = 1;
+  static constexpr TextureSlot _LightClusters = 7;  // Buffer target next to the texture array : only sampled by the lighting pass.
+  static constexpr TextureSlot _LightIndices  = 8;  // Buffer target next to the materials texture.
 };
 
 enum class DeferredDebugModes
@@ -79,6 +90,24 @@ public:
   void SetAnisotropicLevel(int iLevel);
   int GetAnisotropicLevel() const { return _AnisotropicLevel; }
   float GetEffectiveShadowFar() const { return _ShadowFar; }
+  bool GetEnableMultiDrawIndirect() const { return _EnableMultiDrawIndirect; }
+  void SetEnableMultiDrawIndirect( bool iEnabled ) { _EnableMultiDrawIndirect = iEnabled; }
+  bool IsMultiDrawIndirectSupported() const { return _MultiDrawIndirectSupported; }
+  int GetNbDrawCalls() const { return _NbDrawCalls; }
+  bool GetEnableFrustumCulling() const { return _EnableFrustumCulling; }
+  void SetEnableFrustumCulling( bool iEnabled ) { _EnableFrustumCulling = iEnabled; }
+  bool GetEnableOcclusionCulling() const { return _EnableOcclusionCulling; }
+  void SetEnableOcclusionCulling( bool iEnabled ) { _EnableOcclusionCulling = iEnabled; _HiZValid = false; }
+  bool IsGpuCullingSupported() const { return _GpuCullingSupported; }
+  float GetTransparentSortThreshold() const { return _TransparentSortThreshold; }
+  void SetTransparentSortThreshold( float iDegrees ) { _TransparentSortThreshold = std::max(iDegrees, 0.f); }
+  int GetNbTransparentSorts() const { return _NbTransparentSorts; }
+  bool GetEnableShadowCache() const { return _EnableShadowCache; }
+  void SetEnableShadowCache( bool iEnabled ) { _EnableShadowCache = iEnabled; InvalidateShadowCache(); }
+  int GetNbShadowLayersRendered() const { return _NbShadowLayersRendered; }
+  int GetNbShadowCacheHits() const { return _NbShadowCacheHits; }
+  int GetNbLightClusterRefs() const { return _NbLightClusterRefs; }
+  int GetMaxLightsPerCluster() const { return _MaxLightsPerCluster; }
   virtual int GetRenderPassTimings( std::vector<RenderPassTiming> & oTimings ) const override;
 
   virtual DeferredRenderer * AsDeferredRenderer() override { return this; }
@@ -95,6 +124,8 @@ protected:
   int InitializeSSAO();
   int InitializeSSR();
   int InitializeBRDFLUT();
+  int InitializeHiZ();
+  int InitializeSSRHiZ();
   int InitializeStats();
   int UpdateStats();
 
@@ -109,12 +140,27 @@ protected:
   int UpdateUniforms();
   int UpdateShadowState();
   int RenderShadowMap();
+  void InvalidateShadowCache();
+  void UpdateShadowCasterBounds();
+  int BuildLightClusters( const Mat4x4 & iView, float iTop, float iRight );
   int RenderSSAO();
   int RenderSSR();
+  int UpsampleEffect( const GLTexture & iInput, GLFrameBuffer & ioTarget, EffectResolution iResolution, const Vec4 & iBackground );
+  Vec2i EffectSize( EffectResolution iResolution ) const;
   int RenderTransparent();
+  int RenderTransparentWeightedBlended();
   int UpdateSSRSource();
 
   void BuildDeferredDrawLists();
+  void BuildIndirectDraws();
+  bool UseIndirectDraws() const;
+  void DrawOpaqueInstances( ShaderProgram & iShader, bool iIndirect, bool iSetMaterial, int iCullList = -1 );
+  void BeginCulling( bool iIndirect );
+  void ReadCullStats();
+  void ReleaseCullStats();
+  void CullOpaqueInstances( int iCullList, int iCullPass, const Mat4x4 & iViewProj, bool iIndirect, bool iOcclusion );
+  void BuildHiZ( const Mat4x4 & iViewProj );
+  void BuildSSRHiZ();
   void SortTransparentInstances();
   bool IsTransparentMaterial(int iMaterialID);
   void BuildTransparentMeshTriangleData( size_t iMeshID, const std::vector<Vec3> & iPositions, const std::vector<uint32_t> & iIndices );
@@ -136,10 +182,25 @@ protected:
     Vec3      _Pos = Vec3(0.f);
     Vec3      _Dir = Vec3(0.f, 1.f, 0.f);
     float     _Far = 25.f;
-    Mat4x4    _DirectionalViewProj = Mat4x4(1.f);
+    int       _NbCascades = 1; // Distant lights : consecutive 2D layers from _Layer
+    Vec4      _CascadeSplits = Vec4(MAX_FLOAT); // Camera depth where each cascade ends
+    std::array<Mat4x4, S_MaxDeferredShadowCascades> _CascadeViewProj;
     std::array<Mat4x4, 6> _CubeViewProj;
   };
 
+  void FitShadowCascades( ShadowCaster & ioCaster );
+
+  // Key of the depth stored in a shadow map layer : a cube map uses all 6 faces, a 2D layer only the first
+  struct ShadowCacheEntry
+  {
+    int                   _LightIndex = -1;
+    float                 _Far = 0.f;
+    std::array<Mat4x4, 6> _ViewProj;
+    std::array<bool, 6>   _Valid = {};
+  };
+
+  bool IsShadowLayerCached( ShadowCacheEntry & ioEntry, int iFace, int iLightIndex, float iFar, const Mat4x4 & iViewProj );
+
   QuadMesh _Quad;
 
   // G-buffer FBO and attachments
@@ -150,11 +211,17 @@ protected:
   GLTexture     _GMaterialTEX = { 0, GL_TEXTURE_2D, DeferredTexSlot::_GMaterial, GL_RGBA16F, GL_RGBA, GL_FLOAT };
   GLTexture     _GEmissionTEX = { 0, GL_TEXTURE_2D, DeferredTexSlot::_GEmission, GL_RGBA16F, GL_RGBA, GL_FLOAT };
   GLTexture     _GDepthTEX    = { 0, GL_TEXTURE_2D, DeferredTexSlot::_GDepth, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT };
+  bool          _CompactGBuffer = false; // Layout of the allocated targets : RG16 normals, RGBA8 material, no position target
 
   // Lighting target (single texture)
   GLFrameBuffer _LightingFBO;
   GLTexture     _LightingTEX  = { 0, GL_TEXTURE_2D, DeferredTexSlot::_Lighting, GL_RGBA32F, GL_RGBA, GL_FLOAT };
 
+  // Weighted blended OIT targets (G-buffer depth attached, not written)
+  GLFrameBuffer _OITFBO;
+  GLTexture     _OITAccumTEX     = { 0, GL_TEXTURE_2D, DeferredTexSlot::_OITAccum, GL_RGBA16F, GL_RGBA, GL_FLOAT };
+  GLTexture     _OITRevealageTEX = { 0, GL_TEXTURE_2D, DeferredTexSlot::_OITRevealage, GL_R16F, GL_RED, GL_FLOAT };
+
   // SSAO targets
   GLFrameBuffer _SSAOFBO;
   GLFrameBuffer _SSAOBlurFBO;
@@ -162,12 +229,23 @@ protected:
   GLTexture     _SSAOBlurTEX  = { 0, GL_TEXTURE_2D, DeferredTexSlot::_SSAOBlur, GL_R16F, GL_RED, GL_FLOAT };
   GLTexture     _SSAONoiseTEX = { 0, GL_TEXTURE_2D, DeferredTexSlot::_SSAONoise, GL_RGBA16F, GL_RGBA, GL_FLOAT };
 
+  // SSAO and SSR run at _SSAOResolution/_SSRResolution : the upsampled targets replace them in the lighting pass
+  GLFrameBuffer _SSAOUpsampleFBO;
+  GLFrameBuffer _SSRUpsampleFBO;
+  GLTexture     _SSAOUpsampleTEX = { 0, GL_TEXTURE_2D, DeferredTexSlot::_SSAOBlur, GL_R16F, GL_RED, GL_FLOAT };
+  GLTexture     _SSRUpsampleTEX  = { 0, GL_TEXTURE_2D, DeferredTexSlot::_SSR, GL_RGBA16F, GL_RGBA, GL_FLOAT };
+
   // SSR targets
   GLFrameBuffer _SSRFBO;
   GLFrameBuffer _SSRSourceFBO;
   GLTexture     _SSRTEX       = { 0, GL_TEXTURE_2D, DeferredTexSlot::_SSR, GL_RGBA16F, GL_RGBA, GL_FLOAT };
   GLTexture     _SSRSourceTEX = { 0, GL_TEXTURE_2D, DeferredTexSlot::_SSRSource, GL_RGBA32F, GL_RGBA, GL_FLOAT };
 
+  // Min-depth pyramid of the current G-buffer, traversed by the HiZ SSR tracing
+  GLFrameBuffer _SSRHiZFBO;
+  GLTexture     _SSRHiZTEX    = { 0, GL_TEXTURE_2D, DeferredTexSlot::_SSRHiZ, GL_R32F, GL_RED, GL_FLOAT };
+  int           _SSRHiZNbLevels = 0;
+
   // BRDF LUT target
   GLFrameBuffer _BRDFFBO;
   GLTexture     _BRDFLUTTEX   = { 0, GL_TEXTURE_2D, DeferredTexSlot::_BRDFLUT, GL_RG16F, GL_RG, GL_FLOAT };
@@ -179,6 +257,8 @@ protected:
 
   // Scene data
   GLTextureBuffer _TexIndTBO     = { 0, { 0, GL_TEXTURE_BUFFER, DeferredTexSlot::_TexInd } };
+  GLTextureBuffer _LightClustersTBO = { 0, { 0, GL_TEXTURE_BUFFER, DeferredTexSlot::_LightClusters } }; // Per cluster : first index, light count
+  GLTextureBuffer _LightIndicesTBO  = { 0, { 0, GL_TEXTURE_BUFFER, DeferredTexSlot::_LightIndices } };
   GLTexture       _TexArrayTEX   = { 0, GL_TEXTURE_2D_ARRAY, DeferredTexSlot::_TexArray, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE };
   GLTexture       _MaterialsTEX  = { 0, GL_TEXTURE_2D, DeferredTexSlot::_Materials, GL_RGBA32F, GL_RGBA, GL_FLOAT };
   GLTexture       _EnvMapTEX     = { 0, GL_TEXTURE_2D, DeferredTexSlot::_EnvMap, GL_RGB32F,  GL_RGB,  GL_FLOAT };
@@ -193,24 +273,100 @@ protected:
   std::unique_ptr<ShaderProgram> _SSAOShader;
   std::unique_ptr<ShaderProgram> _SSAOBlurShader;
   std::unique_ptr<ShaderProgram> _SSRShader;
+  std::unique_ptr<ShaderProgram> _SSRHiZShader;
+  std::unique_ptr<ShaderProgram> _BilateralUpsampleShader;
   std::unique_ptr<ShaderProgram> _BRDFLUTShader;
   std::unique_ptr<ShaderProgram> _TransparentShader;
+  std::unique_ptr<ShaderProgram> _OITResolveShader;
+
+  // Multi-draw indirect variants : per-instance data read from _InstanceDataSSBO (GL 4.3)
+  std::unique_ptr<ShaderProgram> _GeometryIndirectShader;
+  std::unique_ptr<ShaderProgram> _WireframeIndirectShader;
+  std::unique_ptr<ShaderProgram> _ShadowCubeIndirectShader;
+  std::unique_ptr<ShaderProgram> _ShadowDirectionalIndirectShader;
+
+  // Culling compute shaders (GL 4.3)
+  std::unique_ptr<ShaderProgram> _CullingShader;
+  std::unique_ptr<ShaderProgram> _HiZShader;
 
   // Frame counters
   unsigned int _FrameNum = 1;
 
-  // GPU mesh resources (one entry per Scene::GetMeshes())
-  std::vector<GLuint> _MeshVAOs;
-  std::vector<GLuint> _MeshVBOs;
-  std::vector<GLuint> _MeshEBOs;
+  // GPU mesh resources : every Scene::GetMeshes() entry is a range of one merged vertex/index buffer
+  GLuint              _MeshVAO = 0;
+  GLuint              _MeshVBO = 0;
+  GLuint              _MeshEBO = 0;
+  std::vector<int>    _MeshFirstIndex;
+  std::vector<int>    _MeshBaseVertex;
   std::vector<int>    _MeshIndexCount;
   std::vector<std::vector<uint32_t>> _TransparentMeshBaseIndices;
   std::vector<std::vector<Vec3>>     _TransparentMeshLocalTriCenters;
   std::vector<std::vector<uint32_t>> _TransparentMeshSortedIndices;
   std::vector<std::vector<int>>      _TransparentMeshSortedTriOrder;
   std::vector<std::vector<float>>    _TransparentMeshTriDepths;
+  std::vector<Vec3>                  _TransparentMeshSortAxis; // Mesh-space view axis of the last sort, zero when unsorted
+  std::vector<uint32_t>              _TransparentSortKeys;
+  std::vector<int>                   _TransparentSortValues;
+  RadixSorter                        _TransparentSorter;
+  float                              _TransparentSortThreshold = 0.f; // Degrees
+  int                                _NbTransparentSorts = 0;
   std::vector<int>    _OpaqueMeshInstanceIDs;
+  std::vector<AABB<Vec3>> _OpaqueWorldBounds; // Parallel to _OpaqueMeshInstanceIDs
   std::vector<int>    _TransparentMeshInstanceIDs;
+  std::uint64_t       _SyncedMeshInstanceGeneration = 0;
+
+  // Multi-draw indirect state : one command and one instance entry per opaque instance
+  GLuint _DrawIDVBO                  = 0; // Instanced attribute 0..N-1 : baseInstance selects the draw index
+  GLuint _IndirectCommandBuffer      = 0;
+  GLuint _InstanceDataSSBO           = 0;
+  int    _DrawIDCapacity             = 0;
+  int    _NbIndirectDraws            = 0;
+  int    _NbDrawCalls                = 0;
+  bool   _MultiDrawIndirectSupported = false;
+  bool   _EnableMultiDrawIndirect    = true;
+
+  // Culling state : the camera list is kept for the wireframe overlay, the shadow list is refilled per caster face
+  enum CullList
+  {
+    CullListCamera = 0,
+    CullListShadow,
+    CullListCount
+  };
+
+  enum CullPass
+  {
+    CullPassCamera = 0,
+    CullPassShadow,
+    CullPassCount
+  };
+
+  std::array<GLuint, CullListCount> _CulledCommandBuffers = {};
+  std::array<GLuint, CullListCount> _CulledCountBuffers = {};
+  std::array<std::vector<unsigned char>, CullListCount> _CPUVisibleDraws; // Per opaque draw, without multi-draw indirect
+  int    _CulledCommandCapacity     = 0;
+  bool   _GpuCullingSupported       = false;
+  bool   _EnableFrustumCulling      = true;
+  bool   _EnableOcclusionCulling    = true;
+  std::array<bool, CullListCount> _CullListActive = {};
+  std::array<int, CullPassCount> _NbCullTested = {};    // Current frame
+  std::array<int, CullPassCount> _NbCullVisible = {};   // Current frame, CPU culling only : GPU counts are read back next frame
+  std::array<int, CullPassCount> _CullTestedStats = {}; // Last completed frame
+  std::array<int, CullPassCount> _CullCulledStats = {};
+  bool   _CullStatsPending          = false;
+
+  // GPU visible counts, one buffer per frame in flight : a slot is read back once its fence signaled, never waited on
+  static constexpr int S_NbCullStatsSlots = 3;
+  std::array<GLuint, S_NbCullStatsSlots> _CullStatsBuffers = {};
+  std::array<GLsync, S_NbCullStatsSlots> _CullStatsFences = {};
+  std::array<std::array<int, CullPassCount>, S_NbCullStatsSlots> _CullStatsTested = {};
+  int    _CullStatsSlot             = 0; // Written by the current frame
+  Mat4x4 _CameraViewProj            = Mat4x4(1.f);
+
+  // Max-depth pyramid of the last G-buffer, with the view-projection it was rendered with
+  GLTexture _HiZTEX        = { 0, GL_TEXTURE_2D, DeferredTexSlot::_HiZ, GL_R32F, GL_RED, GL_FLOAT };
+  int       _HiZNbLevels   = 0;
+  Mat4x4    _HiZViewProj   = Mat4x4(1.f);
+  bool      _HiZValid      = false;
 
   // Scene bounds
   AABB<Vec3> _SceneBounds;
@@ -226,10 +382,27 @@ protected:
   int _ShadowLocalCapacity          = -1;
   int _ShadowDirectionalCapacity    = -1;
   int _LocalShadowCasterCount       = 0;
-  int _DirectionalShadowCasterCount = 0;
+  int _DirectionalShadowLayerCount  = 0;
   bool _HasShadowLight              = false;
   std::vector<ShadowCaster> _ShadowCasters;
 
+  // Shadow cache : a layer is redrawn only when its light changed or a moved instance touches its frustum
+  bool                          _EnableShadowCache = true;
+  std::vector<ShadowCacheEntry> _LocalShadowCache;       // Per cube map array layer
+  std::vector<ShadowCacheEntry> _DirectionalShadowCache; // Per 2D array layer
+  std::vector<AABB<Vec3>>       _ShadowCasterBounds;     // Per mesh instance, as last seen by the shadow cache
+  std::vector<AABB<Vec3>>       _ShadowDirtyBounds;      // Old and new bounds of the instances moved since the last shadow pass
+  std::vector<int>              _ShadowDirtyInstanceIDs;
+  int                           _NbShadowLayersRendered = 0; // Current frame, cube faces and 2D layers
+  int                           _NbShadowCacheHits = 0;
+
+  // Clustered lighting : froxel grid over the camera frustum, exponential depth slices
+  std::vector<int>     _LightClusterData;      // Per cluster : first index, light count
+  std::vector<int>     _LightClusterIndices;   // Grows only : the buffer is reallocated when a frame needs more
+  std::vector<Vec2i>   _LightClusterRefs;      // (cluster, light) pairs in light order, cluster -1 : every cluster
+  int                  _NbLightClusterRefs = 0; // Distant lights included
+  int                  _MaxLightsPerCluster = 0;
+
   // SSAO state
   std::array<Vec3, 32> _SSAOKernel;
 
@@ -242,7 +415,10 @@ protected:
     TimingShadowMap = 0,
     TimingGBuffer,
     TimingSSAO,
+    TimingSSAOUpsample,
+    TimingSSRHiZ,
     TimingSSR,
+    TimingSSRUpsample,
     TimingLighting,
     TimingTransparency,
     TimingWireframe,
@@ -0,0 +1,1106 @@
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "DistributedRender.h"
+
+#include "Loader.h"
+#include "PathUtils.h"
+#include "RenderSettings.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "SoftwareRasterizer.h"
+
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include <thread>
+
+#if !defined(_WIN32)
+extern char ** environ;
+#endif
+
+namespace fs = std::filesystem;
+
+namespace RTRT
+{
+
+namespace
+{
+
+static const intptr_t S_InvalidSocket    = -1;
+static const uint32_t S_ProtocolMagic    = 0x44545452; // "RTTD"
+static const uint32_t S_ProtocolVersion  = 2;
+static const uint32_t S_MaxMessageSize   = 256u << 20;
+static const int      S_PollMilliseconds = 50;
+static const int      S_WorkerExitGrace  = 5;          // Seconds given to the local workers to exit once the frame is done
+static const int      S_DefaultTileSize  = 64;
+
+// Every message : magic, type, payload size, then the payload. Little endian.
+enum class MessageType : uint32_t
+{
+  Hello = 1,   // Worker     -> coordinator : protocol version
+  Job,         // Coordinator -> worker     : scene, resolution, tile size
+  Ready,       // Worker     -> coordinator : status, tile count
+  Tiles,       // Coordinator -> worker     : tile indices, none when the frame is done
+  TileData     // Worker     -> coordinator : tile index, origin, size, linear RGBA pixels
+};
+
+// ----------------------------------------------------------------------------
+// MessageWriter / MessageReader
+// ----------------------------------------------------------------------------
+struct MessageWriter
+{
+  std::vector<unsigned char> _Data;
+
+  void PutU32( uint32_t iValue )
+  {
+    for ( int i = 0; i < 4; ++i )
+      _Data.push_back(static_cast<unsigned char>(( iValue >> ( 8 * i ) ) & 0xFF));
+  }
+  void PutI32( int32_t iValue ) { PutU32(static_cast<uint32_t>(iValue)); }
+  void PutFloat( float iValue )
+  {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &iValue, sizeof(bits));
+    PutU32(bits);
+  }
+  void PutString( const std::string & iValue )
+  {
+    PutU32(static_cast<uint32_t>(iValue.size()));
+    _Data.insert(_Data.end(), iValue.begin(), iValue.end());
+  }
+};
+
+struct MessageReader
+{
+  const std::vector<unsigned char> & _Data;
+  size_t                             _Pos = 0;
+  bool                               _Valid = true;
+
+  MessageReader( const std::vector<unsigned char> & iData ) : _Data(iData) {}
+
+  uint32_t GetU32()
+  {
+    if ( _Pos + 4 > _Data.size() )
+    {
+      _Valid = false;
+      return 0;
+    }
+    uint32_t value = 0;
+    for ( int i = 0; i < 4; ++i )
+      value |= static_cast<uint32_t>(_Data[_Pos + i]) << ( 8 * i );
+    _Pos += 4;
+    return value;
+  }
+  int32_t GetI32() { return static_cast<int32_t>(GetU32()); }
+  float GetFloat()
+  {
+    const uint32_t bits = GetU32();
+    float value = 0.f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  std::string GetString()
+  {
+    const uint32_t size = GetU32();
+    if ( !_Valid || ( _Pos + size > _Data.size() ) )
+    {
+      _Valid = false;
+      return "";
+    }
+    std::string value(_Data.begin() + _Pos, _Data.begin() + _Pos + size);
+    _Pos += size;
+    return value;
+  }
+};
+
+// ----------------------------------------------------------------------------
+// Sockets
+// ----------------------------------------------------------------------------
+bool InitializeSockets()
+{
+#ifdef _WIN32
+  static const bool initialized = [](){ WSADATA data; return ( 0 == WSAStartup(MAKEWORD(2, 2), &data) ); }();
+  return initialized;
+#else
+  return true;
+#endif
+}
+
+// Not inherited by the respawned local workers (CreateProcess does not pass handles on Windows)
+intptr_t OpenSocket( int iFamily, int iType, int iProtocol )
+{
+#if defined(SOCK_CLOEXEC)
+  return static_cast<intptr_t>(socket(iFamily, iType | SOCK_CLOEXEC, iProtocol));
+#else
+  const intptr_t result = static_cast<intptr_t>(socket(iFamily, iType, iProtocol));
+#if !defined(_WIN32)
+  if ( S_InvalidSocket != result )
+    fcntl(static_cast<int>(result), F_SETFD, FD_CLOEXEC);
+#endif
+  return result;
+#endif
+}
+
+intptr_t AcceptSocket( intptr_t iListenSocket )
+{
+#if defined(__linux__)
+  return static_cast<intptr_t>(accept4(static_cast<int>(iListenSocket), nullptr, nullptr, SOCK_CLOEXEC));
+#else
+  const intptr_t result = static_cast<intptr_t>(accept(iListenSocket, nullptr, nullptr));
+#if !defined(_WIN32)
+  if ( S_InvalidSocket != result )
+    fcntl(static_cast<int>(result), F_SETFD, FD_CLOEXEC);
+#endif
+  return result;
+#endif
+}
+
+void CloseSocket( intptr_t iSocket )
+{
+  if ( S_InvalidSocket == iSocket )
+    return;
+#ifdef _WIN32
+  closesocket(static_cast<SOCKET>(iSocket));
+#else
+  close(static_cast<int>(iSocket));
+#endif
+}
+
+void ShutdownSocket( intptr_t iSocket )
+{
+#ifdef _WIN32
+  shutdown(static_cast<SOCKET>(iSocket), SD_BOTH);
+#else
+  shutdown(static_cast<int>(iSocket), SHUT_RDWR);
+#endif
+}
+
+void ConfigureSocket( intptr_t iSocket, int iTimeoutSeconds )
+{
+  int noDelay = 1;
+  setsockopt(iSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&noDelay), sizeof(noDelay));
+#ifdef __APPLE__
+  int noSigPipe = 1;
+  setsockopt(iSocket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+  // 0 : blocking receives
+#ifdef _WIN32
+  const DWORD timeout = static_cast<DWORD>(iTimeoutSeconds) * 1000;
+#else
+  timeval timeout;
+  timeout.tv_sec = iTimeoutSeconds;
+  timeout.tv_usec = 0;
+#endif
+  setsockopt(iSocket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char *>(&timeout), sizeof(timeout));
+}
+
+bool SendAll( intptr_t iSocket, const unsigned char * iData, size_t iSize )
+{
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  while ( iSize )
+  {
+    const int chunk = static_cast<int>(std::min<size_t>(iSize, 1 << 20));
+    const auto sent = send(iSocket, reinterpret_cast<const char *>(iData), chunk, flags);
+    if ( sent <= 0 )
+      return false;
+    iData += sent;
+    iSize -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+bool ReceiveAll( intptr_t iSocket, unsigned char * oData, size_t iSize )
+{
+  while ( iSize )
+  {
+    const int chunk = static_cast<int>(std::min<size_t>(iSize, 1 << 20));
+    const auto received = recv(iSocket, reinterpret_cast<char *>(oData), chunk, 0);
+    if ( received <= 0 )
+      return false;
+    oData += received;
+    iSize -= static_cast<size_t>(received);
+  }
+  return true;
+}
+
+bool SendMessage( intptr_t iSocket, MessageType iType, const MessageWriter & iPayload )
+{
+  MessageWriter header;
+  header.PutU32(S_ProtocolMagic);
+  header.PutU32(static_cast<uint32_t>(iType));
+  header.PutU32(static_cast<uint32_t>(iPayload._Data.size()));
+  return SendAll(iSocket, header._Data.data(), header._Data.size())
+      && SendAll(iSocket, iPayload._Data.data(), iPayload._Data.size());
+}
+
+bool ReceiveMessage( intptr_t iSocket, MessageType iExpectedType, std::vector<unsigned char> & oPayload )
+{
+  std::vector<unsigned char> headerData(12);
+  if ( !ReceiveAll(iSocket, headerData.data(), headerData.size()) )
+    return false;
+
+  MessageReader header(headerData);
+  const uint32_t magic = header.GetU32();
+  const uint32_t type = header.GetU32();
+  const uint32_t size = header.GetU32();
+  if ( ( S_ProtocolMagic != magic ) || ( static_cast<uint32_t>(iExpectedType) != type ) || ( size > S_MaxMessageSize ) )
+    return false;
+
+  oPayload.resize(size);
+  return ReceiveAll(iSocket, oPayload.data(), size);
+}
+
+bool WaitReadable( intptr_t iSocket, int iMilliseconds )
+{
+  fd_set readSet;
+  FD_ZERO(&readSet);
+  FD_SET(iSocket, &readSet);
+  timeval timeout;
+  timeout.tv_sec = iMilliseconds / 1000;
+  timeout.tv_usec = ( iMilliseconds % 1000 ) * 1000;
+  return ( select(static_cast<int>(iSocket) + 1, &readSet, nullptr, nullptr, &timeout) > 0 );
+}
+
+intptr_t ConnectTo( const std::string & iHost, int iPort )
+{
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo * addresses = nullptr;
+  if ( 0 != getaddrinfo(iHost.c_str(), std::to_string(iPort).c_str(), &hints, &addresses) )
+    return S_InvalidSocket;
+
+  intptr_t result = S_InvalidSocket;
+  for ( addrinfo * address = addresses; address && ( S_InvalidSocket == result ); address = address -> ai_next )
+  {
+    const intptr_t candidate = OpenSocket(address -> ai_family, address -> ai_socktype, address -> ai_protocol);
+    if ( S_InvalidSocket == candidate )
+      continue;
+    if ( 0 == connect(candidate, address -> ai_addr, static_cast<int>(address -> ai_addrlen)) )
+      result = candidate;
+    else
+      CloseSocket(candidate);
+  }
+  freeaddrinfo(addresses);
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// Local worker processes
+// ----------------------------------------------------------------------------
+#ifdef _WIN32
+typedef HANDLE ProcessHandle;
+#else
+typedef pid_t ProcessHandle;
+#endif
+
+bool SpawnWorkerProcess( const std::string & iExecutable, int iPort, ProcessHandle & oProcess )
+{
+  const std::string address = "127.0.0.1:" + std::to_string(iPort);
+#ifdef _WIN32
+  std::string commandLine = "\"" + iExecutable + "\" --tile-worker " + address;
+  STARTUPINFOA startupInfo;
+  PROCESS_INFORMATION processInfo;
+  ZeroMemory(&startupInfo, sizeof(startupInfo));
+  ZeroMemory(&processInfo, sizeof(processInfo));
+  startupInfo.cb = sizeof(startupInfo);
+  if ( !CreateProcessA(iExecutable.c_str(), &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo) )
+    return false;
+  CloseHandle(processInfo.hThread);
+  oProcess = processInfo.hProcess;
+  return true;
+#else
+  std::string executable = iExecutable;
+  std::string option = "--tile-worker";
+  char * argv[] = { &executable[0], &option[0], const_cast<char *>(address.c_str()), nullptr };
+  return ( 0 == posix_spawnp(&oProcess, executable.c_str(), nullptr, nullptr, argv, environ) );
+#endif
+}
+
+bool HasProcessExited( ProcessHandle iProcess )
+{
+#ifdef _WIN32
+  if ( WAIT_OBJECT_0 != WaitForSingleObject(iProcess, 0) )
+    return false;
+  CloseHandle(iProcess);
+  return true;
+#else
+  int status = 0;
+  return ( 0 != waitpid(iProcess, &status, WNOHANG) );
+#endif
+}
+
+void KillProcess( ProcessHandle iProcess )
+{
+#ifdef _WIN32
+  TerminateProcess(iProcess, 1);
+  WaitForSingleObject(iProcess, INFINITE);
+  CloseHandle(iProcess);
+#else
+  int status = 0;
+  kill(iProcess, SIGKILL);
+  waitpid(iProcess, &status, 0);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Arguments
+// ----------------------------------------------------------------------------
+bool ParseInt( const std::string & iText, int iMin, int & oValue )
+{
+  char * end = nullptr;
+  const long value = std::strtol(iText.c_str(), &end, 10);
+  if ( !end || *end || iText.empty() || ( value < iMin ) || ( value > 1 << 20 ) )
+    return false;
+  oValue = static_cast<int>(value);
+  return true;
+}
+
+bool ParseSize( const std::string & iText, Vec2i & oValue )
+{
+  const size_t separator = iText.find('x');
+  return ( std::string::npos != separator )
+      && ParseInt(iText.substr(0, separator), 1, oValue.x)
+      && ParseInt(iText.substr(separator + 1), 1, oValue.y);
+}
+
+std::string ResolveScenePath( const std::string & iScene )
+{
+  std::error_code error;
+  return ( fs::exists(iScene, error) ) ? ( iScene ) : ( PathUtils::GetAssetPath(iScene) );
+}
+
+double SecondsSince( const std::chrono::steady_clock::time_point & iStart )
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - iStart).count();
+}
+
+// ----------------------------------------------------------------------------
+// Frame layout
+// ----------------------------------------------------------------------------
+void GetTileLayout( const RenderSettings & iSettings, Vec2i & oTileSize, Vec2i & oNbTiles )
+{
+  const Vec2i resolution = glm::max(iSettings._WindowResolution, Vec2i(0));
+  oTileSize.x = ( iSettings._TileResolution.x > 0 ) ? ( iSettings._TileResolution.x ) : ( S_DefaultTileSize );
+  oTileSize.y = ( iSettings._TileResolution.y > 0 ) ? ( iSettings._TileResolution.y ) : ( S_DefaultTileSize );
+  oNbTiles = Vec2i(( resolution.x + oTileSize.x - 1 ) / oTileSize.x, ( resolution.y + oTileSize.y - 1 ) / oTileSize.y);
+}
+
+Vec4i GetTileRect( int iTile, const Vec2i & iResolution, const Vec2i & iTileSize, const Vec2i & iNbTiles )
+{
+  const Vec2i origin(( iTile % iNbTiles.x ) * iTileSize.x, ( iTile / iNbTiles.x ) * iTileSize.y);
+  return Vec4i(origin, std::min(iTileSize.x, iResolution.x - origin.x), std::min(iTileSize.y, iResolution.y - origin.y));
+}
+
+// ----------------------------------------------------------------------------
+// ServeCoordinator
+// Worker side of a connection, returns 0 once the coordinator ends the frame
+// ----------------------------------------------------------------------------
+int ServeCoordinator( intptr_t iSocket, const TileWorkerOptions & iOptions )
+{
+  MessageWriter hello;
+  hello.PutU32(S_ProtocolVersion);
+  std::vector<unsigned char> payload;
+  if ( !SendMessage(iSocket, MessageType::Hello, hello) || !ReceiveMessage(iSocket, MessageType::Job, payload) )
+    return 1;
+
+  MessageReader job(payload);
+  const std::string sceneName = job.GetString();
+  Vec2i resolution, tileSize;
+  resolution.x = job.GetI32();
+  resolution.y = job.GetI32();
+  tileSize.x = job.GetI32();
+  tileSize.y = job.GetI32();
+  if ( !job._Valid || ( resolution.x <= 0 ) || ( resolution.y <= 0 ) || ( tileSize.x <= 0 ) || ( tileSize.y <= 0 ) )
+    return 1;
+
+  Scene scene;
+  RenderSettings settings;
+  const bool loaded = Loader::LoadScene(ResolveScenePath(sceneName), scene, settings);
+  settings._WindowResolution = resolution;
+  settings._RenderScale = 100;
+  settings._TileResolution = tileSize;
+  settings._TiledRendering = true;
+  settings._NbThreads = std::max(settings._NbThreads, 1u);
+
+  Vec2i nbTiles;
+  GetTileLayout(settings, tileSize, nbTiles);
+
+  // Raster tiles never straddle two frame tiles when both sizes are multiples of 8
+  SoftwareRasterizer rasterizer(scene, settings);
+  rasterizer.SetTileSize(std::gcd(tileSize.x, tileSize.y));
+  const int status = ( loaded && ( 0 == rasterizer.InitializeCPU() ) ) ? ( 0 ) : ( 1 );
+
+  MessageWriter ready;
+  ready.PutI32(status);
+  ready.PutI32(nbTiles.x * nbTiles.y);
+  if ( !SendMessage(iSocket, MessageType::Ready, ready) || ( 0 != status ) )
+  {
+    std::cout << "TileWorker : ERROR. Unable to load " << sceneName << std::endl;
+    return 1;
+  }
+
+  int nbRendered = 0;
+  std::vector<int> range;
+  std::vector<Vec4i> regions;
+  std::vector<float> pixels;
+  while ( ReceiveMessage(iSocket, MessageType::Tiles, payload) )
+  {
+    MessageReader tiles(payload);
+    const uint32_t count = tiles.GetU32();
+    if ( !tiles._Valid )
+      return 1;
+    if ( 0 == count )
+      return 0;
+
+    // The whole range in one frame : vertices are transformed and clipped once
+    range.clear();
+    regions.clear();
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+      const int tile = tiles.GetI32();
+      if ( !tiles._Valid || ( tile < 0 ) || ( tile >= nbTiles.x * nbTiles.y ) )
+        return 1;
+      range.push_back(tile);
+      regions.push_back(GetTileRect(tile, resolution, tileSize, nbTiles));
+    }
+    if ( 0 != rasterizer.RenderRegions(regions) )
+      return 1;
+
+    for ( size_t i = 0; i < range.size(); ++i )
+    {
+      const Vec4i & rect = regions[i];
+      if ( 0 != rasterizer.ReadRegion(rect, pixels) )
+        return 1;
+
+      MessageWriter tileData;
+      tileData._Data.reserve(20 + pixels.size() * 4);
+      tileData.PutI32(range[i]);
+      tileData.PutI32(rect.x);
+      tileData.PutI32(rect.y);
+      tileData.PutI32(rect.z);
+      tileData.PutI32(rect.w);
+      for ( float value : pixels )
+        tileData.PutFloat(value);
+      if ( !SendMessage(iSocket, MessageType::TileData, tileData) )
+        return 1;
+
+      if ( ( iOptions._MaxTiles > 0 ) && ( ++nbRendered >= iOptions._MaxTiles ) )
+      {
+        std::cout << "TileWorker : leaving after " << nbRendered << " tile(s)" << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  // Coordinator gone
+  return 1;
+}
+
+}
+
+// ----------------------------------------------------------------------------
+// CTOR
+// ----------------------------------------------------------------------------
+TileCoordinator::TileCoordinator()
+{
+}
+
+// ----------------------------------------------------------------------------
+// DTOR
+// ----------------------------------------------------------------------------
+TileCoordinator::~TileCoordinator()
+{
+  CloseSocket(_ListenSocket);
+}
+
+// ----------------------------------------------------------------------------
+// Listen
+// ----------------------------------------------------------------------------
+int TileCoordinator::Listen( int iPort, bool iAcceptRemote )
+{
+  if ( !InitializeSockets() )
+    return 1;
+
+  CloseSocket(_ListenSocket);
+  _ListenSocket = OpenSocket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if ( S_InvalidSocket == _ListenSocket )
+    return 1;
+
+  int reuse = 1;
+  setsockopt(_ListenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(( iAcceptRemote ) ? ( INADDR_ANY ) : ( INADDR_LOOPBACK ));
+  address.sin_port = htons(static_cast<unsigned short>(iPort));
+
+  socklen_t addressSize = sizeof(address);
+  if ( ( 0 != bind(_ListenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) )
+    || ( 0 != listen(_ListenSocket, 16) )
+    || ( 0 != getsockname(_ListenSocket, reinterpret_cast<sockaddr *>(&address), &addressSize) ) )
+  {
+    CloseSocket(_ListenSocket);
+    _ListenSocket = S_InvalidSocket;
+    return 1;
+  }
+
+  _Port = ntohs(address.sin_port);
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+int TileCoordinator::Run( const DistributedRenderOptions & iOptions, RenderImage & oImage, RenderSettings & oSettings )
+{
+  if ( S_InvalidSocket == _ListenSocket )
+    return 1;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  // The coordinator only needs the frame layout, but loads the whole scene to get it
+  Scene scene;
+  oSettings = RenderSettings();
+  if ( !Loader::LoadScene(ResolveScenePath(iOptions._Scene), scene, oSettings) )
+  {
+    std::cout << "Distributed : ERROR. Unable to load " << iOptions._Scene << std::endl;
+    return 1;
+  }
+  if ( iOptions._Resolution.x > 0 )
+    oSettings._WindowResolution = iOptions._Resolution;
+  oSettings._TileResolution = iOptions._TileResolution;
+
+  GetTileLayout(oSettings, _TileSize, _NbTiles);
+  const int nbTiles = _NbTiles.x * _NbTiles.y;
+  if ( nbTiles <= 0 )
+    return 1;
+
+  MessageWriter job;
+  job.PutString(iOptions._Scene);
+  job.PutI32(oSettings._WindowResolution.x);
+  job.PutI32(oSettings._WindowResolution.y);
+  job.PutI32(_TileSize.x);
+  job.PutI32(_TileSize.y);
+
+  _Options = iOptions;
+  _Options._TilesPerRange = std::max(_Options._TilesPerRange, 1);
+  _JobPayload = job._Data;
+  _Image = &oImage;
+  _Image -> _Width = oSettings._WindowResolution.x;
+  _Image -> _Height = oSettings._WindowResolution.y;
+  _Image -> _Pixels.assign(static_cast<size_t>(_Image -> _Width) * _Image -> _Height * 4, 0.f);
+
+  _Pending.clear();
+  for ( int i = 0; i < nbTiles; ++i )
+    _Pending.push_back(i);
+  _Attempts.assign(nbTiles, 0);
+  _NbDone = 0;
+  _NbActiveWorkers = 0;
+  _Failed = false;
+  _Stats = DistributedRenderStats();
+  _Stats._NbTiles = nbTiles;
+
+  const bool spawnWorkers = ( _Options._NbWorkers > 0 );
+  std::vector<ProcessHandle> processes;
+  for ( int i = 0; spawnWorkers && ( i < _Options._NbWorkers ); ++i )
+  {
+    ProcessHandle process;
+    if ( SpawnWorkerProcess(_Options._WorkerExecutable, _Port, process) )
+      processes.push_back(process);
+  }
+  if ( spawnWorkers && processes.empty() )
+  {
+    std::cout << "Distributed : ERROR. Unable to start " << _Options._WorkerExecutable << std::endl;
+    return 1;
+  }
+
+  std::vector<std::thread> connections;
+  auto lastActivity = std::chrono::steady_clock::now();
+  while ( true )
+  {
+    if ( WaitReadable(_ListenSocket, S_PollMilliseconds) )
+    {
+      const intptr_t client = AcceptSocket(_ListenSocket);
+      if ( S_InvalidSocket != client )
+      {
+        {
+          std::lock_guard<std::mutex> lock(_Mutex);
+          _WorkerSockets.push_back(client);
+        }
+        connections.emplace_back(&TileCoordinator::ServeWorker, this, client);
+        lastActivity = std::chrono::steady_clock::now();
+      }
+    }
+
+    int nbActiveWorkers = 0;
+    {
+      std::lock_guard<std::mutex> lock(_Mutex);
+      if ( _Failed || ( _NbDone == nbTiles ) )
+        break;
+      nbActiveWorkers = _NbActiveWorkers;
+    }
+
+    // Local workers that exited before the end of the frame are replaced
+    for ( size_t i = 0; i < processes.size(); )
+    {
+      if ( !HasProcessExited(processes[i]) )
+      {
+        ++i;
+        continue;
+      }
+      processes.erase(processes.begin() + i);
+
+      std::unique_lock<std::mutex> lock(_Mutex);
+      if ( _Stats._NbRespawns >= _Options._MaxRetries )
+        continue;
+      _Stats._NbRespawns++;
+      lock.unlock();
+
+      ProcessHandle process;
+      if ( SpawnWorkerProcess(_Options._WorkerExecutable, _Port, process) )
+      {
+        processes.push_back(process);
+        std::cout << "Distributed : local worker lost, respawned" << std::endl;
+      }
+    }
+
+    if ( nbActiveWorkers > 0 )
+      lastActivity = std::chrono::steady_clock::now();
+    else if ( SecondsSince(lastActivity) > _Options._TimeoutSeconds )
+    {
+      std::cout << "Distributed : ERROR. No worker for " << _Options._TimeoutSeconds << " s" << std::endl;
+      std::lock_guard<std::mutex> lock(_Mutex);
+      _Failed = true;
+      break;
+    }
+  }
+
+  if ( _Failed )
+    ShutdownWorkers();
+  for ( std::thread & connection : connections )
+    connection.join();
+
+  // Workers leave on their own once told the frame is done
+  const auto exitStart = std::chrono::steady_clock::now();
+  while ( !processes.empty() )
+  {
+    processes.erase(std::remove_if(processes.begin(), processes.end(), []( ProcessHandle iProcess ) { return HasProcessExited(iProcess); }), processes.end());
+    if ( processes.empty() )
+      break;
+    if ( _Failed || ( SecondsSince(exitStart) > S_WorkerExitGrace ) )
+    {
+      for ( ProcessHandle process : processes )
+        KillProcess(process);
+      processes.clear();
+    }
+    else
+      std::this_thread::sleep_for(std::chrono::milliseconds(S_PollMilliseconds));
+  }
+
+  _Image = nullptr;
+  _Stats._Seconds = SecondsSince(start);
+  return ( _Failed ) ? ( 1 ) : ( 0 );
+}
+
+// ----------------------------------------------------------------------------
+// ServeWorker
+// Coordinator side of a connection, one thread per worker
+// ----------------------------------------------------------------------------
+void TileCoordinator::ServeWorker( intptr_t iSocket )
+{
+  ConfigureSocket(iSocket, _Options._TimeoutSeconds);
+
+  std::vector<unsigned char> payload;
+  bool handshake = ReceiveMessage(iSocket, MessageType::Hello, payload) && ( S_ProtocolVersion == MessageReader(payload).GetU32() );
+  if ( handshake )
+  {
+    MessageWriter job;
+    job._Data = _JobPayload;
+    handshake = SendMessage(iSocket, MessageType::Job, job) && ReceiveMessage(iSocket, MessageType::Ready, payload);
+  }
+  if ( handshake )
+  {
+    MessageReader ready(payload);
+    const int status = ready.GetI32();
+    const int nbTiles = ready.GetI32();
+    handshake = ready._Valid && ( 0 == status ) && ( nbTiles == _NbTiles.x * _NbTiles.y );
+  }
+
+  bool lost = !handshake;
+  if ( handshake )
+  {
+    {
+      std::lock_guard<std::mutex> lock(_Mutex);
+      _NbActiveWorkers++;
+      _Stats._NbWorkers++;
+    }
+
+    std::vector<int> range;
+    std::vector<unsigned char> received;
+    while ( !lost )
+    {
+      if ( !TakeRange(range) )
+      {
+        MessageWriter done;
+        done.PutU32(0);
+        SendMessage(iSocket, MessageType::Tiles, done);
+        break;
+      }
+
+      // Every remaining tile is in flight : wait in case a worker loses its range
+      if ( range.empty() )
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(S_PollMilliseconds));
+        continue;
+      }
+
+      received.assign(range.size(), 0);
+      MessageWriter tiles;
+      tiles.PutU32(static_cast<uint32_t>(range.size()));
+      for ( int tile : range )
+        tiles.PutI32(tile);
+      lost = !SendMessage(iSocket, MessageType::Tiles, tiles);
+
+      for ( size_t i = 0; !lost && ( i < range.size() ); ++i )
+      {
+        if ( !ReceiveMessage(iSocket, MessageType::TileData, payload) )
+        {
+          lost = true;
+          break;
+        }
+
+        MessageReader tileData(payload);
+        const int tile = tileData.GetI32();
+        Vec2i origin, size;
+        origin.x = tileData.GetI32();
+        origin.y = tileData.GetI32();
+        size.x = tileData.GetI32();
+        size.y = tileData.GetI32();
+
+        // The tile must belong to the range and match the frame layout
+        const auto slot = std::find(range.begin(), range.end(), tile);
+        const Vec2i expectedOrigin(( tile % _NbTiles.x ) * _TileSize.x, ( tile / _NbTiles.x ) * _TileSize.y);
+        const Vec2i expectedSize(std::min(_TileSize.x, _Image -> _Width - expectedOrigin.x), std::min(_TileSize.y, _Image -> _Height - expectedOrigin.y));
+        if ( !tileData._Valid || ( slot == range.end() ) || received[slot - range.begin()]
+          || ( origin != expectedOrigin ) || ( size != expectedSize )
+          || ( payload.size() != 20 + static_cast<size_t>(size.x) * size.y * 16 ) )
+        {
+          lost = true;
+          break;
+        }
+
+        for ( int y = 0; y < size.y; ++y )
+        {
+          float * row = &_Image -> _Pixels[( static_cast<size_t>(origin.y + y) * _Image -> _Width + origin.x ) * 4];
+          for ( int x = 0; x < size.x * 4; ++x )
+            row[x] = tileData.GetFloat();
+        }
+        received[slot - range.begin()] = 1;
+
+        std::lock_guard<std::mutex> lock(_Mutex);
+        _NbDone++;
+      }
+
+      if ( lost )
+        ReleaseRange(range, received);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_Mutex);
+    if ( handshake )
+      _NbActiveWorkers--;
+    if ( lost )
+      _Stats._NbLostWorkers++;
+    _WorkerSockets.erase(std::remove(_WorkerSockets.begin(), _WorkerSockets.end(), iSocket), _WorkerSockets.end());
+  }
+  CloseSocket(iSocket);
+}
+
+// ----------------------------------------------------------------------------
+// TakeRange
+// False once the frame is done or failed, an empty range when every remaining tile is in flight
+// ----------------------------------------------------------------------------
+bool TileCoordinator::TakeRange( std::vector<int> & oTiles )
+{
+  oTiles.clear();
+
+  std::lock_guard<std::mutex> lock(_Mutex);
+  if ( _Failed || ( _NbDone == static_cast<int>(_Attempts.size()) ) )
+    return false;
+
+  while ( !_Pending.empty() && ( static_cast<int>(oTiles.size()) < _Options._TilesPerRange ) )
+  {
+    oTiles.push_back(_Pending.front());
+    _Pending.pop_front();
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ReleaseRange
+// Tiles of a lost worker go back to the front of the queue
+// ----------------------------------------------------------------------------
+void TileCoordinator::ReleaseRange( const std::vector<int> & iTiles, const std::vector<unsigned char> & iReceived )
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  for ( size_t i = iTiles.size(); i-- > 0; )
+  {
+    if ( iReceived[i] )
+      continue;
+
+    const int tile = iTiles[i];
+    _Stats._NbReassignedTiles++;
+    if ( ++_Attempts[tile] > _Options._MaxRetries )
+    {
+      std::cout << "Distributed : ERROR. Tile " << tile << " failed " << _Attempts[tile] << " times" << std::endl;
+      _Failed = true;
+    }
+    else
+      _Pending.push_front(tile);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ShutdownWorkers
+// Wakes up the connection threads blocked on a worker
+// ----------------------------------------------------------------------------
+void TileCoordinator::ShutdownWorkers()
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  for ( intptr_t workerSocket : _WorkerSockets )
+    ShutdownSocket(workerSocket);
+}
+
+// ----------------------------------------------------------------------------
+// RunTileWorker
+// ----------------------------------------------------------------------------
+int RunTileWorker( const TileWorkerOptions & iOptions )
+{
+  if ( !InitializeSockets() )
+    return 1;
+
+  const intptr_t coordinator = ConnectTo(iOptions._Host, iOptions._Port);
+  if ( S_InvalidSocket == coordinator )
+  {
+    std::cout << "TileWorker : ERROR. Unable to connect to " << iOptions._Host << ":" << iOptions._Port << std::endl;
+    return 1;
+  }
+
+  // No receive timeout : the coordinator may keep an idle worker waiting for a lost range
+  ConfigureSocket(coordinator, 0);
+  const int result = ServeCoordinator(coordinator, iOptions);
+  CloseSocket(coordinator);
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// RunDistributedRender
+// ----------------------------------------------------------------------------
+int RunDistributedRender( const DistributedRenderOptions & iOptions )
+{
+  DistributedRenderOptions options = iOptions;
+#ifdef __linux__
+  // argv[0] may be a bare name found through the PATH
+  std::error_code error;
+  if ( fs::exists("/proc/self/exe", error) )
+    options._WorkerExecutable = fs::read_symlink("/proc/self/exe", error).string();
+#endif
+
+  TileCoordinator coordinator;
+  if ( 0 != coordinator.Listen(options._Port, options._AcceptRemote) )
+  {
+    std::cout << "Distributed : ERROR. Unable to listen on port " << options._Port << std::endl;
+    return 1;
+  }
+  std::cout << "Distributed : listening on port " << coordinator.GetPort() << ", " << options._NbWorkers << " local worker(s)" << std::endl;
+
+  RenderImage image;
+  RenderSettings settings;
+  const int result = coordinator.Run(options, image, settings);
+
+  const DistributedRenderStats & stats = coordinator.GetStats();
+  std::cout << "Distributed : " << stats._NbTiles << " tiles, " << stats._NbWorkers << " worker(s), " << stats._NbLostWorkers << " lost, "
+            << stats._NbReassignedTiles << " tile(s) reassigned, " << stats._NbRespawns << " respawn(s), " << stats._Seconds << " s" << std::endl;
+  if ( 0 != result )
+    return 1;
+
+  // Colour buffer of the software rasterizer, as its ReadbackFinalColor gives it
+  std::vector<unsigned char> pixels(image._Pixels.size());
+  for ( size_t i = 0; i < pixels.size(); ++i )
+    pixels[i] = static_cast<unsigned char>(MathUtil::Clamp(image._Pixels[i], 0.f, 1.f) * 255.f + .5f);
+
+  std::error_code dirError;
+  const fs::path outputPath(options._OutputPath);
+  if ( outputPath.has_parent_path() )
+    fs::create_directories(outputPath.parent_path(), dirError);
+  stbi_flip_vertically_on_write(true);
+  if ( !stbi_write_png(outputPath.string().c_str(), image._Width, image._Height, 4, pixels.data(), image._Width * 4) )
+  {
+    std::cout << "Distributed : ERROR. Failed to save " << fs::absolute(outputPath) << std::endl;
+    return 1;
+  }
+
+  std::cout << "Frame saved in " << fs::absolute(outputPath) << std::endl;
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// ParseDistributedArgs
+// ----------------------------------------------------------------------------
+bool ParseDistributedArgs( int iArgc, const char * const * iArgv, int iFirstArg, DistributedRenderOptions & oOptions, std::string & oError )
+{
+  oOptions = DistributedRenderOptions();
+  oOptions._NbWorkers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  oOptions._WorkerExecutable = ( iArgv && iArgv[0] ) ? ( iArgv[0] ) : ( "" );
+  oError.clear();
+
+  for ( int i = iFirstArg; i < iArgc; ++i )
+  {
+    const std::string argument = ( iArgv[i] ) ? ( iArgv[i] ) : ( "" );
+    if ( 0 != argument.rfind("--", 0) )
+    {
+      if ( !oOptions._Scene.empty() )
+      {
+        oError = "a single scene is rendered at a time";
+        return false;
+      }
+      oOptions._Scene = argument;
+      continue;
+    }
+    if ( "--remote" == argument )
+    {
+      oOptions._AcceptRemote = true;
+      continue;
+    }
+
+    if ( ( i + 1 >= iArgc ) || !iArgv[i + 1] )
+    {
+      oError = "missing value for " + argument;
+      return false;
+    }
+    const std::string value = iArgv[++i];
+
+    bool valid = true;
+    if ( "--workers" == argument )
+      valid = ParseInt(value, 0, oOptions._NbWorkers);
+    else if ( "--port" == argument )
+      valid = ParseInt(value, 0, oOptions._Port) && ( oOptions._Port <= 65535 );
+    else if ( "--resolution" == argument )
+      valid = ParseSize(value, oOptions._Resolution);
+    else if ( "--tile" == argument )
+      valid = ParseSize(value, oOptions._TileResolution);
+    else if ( "--tiles-per-range" == argument )
+      valid = ParseInt(value, 1, oOptions._TilesPerRange);
+    else if ( "--retries" == argument )
+      valid = ParseInt(value, 0, oOptions._MaxRetries);
+    else if ( "--timeout" == argument )
+      valid = ParseInt(value, 1, oOptions._TimeoutSeconds);
+    else if ( "--output" == argument )
+      oOptions._OutputPath = value;
+    else
+    {
+      oError = "unknown option " + argument;
+      return false;
+    }
+
+    if ( !valid )
+    {
+      oError = "invalid value " + value + " for " + argument;
+      return false;
+    }
+  }
+
+  if ( oOptions._Scene.empty() )
+  {
+    oError = "no scene to render";
+    return false;
+  }
+  if ( ( 0 == oOptions._NbWorkers ) && !oOptions._AcceptRemote )
+  {
+    oError = "without local workers, --remote is needed to accept remote ones";
+    return false;
+  }
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ParseTileWorkerArgs
+// ----------------------------------------------------------------------------
+bool ParseTileWorkerArgs( int iArgc, const char * const * iArgv, int iFirstArg, TileWorkerOptions & oOptions, std::string & oError )
+{
+  oOptions = TileWorkerOptions();
+  oError.clear();
+
+  const std::string address = ( ( iFirstArg < iArgc ) && iArgv[iFirstArg] ) ? ( iArgv[iFirstArg] ) : ( "" );
+  const size_t separator = address.rfind(':');
+  if ( ( std::string::npos == separator ) || ( 0 == separator ) || !ParseInt(address.substr(separator + 1), 1, oOptions._Port) || ( oOptions._Port > 65535 ) )
+  {
+    oError = "expected HOST:PORT, got \"" + address + "\"";
+    return false;
+  }
+  oOptions._Host = address.substr(0, separator);
+
+  if ( iFirstArg + 1 < iArgc )
+  {
+    oError = "unexpected argument " + std::string(( iArgv[iFirstArg + 1] ) ? ( iArgv[iFirstArg + 1] ) : ( "" ));
+    return false;
+  }
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// PrintDistributedUsage
+// ----------------------------------------------------------------------------
+void PrintDistributedUsage( const char * iExeName )
+{
+  std::cout << "Usage: " << iExeName << " --distributed [options] SCENE" << std::endl;
+  std::cout << "       " << iExeName << " --tile-worker HOST:PORT" << std::endl;
+  std::cout << "Renders one frame with the software rasterizer, split in tiles across worker processes." << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "  --workers N              Local worker processes (default : one per hardware thread, 0 : remote workers only)" << std::endl;
+  std::cout << "  --remote                 Accept workers from other hosts (default : loopback only)" << std::endl;
+  std::cout << "  --port N                 Coordinator port (default : any free port)" << std::endl;
+  std::cout << "  --resolution WIDTHxHEIGHT (default : scene settings)" << std::endl;
+  std::cout << "  --tile WIDTHxHEIGHT      Tile size (default 64x64)" << std::endl;
+  std::cout << "  --tiles-per-range N      Tiles assigned at once to a worker (default 4)" << std::endl;
+  std::cout << "  --retries N              Reassignments per tile and local worker respawns (default 3)" << std::endl;
+  std::cout << "  --timeout S              Seconds before a silent worker is dropped (default 60)" << std::endl;
+  std::cout << "  --output FILE            PNG path (default distributed.png)" << std::endl;
+}
+
+}
@@ -0,0 +1,109 @@
+#ifndef _DistributedRender_
+#define _DistributedRender_
+
+#include "MathUtil.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace RTRT
+{
+
+struct RenderImage;
+struct RenderSettings;
+
+// One frame split across worker processes rendering tiles with the SoftwareRasterizer CPU pipeline, no GPU needed.
+// The coordinator sends the job and ranges of tiles over TCP, the workers stream back every tile as soon as it is rendered.
+// The tiles of a lost worker go back to the queue, local workers that exit early are respawned.
+struct DistributedRenderOptions
+{
+  std::string _Scene;
+  Vec2i       _Resolution      = Vec2i(0);   // 0 : scene settings
+  Vec2i       _TileResolution  = Vec2i(64);
+  int         _NbWorkers       = 4;          // Local worker processes, 0 : remote workers only
+  int         _Port            = 0;          // 0 : any free port
+  int         _TilesPerRange   = 4;          // Tiles assigned at once to a worker
+  int         _MaxRetries      = 3;          // Reassignments per tile, and local worker respawns
+  int         _TimeoutSeconds  = 60;         // Silent worker, or no worker at all, before giving up
+  bool        _AcceptRemote    = false;      // Listen on every interface instead of the loopback only
+  std::string _WorkerExecutable;             // Program spawned as "--tile-worker HOST:PORT"
+  std::string _OutputPath      = "distributed.png";
+};
+
+struct TileWorkerOptions
+{
+  std::string _Host     = "127.0.0.1";
+  int         _Port     = 0;
+  int         _MaxTiles = 0;                 // Tests only, > 0 : drops the connection after that many tiles to exercise the failover
+};
+
+struct DistributedRenderStats
+{
+  int    _NbTiles           = 0;
+  int    _NbWorkers         = 0;             // Connections that completed the handshake
+  int    _NbLostWorkers     = 0;
+  int    _NbReassignedTiles = 0;
+  int    _NbRespawns        = 0;
+  double _Seconds           = 0.;
+};
+
+class TileCoordinator
+{
+public:
+  TileCoordinator();
+  ~TileCoordinator();
+
+  int Listen( int iPort, bool iAcceptRemote = false );
+  int GetPort() const { return _Port; }
+
+  // Loads the scene settings, hands the tiles out to the workers and assembles the frame (linear RGBA, rows from the bottom)
+  int Run( const DistributedRenderOptions & iOptions, RenderImage & oImage, RenderSettings & oSettings );
+
+  const DistributedRenderStats & GetStats() const { return _Stats; }
+
+protected:
+  void ServeWorker( intptr_t iSocket );
+  bool TakeRange( std::vector<int> & oTiles );
+  void ReleaseRange( const std::vector<int> & iTiles, const std::vector<unsigned char> & iReceived );
+  void ShutdownWorkers();
+
+protected:
+  intptr_t                   _ListenSocket = -1;
+  int                        _Port = 0;
+
+  DistributedRenderOptions   _Options;
+  std::vector<unsigned char> _JobPayload;
+  RenderImage              * _Image = nullptr;
+  Vec2i                      _TileSize = Vec2i(0);
+  Vec2i                      _NbTiles = Vec2i(0);
+
+  std::mutex                 _Mutex;
+  std::deque<int>            _Pending;
+  std::vector<int>           _Attempts;
+  int                        _NbDone = 0;
+  int                        _NbActiveWorkers = 0;
+  bool                       _Failed = false;
+  std::vector<intptr_t>      _WorkerSockets;
+
+  DistributedRenderStats     _Stats;
+};
+
+int RunTileWorker( const TileWorkerOptions & iOptions );
+
+// Spawns the local workers when requested, runs the coordinator and writes the PNG. Returns 0 on success.
+int RunDistributedRender( const DistributedRenderOptions & iOptions );
+
+// Arguments following "--distributed" : [options] scene
+bool ParseDistributedArgs( int iArgc, const char * const * iArgv, int iFirstArg, DistributedRenderOptions & oOptions, std::string & oError );
+
+// Arguments following "--tile-worker" : HOST:PORT
+bool ParseTileWorkerArgs( int iArgc, const char * const * iArgv, int iFirstArg, TileWorkerOptions & oOptions, std::string & oError );
+
+void PrintDistributedUsage( const char * iExeName );
+
+}
+
+#endif /* _DistributedRender_ */
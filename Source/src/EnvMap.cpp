@@ -1,10 +1,60 @@
 #include "EnvMap.h"
+#include "JobSystem.h"
 #include "stb_image.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 namespace RTRT
 {
 
+static const int S_MinRowsPerJob = 64;
+
+// Vose's alias method : entry i keeps i with probability oTable[2i], else picks oTable[2i+1]
+static void BuildAliasTable( const float * iWeights, int iCount, double iSum, float * oTable )
+{
+  for ( int i = 0; i < iCount; ++i )
+  {
+    oTable[2 * i] = 1.f;
+    oTable[2 * i + 1] = (float)i;
+  }
+
+  if ( iSum <= 0. )
+    return;
+
+  std::vector<double> scaled(iCount);
+  std::vector<int> small, large;
+  small.reserve(iCount);
+  large.reserve(iCount);
+  for ( int i = 0; i < iCount; ++i )
+  {
+    scaled[i] = iWeights[i] * iCount / iSum;
+    if ( scaled[i] < 1. )
+      small.push_back(i);
+    else
+      large.push_back(i);
+  }
+
+  while ( !small.empty() && !large.empty() )
+  {
+    int s = small.back();
+    small.pop_back();
+    int l = large.back();
+
+    oTable[2 * s] = (float)scaled[s];
+    oTable[2 * s + 1] = (float)l;
+
+    scaled[l] -= ( 1. - scaled[s] );
+    if ( scaled[l] < 1. )
+    {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // Leftovers only differ from 1 by rounding errors : they keep their own index
+}
+
 EnvMap::~EnvMap()
 {
   Reset();
@@ -16,7 +66,9 @@ void EnvMap::Reset()
     stbi_image_free(_RawData);
   _RawData = nullptr;
 
-  DeleteTab(_CDF);
+  DeleteTab(_MarginalCDF);
+  DeleteTab(_ConditionalCDF);
+  DeleteTab(_AliasTable);
 
   _IsInitialized = false;
   _Handle        = 0;
@@ -49,34 +101,110 @@ bool EnvMap::Load( const std::string & iFilename )
   return true;
 }
 
+// Marginal / conditional distributions of the texels, weighted by sin(theta) :
+// the equirectangular rows shrink toward the poles, their texels cover less solid angle.
 void EnvMap::BuildCDF()
 {
-  DeleteTab(_CDF);
+  DeleteTab(_MarginalCDF);
+  DeleteTab(_ConditionalCDF);
+  DeleteTab(_AliasTable);
   _TotalWeight = 0.f;
 
   if ( !_RawData || !_Width || !_Height )
     return;
 
-  // Gather weights for CDF
-  std::vector<float> weights;
-  weights.resize(_Width * _Height);
-  for ( int y = 0; y < _Height; ++y )
+  const int aliasWidth = GetAliasTableWidth();
+  _MarginalCDF    = new float[_Height];
+  _ConditionalCDF = new float[_Width * _Height];
+  _AliasTable     = new float[2 * aliasWidth * GetAliasTableHeight()];
+  std::fill(_AliasTable, _AliasTable + 2 * aliasWidth * GetAliasTableHeight(), 0.f);
+
+  // Rows are independent : conditional CDF and alias table of each row
+  std::vector<double> rowWeights(_Height, 0.);
+  auto buildRows = [this, aliasWidth, &rowWeights]( int iFirstRow, int iLastRow )
   {
-    for ( int x = 0; x < _Width; ++x )
+    std::vector<float> weights(_Width);
+    for ( int y = iFirstRow; y < iLastRow; ++y )
     {
-      int index = x + y * _Width;
-      weights[index] = MathUtil::Luminance(Vec3(_RawData[index * 3 + 0], _RawData[index * 3 + 1], _RawData[index * 3 + 2]));
+      const float sinTheta = std::sin(( y + .5f ) / _Height * M_PI);
+      float * cdf = &_ConditionalCDF[y * _Width];
+
+      double sum = 0.;
+      for ( int x = 0; x < _Width; ++x )
+      {
+        int index = x + y * _Width;
+        weights[x] = std::max(0.f, MathUtil::Luminance(Vec3(_RawData[index * 3 + 0], _RawData[index * 3 + 1], _RawData[index * 3 + 2]))) * sinTheta;
+        sum += weights[x];
+        cdf[x] = (float)sum;
+      }
+
+      for ( int x = 0; x < _Width; ++x )
+        cdf[x] = ( sum > 0. ) ? ( (float)( cdf[x] / sum ) ) : ( (float)( x + 1 ) / _Width );
+      cdf[_Width - 1] = 1.f;
+
+      BuildAliasTable(weights.data(), _Width, sum, &_AliasTable[2 * y * aliasWidth]);
+      rowWeights[y] = sum;
     }
+  };
+
+  // Without worker threads JobSystem::Wait() never returns : the calling thread builds every row
+  int nbJobs = 1;
+  if ( JobSystem::Get().IsInitialized() )
+    nbJobs = std::clamp(_Height / S_MinRowsPerJob, 1, static_cast<int>(JobSystem::Get().GetThreadCount()));
+  const int rowsPerJob = ( _Height + nbJobs - 1 ) / nbJobs;
+  for ( int job = 1; job < nbJobs; ++job )
+  {
+    const int firstRow = std::min(job * rowsPerJob, _Height);
+    const int lastRow = std::min(( job + 1 ) * rowsPerJob, _Height);
+    JobSystem::Get().Execute([&buildRows, firstRow, lastRow]() { buildRows(firstRow, lastRow); });
+  }
+  buildRows(0, std::min(rowsPerJob, _Height));
+  if ( nbJobs > 1 )
+    JobSystem::Get().Wait();
+
+  // Rows distribution, its alias table is the last row of the table
+  double total = 0.;
+  for ( int y = 0; y < _Height; ++y )
+  {
+    total += rowWeights[y];
+    _MarginalCDF[y] = (float)total;
   }
+  for ( int y = 0; y < _Height; ++y )
+    _MarginalCDF[y] = ( total > 0. ) ? ( (float)( _MarginalCDF[y] / total ) ) : ( (float)( y + 1 ) / _Height );
+  _MarginalCDF[_Height - 1] = 1.f;
+
+  std::vector<float> marginalWeights(rowWeights.begin(), rowWeights.end());
+  BuildAliasTable(marginalWeights.data(), _Height, total, &_AliasTable[2 * _Height * aliasWidth]);
+
+  _TotalWeight = (float)total;
+}
+
+// Texel from the marginal and conditional CDFs, jittered inside the texel
+// oPdf : density over the [0, 1]^2 uv domain
+Vec2 EnvMap::ImportanceSample( Vec2 iRand, float & oPdf ) const
+{
+  oPdf = 0.f;
+  if ( !_MarginalCDF || !_ConditionalCDF || ( _TotalWeight <= 0.f ) )
+    return iRand;
+
+  auto sampleCDF = []( const float * iCDF, int iCount, float & ioRand )
+  {
+    int index = std::min((int)( std::upper_bound(iCDF, iCDF + iCount, ioRand) - iCDF ), iCount - 1);
+    float lower = ( index > 0 ) ? ( iCDF[index - 1] ) : ( 0.f );
+    float width = iCDF[index] - lower;
+    ioRand = ( width > 0.f ) ? ( std::min(( ioRand - lower ) / width, .99999f) ) : ( .5f );
+    return index;
+  };
 
-  // Build CDF
-  _CDF = new float[_Width * _Height];
-  _CDF[0] = weights[0];
+  int y = sampleCDF(_MarginalCDF, _Height, iRand.y);
+  int x = sampleCDF(&_ConditionalCDF[y * _Width], _Width, iRand.x);
 
-  for ( int i = 1; i < ( _Width * _Height ); ++i )
-    _CDF[i] = _CDF[i - 1] + weights[i];
+  const int index = x + y * _Width;
+  const float sinTheta = std::sin(( y + .5f ) / _Height * M_PI);
+  const float weight = std::max(0.f, MathUtil::Luminance(Vec3(_RawData[index * 3 + 0], _RawData[index * 3 + 1], _RawData[index * 3 + 2]))) * sinTheta;
+  oPdf = weight / _TotalWeight * _Width * _Height;
 
-  _TotalWeight = _CDF[_Width * _Height - 1];
+  return Vec2(( x + iRand.x ) / _Width, ( y + iRand.y ) / _Height);
 }
 
 Vec4 EnvMap::Sample( int iX, int iY ) const
@@ -1,6 +1,7 @@
 #ifndef _EnvMap_
 #define _EnvMap_
 
+#include <algorithm>
 #include <string>
 #include "MathUtil.h"
 
@@ -24,7 +25,13 @@ public:
   int GetWidth() const { return _Width; }
   int GetHeight() const { return _Height; }
   float * GetRawData() const { return _RawData; }
-  float * GetCDF() const { return _CDF; }
+
+  // Texel weights : luminance * sin(theta) of the texel center row
+  float * GetMarginalCDF() const { return _MarginalCDF; }       // _Height values, rows
+  float * GetConditionalCDF() const { return _ConditionalCDF; } // _Width values per row, columns of the row
+  float * GetAliasTable() const { return _AliasTable; }         // (threshold, alias) pairs : one table per row, then the rows table
+  int GetAliasTableWidth() const { return std::max(_Width, _Height); }
+  int GetAliasTableHeight() const { return _Height + 1; }
 
   float GetTotalWeight() const { return _TotalWeight; }
 
@@ -35,21 +42,25 @@ public:
   Vec4 Sample( Vec2 iUV ) const;
   Vec4 BiLinearSample( Vec2 iUV ) const;
 
+  Vec2 ImportanceSample( Vec2 iRand, float & oPdf ) const;
+
   const std::string & Filename() const { return _Filename; }
 
 private:
 
   void BuildCDF();
 
-  bool          _IsInitialized = false;
-  GLuint        _Handle        = 0;
-  int           _Width         = 0;
-  int           _Height        = 0;
-
-  std::string   _Filename      = "";
-  float       * _RawData       = nullptr;
-  float       * _CDF           = nullptr; // Cumulative distribution function
-  float         _TotalWeight   = 0.f;
+  bool          _IsInitialized  = false;
+  GLuint        _Handle         = 0;
+  int           _Width          = 0;
+  int           _Height         = 0;
+
+  std::string   _Filename       = "";
+  float       * _RawData        = nullptr;
+  float       * _MarginalCDF    = nullptr; // Cumulative distribution functions, normalized
+  float       * _ConditionalCDF = nullptr;
+  float       * _AliasTable     = nullptr; // Walker alias tables, O(1) sampling on the GPU
+  float         _TotalWeight    = 0.f;
 
   EnvMap( const EnvMap & ); // not implemented
   EnvMap & operator=( const EnvMap & ); // not implemented
@@ -0,0 +1,147 @@
+#include "FpsBroadphase.h"
+
+#include <algorithm>
+
+namespace RTRT
+{
+
+// ----------------------------------------------------------------------------
+// Clear
+// ----------------------------------------------------------------------------
+void FpsBroadphase::Clear()
+{
+  _Nodes.clear();
+  _Items.clear();
+  _Generation++;
+}
+
+// ----------------------------------------------------------------------------
+// Build
+// ----------------------------------------------------------------------------
+int FpsBroadphase::Build( const std::vector<AABB<Vec3>> & iObjectBounds, const std::vector<FpsCollisionObb> & iColliders )
+{
+  Clear();
+
+  _Items.reserve(iObjectBounds.size() + iColliders.size());
+  for ( int i = 0; i < static_cast<int>(iObjectBounds.size()); ++i )
+  {
+    const AABB<Vec3> & bounds = iObjectBounds[i];
+    if ( ( bounds._Low.x > bounds._High.x ) || ( bounds._Low.y > bounds._High.y ) || ( bounds._Low.z > bounds._High.z ) )
+      continue;
+
+    FpsBroadphaseItem item;
+    item._Bounds = bounds;
+    item._Centroid = bounds.Center();
+    item._Layer = FpsBroadphaseLayer::Object;
+    item._Index = i;
+    _Items.push_back(item);
+  }
+
+  for ( int i = 0; i < static_cast<int>(iColliders.size()); ++i )
+  {
+    FpsBroadphaseItem item;
+    item._Bounds = iColliders[i]._Bounds;
+    item._Centroid = item._Bounds.Center();
+    item._Layer = FpsBroadphaseLayer::PropCollider;
+    item._Index = i;
+    _Items.push_back(item);
+  }
+
+  if ( _Items.empty() )
+    return 0;
+
+  _Nodes.reserve(2 * ( _Items.size() / S_MaxLeafItems + 1 ));
+  BuildNode(0, static_cast<int>(_Items.size()));
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// BuildNode
+// ----------------------------------------------------------------------------
+int FpsBroadphase::BuildNode( int iFirstItem, int iNbItems )
+{
+  const int nodeIndex = static_cast<int>(_Nodes.size());
+  _Nodes.push_back(FpsBroadphaseNode());
+
+  AABB<Vec3> bounds;
+  AABB<Vec3> centroidBounds;
+  for ( int i = iFirstItem; i < iFirstItem + iNbItems; ++i )
+  {
+    bounds.Insert(_Items[i]._Bounds._Low);
+    bounds.Insert(_Items[i]._Bounds._High);
+    centroidBounds.Insert(_Items[i]._Centroid);
+  }
+  _Nodes[nodeIndex]._Bounds = bounds;
+
+  const Vec3 extent = centroidBounds._High - centroidBounds._Low;
+  int splitAxis = 0;
+  if ( extent.y > extent[splitAxis] )
+    splitAxis = 1;
+  if ( extent.z > extent[splitAxis] )
+    splitAxis = 2;
+
+  if ( ( iNbItems <= S_MaxLeafItems ) || ( extent[splitAxis] <= EPSILON ) )
+  {
+    _Nodes[nodeIndex]._FirstItem = iFirstItem;
+    _Nodes[nodeIndex]._NbItems = iNbItems;
+    return nodeIndex;
+  }
+
+  const int nbLeft = iNbItems / 2;
+  std::nth_element(_Items.begin() + iFirstItem,
+                   _Items.begin() + iFirstItem + nbLeft,
+                   _Items.begin() + iFirstItem + iNbItems,
+                   [splitAxis]( const FpsBroadphaseItem & iA, const FpsBroadphaseItem & iB ) { return iA._Centroid[splitAxis] < iB._Centroid[splitAxis]; });
+
+  const int left = BuildNode(iFirstItem, nbLeft);
+  const int right = BuildNode(iFirstItem + nbLeft, iNbItems - nbLeft);
+  _Nodes[nodeIndex]._Left = left;
+  _Nodes[nodeIndex]._Right = right;
+  return nodeIndex;
+}
+
+// ----------------------------------------------------------------------------
+// Query
+// ----------------------------------------------------------------------------
+void FpsBroadphase::Query( const AABB<Vec3> & iBounds, FpsBroadphaseQuery & oResult ) const
+{
+  oResult.Clear();
+  if ( _Nodes.empty() )
+    return;
+
+  std::vector<int> & stack = oResult._Stack;
+  stack.clear();
+  stack.push_back(0);
+
+  while ( !stack.empty() )
+  {
+    const FpsBroadphaseNode & node = _Nodes[stack.back()];
+    stack.pop_back();
+    if ( !FpsCollision::OverlapAABB(iBounds, node._Bounds) )
+      continue;
+
+    if ( node._Left < 0 )
+    {
+      for ( int i = node._FirstItem; i < node._FirstItem + node._NbItems; ++i )
+      {
+        const FpsBroadphaseItem & item = _Items[i];
+        if ( !FpsCollision::OverlapAABB(iBounds, item._Bounds) )
+          continue;
+
+        if ( FpsBroadphaseLayer::Object == item._Layer )
+          oResult._Objects.push_back(item._Index);
+        else
+          oResult._Colliders.push_back(item._Index);
+      }
+      continue;
+    }
+
+    stack.push_back(node._Right);
+    stack.push_back(node._Left);
+  }
+
+  std::sort(oResult._Objects.begin(), oResult._Objects.end());
+  std::sort(oResult._Colliders.begin(), oResult._Colliders.end());
+}
+
+}
@@ -0,0 +1,72 @@
+#ifndef _FpsBroadphase_
+#define _FpsBroadphase_
+
+#include "FpsCollision.h"
+#include "MathUtil.h"
+
+#include <vector>
+
+namespace RTRT
+{
+
+enum class FpsBroadphaseLayer
+{
+  Object = 0,
+  PropCollider
+};
+
+struct FpsBroadphaseItem
+{
+  AABB<Vec3>         _Bounds;
+  Vec3               _Centroid = Vec3(0.f);
+  FpsBroadphaseLayer _Layer = FpsBroadphaseLayer::Object;
+  int                _Index = -1;
+};
+
+struct FpsBroadphaseNode
+{
+  AABB<Vec3> _Bounds;
+  int        _Left = -1;
+  int        _Right = -1;
+  int        _FirstItem = 0;
+  int        _NbItems = 0;
+};
+
+struct FpsBroadphaseQuery
+{
+  std::vector<int> _Objects;
+  std::vector<int> _Colliders;
+  std::vector<int> _Stack;     // Traversal scratch, kept by the caller so concurrent queries never share it
+
+  void Clear() { _Objects.clear(); _Colliders.clear(); }
+};
+
+// Static AABB tree over collidable scene objects and prop collision OBBs.
+// Queries return indices sorted in ascending order so callers resolve contacts in the same order as a linear scan.
+class FpsBroadphase
+{
+public:
+  void Clear();
+  int Build( const std::vector<AABB<Vec3>> & iObjectBounds, const std::vector<FpsCollisionObb> & iColliders );
+  void Query( const AABB<Vec3> & iBounds, FpsBroadphaseQuery & oResult ) const;
+
+  bool IsEmpty() const { return _Nodes.empty(); }
+  int GetNbNodes() const { return static_cast<int>(_Nodes.size()); }
+  int GetNbItems() const { return static_cast<int>(_Items.size()); }
+  // Changes on every Clear / Build : data derived from the same objects and colliders stays valid while it does not
+  unsigned int GetGeneration() const { return _Generation; }
+
+protected:
+  int BuildNode( int iFirstItem, int iNbItems );
+
+protected:
+  static constexpr int S_MaxLeafItems = 4;
+
+  std::vector<FpsBroadphaseNode> _Nodes;
+  std::vector<FpsBroadphaseItem> _Items;
+  unsigned int                   _Generation = 0;
+};
+
+}
+
+#endif /* _FpsBroadphase_ */
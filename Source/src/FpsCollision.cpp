@@ -1,6 +1,7 @@
 #include "FpsCollision.h"
 
 #include <algorithm>
+#include <cfloat>
 #include <cmath>
 
 namespace RTRT
@@ -260,6 +261,156 @@ bool FpsCollision::ResolveSphereObb( const Vec3 & iSphereCenter, float iSphereRa
   return true;
 }
 
+// ----------------------------------------------------------------------------
+// FpsCollisionSweepBatchResult::Reset
+// ----------------------------------------------------------------------------
+void FpsCollisionSweepBatchResult::Reset()
+{
+  for ( int i = 0; i < FpsCollisionSweepBatch::S_NbLanes; ++i )
+  {
+    _Time[i] = 1.f;
+    _NormalX[i] = 0.f;
+    _NormalY[i] = 1.f;
+    _NormalZ[i] = 0.f;
+    _Shape[i] = -1;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// SweepSphereObb
+// ----------------------------------------------------------------------------
+bool FpsCollision::SweepSphereObb( const Vec3 & iStart, const Vec3 & iDelta, float iRadius, const FpsCollisionObb & iObb, FpsCollisionSweepResult & oResult )
+{
+  oResult = FpsCollisionSweepResult();
+
+  // Slab test against the box grown by the radius on every axis : no edge cylinders or corner spheres
+  const Vec3 offset = iStart - iObb._Center;
+  float tEnter = -FLT_MAX;
+  float tExit = FLT_MAX;
+  Vec3 normal(0.f, 1.f, 0.f);
+  for ( int i = 0; i < 3; ++i )
+  {
+    const float origin = glm::dot(offset, iObb._Axis[i]);
+    const float direction = glm::dot(iDelta, iObb._Axis[i]);
+    const float extent = iObb._HalfExtents[i] + iRadius;
+
+    if ( std::abs(direction) < 1e-8f )
+    {
+      if ( std::abs(origin) > extent )
+        return false;
+      continue;
+    }
+
+    const float invDirection = 1.f / direction;
+    const float t1 = ( -extent - origin ) * invDirection;
+    const float t2 = ( extent - origin ) * invDirection;
+    const float tNear = std::min(t1, t2);
+    if ( tNear > tEnter )
+    {
+      tEnter = tNear;
+      normal = ( direction > 0.f ) ? -iObb._Axis[i] : iObb._Axis[i];
+    }
+    tExit = std::min(tExit, std::max(t1, t2));
+  }
+
+  if ( ( tEnter > tExit ) || ( tEnter < 0.f ) || ( tEnter > 1.f ) )
+    return false;
+
+  oResult._Hit = true;
+  oResult._Time = tEnter;
+  oResult._Normal = normal;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// SweepSphereObbBatch
+// ----------------------------------------------------------------------------
+void FpsCollision::SweepSphereObbBatch( const FpsCollisionSweepBatch & iBatch, const FpsCollisionObb & iObb, int iShape, FpsCollisionSweepBatchResult & ioResult )
+{
+#ifdef SIMD_AVX2
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256 minusOne = _mm256_set1_ps(-1.f);
+  const __m256 lowest = _mm256_set1_ps(-FLT_MAX);
+  const __m256 highest = _mm256_set1_ps(FLT_MAX);
+  const __m256 signMask = _mm256_set1_ps(-0.f);
+  const __m256 parallelEpsilon = _mm256_set1_ps(1e-8f);
+
+  const __m256 offsetX = _mm256_sub_ps(_mm256_load_ps(iBatch._StartX), _mm256_set1_ps(iObb._Center.x));
+  const __m256 offsetY = _mm256_sub_ps(_mm256_load_ps(iBatch._StartY), _mm256_set1_ps(iObb._Center.y));
+  const __m256 offsetZ = _mm256_sub_ps(_mm256_load_ps(iBatch._StartZ), _mm256_set1_ps(iObb._Center.z));
+  const __m256 deltaX = _mm256_load_ps(iBatch._DeltaX);
+  const __m256 deltaY = _mm256_load_ps(iBatch._DeltaY);
+  const __m256 deltaZ = _mm256_load_ps(iBatch._DeltaZ);
+
+  __m256 tEnter = lowest;
+  __m256 tExit = highest;
+  __m256 normalX = zero;
+  __m256 normalY = one;
+  __m256 normalZ = zero;
+  __m256 valid = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+  for ( int i = 0; i < 3; ++i )
+  {
+    const __m256 axisX = _mm256_set1_ps(iObb._Axis[i].x);
+    const __m256 axisY = _mm256_set1_ps(iObb._Axis[i].y);
+    const __m256 axisZ = _mm256_set1_ps(iObb._Axis[i].z);
+    const __m256 extent = _mm256_set1_ps(iObb._HalfExtents[i] + iBatch._Radius);
+
+    const __m256 origin = _mm256_fmadd_ps(offsetZ, axisZ, _mm256_fmadd_ps(offsetY, axisY, _mm256_mul_ps(offsetX, axisX)));
+    const __m256 direction = _mm256_fmadd_ps(deltaZ, axisZ, _mm256_fmadd_ps(deltaY, axisY, _mm256_mul_ps(deltaX, axisX)));
+
+    // Lanes moving parallel to the slab only survive when they start inside it
+    const __m256 parallel = _mm256_cmp_ps(_mm256_andnot_ps(signMask, direction), parallelEpsilon, _CMP_LT_OQ);
+    const __m256 insideSlab = _mm256_cmp_ps(_mm256_andnot_ps(signMask, origin), extent, _CMP_LE_OQ);
+    valid = _mm256_andnot_ps(_mm256_andnot_ps(insideSlab, parallel), valid);
+
+    const __m256 invDirection = _mm256_div_ps(one, _mm256_blendv_ps(direction, one, parallel));
+    const __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(extent, signMask), origin), invDirection);
+    const __m256 t2 = _mm256_mul_ps(_mm256_sub_ps(extent, origin), invDirection);
+    const __m256 tNear = _mm256_blendv_ps(_mm256_min_ps(t1, t2), lowest, parallel);
+    const __m256 tFar = _mm256_blendv_ps(_mm256_max_ps(t1, t2), highest, parallel);
+
+    const __m256 closer = _mm256_cmp_ps(tNear, tEnter, _CMP_GT_OQ);
+    const __m256 sign = _mm256_blendv_ps(one, minusOne, _mm256_cmp_ps(direction, zero, _CMP_GT_OQ));
+    tEnter = _mm256_blendv_ps(tEnter, tNear, closer);
+    normalX = _mm256_blendv_ps(normalX, _mm256_mul_ps(sign, axisX), closer);
+    normalY = _mm256_blendv_ps(normalY, _mm256_mul_ps(sign, axisY), closer);
+    normalZ = _mm256_blendv_ps(normalZ, _mm256_mul_ps(sign, axisZ), closer);
+    tExit = _mm256_min_ps(tExit, tFar);
+  }
+
+  const __m256 bestTime = _mm256_load_ps(ioResult._Time);
+  __m256 hit = _mm256_and_ps(valid, _mm256_cmp_ps(tEnter, tExit, _CMP_LE_OQ));
+  hit = _mm256_and_ps(hit, _mm256_cmp_ps(tEnter, zero, _CMP_GE_OQ));
+  hit = _mm256_and_ps(hit, _mm256_cmp_ps(tEnter, bestTime, _CMP_LT_OQ));
+  if ( 0 == _mm256_movemask_ps(hit) )
+    return;
+
+  _mm256_store_ps(ioResult._Time, _mm256_blendv_ps(bestTime, tEnter, hit));
+  _mm256_store_ps(ioResult._NormalX, _mm256_blendv_ps(_mm256_load_ps(ioResult._NormalX), normalX, hit));
+  _mm256_store_ps(ioResult._NormalY, _mm256_blendv_ps(_mm256_load_ps(ioResult._NormalY), normalY, hit));
+  _mm256_store_ps(ioResult._NormalZ, _mm256_blendv_ps(_mm256_load_ps(ioResult._NormalZ), normalZ, hit));
+  const __m256i shapes = _mm256_load_si256(reinterpret_cast<const __m256i *>(ioResult._Shape));
+  _mm256_store_si256(reinterpret_cast<__m256i *>(ioResult._Shape), _mm256_blendv_epi8(shapes, _mm256_set1_epi32(iShape), _mm256_castps_si256(hit)));
+#else
+  for ( int i = 0; i < iBatch._NbLanes; ++i )
+  {
+    const Vec3 start(iBatch._StartX[i], iBatch._StartY[i], iBatch._StartZ[i]);
+    const Vec3 delta(iBatch._DeltaX[i], iBatch._DeltaY[i], iBatch._DeltaZ[i]);
+    FpsCollisionSweepResult sweep;
+    if ( !SweepSphereObb(start, delta, iBatch._Radius, iObb, sweep) || ( sweep._Time >= ioResult._Time[i] ) )
+      continue;
+
+    ioResult._Time[i] = sweep._Time;
+    ioResult._NormalX[i] = sweep._Normal.x;
+    ioResult._NormalY[i] = sweep._Normal.y;
+    ioResult._NormalZ[i] = sweep._Normal.z;
+    ioResult._Shape[i] = iShape;
+  }
+#endif
+}
+
 // ----------------------------------------------------------------------------
 // EulerTransform
 // ----------------------------------------------------------------------------
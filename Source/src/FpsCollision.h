@@ -2,6 +2,7 @@
 #define _FpsCollision_
 
 #include "MathUtil.h"
+#include "SIMDUtils.h"
 
 namespace RTRT
 {
@@ -31,6 +32,40 @@ struct FpsCollisionSphereResult
   float _Penetration = 0.f;
 };
 
+struct FpsCollisionSweepResult
+{
+  bool  _Hit = false;
+  float _Time = 1.f;
+  Vec3  _Normal = Vec3(0.f, 1.f, 0.f);
+};
+
+// Swept spheres sharing the same radius, stored as structure of arrays (one lane per sphere)
+struct FpsCollisionSweepBatch
+{
+  static constexpr int S_NbLanes = 8;
+
+  SIMD_ALIGN32 float _StartX[S_NbLanes] = {};
+  SIMD_ALIGN32 float _StartY[S_NbLanes] = {};
+  SIMD_ALIGN32 float _StartZ[S_NbLanes] = {};
+  SIMD_ALIGN32 float _DeltaX[S_NbLanes] = {};
+  SIMD_ALIGN32 float _DeltaY[S_NbLanes] = {};
+  SIMD_ALIGN32 float _DeltaZ[S_NbLanes] = {};
+  float              _Radius = 0.f;
+  int                _NbLanes = 0;
+};
+
+// Earliest hit per lane : _Time is the fraction of the sweep delta, _Shape is -1 when the lane is free
+struct FpsCollisionSweepBatchResult
+{
+  SIMD_ALIGN32 float _Time[FpsCollisionSweepBatch::S_NbLanes];
+  SIMD_ALIGN32 float _NormalX[FpsCollisionSweepBatch::S_NbLanes];
+  SIMD_ALIGN32 float _NormalY[FpsCollisionSweepBatch::S_NbLanes];
+  SIMD_ALIGN32 float _NormalZ[FpsCollisionSweepBatch::S_NbLanes];
+  SIMD_ALIGN32 int   _Shape[FpsCollisionSweepBatch::S_NbLanes];
+
+  void Reset();
+};
+
 class FpsCollision
 {
 public:
@@ -43,6 +78,13 @@ public:
   static bool ResolveAabbObbAxis( const Vec3 & iAabbCenter, const Vec3 & iAabbHalfExtents, const FpsCollisionObb & iObb, int iAxis, float iDelta, FpsCollisionAxisResult & oResult );
   static bool ResolveSphereObb( const Vec3 & iSphereCenter, float iSphereRadius, const FpsCollisionObb & iObb, FpsCollisionSphereResult & oResult );
 
+  // Sphere swept along iDelta against the OBB inflated by the radius. Spheres already overlapping at start are ignored.
+  // Conservative near edges and corners : the inflated box keeps square edges where the exact swept shape is rounded,
+  // a hit there can be reported up to (sqrt(3) - 1) * radius away from the surface (at a corner), with a face normal.
+  // Accepted for projectile sized radii ; the batch version makes the same approximation lane by lane.
+  static bool SweepSphereObb( const Vec3 & iStart, const Vec3 & iDelta, float iRadius, const FpsCollisionObb & iObb, FpsCollisionSweepResult & oResult );
+  static void SweepSphereObbBatch( const FpsCollisionSweepBatch & iBatch, const FpsCollisionObb & iObb, int iShape, FpsCollisionSweepBatchResult & ioResult );
+
   static Mat4x4 EulerTransform( const Vec3 & iPosition, const Vec3 & iRotation, const Vec3 & iScale = Vec3(1.f) );
 };
 
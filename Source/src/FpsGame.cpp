@@ -1,5 +1,6 @@
 #include "FpsGame.h"
 
+#include "Boids.h"
 #include "Camera.h"
 #include "FpsGameMap.h"
 #include "Light.h"
@@ -239,23 +240,40 @@ int FpsGameWorld::Reset( const FpsGameSettings & iSettings )
 // Update
 // ----------------------------------------------------------------------------
 int FpsGameWorld::Update( float iDeltaTime, const FpsGameInput & iInput, const FpsGameSettings & iSettings )
+{
+  if ( 0 != BeginFrame(iDeltaTime, iInput, iSettings) )
+    return 1;
+
+  const float dt = MathUtil::Clamp(iDeltaTime, 0.f, 0.05f);
+  if ( dt <= 0.f )
+    return 0;
+
+  StepPlayer(dt, iInput, iSettings);
+  StepProjectiles(dt, iSettings, _Player);
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// BeginFrame
+// ----------------------------------------------------------------------------
+int FpsGameWorld::BeginFrame( float iDeltaTime, const FpsGameInput & iInput, const FpsGameSettings & iSettings )
 {
   if ( iInput._ResetPressed )
     Reset(iSettings);
 
   const float realDt = MathUtil::Clamp(iDeltaTime, 0.f, 0.25f);
-  const float dt = MathUtil::Clamp(iDeltaTime, 0.f, 0.05f);
   if ( realDt <= 0.f )
     return 0;
 
-  FpsProjectilesUpdateContext projectilesContext(iSettings, _Player, _Objects, _PropCollisionColliders);
+  if ( 0 != UpdateBroadphase() )
+    return 1;
+
+  FpsProjectilesUpdateContext projectilesContext(iSettings, _Player, _Objects, _PropCollisionColliders, &_Broadphase);
   _Projectiles.Update(realDt, 0.f, projectilesContext);
   if ( iInput._FirePressed )
     _Projectiles.RequestFire(iSettings, _Player);
 
-  if ( dt <= 0.f )
-    return 0;
-
   _Player._Yaw += iInput._MouseDeltaX * iSettings._MouseSensitivity;
   _Player._Pitch -= iInput._MouseDeltaY * iSettings._MouseSensitivity;
 
@@ -263,6 +281,14 @@ int FpsGameWorld::Update( float iDeltaTime, const FpsGameInput & iInput, const F
     _Player._Yaw -= MathUtil::Sign(_Player._Yaw) * 360.f * floor( fabs( _Player._Yaw / 360.f ) );
   _Player._Pitch = MathUtil::Clamp(_Player._Pitch, -89.f, 89.f);
 
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// StepPlayer
+// ----------------------------------------------------------------------------
+void FpsGameWorld::StepPlayer( float iDeltaTime, const FpsGameInput & iInput, const FpsGameSettings & iSettings )
+{
   const float speed = iInput._Sprint ? iSettings._SprintSpeed : iSettings._MoveSpeed;
 
   if ( iSettings._FreeLook )
@@ -289,7 +315,7 @@ int FpsGameWorld::Update( float iDeltaTime, const FpsGameInput & iInput, const F
       wishDir /= wishLen;
 
     _Player._Velocity = wishDir * speed;
-    _Player._Position += _Player._Velocity * dt;
+    _Player._Position += _Player._Velocity * iDeltaTime;
     _Player._Grounded = false;
   }
   else
@@ -324,30 +350,36 @@ int FpsGameWorld::Update( float iDeltaTime, const FpsGameInput & iInput, const F
       _Player._Grounded = false;
     }
 
-    _Player._Velocity.y -= iSettings._Gravity * dt;
+    _Player._Velocity.y -= iSettings._Gravity * iDeltaTime;
 
-    MoveAxis(0, _Player._Velocity.x * dt, iSettings);
-    MoveAxis(2, _Player._Velocity.z * dt, iSettings);
+    MoveAxis(0, _Player._Velocity.x * iDeltaTime, iSettings);
+    MoveAxis(2, _Player._Velocity.z * iDeltaTime, iSettings);
 
     _Player._Grounded = false;
-    MoveAxis(1, _Player._Velocity.y * dt, iSettings);
+    MoveAxis(1, _Player._Velocity.y * iDeltaTime, iSettings);
   }
 
   const float horizontalSpeed = glm::length(Vec2(_Player._Velocity.x, _Player._Velocity.z));
   const float yawRad = MathUtil::ToRadians(_Player._Yaw);
   const Vec3 right(-std::sin(yawRad), 0.f, std::cos(yawRad));
   FpsHeadBobUpdate headBobUpdate;
-  headBobUpdate._DeltaTime = dt;
+  headBobUpdate._DeltaTime = iDeltaTime;
   headBobUpdate._HorizontalSpeed = horizontalSpeed;
   headBobUpdate._Grounded = _Player._Grounded;
   headBobUpdate._Enabled = !iSettings._FreeLook;
   headBobUpdate._Right = right;
   headBobUpdate._Up = Vec3(0.f, 1.f, 0.f);
   _Player._HeadBob.Update(iSettings._HeadBob, headBobUpdate);
+}
 
-  _Projectiles.Update(0.f, dt, projectilesContext);
-
-  return 0;
+// ----------------------------------------------------------------------------
+// StepProjectiles
+// ----------------------------------------------------------------------------
+void FpsGameWorld::StepProjectiles( float iDeltaTime, const FpsGameSettings & iSettings, const FpsPlayer & iPlayer, bool iAllowJobs )
+{
+  FpsProjectilesUpdateContext projectilesContext(iSettings, iPlayer, _Objects, _PropCollisionColliders, &_Broadphase);
+  projectilesContext._AllowJobs = iAllowJobs;
+  _Projectiles.Update(0.f, iDeltaTime, projectilesContext);
 }
 
 // ----------------------------------------------------------------------------
@@ -366,6 +398,98 @@ void FpsGameWorld::ClearProjectiles()
   _Projectiles.Clear();
 }
 
+// ----------------------------------------------------------------------------
+// UpdateBroadphase
+// ----------------------------------------------------------------------------
+int FpsGameWorld::UpdateBroadphase()
+{
+  if ( !_BroadphaseDirty )
+    return 0;
+
+  std::vector<AABB<Vec3>> objectBounds(_Objects.size());
+  for ( int i = 0; i < static_cast<int>(_Objects.size()); ++i )
+  {
+    const FpsSceneObject & object = _Objects[i];
+    if ( !object._Collidable )
+      continue;
+
+    // Projectiles test the unrotated half extents while the player uses the rotated ones : keep both inside the bounds
+    const Vec3 halfExtents = MathUtil::Max(MathUtil::Max(ObjectCollisionHalfExtents(object), object._HalfExtents), Vec3(0.05f));
+    objectBounds[i].Insert(object._Center - halfExtents);
+    objectBounds[i].Insert(object._Center + halfExtents);
+  }
+
+  if ( 0 != _Broadphase.Build(objectBounds, _PropCollisionColliders) )
+    return 1;
+
+  _BroadphaseDirty = false;
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// ResolveBoidCollisions
+// ----------------------------------------------------------------------------
+int FpsGameWorld::ResolveBoidCollisions( BoidSimulation & ioSimulation, const BoidSettings & iSettings )
+{
+  if ( !iSettings._CollideWithWorld )
+    return 0;
+  if ( 0 != UpdateBroadphase() )
+    return 1;
+  if ( _Broadphase.IsEmpty() )
+    return 0;
+
+  // Local query scratch : flocks are resolved concurrently by the fixed-step scheduler
+  FpsBroadphaseQuery query;
+  const float radius = std::max(0.01f, iSettings._Scale * 0.5f);
+  for ( BoidState & boid : ioSimulation.GetBoids() )
+  {
+    AABB<Vec3> boidBounds;
+    boidBounds.Insert(boid._Position - Vec3(radius));
+    boidBounds.Insert(boid._Position + Vec3(radius));
+    _Broadphase.Query(boidBounds, query);
+
+    for ( int objectIndex : query._Objects )
+    {
+      if ( objectIndex >= static_cast<int>(_Objects.size()) )
+        continue;
+
+      const FpsSceneObject & object = _Objects[objectIndex];
+      if ( !object._Collidable )
+        continue;
+
+      const Mat4x4 rotation = BuildObjectRotationTransform(object);
+      const Vec3 axes[3] = { Vec3(rotation[0]), Vec3(rotation[1]), Vec3(rotation[2]) };
+      const FpsCollisionObb obb = FpsCollision::MakeObb(-1, -1, object._Center, axes, object._HalfExtents);
+
+      FpsCollisionSphereResult hit;
+      if ( !FpsCollision::ResolveSphereObb(boid._Position, radius, obb, hit) )
+        continue;
+
+      boid._Position += hit._Correction;
+      const float normalSpeed = glm::dot(boid._Velocity, hit._Normal);
+      if ( normalSpeed < 0.f )
+        boid._Velocity -= 2.f * normalSpeed * hit._Normal;
+    }
+
+    for ( int colliderIndex : query._Colliders )
+    {
+      if ( colliderIndex >= static_cast<int>(_PropCollisionColliders.size()) )
+        continue;
+
+      FpsCollisionSphereResult hit;
+      if ( !FpsCollision::ResolveSphereObb(boid._Position, radius, _PropCollisionColliders[colliderIndex], hit) )
+        continue;
+
+      boid._Position += hit._Correction;
+      const float normalSpeed = glm::dot(boid._Velocity, hit._Normal);
+      if ( normalSpeed < 0.f )
+        boid._Velocity -= 2.f * normalSpeed * hit._Normal;
+    }
+  }
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // PlayerForward
 // ----------------------------------------------------------------------------
@@ -386,6 +510,7 @@ void FpsGameWorld::BuildDefaultArena()
 {
   _Objects.clear();
   _PropCollisionColliders.clear();
+  _BroadphaseDirty = true;
   _SpawnPosition = Vec3(0.f, 0.05f, -8.f);
   _SpawnYaw = 90.f;
   _SpawnPitch = 0.f;
@@ -415,6 +540,7 @@ void FpsGameWorld::BuildFromMap( const FpsGameMap & iMap )
 {
   _Objects = iMap._Objects;
   _PropCollisionColliders.clear();
+  _BroadphaseDirty = true;
   _SpawnPosition = iMap._Player._Position;
   _SpawnYaw = iMap._Player._Yaw;
   _SpawnPitch = iMap._Player._Pitch;
@@ -432,8 +558,25 @@ void FpsGameWorld::MoveAxis( int iAxis, float iDelta, const FpsGameSettings & iS
 
   _Player._Position[iAxis] += iDelta;
 
-  for ( const FpsSceneObject & object : _Objects )
+  const Vec3 playerHalf(std::max(iSettings._PlayerRadius, 0.05f),
+                        std::max(iSettings._PlayerHeight * 0.5f, 0.1f),
+                        std::max(iSettings._PlayerRadius, 0.05f));
+
+  // Swept player box, padded so contacts reached after a correction are still part of the candidates
+  Vec3 playerCenter = _Player._Position + Vec3(0.f, playerHalf.y, 0.f);
+  Vec3 previousCenter = playerCenter;
+  previousCenter[iAxis] -= iDelta;
+  AABB<Vec3> sweptBounds;
+  sweptBounds.Insert(MathUtil::Min(previousCenter, playerCenter) - playerHalf * 2.f);
+  sweptBounds.Insert(MathUtil::Max(previousCenter, playerCenter) + playerHalf * 2.f);
+  _Broadphase.Query(sweptBounds, _BroadphaseQuery);
+
+  for ( int objectIndex : _BroadphaseQuery._Objects )
   {
+    if ( objectIndex >= static_cast<int>(_Objects.size()) )
+      continue;
+
+    const FpsSceneObject & object = _Objects[objectIndex];
     if ( !object._Collidable )
       continue;
 
@@ -459,14 +602,14 @@ void FpsGameWorld::MoveAxis( int iAxis, float iDelta, const FpsGameSettings & iS
       _Player._Grounded = true;
   }
 
-  for ( const FpsCollisionObb & collider : _PropCollisionColliders )
+  for ( int colliderIndex : _BroadphaseQuery._Colliders )
   {
-    const Vec3 playerHalf(std::max(iSettings._PlayerRadius, 0.05f),
-                          std::max(iSettings._PlayerHeight * 0.5f, 0.1f),
-                          std::max(iSettings._PlayerRadius, 0.05f));
-    const Vec3 playerCenter = _Player._Position + Vec3(0.f, playerHalf.y, 0.f);
+    if ( colliderIndex >= static_cast<int>(_PropCollisionColliders.size()) )
+      continue;
+
+    playerCenter = _Player._Position + Vec3(0.f, playerHalf.y, 0.f);
     FpsCollisionAxisResult result;
-    if ( !FpsCollision::ResolveAabbObbAxis(playerCenter, playerHalf, collider, iAxis, iDelta, result) )
+    if ( !FpsCollision::ResolveAabbObbAxis(playerCenter, playerHalf, _PropCollisionColliders[colliderIndex], iAxis, iDelta, result) )
       continue;
 
     _Player._Position[iAxis] += result._Correction;
@@ -585,10 +728,17 @@ int FpsGameSceneBinding::Attach( Scene & iScene, const FpsGameWorld & iWorld, co
 // SyncCamera
 // ----------------------------------------------------------------------------
 int FpsGameSceneBinding::SyncCamera( Scene & iScene, const FpsGameWorld & iWorld, const FpsGameSettings & iSettings )
+{
+  return SyncCamera(iScene, iWorld.GetPlayer(), iSettings);
+}
+
+// ----------------------------------------------------------------------------
+// SyncCamera
+// ----------------------------------------------------------------------------
+int FpsGameSceneBinding::SyncCamera( Scene & iScene, const FpsPlayer & iPlayer, const FpsGameSettings & iSettings )
 {
   Camera & camera = iScene.GetCamera();
-  const FpsPlayer & player = iWorld.GetPlayer();
-  camera.SetFreeLookPose(player.ViewPosition(iSettings), player._Yaw, player._Pitch);
+  camera.SetFreeLookPose(iPlayer.ViewPosition(iSettings), iPlayer._Yaw, iPlayer._Pitch);
   camera.SetFOVInDegrees(MathUtil::Clamp(iSettings._CameraFOV, 30.f, 140.f));
   const float zNear = std::max(0.001f, iSettings._CameraZNear);
   const float zFar = std::max(zNear + 0.001f, iSettings._CameraZFar);
@@ -600,50 +750,60 @@ int FpsGameSceneBinding::SyncCamera( Scene & iScene, const FpsGameWorld & iWorld
 // SyncTransforms
 // ----------------------------------------------------------------------------
 int FpsGameSceneBinding::SyncTransforms( Scene & iScene, const FpsGameWorld & iWorld, const FpsGameSettings & iSettings )
+{
+  return SyncTransforms(iScene, iWorld, iWorld.GetPlayer(), iWorld.GetProjectiles(), iSettings);
+}
+
+// ----------------------------------------------------------------------------
+// SyncTransforms
+// ----------------------------------------------------------------------------
+int FpsGameSceneBinding::SyncTransforms( Scene & iScene, const FpsGameWorld & iWorld, const FpsPlayer & iPlayer, const std::vector<FpsProjectile> & iProjectiles, const FpsGameSettings & iSettings )
 {
   const std::vector<FpsSceneObject> & objects = iWorld.GetObjects();
   if ( objects.size() != _ObjectInstanceIDs.size() )
     return 1;
 
-  const std::vector<FpsProjectile> & projectiles = iWorld.GetProjectiles();
+  const std::vector<FpsProjectile> & projectiles = iProjectiles;
   if ( projectiles.size() != _ProjectileInstanceIDs.size() )
     return 1;
 
-  std::vector<MeshInstance> & instances = iScene.GetMeshInstances();
+  // Only instances whose transform or visibility differs get flagged : idle objects cost no renderer work
+  const int nbInstances = iScene.GetNbMeshInstances();
   for ( int i = 0; i < static_cast<int>(_ObjectInstanceIDs.size()); ++i )
   {
     const int instanceID = _ObjectInstanceIDs[i];
     if ( instanceID < 0 )
       continue;
-    if ( instanceID >= static_cast<int>(instances.size()) )
+    if ( instanceID >= nbInstances )
       return 1;
 
-    instances[instanceID]._Visible = objects[i]._Visible;
-    instances[instanceID]._Transform = BuildObjectTransform(objects[i]);
+    iScene.SetMeshInstanceVisible(instanceID, objects[i]._Visible);
+    iScene.SetMeshInstanceTransform(instanceID, BuildObjectTransform(objects[i]));
   }
 
   for ( int i = 0; i < static_cast<int>(_ProjectileInstanceIDs.size()); ++i )
   {
     const int instanceID = _ProjectileInstanceIDs[i];
-    if ( ( instanceID < 0 ) || ( instanceID >= static_cast<int>(instances.size()) ) )
+    if ( ( instanceID < 0 ) || ( instanceID >= nbInstances ) )
       return 1;
 
-    instances[instanceID]._Visible = projectiles[i]._Active;
-    instances[instanceID]._Transform = BuildProjectileTransform(projectiles[i], iSettings);
+    iScene.SetMeshInstanceVisible(instanceID, projectiles[i]._Active);
+    if ( projectiles[i]._Active )
+      iScene.SetMeshInstanceTransform(instanceID, BuildProjectileTransform(projectiles[i], iSettings));
   }
 
   if ( _WeaponInstanceIDs.size() != _WeaponBaseTransforms.size() )
     return 1;
 
-  const Mat4x4 weaponTransform = BuildViewWeaponTransform(iWorld.GetPlayer(), iSettings);
+  const Mat4x4 weaponTransform = BuildViewWeaponTransform(iPlayer, iSettings);
   for ( int i = 0; i < static_cast<int>(_WeaponInstanceIDs.size()); ++i )
   {
     const int instanceID = _WeaponInstanceIDs[i];
-    if ( ( instanceID < 0 ) || ( instanceID >= static_cast<int>(instances.size()) ) )
+    if ( ( instanceID < 0 ) || ( instanceID >= nbInstances ) )
       return 1;
 
-    instances[instanceID]._Visible = iSettings._ShowViewWeapon;
-    instances[instanceID]._Transform = weaponTransform * _WeaponBaseTransforms[i];
+    iScene.SetMeshInstanceVisible(instanceID, iSettings._ShowViewWeapon);
+    iScene.SetMeshInstanceTransform(instanceID, weaponTransform * _WeaponBaseTransforms[i]);
   }
 
   return 0;
@@ -661,11 +821,10 @@ int FpsGameSceneBinding::SetObjectInstanceVisible( Scene & iScene, int iObjectIn
   if ( instanceID < 0 )
     return 0;
 
-  std::vector<MeshInstance> & instances = iScene.GetMeshInstances();
-  if ( instanceID >= static_cast<int>(instances.size()) )
+  if ( instanceID >= iScene.GetNbMeshInstances() )
     return 1;
 
-  instances[instanceID]._Visible = iVisible;
+  iScene.SetMeshInstanceVisible(instanceID, iVisible);
   return 0;
 }
 
@@ -687,15 +846,14 @@ int FpsGameSceneBinding::SyncProp( Scene & iScene, const FpsGameMap & iMap, int
   if ( instanceIDs.size() != baseTransforms.size() )
     return 1;
 
-  std::vector<MeshInstance> & instances = iScene.GetMeshInstances();
   for ( int i = 0; i < static_cast<int>(instanceIDs.size()); ++i )
   {
     const int instanceID = instanceIDs[i];
-    if ( ( instanceID < 0 ) || ( instanceID >= static_cast<int>(instances.size()) ) )
+    if ( ( instanceID < 0 ) || ( instanceID >= iScene.GetNbMeshInstances() ) )
       return 1;
 
-    instances[instanceID]._Visible = prop._Visible;
-    instances[instanceID]._Transform = propTransform * baseTransforms[i];
+    iScene.SetMeshInstanceVisible(instanceID, prop._Visible);
+    iScene.SetMeshInstanceTransform(instanceID, propTransform * baseTransforms[i]);
   }
 
   return 0;
@@ -1,6 +1,7 @@
 #ifndef _FpsGame_
 #define _FpsGame_
 
+#include "FpsBroadphase.h"
 #include "FpsCollision.h"
 #include "FpsHeadBob.h"
 #include "FpsProjectiles.h"
@@ -14,6 +15,8 @@ namespace RTRT
 {
 
 class Scene;
+class BoidSimulation;
+struct BoidSettings;
 struct FpsGameMap;
 struct FpsMapProp;
 struct FpsMapPropCollider;
@@ -63,6 +66,11 @@ struct FpsGameSettings
   float           _ProjectileLifetime = 8.f;
   int             _MaxProjectiles = 32;
   float           _ProjectileCooldown = 0.12f;
+  bool            _ProjectileStressTest = false; // Keeps the whole stress pool in flight, ignoring ammo and cooldown
+  int             _ProjectileStressCount = 4096;
+  bool            _FixedTimestep = false;        // Player, projectiles and boids advance in fixed ticks, display is interpolated
+  float           _SimulationRate = 60.f;        // Ticks per second
+  int             _MaxSimulationSteps = 5;       // Ticks per frame before the remaining time is dropped
   int             _MaxHealth = 100;
   int             _MaxArmor = 50;
   int             _MaxProjectileAmmo = 32;
@@ -126,17 +134,28 @@ public:
   int Initialize( const FpsGameSettings & iSettings, const FpsGameMap & iMap );
   int Reset( const FpsGameSettings & iSettings );
   int Update( float iDeltaTime, const FpsGameInput & iInput, const FpsGameSettings & iSettings );
+
+  // Update() split for the fixed-step scheduler : BeginFrame once per frame, the Step* calls once per tick.
+  // StepPlayer and StepProjectiles only share read-only collision data and may run concurrently.
+  int BeginFrame( float iDeltaTime, const FpsGameInput & iInput, const FpsGameSettings & iSettings );
+  void StepPlayer( float iDeltaTime, const FpsGameInput & iInput, const FpsGameSettings & iSettings );
+  void StepProjectiles( float iDeltaTime, const FpsGameSettings & iSettings, const FpsPlayer & iPlayer, bool iAllowJobs = true );
   int ResizeProjectilePool( const FpsGameSettings & iSettings );
   void ClearProjectiles();
+  int UpdateBroadphase();
+  int ResolveBoidCollisions( BoidSimulation & ioSimulation, const BoidSettings & iSettings );
 
   const FpsPlayer & GetPlayer() const { return _Player; }
   FpsPlayer & GetPlayer() { return _Player; }
   const std::vector<FpsSceneObject> & GetObjects() const { return _Objects; }
   std::vector<FpsSceneObject> & GetObjects() { return _Objects; }
   const std::vector<FpsCollisionObb> & GetPropCollisionColliders() const { return _PropCollisionColliders; }
-  void SetPropCollisionColliders( const std::vector<FpsCollisionObb> & iColliders ) { _PropCollisionColliders = iColliders; }
-  void ClearPropCollisionColliders() { _PropCollisionColliders.clear(); }
+  void SetPropCollisionColliders( const std::vector<FpsCollisionObb> & iColliders ) { _PropCollisionColliders = iColliders; _BroadphaseDirty = true; }
+  void ClearPropCollisionColliders() { _PropCollisionColliders.clear(); _BroadphaseDirty = true; }
+  void MarkCollisionDirty() { _BroadphaseDirty = true; }
+  const FpsBroadphase & GetBroadphase() const { return _Broadphase; }
   const std::vector<FpsProjectile> & GetProjectiles() const { return _Projectiles.GetProjectiles(); }
+  std::vector<FpsProjectile> & GetProjectiles() { return _Projectiles.GetProjectiles(); }
   int GetActiveProjectileCount() const { return _Projectiles.GetActiveCount(); }
   int GetProjectileAmmo() const { return _Projectiles.GetAmmo(); }
   bool ConsumeProjectilesDirty() { return _Projectiles.ConsumeDirty(); }
@@ -152,6 +171,9 @@ protected:
   FpsPlayer                  _Player;
   std::vector<FpsSceneObject> _Objects;
   std::vector<FpsCollisionObb>     _PropCollisionColliders;
+  FpsBroadphase              _Broadphase;
+  FpsBroadphaseQuery         _BroadphaseQuery;
+  bool                       _BroadphaseDirty = true;
   FpsProjectiles             _Projectiles;
   Vec3                       _SpawnPosition = Vec3(0.f, 0.05f, -8.f);
   float                      _SpawnYaw = 90.f;
@@ -166,7 +188,9 @@ public:
   int Attach( Scene & iScene, const FpsGameWorld & iWorld, const FpsGameSettings & iSettings );
   int Attach( Scene & iScene, const FpsGameWorld & iWorld, const FpsGameSettings & iSettings, const FpsGameMap & iMap );
   int SyncCamera( Scene & iScene, const FpsGameWorld & iWorld, const FpsGameSettings & iSettings );
+  int SyncCamera( Scene & iScene, const FpsPlayer & iPlayer, const FpsGameSettings & iSettings );
   int SyncTransforms( Scene & iScene, const FpsGameWorld & iWorld, const FpsGameSettings & iSettings );
+  int SyncTransforms( Scene & iScene, const FpsGameWorld & iWorld, const FpsPlayer & iPlayer, const std::vector<FpsProjectile> & iProjectiles, const FpsGameSettings & iSettings );
   int SyncProp( Scene & iScene, const FpsGameMap & iMap, int iPropIndex );
   int LoadProp( Scene & iScene, const FpsGameMap & iMap, int iPropIndex );
   int BuildPropCollisionColliders( Scene & iScene, const FpsGameMap & iMap, std::vector<FpsCollisionObb> & oColliders ) const;
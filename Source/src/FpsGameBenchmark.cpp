@@ -1,5 +1,6 @@
 #include "FpsGameBenchmark.h"
 
+#include "DeferredRenderer.h"
 #include "PathUtils.h"
 #include "RenderSettings.h"
 #include "Scene.h"
@@ -55,6 +56,15 @@ std::string JsonEscape( const std::string & iText )
   return result;
 }
 
+const char * EffectResolutionName( EffectResolution iResolution )
+{
+  if ( EffectResolution::Half == iResolution )
+    return "half";
+  if ( EffectResolution::Quarter == iResolution )
+    return "quarter";
+  return "full";
+}
+
 std::string BenchmarkTimestamp()
 {
   const auto now = std::chrono::system_clock::now();
@@ -272,6 +282,8 @@ void FpsGameBenchmark::Update( const std::vector<FpsCpuTiming> & iCpuTimings,
       _RendererTotals[i]._Enabled = true;
       _RendererTotals[i]._Seconds += timing._Seconds;
       _RendererTotals[i]._Samples.push_back(timing._Seconds);
+      _RendererTotals[i]._NbTested += timing._NbTested;
+      _RendererTotals[i]._NbCulled += timing._NbCulled;
     }
     _RendererFrameSeconds += rendererFrameSeconds;
   }
@@ -485,6 +497,12 @@ bool FpsGameBenchmark::SaveResult( const FpsGameBenchmarkSaveContext & iContext
     file << "    \"" << JsonEscape(timing._Name) << "\": {\n";
     file << "      \"device\": \"" << ( timing._GPU ? "GPU" : "CPU" ) << "\",\n";
     file << "      \"inclusive\": " << ( timing._Inclusive ? "true" : "false" ) << ",\n";
+    if ( ( timing._NbTested > 0. ) && !timing._Samples.empty() )
+    {
+      const double nbSamples = static_cast<double>(timing._Samples.size());
+      file << "      \"tested_instances_average\": " << timing._NbTested / nbSamples << ",\n";
+      file << "      \"culled_instances_average\": " << timing._NbCulled / nbSamples << ",\n";
+    }
     WriteDistribution(file, timing._Distribution, "      ");
     file << "    }";
     first = false;
@@ -521,6 +539,34 @@ bool FpsGameBenchmark::SaveResult( const FpsGameBenchmarkSaveContext & iContext
     }
     file << "\n  }";
   }
+  else if ( const DeferredRenderer * deferred = iContext._Renderer ? const_cast<Renderer *>(iContext._Renderer) -> AsDeferredRenderer() : nullptr )
+  {
+    file << ",\n";
+    file << "  \"deferred_configuration\": {\n";
+    file << "    \"multi_draw_indirect\": " << ( deferred -> GetEnableMultiDrawIndirect() ? "true" : "false" ) << ",\n";
+    file << "    \"multi_draw_indirect_supported\": " << ( deferred -> IsMultiDrawIndirectSupported() ? "true" : "false" ) << ",\n";
+    file << "    \"draw_calls\": " << deferred -> GetNbDrawCalls() << ",\n";
+    file << "    \"frustum_culling\": " << ( deferred -> GetEnableFrustumCulling() ? "true" : "false" ) << ",\n";
+    file << "    \"occlusion_culling\": " << ( deferred -> GetEnableOcclusionCulling() ? "true" : "false" ) << ",\n";
+    file << "    \"gpu_culling_supported\": " << ( deferred -> IsGpuCullingSupported() ? "true" : "false" ) << ",\n";
+    file << "    \"gbuffer_layout\": \"" << ( settings._CompactGBuffer ? "compact" : "full" ) << "\",\n";
+    file << "    \"ssao_resolution\": \"" << EffectResolutionName(settings._SSAOResolution) << "\",\n";
+    file << "    \"ssr_resolution\": \"" << EffectResolutionName(settings._SSRResolution) << "\",\n";
+    file << "    \"ssr_trace_mode\": \"" << ( ( SSRTraceMode::HiZ == settings._SSRTraceMode ) ? "hiz" : "linear" ) << "\",\n";
+    file << "    \"transparency\": " << ( settings._Transparency ? "true" : "false" ) << ",\n";
+    file << "    \"transparency_mode\": \"" << ( ( TransparencyMode::WeightedBlended == settings._TransparencyMode ) ? "weighted_blended" : "sorted" ) << "\",\n";
+    file << "    \"transparent_sort_threshold_deg\": " << deferred -> GetTransparentSortThreshold() << ",\n";
+    file << "    \"transparent_sorts\": " << deferred -> GetNbTransparentSorts() << ",\n";
+    file << "    \"shadow_cascades\": " << settings._ShadowCascades << ",\n";
+    file << "    \"shadow_cache\": " << ( deferred -> GetEnableShadowCache() ? "true" : "false" ) << ",\n";
+    file << "    \"shadow_layers_rendered\": " << deferred -> GetNbShadowLayersRendered() << ",\n";
+    file << "    \"shadow_cache_hits\": " << deferred -> GetNbShadowCacheHits() << ",\n";
+    file << "    \"light_clustering\": " << ( settings._LightClustering ? "true" : "false" ) << ",\n";
+    file << "    \"light_cluster_grid\": [" << settings._LightClusterGrid.x << ", " << settings._LightClusterGrid.y << ", " << settings._LightClusterGrid.z << "],\n";
+    file << "    \"light_cluster_refs\": " << deferred -> GetNbLightClusterRefs() << ",\n";
+    file << "    \"max_lights_per_cluster\": " << deferred -> GetMaxLightsPerCluster() << "\n";
+    file << "  }";
+  }
   file << "\n";
   file << "}\n";
 
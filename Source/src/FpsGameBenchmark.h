@@ -32,6 +32,8 @@ struct FpsGameBenchmarkPassTiming
   bool        _GPU = false;
   bool        _Enabled = false;
   bool        _Inclusive = false;
+  double      _NbTested = 0.; // Culling counts summed over the samples
+  double      _NbCulled = 0.;
   std::vector<double> _Samples;
   FpsGameBenchmarkDistribution _Distribution;
 };
@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cfloat>
+#include <cmath>
 #include <cstring>
 #include <cstdio>
 #include <filesystem>
@@ -91,6 +92,9 @@ FpsGameEditorContext::FpsGameEditorContext( GLFWwindow * iWindow,
 // ----------------------------------------------------------------------------
 void FpsGameEditor::HandleMousePick( const FpsGameEditorContext & iContext, double iMouseX, double iMouseY )
 {
+  UpdatePicking(iContext);
+  _BoxSelectedProps.clear();
+
   FpsEditorSelection selection;
   if ( PickSelection(iContext, iMouseX, iMouseY, selection) )
     _Selection = selection;
@@ -98,6 +102,95 @@ void FpsGameEditor::HandleMousePick( const FpsGameEditorContext & iContext, doub
     _Selection = FpsEditorSelection();
 }
 
+// ----------------------------------------------------------------------------
+// BeginBoxSelect
+// ----------------------------------------------------------------------------
+void FpsGameEditor::BeginBoxSelect( double iMouseX, double iMouseY )
+{
+  _BoxSelecting = true;
+  _BoxSelectStartX = iMouseX;
+  _BoxSelectStartY = iMouseY;
+}
+
+// ----------------------------------------------------------------------------
+// EndBoxSelect
+// ----------------------------------------------------------------------------
+void FpsGameEditor::EndBoxSelect( const FpsGameEditorContext & iContext, double iMouseX, double iMouseY )
+{
+  if ( !_BoxSelecting )
+    return;
+  _BoxSelecting = false;
+
+  // A click without drag is a regular pick
+  if ( ( std::abs(iMouseX - _BoxSelectStartX) < 3. ) && ( std::abs(iMouseY - _BoxSelectStartY) < 3. ) )
+  {
+    HandleMousePick(iContext, iMouseX, iMouseY);
+    return;
+  }
+
+  UpdatePicking(iContext);
+  if ( !BoxSelectProps(iContext, _BoxSelectStartX, _BoxSelectStartY, iMouseX, iMouseY, _BoxSelectedProps) )
+    _BoxSelectedProps.clear();
+
+  _Selection = FpsEditorSelection();
+  if ( !_BoxSelectedProps.empty() )
+  {
+    _Selection._Kind = FpsEditableKind::Prop;
+    _Selection._Index = _BoxSelectedProps[0];
+    _Selection._SubIndex = -1;
+    _Selection._SceneInstanceID = -1;
+  }
+  SetStatus("Box selected " + std::to_string(_BoxSelectedProps.size()) + " props");
+}
+
+// ----------------------------------------------------------------------------
+// ResetPicking
+// ----------------------------------------------------------------------------
+void FpsGameEditor::ResetPicking()
+{
+  _Picker.Reset();
+  _PickableInstances.clear();
+  _InstancePropIndices.clear();
+  _BoxSelectedProps.clear();
+  _BoxSelecting = false;
+}
+
+// ----------------------------------------------------------------------------
+// UpdatePicking
+// ----------------------------------------------------------------------------
+int FpsGameEditor::UpdatePicking( const FpsGameEditorContext & iContext )
+{
+  if ( !iContext._Scene )
+    return 1;
+
+  if ( 0 != _Picker.Update(*iContext._Scene) )
+    return 1;
+
+  const int nbInstances = iContext._Scene -> GetNbMeshInstances();
+  _PickableInstances.assign(nbInstances, 0);
+  _InstancePropIndices.assign(nbInstances, -1);
+  for ( int propIndex = 0; propIndex < static_cast<int>(iContext._Map._Props.size()); ++propIndex )
+  {
+    if ( !iContext._Map._Props[propIndex]._Visible )
+      continue;
+
+    const std::vector<int> * instanceIDs = iContext._SceneBinding.GetPropInstanceIDs(propIndex);
+    if ( !instanceIDs )
+      continue;
+
+    for ( int instanceID : *instanceIDs )
+    {
+      if ( ( instanceID < 0 ) || ( instanceID >= nbInstances ) )
+        continue;
+
+      _PickableInstances[instanceID] = 1;
+      _InstancePropIndices[instanceID] = propIndex;
+    }
+  }
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // DrawPanels
 // ----------------------------------------------------------------------------
@@ -446,47 +539,38 @@ static bool EditorIntersectRayObject( const Vec3 & iRayOrigin, const Vec3 & iRay
 }
 
 // ----------------------------------------------------------------------------
-// EditorIntersectRayMeshInstance
+// EditorMouseToNdc
 // ----------------------------------------------------------------------------
-static bool EditorIntersectRayMeshInstance( const Vec3 & iRayOrigin, const Vec3 & iRayDir, const MeshInstance & iInstance, const Mesh & iMesh, float & oHitT )
+static bool EditorMouseToNdc( const FpsGameEditorContext & iContext, double iMouseX, double iMouseY, Vec2 & oNdc )
 {
-  Mat4x4 invTransform = glm::inverse(iInstance._Transform);
-  Vec3 localOrigin = Vec3(invTransform * Vec4(iRayOrigin, 1.f));
-  Vec3 localDir = glm::normalize(Vec3(invTransform * Vec4(iRayDir, 0.f)));
+  if ( !iContext._Window )
+    return false;
 
-  float boxHitT = 0.f;
-  if ( !MathUtil::IntersectRayAABB(localOrigin, localDir, iMesh.GetBoundingBox(), boxHitT) )
+  int windowWidth = 0;
+  int windowHeight = 0;
+  glfwGetWindowSize(iContext._Window, &windowWidth, &windowHeight);
+  if ( !windowWidth || !windowHeight || !iContext._Settings._WindowResolution.x || !iContext._Settings._WindowResolution.y )
     return false;
 
-  bool hit = false;
-  float nearestDist = MAX_FLOAT;
-  const std::vector<Vec3> & vertices = iMesh.GetVertices();
-  const std::vector<Vec3i> & indices = iMesh.GetIndices();
-  for ( int i = 0; i + 2 < static_cast<int>(indices.size()); i += 3 )
-  {
-    const Vec3i & i0 = indices[i + 0];
-    const Vec3i & i1 = indices[i + 1];
-    const Vec3i & i2 = indices[i + 2];
+  const float mouseX = static_cast<float>(iMouseX) * static_cast<float>(iContext._Settings._WindowResolution.x) / static_cast<float>(windowWidth);
+  const float mouseY = static_cast<float>(iMouseY) * static_cast<float>(iContext._Settings._WindowResolution.y) / static_cast<float>(windowHeight);
 
-    float triHitT = 0.f;
-    if ( MathUtil::IntersectRayTriangle(localOrigin, localDir, vertices[i0.x], vertices[i1.x], vertices[i2.x], triHitT) )
-    {
-      const Vec3 localHit = localOrigin + localDir * triHitT;
-      const Vec3 worldHit = MathUtil::TransformPoint(localHit, iInstance._Transform);
-      const float worldDist = glm::length(worldHit - iRayOrigin);
-      if ( worldDist < nearestDist )
-      {
-        nearestDist = worldDist;
-        hit = true;
-      }
-    }
-  }
+  oNdc.x = 2.f * mouseX / static_cast<float>(iContext._Settings._WindowResolution.x) - 1.f;
+  oNdc.y = 1.f - 2.f * mouseY / static_cast<float>(iContext._Settings._WindowResolution.y);
+  return true;
+}
 
-  if ( !hit )
-    return false;
+// ----------------------------------------------------------------------------
+// EditorComputeViewProj
+// ----------------------------------------------------------------------------
+static void EditorComputeViewProj( const FpsGameEditorContext & iContext, Mat4x4 & oView, Mat4x4 & oProj )
+{
+  oView = Mat4x4(1.f);
+  oProj = Mat4x4(1.f);
 
-  oHitT = nearestDist;
-  return true;
+  Camera & camera = iContext._Scene -> GetCamera();
+  camera.ComputeLookAtMatrix(oView);
+  camera.ComputePerspectiveProjMatrix(static_cast<float>(iContext._Settings._WindowResolution.x) / static_cast<float>(iContext._Settings._WindowResolution.y), oProj);
 }
 
 // ----------------------------------------------------------------------------
@@ -607,6 +691,34 @@ static void EditorDrawTransformedAABB( const AABB<Vec3> & iBox, const Mat4x4 & i
   }
 }
 
+// ----------------------------------------------------------------------------
+// EditorDrawPropInstanceBounds
+// ----------------------------------------------------------------------------
+static void EditorDrawPropInstanceBounds( const FpsGameEditorContext & iContext, int iPropIndex, const Mat4x4 & iView, const Mat4x4 & iProj, ImDrawList * ioDrawList, ImU32 iColor, float iLineWidth )
+{
+  const std::vector<int> * instanceIDs = iContext._SceneBinding.GetPropInstanceIDs(iPropIndex);
+  if ( !instanceIDs )
+    return;
+
+  const std::vector<MeshInstance> & meshInstances = iContext._Scene -> GetMeshInstances();
+  const std::vector<Mesh*> & meshes = iContext._Scene -> GetMeshes();
+  for ( int instanceID : *instanceIDs )
+  {
+    if ( ( instanceID < 0 ) || ( instanceID >= static_cast<int>(meshInstances.size()) ) )
+      continue;
+
+    const MeshInstance & instance = meshInstances[instanceID];
+    if ( !instance._Visible )
+      continue;
+    if ( ( instance._MeshID < 0 ) || ( instance._MeshID >= static_cast<int>(meshes.size()) ) )
+      continue;
+
+    Mesh * mesh = meshes[instance._MeshID];
+    if ( mesh )
+      EditorDrawTransformedAABB(mesh -> GetBoundingBox(), instance._Transform, iView, iProj, ioDrawList, iColor, iLineWidth);
+  }
+}
+
 // ----------------------------------------------------------------------------
 // SetEditorPathBuffers
 // ----------------------------------------------------------------------------
@@ -755,12 +867,16 @@ void FpsGameEditor::SyncMapFromRuntimeSettings( FpsGameEditorContext & ioContext
   renderSettings._ShadowMapResolution = ioContext._Settings._ShadowMapResolution;
   renderSettings._ShadowBias = ioContext._Settings._ShadowBias;
   renderSettings._MaxShadowCastingLights = ioContext._Settings._MaxShadowCastingLights;
+  renderSettings._ShadowCascades = ioContext._Settings._ShadowCascades;
+  renderSettings._ShadowCascadeSplitLambda = ioContext._Settings._ShadowCascadeSplitLambda;
+  renderSettings._ShadowCascadeDistance = ioContext._Settings._ShadowCascadeDistance;
   renderSettings._SSAO = ioContext._Settings._SSAO;
   renderSettings._SSAOBlur = ioContext._Settings._SSAOBlur;
   renderSettings._SSAORadius = ioContext._Settings._SSAORadius;
   renderSettings._SSAOBias = ioContext._Settings._SSAOBias;
   renderSettings._SSAOIntensity = ioContext._Settings._SSAOIntensity;
   renderSettings._SSAOKernelSize = ioContext._Settings._SSAOKernelSize;
+  renderSettings._SSAOResolution = ioContext._Settings._SSAOResolution;
   renderSettings._SSR = ioContext._Settings._SSR;
   renderSettings._SSRIntensity = ioContext._Settings._SSRIntensity;
   renderSettings._SSRMaxRoughness = ioContext._Settings._SSRMaxRoughness;
@@ -769,11 +885,21 @@ void FpsGameEditor::SyncMapFromRuntimeSettings( FpsGameEditorContext & ioContext
   renderSettings._SSRMaxDistance = ioContext._Settings._SSRMaxDistance;
   renderSettings._SSRThickness = ioContext._Settings._SSRThickness;
   renderSettings._SSRFade = ioContext._Settings._SSRFade;
+  renderSettings._SSRResolution = ioContext._Settings._SSRResolution;
+  renderSettings._SSRTraceMode = ioContext._Settings._SSRTraceMode;
   renderSettings._PBRDirectLighting = ioContext._Settings._PBRDirectLighting;
   renderSettings._DirectLightIntensity = ioContext._Settings._DirectLightIntensity;
+  renderSettings._LightClustering = ioContext._Settings._LightClustering;
+  renderSettings._LightClusterGrid = ioContext._Settings._LightClusterGrid;
+  renderSettings._LightClusterThreshold = ioContext._Settings._LightClusterThreshold;
+  renderSettings._CompactGBuffer = ioContext._Settings._CompactGBuffer;
   renderSettings._SpecularIBLMaxRoughness = ioContext._Settings._SpecularIBLMaxRoughness;
   renderSettings._Bounces = ioContext._Settings._Bounces;
   renderSettings._NbSamplesPerPixel = ioContext._Settings._NbSamplesPerPixel;
+  renderSettings._AdaptiveSampling = ioContext._Settings._AdaptiveSampling;
+  renderSettings._ConvergenceThreshold = ioContext._Settings._ConvergenceThreshold;
+  renderSettings._AdaptiveMinFrames = ioContext._Settings._AdaptiveMinFrames;
+  renderSettings._WavefrontPathTracing = ioContext._Settings._WavefrontPathTracing;
   renderSettings._Denoise = ioContext._Settings._Denoise;
 }
 
@@ -829,6 +955,7 @@ void FpsGameEditor::SyncObject( FpsGameEditorContext & ioContext, int iObjectInd
     return;
 
   objects[iObjectIndex] = ioContext._Map._Objects[iObjectIndex];
+  ioContext._GameWorld.MarkCollisionDirty();
 
   if ( ioContext._Scene )
     ioContext._SceneBinding.SyncTransforms(*ioContext._Scene, ioContext._GameWorld, ioContext._GameSettings);
@@ -1144,36 +1271,26 @@ void FpsGameEditor::ApplyObjectVisibility( FpsGameEditorContext & ioContext )
 // ----------------------------------------------------------------------------
 bool FpsGameEditor::BuildPickingRay( const FpsGameEditorContext & iContext, double iMouseX, double iMouseY, Vec3 & oRayOrigin, Vec3 & oRayDir ) const
 {
-  if ( !iContext._Window || !iContext._Scene )
+  if ( !iContext._Scene )
     return false;
 
-  int windowWidth = 0;
-  int windowHeight = 0;
-  glfwGetWindowSize(iContext._Window, &windowWidth, &windowHeight);
-  if ( !windowWidth || !windowHeight || !iContext._Settings._WindowResolution.x || !iContext._Settings._WindowResolution.y )
+  Vec2 ndc(0.f);
+  if ( !EditorMouseToNdc(iContext, iMouseX, iMouseY, ndc) )
     return false;
 
-  const float mouseX = static_cast<float>(iMouseX) * static_cast<float>(iContext._Settings._WindowResolution.x) / static_cast<float>(windowWidth);
-  const float mouseY = static_cast<float>(iMouseY) * static_cast<float>(iContext._Settings._WindowResolution.y) / static_cast<float>(windowHeight);
-
-  const float ndcX = 2.f * mouseX / static_cast<float>(iContext._Settings._WindowResolution.x) - 1.f;
-  const float ndcY = 1.f - 2.f * mouseY / static_cast<float>(iContext._Settings._WindowResolution.y);
-
   Mat4x4 view(1.f);
   Mat4x4 proj(1.f);
-  Camera & camera = iContext._Scene -> GetCamera();
-  camera.ComputeLookAtMatrix(view);
-  camera.ComputePerspectiveProjMatrix(static_cast<float>(iContext._Settings._WindowResolution.x) / static_cast<float>(iContext._Settings._WindowResolution.y), proj);
+  EditorComputeViewProj(iContext, view, proj);
 
   Mat4x4 invViewProj = glm::inverse(proj * view);
-  Vec4 nearPoint = invViewProj * Vec4(ndcX, ndcY, -1.f, 1.f);
-  Vec4 farPoint  = invViewProj * Vec4(ndcX, ndcY,  1.f, 1.f);
+  Vec4 nearPoint = invViewProj * Vec4(ndc.x, ndc.y, -1.f, 1.f);
+  Vec4 farPoint  = invViewProj * Vec4(ndc.x, ndc.y,  1.f, 1.f);
   if ( nearPoint.w != 0.f )
     nearPoint /= nearPoint.w;
   if ( farPoint.w != 0.f )
     farPoint /= farPoint.w;
 
-  oRayOrigin = camera.GetPos();
+  oRayOrigin = iContext._Scene -> GetCamera().GetPos();
   oRayDir = glm::normalize(Vec3(farPoint) - oRayOrigin);
 
   return glm::length(oRayDir) > 0.f;
@@ -1216,41 +1333,17 @@ bool FpsGameEditor::PickSelection( const FpsGameEditorContext & iContext, double
     }
   }
 
-  const std::vector<MeshInstance> & meshInstances = iContext._Scene -> GetMeshInstances();
-  const std::vector<Mesh*> & meshes = iContext._Scene -> GetMeshes();
-  for ( int propIndex = 0; propIndex < static_cast<int>(iContext._Map._Props.size()); ++propIndex )
+  // Props go through the picking TLAS : only the instances along the ray reach their mesh BLAS
+  ScenePickHit propHit;
+  if ( _Picker.CastRay(rayOrigin, rayDir, propHit, &_PickableInstances) && ( propHit._Distance < nearestDist ) )
   {
-    const FpsMapProp & prop = iContext._Map._Props[propIndex];
-    if ( !prop._Visible )
-      continue;
-
-    const std::vector<int> * instanceIDs = iContext._SceneBinding.GetPropInstanceIDs(propIndex);
-    if ( !instanceIDs )
-      continue;
-
-    for ( int instanceID : *instanceIDs )
+    const int propIndex = ( propHit._InstanceID < static_cast<int>(_InstancePropIndices.size()) ) ? _InstancePropIndices[propHit._InstanceID] : -1;
+    if ( propIndex >= 0 )
     {
-      if ( ( instanceID < 0 ) || ( instanceID >= static_cast<int>(meshInstances.size()) ) )
-        continue;
-
-      const MeshInstance & instance = meshInstances[instanceID];
-      if ( !instance._Visible )
-        continue;
-      if ( ( instance._MeshID < 0 ) || ( instance._MeshID >= static_cast<int>(meshes.size()) ) )
-        continue;
-
-      Mesh * mesh = meshes[instance._MeshID];
-      if ( !mesh )
-        continue;
-
-      float hitT = 0.f;
-      if ( EditorIntersectRayMeshInstance(rayOrigin, rayDir, instance, *mesh, hitT) && hitT < nearestDist )
-      {
-        nearestDist = hitT;
-        oSelection._Kind = FpsEditableKind::Prop;
-        oSelection._Index = propIndex;
-        oSelection._SceneInstanceID = instanceID;
-      }
+      nearestDist = propHit._Distance;
+      oSelection._Kind = FpsEditableKind::Prop;
+      oSelection._Index = propIndex;
+      oSelection._SceneInstanceID = propHit._InstanceID;
     }
   }
 
@@ -1297,6 +1390,43 @@ bool FpsGameEditor::PickSelection( const FpsGameEditorContext & iContext, double
   return FpsEditableKind::None != oSelection._Kind;
 }
 
+// ----------------------------------------------------------------------------
+// BoxSelectProps
+// ----------------------------------------------------------------------------
+bool FpsGameEditor::BoxSelectProps( const FpsGameEditorContext & iContext, double iMouseX0, double iMouseY0, double iMouseX1, double iMouseY1, std::vector<int> & oPropIndices ) const
+{
+  oPropIndices.clear();
+  if ( !iContext._Scene )
+    return false;
+
+  Vec2 ndc0(0.f);
+  Vec2 ndc1(0.f);
+  if ( !EditorMouseToNdc(iContext, iMouseX0, iMouseY0, ndc0) || !EditorMouseToNdc(iContext, iMouseX1, iMouseY1, ndc1) )
+    return false;
+
+  Mat4x4 view(1.f);
+  Mat4x4 proj(1.f);
+  EditorComputeViewProj(iContext, view, proj);
+
+  // The dragged rectangle becomes the whole clip space of a narrower frustum
+  const Mat4x4 region = ScenePicker::BuildRegionMatrix(glm::min(ndc0, ndc1), glm::max(ndc0, ndc1));
+
+  std::vector<int> instanceIDs;
+  if ( 0 != _Picker.SelectFrustum(region * proj * view, instanceIDs, &_PickableInstances) )
+    return false;
+
+  for ( int instanceID : instanceIDs )
+  {
+    const int propIndex = ( instanceID < static_cast<int>(_InstancePropIndices.size()) ) ? _InstancePropIndices[instanceID] : -1;
+    if ( propIndex >= 0 )
+      oPropIndices.push_back(propIndex);
+  }
+
+  std::sort(oPropIndices.begin(), oPropIndices.end());
+  oPropIndices.erase(std::unique(oPropIndices.begin(), oPropIndices.end()), oPropIndices.end());
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 // DrawEditorDockspace
 // ----------------------------------------------------------------------------
@@ -1553,6 +1683,8 @@ void FpsGameEditor::DrawScenePanel( FpsGameEditorContext & ioContext )
         std::string label = "Prop: " + prop._Name;
         if ( !prop._Visible )
           label += " (hidden)";
+        if ( std::binary_search(_BoxSelectedProps.begin(), _BoxSelectedProps.end(), i) )
+          label += " (box)";
         label += "##prop" + std::to_string(i);
         if ( ImGui::Selectable(label.c_str(), selected) )
         {
@@ -1566,6 +1698,15 @@ void FpsGameEditor::DrawScenePanel( FpsGameEditorContext & ioContext )
       ImGui::EndListBox();
     }
 
+    if ( !_BoxSelectedProps.empty() )
+    {
+      ImGui::Text("Box selection: %d props", static_cast<int>(_BoxSelectedProps.size()));
+      ImGui::SameLine();
+      if ( ImGui::Button("Clear box selection") )
+        _BoxSelectedProps.clear();
+    }
+    ImGui::TextDisabled("Shift + drag in the viewport to box select props");
+
   }
 
   if ( ImGui::CollapsingHeader("Boids") )
@@ -2023,6 +2164,7 @@ void FpsGameEditor::DrawInspectorPanel( FpsGameEditorContext & ioContext )
       boidsDirty |= ImGui::DragFloat("Alignment", &settings._AlignmentWeight, 0.01f, 0.f, 10.f, "%.3f");
       boidsDirty |= ImGui::DragFloat("Cohesion", &settings._CohesionWeight, 0.01f, 0.f, 10.f, "%.3f");
       boidsDirty |= ImGui::DragFloat("Bounds weight", &settings._BoundsWeight, 0.01f, 0.f, 10.f, "%.3f");
+      boidsDirty |= ImGui::Checkbox("Collide with world", &settings._CollideWithWorld);
 
       if ( boidsDirty )
       {
@@ -2366,6 +2508,15 @@ int FpsGameEditor::DrawRenderSettingsUI( FpsGameEditorContext & ioContext )
         notifyPersistedRenderSettingsChanged();
       if ( ImGui::SliderInt("Max shadow casting lights", &ioContext._Settings._MaxShadowCastingLights, 1, 8) )
         notifyPersistedRenderSettingsChanged();
+      if ( ImGui::SliderInt("Distant light cascades", &ioContext._Settings._ShadowCascades, 1, 4) )
+        notifyPersistedRenderSettingsChanged();
+      if ( ioContext._Settings._ShadowCascades > 1 )
+      {
+        if ( ImGui::SliderFloat("Cascade split lambda", &ioContext._Settings._ShadowCascadeSplitLambda, 0.f, 1.f) )
+          notifyPersistedRenderSettingsChanged();
+        if ( ImGui::SliderFloat("Cascade distance (0 : auto)", &ioContext._Settings._ShadowCascadeDistance, 0.f, 500.f) )
+          notifyPersistedRenderSettingsChanged();
+      }
     }
 
     if ( ImGui::CollapsingHeader("SSAO", ImGuiTreeNodeFlags_DefaultOpen) )
@@ -2386,6 +2537,13 @@ int FpsGameEditor::DrawRenderSettingsUI( FpsGameEditorContext & ioContext )
         ioContext._Settings._SSAOKernelSize = std::max(4, std::min(32, ssaoKernelSize));
         notifyPersistedRenderSettingsChanged();
       }
+      static const char * SSAOResolutions[] = { "Full", "Half", "Quarter" };
+      int ssaoResolution = (int)ioContext._Settings._SSAOResolution;
+      if ( ImGui::Combo("SSAO resolution", &ssaoResolution, SSAOResolutions, 3) )
+      {
+        ioContext._Settings._SSAOResolution = (EffectResolution)ssaoResolution;
+        notifyPersistedRenderSettingsChanged();
+      }
     }
 
     if ( ImGui::CollapsingHeader("SSR", ImGuiTreeNodeFlags_DefaultOpen) )
@@ -2410,6 +2568,20 @@ int FpsGameEditor::DrawRenderSettingsUI( FpsGameEditorContext & ioContext )
         notifyPersistedRenderSettingsChanged();
       if ( ImGui::SliderFloat("SSR edge fade", &ioContext._Settings._SSRFade, 0.01f, 0.5f) )
         notifyPersistedRenderSettingsChanged();
+      static const char * SSRResolutions[] = { "Full", "Half", "Quarter" };
+      int ssrResolution = (int)ioContext._Settings._SSRResolution;
+      if ( ImGui::Combo("SSR resolution", &ssrResolution, SSRResolutions, 3) )
+      {
+        ioContext._Settings._SSRResolution = (EffectResolution)ssrResolution;
+        notifyPersistedRenderSettingsChanged();
+      }
+      static const char * SSRTraceModes[] = { "Linear", "Hierarchical Z" };
+      int ssrTraceMode = (int)ioContext._Settings._SSRTraceMode;
+      if ( ImGui::Combo("SSR tracing", &ssrTraceMode, SSRTraceModes, 2) )
+      {
+        ioContext._Settings._SSRTraceMode = (SSRTraceMode)ssrTraceMode;
+        notifyPersistedRenderSettingsChanged();
+      }
     }
 
     if ( ImGui::CollapsingHeader("PBR Lighting", ImGuiTreeNodeFlags_DefaultOpen) )
@@ -2418,6 +2590,17 @@ int FpsGameEditor::DrawRenderSettingsUI( FpsGameEditorContext & ioContext )
         notifyPersistedRenderSettingsChanged();
       if ( ImGui::SliderFloat("Direct light intensity", &ioContext._Settings._DirectLightIntensity, 0.f, 8.f) )
         notifyPersistedRenderSettingsChanged();
+      if ( ImGui::Checkbox("Clustered lighting", &ioContext._Settings._LightClustering) )
+        notifyPersistedRenderSettingsChanged();
+      if ( ioContext._Settings._LightClustering )
+      {
+        if ( ImGui::SliderInt3("Cluster grid", &ioContext._Settings._LightClusterGrid.x, 1, S_MaxDeferredLightClusterDim) )
+          notifyPersistedRenderSettingsChanged();
+        if ( ImGui::SliderFloat("Light cull threshold", &ioContext._Settings._LightClusterThreshold, 0.0001f, 0.1f, "%.4f", ImGuiSliderFlags_Logarithmic) )
+          notifyPersistedRenderSettingsChanged();
+      }
+      if ( ImGui::Checkbox("Compact G-buffer", &ioContext._Settings._CompactGBuffer) )
+        notifyPersistedRenderSettingsChanged();
       if ( ImGui::SliderFloat("IBL max roughness", &ioContext._Settings._SpecularIBLMaxRoughness, 0.05f, 1.f) )
         notifyPersistedRenderSettingsChanged();
     }
@@ -2497,14 +2680,25 @@ int FpsGameEditor::DrawRenderSettingsUI( FpsGameEditorContext & ioContext )
         notifyPersistedRenderSettingsChanged();
       if ( ImGui::SliderInt("SPP", &ioContext._Settings._NbSamplesPerPixel, 1, 8) )
         notifyPersistedRenderSettingsChanged();
+      if ( ImGui::Checkbox("Adaptive sampling", &ioContext._Settings._AdaptiveSampling) )
+        notifyPersistedRenderSettingsChanged();
+      if ( ioContext._Settings._AdaptiveSampling )
+      {
+        if ( ImGui::SliderFloat("Convergence threshold", &ioContext._Settings._ConvergenceThreshold, 0.001f, 0.2f, "%.3f", ImGuiSliderFlags_Logarithmic) )
+          notifyPersistedRenderSettingsChanged();
+        if ( ImGui::SliderInt("Min frames", &ioContext._Settings._AdaptiveMinFrames, 1, 128) )
+          notifyPersistedRenderSettingsChanged();
+      }
+      if ( ImGui::Checkbox("Wavefront (compute)", &ioContext._Settings._WavefrontPathTracing) )
+        notifyPersistedRenderSettingsChanged();
       if ( ImGui::Checkbox("Denoise", &ioContext._Settings._Denoise) )
         notifyPersistedRenderSettingsChanged();
     }
 
     if ( ImGui::CollapsingHeader("Path Tracer Debug") )
     {
-      static const char * DEBUG_VIEWS[] = { "Off", "Tiles", "Albedo", "Metalness", "Roughness", "Normals", "UV", "BLAS" };
-      if ( ImGui::Combo("Debug view", &ioContext._DebugMode, DEBUG_VIEWS, 8) )
+      static const char * DEBUG_VIEWS[] = { "Off", "Tiles", "Albedo", "Metalness", "Roughness", "Normals", "UV", "BLAS", "Sample heatmap" };
+      if ( ImGui::Combo("Debug view", &ioContext._DebugMode, DEBUG_VIEWS, 9) )
       {
         ioContext._Renderer -> SetDebugMode(ioContext._DebugMode);
         ioContext._Renderer -> Notify(DirtyState::RenderSettings);
@@ -2574,6 +2768,7 @@ int FpsGameEditor::DrawOverlays( FpsGameEditorContext & ioContext )
   const ImU32 hiddenColor = IM_COL32(180, 180, 180, 170);
   const ImU32 lightColor = IM_COL32(255, 232, 96, 230);
   const ImU32 boidsColor = IM_COL32(98, 224, 140, 220);
+  const ImU32 boxSelectedColor = IM_COL32(255, 140, 220, 220);
 
   for ( int i = 0; i < static_cast<int>(ioContext._Map._Objects.size()); ++i )
   {
@@ -2616,27 +2811,14 @@ int FpsGameEditor::DrawOverlays( FpsGameEditorContext & ioContext )
       }
     }
 
-    const std::vector<int> * instanceIDs = ioContext._SceneBinding.GetPropInstanceIDs(propIndex);
-    if ( instanceIDs )
-    {
-      const std::vector<MeshInstance> & meshInstances = ioContext._Scene -> GetMeshInstances();
-      const std::vector<Mesh*> & meshes = ioContext._Scene -> GetMeshes();
-      for ( int instanceID : *instanceIDs )
-      {
-        if ( ( instanceID < 0 ) || ( instanceID >= static_cast<int>(meshInstances.size()) ) )
-          continue;
-
-        const MeshInstance & instance = meshInstances[instanceID];
-        if ( !instance._Visible )
-          continue;
-        if ( ( instance._MeshID < 0 ) || ( instance._MeshID >= static_cast<int>(meshes.size()) ) )
-          continue;
+    EditorDrawPropInstanceBounds(ioContext, propIndex, view, proj, drawList, selectedColor, 2.5f);
+  }
 
-        Mesh * mesh = meshes[instance._MeshID];
-        if ( mesh )
-          EditorDrawTransformedAABB(mesh -> GetBoundingBox(), instance._Transform, view, proj, drawList, selectedColor, 2.5f);
-      }
-    }
+  for ( int propIndex : _BoxSelectedProps )
+  {
+    if ( ( FpsEditableKind::Prop == _Selection._Kind ) && ( _Selection._Index == propIndex ) )
+      continue;
+    EditorDrawPropInstanceBounds(ioContext, propIndex, view, proj, drawList, boxSelectedColor, 1.8f);
   }
 
   for ( int i = 0; i < static_cast<int>(ioContext._Map._Lights.size()); ++i )
@@ -2675,6 +2857,16 @@ int FpsGameEditor::DrawOverlays( FpsGameEditorContext & ioContext )
     EditorDrawTransformedBox(EditorBoidsTransform(boids), view, proj, drawList, color, selected ? 2.5f : 1.5f);
   }
 
+  if ( _BoxSelecting )
+  {
+    const ImVec2 start(static_cast<float>(_BoxSelectStartX), static_cast<float>(_BoxSelectStartY));
+    const ImVec2 end = ImGui::GetMousePos();
+    const ImVec2 rectMin(std::min(start.x, end.x), std::min(start.y, end.y));
+    const ImVec2 rectMax(std::max(start.x, end.x), std::max(start.y, end.y));
+    drawList -> AddRectFilled(rectMin, rectMax, IM_COL32(255, 140, 220, 40));
+    drawList -> AddRect(rectMin, rectMax, boxSelectedColor, 0.f, 0, 1.5f);
+  }
+
   return 0;
 }
 
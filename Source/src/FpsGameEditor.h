@@ -7,6 +7,7 @@
 #include "KeyInput.h"
 #include "RenderSettings.h"
 #include "RenderStatsUI.h"
+#include "ScenePicker.h"
 
 #include <filesystem>
 #include <string>
@@ -121,6 +122,11 @@ public:
   bool BuildPickingRay( const FpsGameEditorContext & iContext, double iMouseX, double iMouseY, Vec3 & oRayOrigin, Vec3 & oRayDir ) const;
   bool PickSelection( const FpsGameEditorContext & iContext, double iMouseX, double iMouseY, FpsEditorSelection & oSelection ) const;
   void HandleMousePick( const FpsGameEditorContext & iContext, double iMouseX, double iMouseY );
+  void BeginBoxSelect( double iMouseX, double iMouseY );
+  void EndBoxSelect( const FpsGameEditorContext & iContext, double iMouseX, double iMouseY );
+  bool IsBoxSelecting() const { return _BoxSelecting; }
+  bool BoxSelectProps( const FpsGameEditorContext & iContext, double iMouseX0, double iMouseY0, double iMouseX1, double iMouseY1, std::vector<int> & oPropIndices ) const;
+  void ResetPicking();
 
   void DrawDockspace();
   void DrawPanels( FpsGameEditorContext & ioContext );
@@ -135,6 +141,9 @@ public:
   int DrawOverlays( FpsGameEditorContext & ioContext );
   int DrawGizmo( FpsGameEditorContext & ioContext );
 
+protected:
+  int UpdatePicking( const FpsGameEditorContext & iContext );
+
 protected:
   bool               _Enabled = false;
   bool               _Dirty = false;
@@ -160,6 +169,13 @@ protected:
   int                _NewPropAssetIndex = -1;
   std::vector<std::string> _PropAssetPaths;
   std::vector<bool>  _ObjectInstanceVisible;
+  ScenePicker        _Picker;
+  std::vector<unsigned char> _PickableInstances; // Per scene instance : 1 for visible prop instances
+  std::vector<int>   _InstancePropIndices;       // Per scene instance : owning prop index or -1
+  std::vector<int>   _BoxSelectedProps;
+  bool               _BoxSelecting = false;
+  double             _BoxSelectStartX = 0.;
+  double             _BoxSelectStartY = 0.;
   std::string        _StatusMessage;
 };
 
@@ -322,6 +322,55 @@ static const char * RendererModeName( FpsRendererMode iMode )
   return "deferred";
 }
 
+static bool ParseEffectResolution( const std::string & iToken, EffectResolution & oResolution )
+{
+  if ( IsEqual(iToken, "full") )
+  {
+    oResolution = EffectResolution::Full;
+    return true;
+  }
+  if ( IsEqual(iToken, "half") )
+  {
+    oResolution = EffectResolution::Half;
+    return true;
+  }
+  if ( IsEqual(iToken, "quarter") )
+  {
+    oResolution = EffectResolution::Quarter;
+    return true;
+  }
+  return false;
+}
+
+static const char * EffectResolutionName( EffectResolution iResolution )
+{
+  if ( EffectResolution::Half == iResolution )
+    return "half";
+  if ( EffectResolution::Quarter == iResolution )
+    return "quarter";
+  return "full";
+}
+
+static bool ParseSSRTraceMode( const std::string & iToken, SSRTraceMode & oMode )
+{
+  if ( IsEqual(iToken, "linear") )
+  {
+    oMode = SSRTraceMode::Linear;
+    return true;
+  }
+  if ( IsEqual(iToken, "hiz") )
+  {
+    oMode = SSRTraceMode::HiZ;
+    return true;
+  }
+  return false;
+}
+
+static const char * SSRTraceModeName( SSRTraceMode iMode )
+{
+  return ( SSRTraceMode::HiZ == iMode ) ? "hiz" : "linear";
+}
+
 class FpsGameMapParser
 {
 public:
@@ -596,6 +645,21 @@ protected:
         if ( !ParseInt(tokens[1], settings._MaxShadowCastingLights) )
           return Error("invalid render maxShadowCastingLights");
       }
+      else if ( IsEqual(tokens[0], "shadowcascades") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseInt(tokens[1], settings._ShadowCascades) )
+          return Error("invalid render shadowCascades");
+      }
+      else if ( IsEqual(tokens[0], "shadowcascadesplitlambda") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseFloat(tokens[1], settings._ShadowCascadeSplitLambda) )
+          return Error("invalid render shadowCascadeSplitLambda");
+      }
+      else if ( IsEqual(tokens[0], "shadowcascadedistance") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseFloat(tokens[1], settings._ShadowCascadeDistance) )
+          return Error("invalid render shadowCascadeDistance");
+      }
       else if ( IsEqual(tokens[0], "ssao") && ( 2 == static_cast<int>(tokens.size()) ) )
       {
         if ( !ParseBool(tokens[1], settings._SSAO) )
@@ -626,6 +690,11 @@ protected:
         if ( !ParseInt(tokens[1], settings._SSAOKernelSize) )
           return Error("invalid render ssaoKernelSize");
       }
+      else if ( IsEqual(tokens[0], "ssaoresolution") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseEffectResolution(tokens[1], settings._SSAOResolution) )
+          return Error("invalid render ssaoResolution");
+      }
       else if ( IsEqual(tokens[0], "ssr") && ( 2 == static_cast<int>(tokens.size()) ) )
       {
         if ( !ParseBool(tokens[1], settings._SSR) )
@@ -666,6 +735,16 @@ protected:
         if ( !ParseFloat(tokens[1], settings._SSRFade) )
           return Error("invalid render ssrFade");
       }
+      else if ( IsEqual(tokens[0], "ssrresolution") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseEffectResolution(tokens[1], settings._SSRResolution) )
+          return Error("invalid render ssrResolution");
+      }
+      else if ( IsEqual(tokens[0], "ssrtrace") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseSSRTraceMode(tokens[1], settings._SSRTraceMode) )
+          return Error("invalid render ssrTrace");
+      }
       else if ( IsEqual(tokens[0], "pbrdirectlighting") && ( 2 == static_cast<int>(tokens.size()) ) )
       {
         if ( !ParseBool(tokens[1], settings._PBRDirectLighting) )
@@ -676,6 +755,26 @@ protected:
         if ( !ParseFloat(tokens[1], settings._DirectLightIntensity) )
           return Error("invalid render directLightIntensity");
       }
+      else if ( IsEqual(tokens[0], "lightclustering") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseBool(tokens[1], settings._LightClustering) )
+          return Error("invalid render lightClustering");
+      }
+      else if ( IsEqual(tokens[0], "lightclustergrid") && ( 4 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseInt(tokens[1], settings._LightClusterGrid.x) || !ParseInt(tokens[2], settings._LightClusterGrid.y) || !ParseInt(tokens[3], settings._LightClusterGrid.z) )
+          return Error("invalid render lightClusterGrid");
+      }
+      else if ( IsEqual(tokens[0], "lightclusterthreshold") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseFloat(tokens[1], settings._LightClusterThreshold) )
+          return Error("invalid render lightClusterThreshold");
+      }
+      else if ( IsEqual(tokens[0], "compactgbuffer") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseBool(tokens[1], settings._CompactGBuffer) )
+          return Error("invalid render compactGBuffer");
+      }
       else if ( ( IsEqual(tokens[0], "iblmaxroughness") || IsEqual(tokens[0], "speculariblmaxroughness") ) && ( 2 == static_cast<int>(tokens.size()) ) )
       {
         if ( !ParseFloat(tokens[1], settings._SpecularIBLMaxRoughness) )
@@ -691,6 +790,26 @@ protected:
         if ( !ParseInt(tokens[1], settings._NbSamplesPerPixel) )
           return Error("invalid render spp");
       }
+      else if ( IsEqual(tokens[0], "adaptivesampling") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseBool(tokens[1], settings._AdaptiveSampling) )
+          return Error("invalid render adaptiveSampling");
+      }
+      else if ( IsEqual(tokens[0], "convergencethreshold") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseFloat(tokens[1], settings._ConvergenceThreshold) )
+          return Error("invalid render convergenceThreshold");
+      }
+      else if ( IsEqual(tokens[0], "adaptiveminframes") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseInt(tokens[1], settings._AdaptiveMinFrames) )
+          return Error("invalid render adaptiveMinFrames");
+      }
+      else if ( IsEqual(tokens[0], "wavefront") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseBool(tokens[1], settings._WavefrontPathTracing) )
+          return Error("invalid render wavefront");
+      }
       else if ( IsEqual(tokens[0], "denoise") && ( 2 == static_cast<int>(tokens.size()) ) )
       {
         if ( !ParseBool(tokens[1], settings._Denoise) )
@@ -1160,6 +1279,11 @@ protected:
         if ( !ParseFloat(tokens[1], boids._Settings._Scale) )
           return Error("invalid boids scale");
       }
+      else if ( IsEqual(tokens[0], "collide") && ( 2 == static_cast<int>(tokens.size()) ) )
+      {
+        if ( !ParseBool(tokens[1], boids._Settings._CollideWithWorld) )
+          return Error("invalid boids collide flag");
+      }
       else if ( IsEqual(tokens[0], "color") )
       {
         if ( !ParseVec3(tokens, boids._Settings._Color) )
@@ -1320,12 +1444,16 @@ bool FpsGameMapLoader::Save( const std::string & iFilename, const FpsGameMap & i
     file << "  shadowMapResolution " << settings._ShadowMapResolution << "\n";
     file << "  shadowBias " << settings._ShadowBias << "\n";
     file << "  maxShadowCastingLights " << settings._MaxShadowCastingLights << "\n";
+    file << "  shadowCascades " << settings._ShadowCascades << "\n";
+    file << "  shadowCascadeSplitLambda " << settings._ShadowCascadeSplitLambda << "\n";
+    file << "  shadowCascadeDistance " << settings._ShadowCascadeDistance << "\n";
     file << "  ssao " << ( settings._SSAO ? "true" : "false" ) << "\n";
     file << "  ssaoBlur " << ( settings._SSAOBlur ? "true" : "false" ) << "\n";
     file << "  ssaoRadius " << settings._SSAORadius << "\n";
     file << "  ssaoBias " << settings._SSAOBias << "\n";
     file << "  ssaoIntensity " << settings._SSAOIntensity << "\n";
     file << "  ssaoKernelSize " << settings._SSAOKernelSize << "\n";
+    file << "  ssaoResolution " << EffectResolutionName(settings._SSAOResolution) << "\n";
     file << "  ssr " << ( settings._SSR ? "true" : "false" ) << "\n";
     file << "  ssrIntensity " << settings._SSRIntensity << "\n";
     file << "  ssrMaxRoughness " << settings._SSRMaxRoughness << "\n";
@@ -1334,11 +1462,21 @@ bool FpsGameMapLoader::Save( const std::string & iFilename, const FpsGameMap & i
     file << "  ssrMaxDistance " << settings._SSRMaxDistance << "\n";
     file << "  ssrThickness " << settings._SSRThickness << "\n";
     file << "  ssrFade " << settings._SSRFade << "\n";
+    file << "  ssrResolution " << EffectResolutionName(settings._SSRResolution) << "\n";
+    file << "  ssrTrace " << SSRTraceModeName(settings._SSRTraceMode) << "\n";
     file << "  pbrDirectLighting " << ( settings._PBRDirectLighting ? "true" : "false" ) << "\n";
     file << "  directLightIntensity " << settings._DirectLightIntensity << "\n";
+    file << "  lightClustering " << ( settings._LightClustering ? "true" : "false" ) << "\n";
+    file << "  lightClusterGrid " << settings._LightClusterGrid.x << " " << settings._LightClusterGrid.y << " " << settings._LightClusterGrid.z << "\n";
+    file << "  lightClusterThreshold " << settings._LightClusterThreshold << "\n";
+    file << "  compactGBuffer " << ( settings._CompactGBuffer ? "true" : "false" ) << "\n";
     file << "  iblMaxRoughness " << settings._SpecularIBLMaxRoughness << "\n";
     file << "  bounces " << settings._Bounces << "\n";
     file << "  spp " << settings._NbSamplesPerPixel << "\n";
+    file << "  adaptiveSampling " << ( settings._AdaptiveSampling ? "true" : "false" ) << "\n";
+    file << "  convergenceThreshold " << settings._ConvergenceThreshold << "\n";
+    file << "  adaptiveMinFrames " << settings._AdaptiveMinFrames << "\n";
+    file << "  wavefront " << ( settings._WavefrontPathTracing ? "true" : "false" ) << "\n";
     file << "  denoise " << ( settings._Denoise ? "true" : "false" ) << "\n";
     file << "}\n\n";
   }
@@ -1427,6 +1565,7 @@ bool FpsGameMapLoader::Save( const std::string & iFilename, const FpsGameMap & i
     file << "  cohesion " << settings._CohesionWeight << "\n";
     file << "  boundsweight " << settings._BoundsWeight << "\n";
     file << "  scale " << settings._Scale << "\n";
+    file << "  collide " << ( settings._CollideWithWorld ? "true" : "false" ) << "\n";
     WriteVec3(file, "color", settings._Color);
     file << "}\n\n";
   }
@@ -6,6 +6,7 @@
 #include "Light.h"
 #include "Material.h"
 #include "MathUtil.h"
+#include "RenderSettings.h"
 
 #include <string>
 #include <vector>
@@ -80,12 +81,16 @@ struct FpsMapRenderSettings
   int             _ShadowMapResolution = 1024;
   float           _ShadowBias = 0.002f;
   int             _MaxShadowCastingLights = 4;
+  int             _ShadowCascades = 1;
+  float           _ShadowCascadeSplitLambda = 0.75f;
+  float           _ShadowCascadeDistance = 0.f;
   bool            _SSAO = true;
   bool            _SSAOBlur = true;
   float           _SSAORadius = 0.5f;
   float           _SSAOBias = 0.025f;
   float           _SSAOIntensity = 1.f;
   int             _SSAOKernelSize = 16;
+  EffectResolution _SSAOResolution = EffectResolution::Full;
   bool            _SSR = true;
   float           _SSRIntensity = 0.6f;
   float           _SSRMaxRoughness = 0.55f;
@@ -94,11 +99,21 @@ struct FpsMapRenderSettings
   float           _SSRMaxDistance = 35.f;
   float           _SSRThickness = 0.25f;
   float           _SSRFade = 0.18f;
+  EffectResolution _SSRResolution = EffectResolution::Full;
+  SSRTraceMode    _SSRTraceMode = SSRTraceMode::Linear;
   bool            _PBRDirectLighting = true;
   float           _DirectLightIntensity = 1.f;
+  bool            _LightClustering = false;
+  Vec3i           _LightClusterGrid = Vec3i(16, 9, 24);
+  float           _LightClusterThreshold = 0.01f;
+  bool            _CompactGBuffer = false;
   float           _SpecularIBLMaxRoughness = 0.5f;
   int             _Bounces = 1;
   int             _NbSamplesPerPixel = 1;
+  bool            _AdaptiveSampling = false;
+  float           _ConvergenceThreshold = 0.02f;
+  int             _AdaptiveMinFrames = 16;
+  bool            _WavefrontPathTracing = false;
   bool            _Denoise = false;
 };
 
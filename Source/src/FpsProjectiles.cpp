@@ -1,6 +1,7 @@
 #include "FpsProjectiles.h"
 
 #include "FpsGame.h"
+#include "JobSystem.h"
 
 #include <algorithm>
 #include <cmath>
@@ -28,6 +29,26 @@ static Vec3 PlayerForward( const FpsPlayer & iPlayer )
   return glm::normalize(forward);
 }
 
+static float NextStressRandom( uint32_t & ioSeed )
+{
+  ioSeed = ioSeed * 1664525u + 1013904223u;
+  return static_cast<float>(ioSeed >> 8) / static_cast<float>(1u << 24);
+}
+
+static void BounceProjectile( FpsProjectile & ioProjectile, const Vec3 & iNormal, float iBounciness )
+{
+  const float normalSpeed = glm::dot(ioProjectile._Velocity, iNormal);
+  if ( normalSpeed >= 0.f )
+    return;
+
+  float bounceSpeed = -normalSpeed * iBounciness;
+  if ( bounceSpeed < 0.15f )
+    bounceSpeed = 0.f;
+
+  const Vec3 tangent = ioProjectile._Velocity - iNormal * normalSpeed;
+  ioProjectile._Velocity = tangent * 0.96f + iNormal * bounceSpeed;
+}
+
 // ----------------------------------------------------------------------------
 // Initialize
 // ----------------------------------------------------------------------------
@@ -55,7 +76,9 @@ int FpsProjectiles::Reset( const FpsGameSettings & iSettings )
 // ----------------------------------------------------------------------------
 int FpsProjectiles::ResizePool( const FpsGameSettings & iSettings )
 {
-  const int maxProjectiles = std::max(1, iSettings._MaxProjectiles);
+  int maxProjectiles = std::max(1, iSettings._MaxProjectiles);
+  if ( iSettings._ProjectileStressTest )
+    maxProjectiles = std::max(maxProjectiles, iSettings._ProjectileStressCount);
   if ( static_cast<int>(_Projectiles.size()) == maxProjectiles )
     return 0;
 
@@ -132,6 +155,9 @@ int FpsProjectiles::Update( float iRealDeltaTime, float iSimDeltaTime, const Fps
     _PendingShots--;
   }
 
+  if ( iContext._Settings._ProjectileStressTest )
+    FireStressVolley(iContext._Settings, iContext._Player);
+
   UpdateActiveProjectiles(iSimDeltaTime, iContext);
   return 0;
 }
@@ -199,112 +225,262 @@ void FpsProjectiles::Fire( const FpsGameSettings & iSettings, const FpsPlayer &
   _Dirty = true;
 }
 
+// ----------------------------------------------------------------------------
+// FireStressVolley
+// ----------------------------------------------------------------------------
+void FpsProjectiles::FireStressVolley( const FpsGameSettings & iSettings, const FpsPlayer & iPlayer )
+{
+  const float radius = std::max(0.02f, iSettings._ProjectileRadius);
+  const Vec3 forward = PlayerForward(iPlayer);
+  const Vec3 right = glm::normalize(glm::cross(forward, Vec3(0.f, 1.f, 0.f)));
+  const Vec3 up = glm::cross(right, forward);
+  const Vec3 origin = iPlayer.EyePosition(iSettings) + forward * (iSettings._PlayerRadius + radius + 0.08f);
+
+  for ( FpsProjectile & projectile : _Projectiles )
+  {
+    if ( projectile._Active )
+      continue;
+
+    // Random direction in a wide cone around the view direction
+    const float spreadX = NextStressRandom(_StressSeed) * 2.f - 1.f;
+    const float spreadY = NextStressRandom(_StressSeed) * 2.f - 1.f;
+    const Vec3 direction = glm::normalize(forward + right * (spreadX * 0.6f) + up * (spreadY * 0.4f));
+    const float speed = std::max(0.f, iSettings._ProjectileSpeed) * (0.5f + NextStressRandom(_StressSeed));
+
+    projectile._Active = true;
+    projectile._Position = origin;
+    projectile._Velocity = iPlayer._Velocity + direction * speed;
+    projectile._Age = NextStressRandom(_StressSeed) * std::max(0.1f, iSettings._ProjectileLifetime) * 0.5f;
+    _Dirty = true;
+  }
+}
+
 // ----------------------------------------------------------------------------
 // UpdateActiveProjectiles
 // ----------------------------------------------------------------------------
 void FpsProjectiles::UpdateActiveProjectiles( float iDeltaTime, const FpsProjectilesUpdateContext & iContext )
 {
-  const float radius = std::max(0.02f, iContext._Settings._ProjectileRadius);
-  const float maxMovePerStep = std::max(0.05f, radius * 0.75f);
+  const float lifetime = std::max(0.1f, iContext._Settings._ProjectileLifetime);
 
-  for ( FpsProjectile & projectile : _Projectiles )
+  _ActiveIndices.clear();
+  for ( int i = 0; i < static_cast<int>(_Projectiles.size()); ++i )
   {
+    FpsProjectile & projectile = _Projectiles[i];
     if ( !projectile._Active )
       continue;
 
     projectile._Age += iDeltaTime;
-    if ( projectile._Age >= std::max(0.1f, iContext._Settings._ProjectileLifetime) )
+    if ( projectile._Age >= lifetime )
     {
       projectile._Active = false;
       _Dirty = true;
       continue;
     }
 
-    const float moveLen = glm::length(projectile._Velocity) * iDeltaTime;
-    const int nbSteps = std::max(1, std::min(16, static_cast<int>(std::ceil(moveLen / maxMovePerStep))));
-    const float stepDt = iDeltaTime / static_cast<float>(nbSteps);
+    _ActiveIndices.push_back(i);
+  }
+
+  if ( _ActiveIndices.empty() )
+    return;
+
+  UpdateSweepShapes(iContext);
+
+  const int nbBatches = ( static_cast<int>(_ActiveIndices.size()) + FpsCollisionSweepBatch::S_NbLanes - 1 ) / FpsCollisionSweepBatch::S_NbLanes;
+  int nbJobs = 1;
+  if ( iContext._AllowJobs && JobSystem::Get().IsInitialized() && ( static_cast<int>(_ActiveIndices.size()) >= S_ParallelSweepThreshold ) )
+    nbJobs = std::max(1, std::min(nbBatches, static_cast<int>(JobSystem::Get().GetThreadCount())));
+
+  if ( static_cast<int>(_SweepScratch.size()) < nbJobs )
+    _SweepScratch.resize(nbJobs);
 
-    for ( int step = 0; step < nbSteps; ++step )
+  if ( 1 == nbJobs )
+    SweepBatches(0, nbBatches, iDeltaTime, iContext, _SweepScratch[0]);
+  else
+  {
+    // Each job owns a contiguous range of batches and its own scratch : projectiles never interact with each other
+    const int batchesPerJob = ( nbBatches + nbJobs - 1 ) / nbJobs;
+    for ( int job = 0; job < nbJobs; ++job )
     {
-      projectile._Velocity.y -= std::max(0.f, iContext._Settings._ProjectileGravity) * stepDt;
-      MoveProjectileAxis(projectile, 0, projectile._Velocity.x * stepDt, iContext);
-      MoveProjectileAxis(projectile, 1, projectile._Velocity.y * stepDt, iContext);
-      MoveProjectileAxis(projectile, 2, projectile._Velocity.z * stepDt, iContext);
-    }
+      const int firstBatch = job * batchesPerJob;
+      const int lastBatch = std::min(nbBatches, firstBatch + batchesPerJob);
+      if ( firstBatch >= lastBatch )
+        break;
 
-    _Dirty = true;
+      FpsProjectileSweepScratch * scratch = &_SweepScratch[job];
+      JobSystem::Get().Execute([this, firstBatch, lastBatch, iDeltaTime, &iContext, scratch]() { this -> SweepBatches(firstBatch, lastBatch, iDeltaTime, iContext, *scratch); });
+    }
+    JobSystem::Get().Wait();
   }
+
+  _Dirty = true;
 }
 
 // ----------------------------------------------------------------------------
-// MoveProjectileAxis
+// UpdateSweepShapes
 // ----------------------------------------------------------------------------
-void FpsProjectiles::MoveProjectileAxis( FpsProjectile & ioProjectile, int iAxis, float iDelta, const FpsProjectilesUpdateContext & iContext )
+void FpsProjectiles::UpdateSweepShapes( const FpsProjectilesUpdateContext & iContext )
 {
-  if ( fabs(iDelta) <= EPSILON )
+  static const Vec3 worldAxes[3] = { Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f) };
+
+  // The broadphase is rebuilt whenever objects or colliders change : same build, same shapes.
+  // Without a broadphase nothing tells what moved, the shapes are rebuilt every update.
+  if ( iContext._Broadphase && ( iContext._Broadphase == _SweepShapesBroadphase ) && ( iContext._Broadphase -> GetGeneration() == _SweepShapesGeneration ) )
     return;
 
-  ioProjectile._Position[iAxis] += iDelta;
+  _SweepShapesBroadphase = iContext._Broadphase;
+  _SweepShapesGeneration = ( iContext._Broadphase ) ? ( iContext._Broadphase -> GetGeneration() ) : ( 0 );
 
-  const float radius = std::max(0.02f, iContext._Settings._ProjectileRadius);
-  const float bounciness = MathUtil::Clamp(iContext._Settings._ProjectileBounciness, 0.f, 1.f);
-
-  for ( const FpsSceneObject & object : iContext._Objects )
+  _SweepShapes.clear();
+  _ObjectSweepShapes.assign(iContext._Objects.size(), -1);
+  for ( int i = 0; i < static_cast<int>(iContext._Objects.size()); ++i )
   {
+    const FpsSceneObject & object = iContext._Objects[i];
     if ( !object._Collidable )
       continue;
 
-    const Vec3 delta = ioProjectile._Position - object._Center;
-    const Vec3 sumHalf = ObjectCollisionHalfExtents(object) + Vec3(radius);
-    if ( ( std::abs(delta.x) >= sumHalf.x )
-      || ( std::abs(delta.y) >= sumHalf.y )
-      || ( std::abs(delta.z) >= sumHalf.z ) )
-      continue;
+    _ObjectSweepShapes[i] = static_cast<int>(_SweepShapes.size());
+    _SweepShapes.push_back(FpsCollision::MakeObb(-1, -1, object._Center, worldAxes, ObjectCollisionHalfExtents(object)));
+  }
 
-    const Vec3 overlap = sumHalf - Vec3(std::abs(delta.x), std::abs(delta.y), std::abs(delta.z));
-    int minAxis = 0;
-    if ( overlap.y < overlap[minAxis] )
-      minAxis = 1;
-    if ( overlap.z < overlap[minAxis] )
-      minAxis = 2;
-    if ( minAxis != iAxis )
-      continue;
+  _FirstColliderSweepShape = static_cast<int>(_SweepShapes.size());
+  _SweepShapes.insert(_SweepShapes.end(), iContext._PropColliders.begin(), iContext._PropColliders.end());
+}
 
-    if ( iDelta > 0.f )
-      ioProjectile._Position[iAxis] -= overlap[iAxis];
-    else
-      ioProjectile._Position[iAxis] += overlap[iAxis];
+// ----------------------------------------------------------------------------
+// GatherSweepShapes
+// ----------------------------------------------------------------------------
+void FpsProjectiles::GatherSweepShapes( const FpsCollisionSweepBatch & iBatch, const FpsProjectilesUpdateContext & iContext, FpsProjectileSweepScratch & ioScratch ) const
+{
+  ioScratch._Shapes.clear();
 
-    ioProjectile._Velocity[iAxis] = -ioProjectile._Velocity[iAxis] * bounciness;
-    if ( std::abs(ioProjectile._Velocity[iAxis]) < 0.15f )
-      ioProjectile._Velocity[iAxis] = 0.f;
+  if ( !iContext._Broadphase )
+  {
+    for ( int i = 0; i < static_cast<int>(_SweepShapes.size()); ++i )
+      ioScratch._Shapes.push_back(i);
+    return;
+  }
 
-    for ( int axis = 0; axis < 3; ++axis )
-    {
-      if ( axis != iAxis )
-        ioProjectile._Velocity[axis] *= 0.96f;
-    }
+  AABB<Vec3> sweptBounds;
+  for ( int i = 0; i < iBatch._NbLanes; ++i )
+  {
+    const Vec3 start(iBatch._StartX[i], iBatch._StartY[i], iBatch._StartZ[i]);
+    const Vec3 delta(iBatch._DeltaX[i], iBatch._DeltaY[i], iBatch._DeltaZ[i]);
+    sweptBounds.Insert(start);
+    sweptBounds.Insert(start + delta);
+  }
+  sweptBounds._Low -= Vec3(iBatch._Radius + 0.01f);
+  sweptBounds._High += Vec3(iBatch._Radius + 0.01f);
 
-    _Dirty = true;
+  iContext._Broadphase -> Query(sweptBounds, ioScratch._Query);
+  for ( int objectIndex : ioScratch._Query._Objects )
+  {
+    if ( ( objectIndex < static_cast<int>(_ObjectSweepShapes.size()) ) && ( _ObjectSweepShapes[objectIndex] >= 0 ) )
+      ioScratch._Shapes.push_back(_ObjectSweepShapes[objectIndex]);
+  }
+  for ( int colliderIndex : ioScratch._Query._Colliders )
+  {
+    if ( _FirstColliderSweepShape + colliderIndex < static_cast<int>(_SweepShapes.size()) )
+      ioScratch._Shapes.push_back(_FirstColliderSweepShape + colliderIndex);
   }
+}
+
+// ----------------------------------------------------------------------------
+// SweepBatches
+// ----------------------------------------------------------------------------
+void FpsProjectiles::SweepBatches( int iFirstBatch, int iLastBatch, float iDeltaTime, const FpsProjectilesUpdateContext & iContext, FpsProjectileSweepScratch & ioScratch )
+{
+  constexpr int nbLanes = FpsCollisionSweepBatch::S_NbLanes;
+  constexpr float skinWidth = 1e-3f;
 
-  for ( const FpsCollisionObb & collider : iContext._PropColliders )
+  const float radius = std::max(0.02f, iContext._Settings._ProjectileRadius);
+  const float bounciness = MathUtil::Clamp(iContext._Settings._ProjectileBounciness, 0.f, 1.f);
+  const float gravity = std::max(0.f, iContext._Settings._ProjectileGravity);
+  const int nbActive = static_cast<int>(_ActiveIndices.size());
+
+  for ( int batchIndex = iFirstBatch; batchIndex < iLastBatch; ++batchIndex )
   {
-    FpsCollisionSphereResult hit;
-    if ( !FpsCollision::ResolveSphereObb(ioProjectile._Position, radius, collider, hit) )
-      continue;
+    const int firstActive = batchIndex * nbLanes;
+    FpsCollisionSweepBatch batch;
+    batch._Radius = radius;
+    batch._NbLanes = std::min(nbLanes, nbActive - firstActive);
+
+    float remainingTime[nbLanes] = {};
+    for ( int lane = 0; lane < batch._NbLanes; ++lane )
+    {
+      FpsProjectile & projectile = _Projectiles[_ActiveIndices[firstActive + lane]];
+      projectile._Velocity.y -= gravity * iDeltaTime;
+      remainingTime[lane] = iDeltaTime;
+    }
 
-    ioProjectile._Position += hit._Correction;
+    // Move every lane to its earliest time of impact, bounce, then sweep the remaining time.
+    // Motion left after the last bounce is dropped rather than moved unchecked.
+    for ( int bounce = 0; bounce < S_MaxSweepBounces; ++bounce )
+    {
+      bool moving = false;
+      for ( int lane = 0; lane < batch._NbLanes; ++lane )
+      {
+        const FpsProjectile & projectile = _Projectiles[_ActiveIndices[firstActive + lane]];
+        const Vec3 delta = projectile._Velocity * remainingTime[lane];
+        batch._StartX[lane] = projectile._Position.x;
+        batch._StartY[lane] = projectile._Position.y;
+        batch._StartZ[lane] = projectile._Position.z;
+        batch._DeltaX[lane] = delta.x;
+        batch._DeltaY[lane] = delta.y;
+        batch._DeltaZ[lane] = delta.z;
+        moving |= ( glm::dot(delta, delta) > EPSILON );
+      }
+      if ( !moving )
+        break;
 
-    const float normalSpeed = glm::dot(ioProjectile._Velocity, hit._Normal);
-    if ( normalSpeed < 0.f )
-      ioProjectile._Velocity -= ( 1.f + bounciness ) * normalSpeed * hit._Normal;
+      GatherSweepShapes(batch, iContext, ioScratch);
 
-    ioProjectile._Velocity *= 0.96f;
-    if ( glm::length(ioProjectile._Velocity) < 0.15f )
-      ioProjectile._Velocity = Vec3(0.f);
+      FpsCollisionSweepBatchResult hits;
+      hits.Reset();
+      for ( int shape : ioScratch._Shapes )
+        FpsCollision::SweepSphereObbBatch(batch, _SweepShapes[shape], shape, hits);
 
-    _Dirty = true;
+      for ( int lane = 0; lane < batch._NbLanes; ++lane )
+      {
+        FpsProjectile & projectile = _Projectiles[_ActiveIndices[firstActive + lane]];
+        const Vec3 delta(batch._DeltaX[lane], batch._DeltaY[lane], batch._DeltaZ[lane]);
+        if ( hits._Shape[lane] < 0 )
+        {
+          projectile._Position += delta;
+          remainingTime[lane] = 0.f;
+          continue;
+        }
+
+        const Vec3 normal(hits._NormalX[lane], hits._NormalY[lane], hits._NormalZ[lane]);
+        projectile._Position += delta * hits._Time[lane] + normal * skinWidth;
+        remainingTime[lane] *= ( 1.f - hits._Time[lane] );
+        BounceProjectile(projectile, normal, bounciness);
+      }
+    }
+
+    // Spheres starting inside a shape are ignored by the sweep : push them out discretely
+    for ( int lane = 0; lane < batch._NbLanes; ++lane )
+    {
+      const FpsProjectile & projectile = _Projectiles[_ActiveIndices[firstActive + lane]];
+      batch._StartX[lane] = projectile._Position.x;
+      batch._StartY[lane] = projectile._Position.y;
+      batch._StartZ[lane] = projectile._Position.z;
+      batch._DeltaX[lane] = batch._DeltaY[lane] = batch._DeltaZ[lane] = 0.f;
+    }
+    GatherSweepShapes(batch, iContext, ioScratch);
+
+    for ( int lane = 0; lane < batch._NbLanes; ++lane )
+    {
+      FpsProjectile & projectile = _Projectiles[_ActiveIndices[firstActive + lane]];
+      for ( int shape : ioScratch._Shapes )
+      {
+        FpsCollisionSphereResult hit;
+        if ( !FpsCollision::ResolveSphereObb(projectile._Position, radius, _SweepShapes[shape], hit) )
+          continue;
+
+        projectile._Position += hit._Correction;
+        BounceProjectile(projectile, hit._Normal, bounciness);
+      }
+    }
   }
 }
 
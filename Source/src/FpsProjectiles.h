@@ -1,9 +1,11 @@
 #ifndef _FpsProjectiles_
 #define _FpsProjectiles_
 
+#include "FpsBroadphase.h"
 #include "FpsCollision.h"
 #include "MathUtil.h"
 
+#include <cstdint>
 #include <vector>
 
 namespace RTRT
@@ -26,17 +28,27 @@ struct FpsProjectilesUpdateContext
   FpsProjectilesUpdateContext( const FpsGameSettings & iSettings,
                                const FpsPlayer & iPlayer,
                                const std::vector<FpsSceneObject> & iObjects,
-                               const std::vector<FpsCollisionObb> & iPropColliders )
+                               const std::vector<FpsCollisionObb> & iPropColliders,
+                               const FpsBroadphase * iBroadphase = nullptr )
   : _Settings(iSettings)
   , _Player(iPlayer)
   , _Objects(iObjects)
   , _PropColliders(iPropColliders)
+  , _Broadphase(iBroadphase)
   {}
 
   const FpsGameSettings & _Settings;
   const FpsPlayer & _Player;
   const std::vector<FpsSceneObject> & _Objects;
   const std::vector<FpsCollisionObb> & _PropColliders;
+  const FpsBroadphase * _Broadphase; // Optional : linear scan over objects and colliders when null
+  bool _AllowJobs = true;            // False when already running inside a job
+};
+
+struct FpsProjectileSweepScratch
+{
+  FpsBroadphaseQuery _Query;
+  std::vector<int>   _Shapes;
 };
 
 class FpsProjectiles
@@ -51,6 +63,7 @@ public:
   int Update( float iRealDeltaTime, float iSimDeltaTime, const FpsProjectilesUpdateContext & iContext );
 
   const std::vector<FpsProjectile> & GetProjectiles() const { return _Projectiles; }
+  std::vector<FpsProjectile> & GetProjectiles() { return _Projectiles; }
   int GetAmmo() const { return _Ammo; }
   int GetActiveCount() const;
   bool ConsumeDirty();
@@ -58,15 +71,29 @@ public:
 protected:
   void Fire( const FpsGameSettings & iSettings, const FpsPlayer & iPlayer );
   void UpdateActiveProjectiles( float iDeltaTime, const FpsProjectilesUpdateContext & iContext );
-  void MoveProjectileAxis( FpsProjectile & ioProjectile, int iAxis, float iDelta, const FpsProjectilesUpdateContext & iContext );
+  void FireStressVolley( const FpsGameSettings & iSettings, const FpsPlayer & iPlayer );
+  void UpdateSweepShapes( const FpsProjectilesUpdateContext & iContext );
+  void SweepBatches( int iFirstBatch, int iLastBatch, float iDeltaTime, const FpsProjectilesUpdateContext & iContext, FpsProjectileSweepScratch & ioScratch );
+  void GatherSweepShapes( const FpsCollisionSweepBatch & iBatch, const FpsProjectilesUpdateContext & iContext, FpsProjectileSweepScratch & ioScratch ) const;
 
 protected:
-  std::vector<FpsProjectile> _Projectiles;
-  float                      _CooldownTimer = 0.f;
-  float                      _AmmoRefillTimer = 0.f;
-  int                        _Ammo = 32;
-  int                        _PendingShots = 0;
-  bool                       _Dirty = false;
+  static constexpr int S_MaxSweepBounces = 4;
+  static constexpr int S_ParallelSweepThreshold = 256; // Active projectiles before the sweep is split across jobs
+
+  std::vector<FpsProjectile>             _Projectiles;
+  std::vector<int>                       _ActiveIndices;
+  std::vector<FpsCollisionObb>           _SweepShapes;        // Collidable objects as unrotated boxes, then prop colliders
+  std::vector<int>                       _ObjectSweepShapes;  // Object index -> sweep shape, -1 when not collidable
+  int                                    _FirstColliderSweepShape = 0;
+  const FpsBroadphase *                  _SweepShapesBroadphase = nullptr; // Broadphase build the sweep shapes were made from
+  unsigned int                           _SweepShapesGeneration = 0;
+  std::vector<FpsProjectileSweepScratch> _SweepScratch;
+  float                                  _CooldownTimer = 0.f;
+  float                                  _AmmoRefillTimer = 0.f;
+  int                                    _Ammo = 32;
+  int                                    _PendingShots = 0;
+  uint32_t                               _StressSeed = 1u;
+  bool                                   _Dirty = false;
 };
 
 }
@@ -0,0 +1,251 @@
+#include "FpsSimulation.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace RTRT
+{
+
+// ----------------------------------------------------------------------------
+// AddTask
+// ----------------------------------------------------------------------------
+int FpsSimulationGraph::AddTask( const char * iName, const std::function<int()> & iRun, const std::vector<int> & iDependencies, bool iSpawnsJobs )
+{
+  FpsSimulationTask task;
+  task._Name = iName;
+  task._Run = iRun;
+  task._Dependencies = iDependencies;
+  task._SpawnsJobs = iSpawnsJobs;
+  _Tasks.push_back(task);
+  return static_cast<int>(_Tasks.size()) - 1;
+}
+
+// ----------------------------------------------------------------------------
+// Execute
+// ----------------------------------------------------------------------------
+int FpsSimulationGraph::Execute()
+{
+  const int nbTasks = static_cast<int>(_Tasks.size());
+  _Results.assign(nbTasks, 0);
+  _Done.assign(nbTasks, false);
+  _NbWaves = 0;
+
+  // Without worker threads JobSystem::Wait() never returns : run everything on the calling thread
+  const bool useJobs = JobSystem::Get().IsInitialized();
+
+  int nbDone = 0;
+  int result = 0;
+  while ( nbDone < nbTasks )
+  {
+    _Wave.clear();
+    for ( int i = 0; i < nbTasks; ++i )
+    {
+      if ( _Done[i] )
+        continue;
+
+      bool ready = true;
+      for ( int dependency : _Tasks[i]._Dependencies )
+      {
+        if ( ( dependency < 0 ) || ( dependency >= nbTasks ) || !_Done[dependency] )
+        {
+          ready = false;
+          break;
+        }
+      }
+      if ( ready )
+        _Wave.push_back(i);
+    }
+
+    // Cycle or invalid dependency
+    if ( _Wave.empty() )
+      return 1;
+
+    for ( int taskIndex : _Wave )
+    {
+      if ( useJobs && !_Tasks[taskIndex]._SpawnsJobs )
+        JobSystem::Get().Execute([this, taskIndex]() { _Results[taskIndex] = _Tasks[taskIndex]._Run(); });
+    }
+    for ( int taskIndex : _Wave )
+    {
+      if ( !useJobs || _Tasks[taskIndex]._SpawnsJobs )
+        _Results[taskIndex] = _Tasks[taskIndex]._Run();
+    }
+    if ( useJobs )
+      JobSystem::Get().Wait();
+
+    for ( int taskIndex : _Wave )
+    {
+      _Done[taskIndex] = true;
+      if ( 0 != _Results[taskIndex] )
+        result = 1;
+    }
+    nbDone += static_cast<int>(_Wave.size());
+    _NbWaves++;
+  }
+
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// Reset
+// ----------------------------------------------------------------------------
+void FpsSimulation::Reset()
+{
+  _Accumulator = 0.f;
+  _Alpha = 1.f;
+  _LastNbSteps = 0;
+  _HasState = false;
+}
+
+// ----------------------------------------------------------------------------
+// Advance
+// ----------------------------------------------------------------------------
+int FpsSimulation::Advance( float iFrameTime,
+                            const FpsGameInput & iInput,
+                            const FpsGameSettings & iSettings,
+                            FpsGameWorld & ioWorld,
+                            std::vector<BoidSimulation> & ioBoidSimulations,
+                            const std::vector<BoidSettings> & iBoidSettings )
+{
+  const float stepTime = 1.f / MathUtil::Clamp(iSettings._SimulationRate, 10.f, 240.f);
+  const int maxSteps = std::max(1, iSettings._MaxSimulationSteps);
+  const float frameTime = MathUtil::Clamp(iFrameTime, 0.f, 0.25f);
+
+  // Frame-rate input (look, fire requests, ammo refill) is applied once per frame
+  if ( 0 != ioWorld.BeginFrame(frameTime, iInput, iSettings) )
+    return 1;
+
+  // Snap on first use, after a reset or when the world was resized outside the scheduler
+  if ( !_HasState || iInput._ResetPressed || !Matches(ioWorld, ioBoidSimulations) )
+  {
+    Capture(ioWorld, ioBoidSimulations, _Current);
+    _Previous = _Current;
+    _Accumulator = 0.f;
+    _HasState = true;
+  }
+
+  _Accumulator += frameTime;
+  _LastNbSteps = 0;
+  while ( ( _Accumulator >= stepTime ) && ( _LastNbSteps < maxSteps ) )
+  {
+    std::swap(_Previous, _Current);
+    if ( 0 != Step(stepTime, iInput, iSettings, ioWorld, ioBoidSimulations, iBoidSettings) )
+      return 1;
+    Capture(ioWorld, ioBoidSimulations, _Current);
+
+    _Accumulator -= stepTime;
+    _LastNbSteps++;
+  }
+
+  // Too slow to keep up : drop whole ticks instead of spiraling
+  if ( _Accumulator >= stepTime )
+    _Accumulator = std::fmod(_Accumulator, stepTime);
+
+  _Alpha = MathUtil::Clamp(_Accumulator / stepTime, 0.f, 1.f);
+  Interpolate(ioWorld);
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Step
+// ----------------------------------------------------------------------------
+int FpsSimulation::Step( float iStepTime,
+                         const FpsGameInput & iInput,
+                         const FpsGameSettings & iSettings,
+                         FpsGameWorld & ioWorld,
+                         std::vector<BoidSimulation> & ioBoidSimulations,
+                         const std::vector<BoidSettings> & iBoidSettings )
+{
+  // Projectiles fire from the player pose of the previous tick while the player task writes the next one
+  const FpsPlayer tickPlayer = ioWorld.GetPlayer();
+
+  _Graph.Clear();
+  const int broadphaseTask = _Graph.AddTask("Broadphase", [&ioWorld]() { return ioWorld.UpdateBroadphase(); });
+
+  _Graph.AddTask("Player", [&]() { ioWorld.StepPlayer(iStepTime, iInput, iSettings); return 0; }, { broadphaseTask });
+
+  // The projectile sweep splits large pools into its own jobs
+  _Graph.AddTask("Projectiles", [&]() { ioWorld.StepProjectiles(iStepTime, iSettings, tickPlayer, true); return 0; }, { broadphaseTask }, true);
+
+  for ( int i = 0; i < static_cast<int>(ioBoidSimulations.size()); ++i )
+  {
+    if ( ( i >= static_cast<int>(iBoidSettings.size()) ) || iBoidSettings[i]._Paused )
+      continue;
+
+    // Colliding flocks read the broadphase
+    const std::vector<int> dependencies = ( iBoidSettings[i]._CollideWithWorld ) ? ( std::vector<int>{ broadphaseTask } ) : ( std::vector<int>() );
+    _Graph.AddTask("Boids", [&, i]()
+    {
+      if ( 0 != ioBoidSimulations[i].Update(iStepTime, iBoidSettings[i]) )
+        return 1;
+      return ioWorld.ResolveBoidCollisions(ioBoidSimulations[i], iBoidSettings[i]);
+    }, dependencies);
+  }
+
+  return _Graph.Execute();
+}
+
+// ----------------------------------------------------------------------------
+// Capture
+// ----------------------------------------------------------------------------
+void FpsSimulation::Capture( const FpsGameWorld & iWorld, const std::vector<BoidSimulation> & iBoidSimulations, FpsSimulationState & oState ) const
+{
+  oState._Player = iWorld.GetPlayer();
+  oState._Projectiles = iWorld.GetProjectiles();
+  oState._Boids.resize(iBoidSimulations.size());
+  for ( int i = 0; i < static_cast<int>(iBoidSimulations.size()); ++i )
+    oState._Boids[i] = iBoidSimulations[i].GetBoids();
+}
+
+// ----------------------------------------------------------------------------
+// Matches
+// ----------------------------------------------------------------------------
+bool FpsSimulation::Matches( const FpsGameWorld & iWorld, const std::vector<BoidSimulation> & iBoidSimulations ) const
+{
+  if ( ( _Current._Projectiles.size() != iWorld.GetProjectiles().size() ) || ( _Current._Boids.size() != iBoidSimulations.size() ) )
+    return false;
+
+  for ( int i = 0; i < static_cast<int>(iBoidSimulations.size()); ++i )
+  {
+    if ( _Current._Boids[i].size() != iBoidSimulations[i].GetBoids().size() )
+      return false;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Interpolate
+// ----------------------------------------------------------------------------
+void FpsSimulation::Interpolate( const FpsGameWorld & iWorld )
+{
+  // Orientation comes straight from the world : look input is per frame, not per tick
+  _Display._Player = iWorld.GetPlayer();
+  _Display._Player._Position = glm::mix(_Previous._Player._Position, _Current._Player._Position, _Alpha);
+
+  _Display._Projectiles = _Current._Projectiles;
+  for ( int i = 0; i < static_cast<int>(_Display._Projectiles.size()); ++i )
+  {
+    const FpsProjectile & previous = _Previous._Projectiles[i];
+    const FpsProjectile & current = _Current._Projectiles[i];
+
+    // Skip slots that were (re)fired during the last tick
+    if ( previous._Active && current._Active && ( current._Age >= previous._Age ) )
+      _Display._Projectiles[i]._Position = glm::mix(previous._Position, current._Position, _Alpha);
+  }
+
+  _Display._Boids = _Current._Boids;
+  for ( int flock = 0; flock < static_cast<int>(_Display._Boids.size()); ++flock )
+  {
+    std::vector<BoidState> & boids = _Display._Boids[flock];
+    const std::vector<BoidState> & previous = _Previous._Boids[flock];
+    for ( int i = 0; i < static_cast<int>(boids.size()); ++i )
+    {
+      boids[i]._Position = glm::mix(previous[i]._Position, boids[i]._Position, _Alpha);
+      boids[i]._Velocity = glm::mix(previous[i]._Velocity, boids[i]._Velocity, _Alpha);
+    }
+  }
+}
+
+}
@@ -0,0 +1,89 @@
+#ifndef _FpsSimulation_
+#define _FpsSimulation_
+
+#include "Boids.h"
+#include "FpsGame.h"
+
+#include <functional>
+#include <vector>
+
+namespace RTRT
+{
+
+struct FpsSimulationState
+{
+  FpsPlayer                           _Player;
+  std::vector<FpsProjectile>          _Projectiles;
+  std::vector<std::vector<BoidState>> _Boids;
+};
+
+struct FpsSimulationTask
+{
+  const char *         _Name = "";
+  std::function<int()> _Run;
+  std::vector<int>     _Dependencies;
+  bool                 _SpawnsJobs = false; // Runs on the calling thread : a job must not wait on other jobs
+};
+
+// Tasks run in waves : every task whose dependencies are complete is dispatched on the JobSystem, then the wave is joined.
+class FpsSimulationGraph
+{
+public:
+  void Clear() { _Tasks.clear(); }
+  int AddTask( const char * iName, const std::function<int()> & iRun, const std::vector<int> & iDependencies = {}, bool iSpawnsJobs = false );
+  int Execute();
+
+  int GetNbTasks() const { return static_cast<int>(_Tasks.size()); }
+  int GetNbWaves() const { return _NbWaves; }
+
+protected:
+  std::vector<FpsSimulationTask> _Tasks;
+  std::vector<int>               _Results;
+  std::vector<int>               _Wave;
+  std::vector<bool>              _Done;
+  int                            _NbWaves = 0;
+};
+
+// Fixed-step scheduler for the FPS world and its boid flocks.
+// Ticks read the previous tick state for cross-system inputs and the display state is interpolated between the last two ticks.
+class FpsSimulation
+{
+public:
+  void Reset();
+  int Advance( float iFrameTime,
+               const FpsGameInput & iInput,
+               const FpsGameSettings & iSettings,
+               FpsGameWorld & ioWorld,
+               std::vector<BoidSimulation> & ioBoidSimulations,
+               const std::vector<BoidSettings> & iBoidSettings );
+
+  const FpsSimulationState & GetDisplayState() const { return _Display; }
+  float GetAlpha() const { return _Alpha; }
+  int GetLastNbSteps() const { return _LastNbSteps; }
+  int GetNbWaves() const { return _Graph.GetNbWaves(); }
+
+protected:
+  int Step( float iStepTime,
+            const FpsGameInput & iInput,
+            const FpsGameSettings & iSettings,
+            FpsGameWorld & ioWorld,
+            std::vector<BoidSimulation> & ioBoidSimulations,
+            const std::vector<BoidSettings> & iBoidSettings );
+  void Capture( const FpsGameWorld & iWorld, const std::vector<BoidSimulation> & iBoidSimulations, FpsSimulationState & oState ) const;
+  bool Matches( const FpsGameWorld & iWorld, const std::vector<BoidSimulation> & iBoidSimulations ) const;
+  void Interpolate( const FpsGameWorld & iWorld );
+
+protected:
+  FpsSimulationGraph _Graph;
+  FpsSimulationState _Previous;
+  FpsSimulationState _Current;
+  FpsSimulationState _Display;
+  float              _Accumulator = 0.f;
+  float              _Alpha = 1.f;
+  int                _LastNbSteps = 0;
+  bool               _HasState = false;
+};
+
+}
+
+#endif /* _FpsSimulation_ */
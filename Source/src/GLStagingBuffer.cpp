@@ -0,0 +1,157 @@
+#include "GLStagingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace RTRT
+{
+
+static const GLsizeiptr S_WriteAlignment = 16;
+static const GLuint64 S_FenceTimeout = 1000000000; // ns
+
+// ----------------------------------------------------------------------------
+// DTOR
+// ----------------------------------------------------------------------------
+GLStagingBuffer::~GLStagingBuffer()
+{
+  Release();
+}
+
+// ----------------------------------------------------------------------------
+// IsSupported
+// ----------------------------------------------------------------------------
+bool GLStagingBuffer::IsSupported()
+{
+  return ( GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage );
+}
+
+// ----------------------------------------------------------------------------
+// Initialize
+// ----------------------------------------------------------------------------
+bool GLStagingBuffer::Initialize( GLsizeiptr iSlotSize, int iNbSlots )
+{
+  Release();
+
+  if ( !IsSupported() || ( iSlotSize <= 0 ) || ( iNbSlots <= 0 ) )
+    return false;
+
+  _SlotSize = ( ( iSlotSize + S_WriteAlignment - 1 ) / S_WriteAlignment ) * S_WriteAlignment;
+  _Fences.assign(iNbSlots, nullptr);
+
+  const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glGenBuffers(1, &_Handle);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, _Handle);
+  glBufferStorage(GL_COPY_WRITE_BUFFER, _SlotSize * iNbSlots, nullptr, flags);
+  _Mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, _SlotSize * iNbSlots, flags));
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  if ( !_Mapped )
+  {
+    Release();
+    return false;
+  }
+
+  _Slot = 0;
+  _Cursor = _SlotSize; // Full until the first BeginFrame()
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Release
+// ----------------------------------------------------------------------------
+void GLStagingBuffer::Release()
+{
+  for ( GLsync & fence : _Fences )
+  {
+    if ( fence )
+      glDeleteSync(fence);
+    fence = nullptr;
+  }
+  _Fences.clear();
+
+  if ( _Handle )
+  {
+    if ( _Mapped )
+    {
+      glBindBuffer(GL_COPY_WRITE_BUFFER, _Handle);
+      glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &_Handle);
+  }
+
+  _Handle = 0;
+  _Mapped = nullptr;
+  _SlotSize = 0;
+  _Cursor = 0;
+}
+
+// ----------------------------------------------------------------------------
+// BeginFrame
+// Waits until the GPU consumed the copies issued the last time this slot was used
+// ----------------------------------------------------------------------------
+void GLStagingBuffer::BeginFrame()
+{
+  if ( !_Mapped )
+    return;
+
+  _Slot = ( _Slot + 1 ) % static_cast<int>(_Fences.size());
+  _Cursor = 0;
+
+  GLsync & fence = _Fences[_Slot];
+  if ( fence )
+  {
+    glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, S_FenceTimeout);
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Write
+// ----------------------------------------------------------------------------
+GLintptr GLStagingBuffer::Write( const void * iData, GLsizeiptr iSize )
+{
+  if ( !_Mapped || ( iSize <= 0 ) || ( _Cursor + iSize > _SlotSize ) )
+    return -1;
+
+  const GLintptr offset = _Slot * _SlotSize + _Cursor;
+  std::memcpy(_Mapped + offset, iData, iSize);
+  _Cursor = ( ( _Cursor + iSize + S_WriteAlignment - 1 ) / S_WriteAlignment ) * S_WriteAlignment;
+
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// EndFrame
+// ----------------------------------------------------------------------------
+void GLStagingBuffer::EndFrame()
+{
+  if ( !_Mapped )
+    return;
+
+  GLsync & fence = _Fences[_Slot];
+  if ( fence )
+    glDeleteSync(fence);
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+// ----------------------------------------------------------------------------
+// Coalesce
+// ----------------------------------------------------------------------------
+void GLStagingBuffer::Coalesce( std::vector<int> & ioIndices, int iMaxGap, std::vector<Vec2i> & oRanges )
+{
+  oRanges.clear();
+  std::sort(ioIndices.begin(), ioIndices.end());
+  ioIndices.erase(std::unique(ioIndices.begin(), ioIndices.end()), ioIndices.end());
+
+  for ( int index : ioIndices )
+  {
+    if ( !oRanges.empty() && ( index - ( oRanges.back().x + oRanges.back().y ) <= iMaxGap ) )
+      oRanges.back().y = index - oRanges.back().x + 1;
+    else
+      oRanges.emplace_back(index, 1);
+  }
+}
+
+}
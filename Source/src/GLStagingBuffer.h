@@ -0,0 +1,49 @@
+#ifndef _GLStagingBuffer_
+#define _GLStagingBuffer_
+
+#include "MathUtil.h"
+
+#include <vector>
+
+#include <GL/glew.h>
+
+namespace RTRT
+{
+
+// Persistently mapped upload ring (OpenGL 4.4 / ARB_buffer_storage).
+// Every frame writes into its own slot, a fence guards the slot until the GPU copies out of it.
+// Copies to the destination buffers and textures are issued by the caller from GetHandle() at the returned offsets.
+class GLStagingBuffer
+{
+public:
+  GLStagingBuffer() {}
+  ~GLStagingBuffer();
+
+  static bool IsSupported();
+
+  bool Initialize( GLsizeiptr iSlotSize, int iNbSlots = 3 );
+  void Release();
+
+  void BeginFrame();
+  GLintptr Write( const void * iData, GLsizeiptr iSize ); // -1 : no room left in the slot, upload directly
+  void EndFrame();
+
+  bool IsInitialized() const { return ( nullptr != _Mapped ); }
+  GLuint GetHandle() const { return _Handle; }
+  GLsizeiptr GetSlotSize() const { return _SlotSize; }
+
+  // Sorted element indices to [first, count] ranges, merging ranges closer than iMaxGap
+  static void Coalesce( std::vector<int> & ioIndices, int iMaxGap, std::vector<Vec2i> & oRanges );
+
+private:
+  GLuint              _Handle   = 0;
+  unsigned char     * _Mapped   = nullptr;
+  GLsizeiptr          _SlotSize = 0;
+  int                 _Slot     = 0;
+  GLsizeiptr          _Cursor   = 0;
+  std::vector<GLsync> _Fences;
+};
+
+}
+
+#endif /* _GLStagingBuffer_ */
@@ -17,6 +17,8 @@ namespace RTRT
 {
 
 using TLASNode = RadeonRays::Bvh::Node;
+
+static const float S_MaxRefitAreaGrowth = 2.f;
 #ifdef USE_TINYBVH
 using BLASNode = tinybvh::BVH::BVHNode;
 #else
@@ -50,6 +52,55 @@ void GpuTLAS::Clear()
   GpuBvh::Clear();
 
   _PackedMeshInstances.clear();
+  _PackedMeshInstanceIDs.clear();
+  _PackedBounds.clear();
+  _PackedIndices.clear();
+  _LeafNodes.clear();
+  _ParentNodes.clear();
+  _BuildArea = 0.f;
+}
+
+static bool IsTLASInstance( const std::vector<Mesh*> & iMeshes, const MeshInstance & iMeshInstance )
+{
+  if ( !iMeshInstance._Visible )
+    return false;
+  if ( ( iMeshInstance._MeshID < 0 ) || ( iMeshInstance._MeshID >= static_cast<int>(iMeshes.size()) ) )
+    return false;
+  return ( nullptr != iMeshes[iMeshInstance._MeshID] );
+}
+
+static AABB<Vec3> InstanceBounds( const Mesh & iMesh, const Mat4x4 & iTransform )
+{
+  AABB<Vec3> boundingBox = iMesh.GetBoundingBox();
+
+  Vec3 right, up, forward, pos;
+  MathUtil::Decompose(iTransform, right, up, forward, pos);
+
+  // Transformation de la bbox
+  Vec3 lowRight = right * boundingBox._Low.x;
+  Vec3 highRight = right * boundingBox._High.x;
+
+  Vec3 lowUp = up * boundingBox._Low.y;
+  Vec3 highUp = up * boundingBox._High.y;
+
+  Vec3 lowForward = forward * boundingBox._Low.z;
+  Vec3 highForward = forward * boundingBox._High.z;
+
+  AABB<Vec3> bounds;
+  bounds._Low  = MathUtil::Min(lowRight, highRight) + MathUtil::Min(lowUp, highUp) + MathUtil::Min(lowForward, highForward) + pos;
+  bounds._High = MathUtil::Max(lowRight, highRight) + MathUtil::Max(lowUp, highUp) + MathUtil::Max(lowForward, highForward) + pos;
+  return bounds;
+}
+
+static float NodesArea( const std::vector<GpuBvh::Node> & iNodes )
+{
+  float area = 0.f;
+  for ( const GpuBvh::Node & node : iNodes )
+  {
+    Vec3 extent = node._BBoxMax - node._BBoxMin;
+    area += extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+  }
+  return area;
 }
 
 int ProcessNodes( TLASNode * iNode, GpuTLAS * ioGpuTLAS )
@@ -84,54 +135,37 @@ int GpuTLAS::Build( std::vector<Mesh*> & iMeshes, std::vector<MeshInstance> & iM
   auto startTime = std::chrono::system_clock::now();
 
   std::vector<MeshInstance> visibleInstances;
+  std::vector<int> visibleInstanceIDs;
   visibleInstances.reserve(iMeshInstances.size());
-  for ( const MeshInstance & meshInstance : iMeshInstances )
+  visibleInstanceIDs.reserve(iMeshInstances.size());
+  for ( int instanceID = 0; instanceID < static_cast<int>(iMeshInstances.size()); ++instanceID )
   {
-    if ( !meshInstance._Visible )
-      continue;
-    if ( ( meshInstance._MeshID < 0 ) || ( meshInstance._MeshID >= static_cast<int>(iMeshes.size()) ) )
-      continue;
-    if ( !iMeshes[meshInstance._MeshID] )
+    const MeshInstance & meshInstance = iMeshInstances[instanceID];
+    if ( !IsTLASInstance(iMeshes, meshInstance) )
       continue;
 
-      visibleInstances.push_back(meshInstance);
+    visibleInstances.push_back(meshInstance);
+    visibleInstanceIDs.push_back(instanceID);
   }
 
   // 1. Compute BVH
   const int nbInstances = static_cast<int>(visibleInstances.size());
   if ( 0 == nbInstances )
   {
-    _Nodes.clear();
-    _PackedMeshInstances.clear();
+    Clear();
+    _PackedIndices.assign(iMeshInstances.size(), -1);
     return 0;
   }
 
+  std::vector<AABB<Vec3>> instanceBounds(nbInstances);
   std::vector<RadeonRays::bbox> bounds(nbInstances);
 
 //#pragma omp parallel for
   for ( int i = 0; i < nbInstances; ++i )
   {
-    Mesh * curMesh = iMeshes[visibleInstances[i]._MeshID];
-    if ( !curMesh )
-      return 1;
-
-    AABB<Vec3> boundingBox = curMesh -> GetBoundingBox();
-
-    Vec3 right, up, forward, pos;
-    MathUtil::Decompose(visibleInstances[i]._Transform, right, up, forward, pos);
-
-    // Transformation de la bbox
-    Vec3 lowRight = right * boundingBox._Low.x;
-    Vec3 highRight = right * boundingBox._High.x;
-
-    Vec3 lowUp = up * boundingBox._Low.y;
-    Vec3 highUp = up * boundingBox._High.y;
-
-    Vec3 lowForward = forward * boundingBox._Low.z;
-    Vec3 highForward = forward * boundingBox._High.z;
-
-    bounds[i].pmin = MathUtil::Min(lowRight, highRight) + MathUtil::Min(lowUp, highUp) + MathUtil::Min(lowForward, highForward) + pos;
-    bounds[i].pmax = MathUtil::Max(lowRight, highRight) + MathUtil::Max(lowUp, highUp) + MathUtil::Max(lowForward, highForward) + pos;
+    instanceBounds[i] = InstanceBounds(*iMeshes[visibleInstances[i]._MeshID], visibleInstances[i]._Transform);
+    bounds[i].pmin = instanceBounds[i]._Low;
+    bounds[i].pmax = instanceBounds[i]._High;
   }
 
   std::unique_ptr<RadeonRays::Bvh> bvh = std::make_unique<RadeonRays::Bvh>(10.0f, 64, false);
@@ -148,6 +182,12 @@ int GpuTLAS::Build( std::vector<Mesh*> & iMeshes, std::vector<MeshInstance> & iM
   size_t nbPackedInstance = bvh -> GetNumIndices();
   _PackedMeshInstances.clear();
   _PackedMeshInstances.reserve(nbPackedInstance);
+  _PackedMeshInstanceIDs.clear();
+  _PackedMeshInstanceIDs.reserve(nbPackedInstance);
+
+  _PackedBounds.clear();
+  _PackedBounds.reserve(nbPackedInstance);
+  _PackedIndices.assign(iMeshInstances.size(), -1);
 
   const int * PackedInstances = bvh -> GetIndices();
   if ( PackedInstances )
@@ -156,8 +196,31 @@ int GpuTLAS::Build( std::vector<Mesh*> & iMeshes, std::vector<MeshInstance> & iM
     {
       int instanceId = PackedInstances[i];
       _PackedMeshInstances.push_back(visibleInstances[instanceId]);
+      _PackedMeshInstanceIDs.push_back(visibleInstanceIDs[instanceId]);
+      _PackedBounds.push_back(instanceBounds[instanceId]);
+      _PackedIndices[visibleInstanceIDs[instanceId]] = i;
+    }
+  }
+
+  // 4. Links used by the refit
+  _LeafNodes.assign(nbPackedInstance, 0);
+  _ParentNodes.assign(_Nodes.size(), -1);
+  for ( int i = 0; i < static_cast<int>(_Nodes.size()); ++i )
+  {
+    const Vec3 & lcRcLeaf = _Nodes[i]._LcRcLeaf;
+    if ( lcRcLeaf.z < 0.f )
+    {
+      const int first = static_cast<int>(lcRcLeaf.x);
+      for ( int j = first; j < first + static_cast<int>(lcRcLeaf.y); ++j )
+        _LeafNodes[j] = i;
+    }
+    else
+    {
+      _ParentNodes[static_cast<int>(lcRcLeaf.x)] = i;
+      _ParentNodes[static_cast<int>(lcRcLeaf.y)] = i;
     }
   }
+  _BuildArea = NodesArea(_Nodes);
 
   auto endTime = std::chrono::system_clock::now();
   auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>( endTime - startTime ).count();
@@ -166,6 +229,73 @@ int GpuTLAS::Build( std::vector<Mesh*> & iMeshes, std::vector<MeshInstance> & iM
   return 0;
 }
 
+int GpuTLAS::Refit( std::vector<Mesh*> & iMeshes, std::vector<MeshInstance> & iMeshInstances, const std::vector<int> & iInstanceIDs,
+                    std::vector<int> & oNodeIDs, std::vector<int> & oPackedIDs )
+{
+  oNodeIDs.clear();
+  oPackedIDs.clear();
+
+  if ( _PackedIndices.size() != iMeshInstances.size() )
+    return 1;
+
+  std::vector<int> leaves;
+  for ( int instanceID : iInstanceIDs )
+  {
+    if ( ( instanceID < 0 ) || ( instanceID >= static_cast<int>(iMeshInstances.size()) ) )
+      return 1;
+
+    const MeshInstance & meshInstance = iMeshInstances[instanceID];
+    const int packedID = _PackedIndices[instanceID];
+    if ( IsTLASInstance(iMeshes, meshInstance) != ( packedID >= 0 ) )
+      return 1;
+    if ( packedID < 0 )
+      continue;
+
+    _PackedMeshInstances[packedID] = meshInstance;
+    _PackedBounds[packedID] = InstanceBounds(*iMeshes[meshInstance._MeshID], meshInstance._Transform);
+    oPackedIDs.push_back(packedID);
+    leaves.push_back(_LeafNodes[packedID]);
+  }
+
+  // Leaves from their instances, then the ancestors from their children, bottom-up
+  std::vector<bool> touched(_Nodes.size(), false);
+  for ( int leaf : leaves )
+  {
+    Node & leafNode = _Nodes[leaf];
+    const int first = static_cast<int>(leafNode._LcRcLeaf.x);
+    AABB<Vec3> bounds;
+    for ( int i = first; i < first + static_cast<int>(leafNode._LcRcLeaf.y); ++i )
+    {
+      bounds.Insert(_PackedBounds[i]._Low);
+      bounds.Insert(_PackedBounds[i]._High);
+    }
+    leafNode._BBoxMin = bounds._Low;
+    leafNode._BBoxMax = bounds._High;
+    touched[leaf] = true;
+
+    for ( int node = _ParentNodes[leaf]; node >= 0; node = _ParentNodes[node] )
+    {
+      const Node & left  = _Nodes[static_cast<int>(_Nodes[node]._LcRcLeaf.x)];
+      const Node & right = _Nodes[static_cast<int>(_Nodes[node]._LcRcLeaf.y)];
+      _Nodes[node]._BBoxMin = MathUtil::Min(left._BBoxMin, right._BBoxMin);
+      _Nodes[node]._BBoxMax = MathUtil::Max(left._BBoxMax, right._BBoxMax);
+      touched[node] = true;
+    }
+  }
+
+  for ( int i = 0; i < static_cast<int>(_Nodes.size()); ++i )
+  {
+    if ( touched[i] )
+      oNodeIDs.push_back(i);
+  }
+
+  // Instances moving apart inflate the refitted boxes : rebuild once the tree got much looser than when built
+  if ( !oNodeIDs.empty() && ( NodesArea(_Nodes) > S_MaxRefitAreaGrowth * _BuildArea ) )
+    return 1;
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // BLAS
 // ----------------------------------------------------------------------------
@@ -179,6 +309,7 @@ void GpuBLAS::Clear()
   GpuBvh::Clear();
 
   _PackedTriangleIdx.clear();
+  _PackedTriangleIDs.clear();
 }
 
 #ifdef USE_TINYBVH
@@ -276,6 +407,8 @@ int GpuBLAS::Build( Mesh & iMesh )
   size_t nbPackedTriangles = bvh.idxCount;
   _PackedTriangleIdx.clear();
   _PackedTriangleIdx.reserve( nbPackedTriangles * 3 );
+  _PackedTriangleIDs.clear();
+  _PackedTriangleIDs.reserve( nbPackedTriangles );
 
   if ( bvh.triIdx )
   {
@@ -289,6 +422,7 @@ int GpuBLAS::Build( Mesh & iMesh )
       _PackedTriangleIdx.push_back( indices1 );
       _PackedTriangleIdx.push_back( indices2 );
       _PackedTriangleIdx.push_back( indices3 );
+      _PackedTriangleIDs.push_back( static_cast<int>(triangleIdx) );
     }
   }
   else
@@ -322,6 +456,8 @@ int GpuBLAS::Build( Mesh & iMesh )
   size_t nbPackedTriangles = bvh -> GetNumIndices();
   _PackedTriangleIdx.clear();
   _PackedTriangleIdx.reserve(nbPackedTriangles * 3);
+  _PackedTriangleIDs.clear();
+  _PackedTriangleIDs.reserve(nbPackedTriangles);
 
   const int * TrianglesIdx = bvh -> GetIndices();
   if ( TrianglesIdx )
@@ -336,6 +472,7 @@ int GpuBLAS::Build( Mesh & iMesh )
       _PackedTriangleIdx.push_back(indices1);
       _PackedTriangleIdx.push_back(indices2);
       _PackedTriangleIdx.push_back(indices3);
+      _PackedTriangleIDs.push_back(triangleIdx);
     }
   }
   #endif
@@ -40,11 +40,25 @@ public:
 
   int Build( std::vector<Mesh*> & iMeshes , std::vector<MeshInstance> & iMeshInstances );
 
+  // Updates the changed instances and refits their leaves and ancestors, the tree topology is kept.
+  // Returns 1 when the TLAS must be rebuilt : visibility or instance count changed, or the refitted tree degraded too much.
+  int Refit( std::vector<Mesh*> & iMeshes, std::vector<MeshInstance> & iMeshInstances, const std::vector<int> & iInstanceIDs,
+             std::vector<int> & oNodeIDs, std::vector<int> & oPackedIDs );
+
   const std::vector<MeshInstance> & GetPackedMeshInstances() const { return _PackedMeshInstances; }
+  const std::vector<int> & GetPackedMeshInstanceIDs() const { return _PackedMeshInstanceIDs; } // Index in the source instance list
 
 private:
 
   std::vector<MeshInstance> _PackedMeshInstances;
+  std::vector<int>          _PackedMeshInstanceIDs;
+
+  // Refit data
+  std::vector<AABB<Vec3>>   _PackedBounds;
+  std::vector<int>          _PackedIndices; // Packed index of each source instance, -1 when not in the TLAS
+  std::vector<int>          _LeafNodes;     // Leaf node of each packed instance
+  std::vector<int>          _ParentNodes;   // -1 for the root
+  float                     _BuildArea = 0.f; // Sum of the node surface areas after the last build
 };
 
 class GpuBLAS : public GpuBvh
@@ -58,10 +72,12 @@ public:
   int Build( Mesh & iMesh );
 
   const std::vector<Vec3i> & GetPackedTriangleIdx() const { return _PackedTriangleIdx; }
+  const std::vector<int> & GetPackedTriangleIDs() const { return _PackedTriangleIDs; } // Mesh triangle index of each packed triangle
 
 private:
 
   std::vector<Vec3i> _PackedTriangleIdx;
+  std::vector<int>   _PackedTriangleIDs;
 };
 
 }
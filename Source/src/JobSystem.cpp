@@ -15,6 +15,7 @@ void JobSystem::Initialize( unsigned int iNbThreads )
 
   _NbThreads = iNbThreads;
   _Stop = false;
+  _Initialized = ( _NbThreads > 0 );
 
   _NbFinishedJobs.store(0);
 
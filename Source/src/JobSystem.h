@@ -30,6 +30,7 @@ public:
 
   void Execute( const std::function<void()> & iJob );
   unsigned int GetThreadCount() const { return _NbThreads; }
+  bool IsInitialized() const { return _Initialized; } // Wait() only makes progress once worker threads exist
 
 	bool IsBusy();
 
@@ -48,6 +49,7 @@ protected:
   static JobSystem                  _S_JobSystem; // Singleton
 
   unsigned int                      _NbThreads = 1;
+  bool                              _Initialized = false;
 
   std::queue<std::function<void()>> _Jobs;
   std::mutex                        _JobsMutex;
@@ -5,7 +5,9 @@
 #include "ShaderProgram.h"
 #include "GLUtil.h"
 #include "PathUtils.h"
+#include "AccumulationCheckpoint.h"
 
+#include <algorithm>
 #include <string>
 #include <iostream>
 
@@ -20,6 +22,26 @@ namespace fs = std::filesystem;
 namespace RTRT
 {
 
+// Bounces past the configured count left to the russian roulette by the wavefront loop
+static const int S_WavefrontExtraBounces = 8;
+static const int S_WavefrontMaxBounces   = 128; // MaxPathSegments of the shaders
+
+// Queue shader stages (see compute_WavefrontQueue.glsl)
+static const int S_QueueReset       = 0;
+static const int S_QueueBeginBounce = 1;
+static const int S_QueueScanBuckets = 2;
+static const int S_QueueSort        = 3;
+static const int S_QueueShadow      = 4;
+
+// Offsets of the indirect dispatch arguments in the counters buffer
+static const GLintptr S_ExtendArgsOffset = 0;
+static const GLintptr S_ShadeArgsOffset  = 16;
+static const GLintptr S_ShadowArgsOffset = 32;
+static const GLsizeiptr S_CountersSize   = 64;
+
+// Incremental TLAS upload
+static const int S_TLASRangeMaxGap = 4; // Clean elements uploaded to merge two dirty ranges
+
 // ----------------------------------------------------------------------------
 // METHODS
 // ----------------------------------------------------------------------------
@@ -43,6 +65,12 @@ PathTracer::~PathTracer()
   GLUtil::DeleteFBO(_RenderTargetTileFBO);
   GLUtil::DeleteFBO(_AccumulateFBO);
   GLUtil::DeleteFBO(_DenoiseFBO);
+  for ( int i = 0; i < 2; ++i )
+  {
+    GLUtil::DeleteFBO(_SVGFHistoryFBO[i]);
+    GLUtil::DeleteFBO(_AtrousFBO[i]);
+  }
+  this -> ReleaseTileErrors();
 
   UnloadScene( true );
 }
@@ -88,14 +116,15 @@ int PathTracer::Update()
   {
     this -> ResetTiles();
     _NbCompleteFrames = 0;
+    _NbRenderedFrames = 0;
   }
-  else if ( TiledRendering() )
-    this -> NextTile();
 
   if ( _DirtyStates & (unsigned long)DirtyState::RenderSettings )
     this -> ResizeRenderTarget();
 
-  if ( _DirtyStates & (unsigned long)DirtyState::SceneInstances )
+  // The TLAS is only rebuilt when the scene flagged a mesh instance change since the last upload
+  if ( ( _DirtyStates & (unsigned long)DirtyState::SceneInstances )
+    && ( _Scene.GetMeshInstanceGeneration() != _SyncedMeshInstanceGeneration ) )
   {
     if ( 0 != this -> ReloadSceneInstances() )
       return 1;
@@ -118,6 +147,7 @@ int PathTracer::Update()
 int PathTracer::Done()
 {
   _FrameNum++;
+  _NbRenderedFrames++;
 
   if ( !Dirty() && !TiledRendering() )
     _NbCompleteFrames++;
@@ -143,6 +173,12 @@ int PathTracer::InitializeStats()
   _DenoiseTimerWritten = false;
   _RenderToScreenTimerWritten = false;
 
+  for ( int i = 0; i < WavefrontStageCount; ++i )
+  {
+    _WavefrontTime[i] = 0.;
+    _NbWavefrontTimers[i] = 0;
+  }
+
   glGenQueries( 1, &_PathTraceTimeId[0] );
   glGenQueries( 1, &_PathTraceTimeId[1] );
   glGenQueries( 1, &_AccumulateTimeId[0] );
@@ -164,6 +200,9 @@ int PathTracer::UpdateStats()
   {
     _PathTraceTime = ReadTimer(_PathTraceTimeId);
     _PathTraceTimerWritten = false;
+
+    if ( !_RenderedTiles.empty() )
+      _TileScheduler.RecordFrameTime((int)_RenderedTiles.size(), _PathTraceTime);
   }
   else
     _PathTraceTime = 0.;
@@ -192,6 +231,14 @@ int PathTracer::UpdateStats()
   else
     _RenderToScreenTime = 0.;
 
+  for ( int i = 0; i < WavefrontStageCount; ++i )
+  {
+    _WavefrontTime[i] = 0.;
+    for ( int j = 0; j < _NbWavefrontTimers[i]; ++j )
+      _WavefrontTime[i] += ReadTimer(&_WavefrontTimeIds[i][2 * j]);
+    _NbWavefrontTimers[i] = 0;
+  }
+
   return 0;
 }
 
@@ -202,7 +249,12 @@ int PathTracer::GetRenderPassTimings( std::vector<RenderPassTiming> & oTimings )
 {
   oTimings.clear();
   oTimings.push_back({ "Path trace", _PathTraceTime, true, true });
-  oTimings.push_back({ "Accumulate", _AccumulateTime, true, true });
+  oTimings.push_back({ "Wavefront generate", _WavefrontTime[WavefrontGenerate], true, _WavefrontThisFrame, true });
+  oTimings.push_back({ "Wavefront extend", _WavefrontTime[WavefrontExtend], true, _WavefrontThisFrame, true });
+  oTimings.push_back({ "Wavefront material sort", _WavefrontTime[WavefrontSort], true, _WavefrontThisFrame, true });
+  oTimings.push_back({ "Wavefront shade", _WavefrontTime[WavefrontShade], true, _WavefrontThisFrame, true });
+  oTimings.push_back({ "Wavefront shadow rays", _WavefrontTime[WavefrontShadow], true, _WavefrontThisFrame, true });
+  oTimings.push_back({ "Accumulate", _AccumulateTime, true, _RenderedTiles.empty() }); // Tiles : within the path trace timer
   oTimings.push_back({ "Denoise", _DenoiseTime, true, _DenoisedThisFrame });
   oTimings.push_back({ "Composite / screen", _RenderToScreenTime, true, true });
   return 0;
@@ -266,51 +318,115 @@ double PathTracer::ReadTimer( GLuint iTimerId[2] )
   return (double)executionTime / 1000000000.;
 }
 
+// ----------------------------------------------------------------------------
+// BeginWavefrontTimer
+// ----------------------------------------------------------------------------
+void PathTracer::BeginWavefrontTimer( int iStage )
+{
+  std::vector<GLuint> & timerIds = _WavefrontTimeIds[iStage];
+  const int timer = _NbWavefrontTimers[iStage];
+  if ( static_cast<int>(timerIds.size()) < 2 * ( timer + 1 ) )
+  {
+    timerIds.resize(2 * ( timer + 1 ), 0);
+    glGenQueries( 2, &timerIds[2 * timer] );
+  }
+
+  BeginTimer(&timerIds[2 * timer]);
+}
+
+// ----------------------------------------------------------------------------
+// EndWavefrontTimer
+// ----------------------------------------------------------------------------
+void PathTracer::EndWavefrontTimer( int iStage )
+{
+  EndTimer(&_WavefrontTimeIds[iStage][2 * _NbWavefrontTimers[iStage]]);
+  _NbWavefrontTimers[iStage]++;
+}
+
 // ----------------------------------------------------------------------------
 // UpdatePathTraceUniforms
 // ----------------------------------------------------------------------------
 int PathTracer::UpdatePathTraceUniforms()
 {
-  _PathTraceShader -> Use();
+  this -> UpdatePathTraceUniforms(*_PathTraceShader);
+
+  // Every wavefront stage shares the path tracing uniforms
+  if ( _WavefrontSupported )
+  {
+    this -> UpdatePathTraceUniforms(*_WavefrontGenerateShader);
+    this -> UpdatePathTraceUniforms(*_WavefrontExtendShader);
+    this -> UpdatePathTraceUniforms(*_WavefrontQueueShader);
+    this -> UpdatePathTraceUniforms(*_WavefrontShadeShader);
+    this -> UpdatePathTraceUniforms(*_WavefrontShadowShader);
+    this -> UpdatePathTraceUniforms(*_WavefrontResolveShader);
+  }
 
-  _PathTraceShader -> SetUniform("u_Resolution", (float)RenderWidth(), (float)RenderHeight());
-  _PathTraceShader -> SetUniform("u_TiledRendering", ( TiledRendering() && !Dirty() ) ? ( 1 ) : ( 0 ));
-  _PathTraceShader -> SetUniform("u_TileOffset", TileOffset());
-  _PathTraceShader -> SetUniform("u_InvNbTiles", InvNbTiles());
-  _PathTraceShader -> SetUniform("u_Time", (float)glfwGetTime());
-  _PathTraceShader -> SetUniform("u_FrameNum", (int)_FrameNum);
-  _PathTraceShader -> SetUniform("u_NbCompleteFrames", (int)_NbCompleteFrames);
+  if ( _DirtyStates & (unsigned long)DirtyState::SceneMaterials )
+  {
+    GLTextureDesc materialsDesc;
+    materialsDesc._Target         = _MaterialsTEX._Target;
+    materialsDesc._Slot           = _MaterialsTEX._Slot;
+    materialsDesc._Width          = static_cast<GLsizei>((sizeof(Material) / sizeof(Vec4)) * _Scene.GetMaterials().size());
+    materialsDesc._Height         = 1;
+    materialsDesc._InternalFormat = _MaterialsTEX._InternalFormat;
+    materialsDesc._DataFormat     = _MaterialsTEX._DataFormat;
+    materialsDesc._DataType       = _MaterialsTEX._DataType;
+    materialsDesc._Data           = &_Scene.GetMaterials()[0];
+    materialsDesc._MinFilter      = GL_NEAREST;
+    materialsDesc._MagFilter      = GL_NEAREST;
+    GLUtil::CreateTexture(materialsDesc, _MaterialsTEX);
+  }
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// UpdatePathTraceUniforms
+// ----------------------------------------------------------------------------
+int PathTracer::UpdatePathTraceUniforms( ShaderProgram & ioShader )
+{
+  ioShader.Use();
+
+  ioShader.SetUniform("u_Resolution", (float)RenderWidth(), (float)RenderHeight());
+  ioShader.SetUniform("u_TiledRendering", ( TiledRendering() && !Dirty() ) ? ( 1 ) : ( 0 ));
+  ioShader.SetUniform("u_TileOffset", TileOffset());
+  ioShader.SetUniform("u_InvNbTiles", InvNbTiles());
+  ioShader.SetUniform("u_Time", (float)glfwGetTime());
+  ioShader.SetUniform("u_FrameNum", (int)RNGFrameIndex());
+  ioShader.SetUniform("u_NbCompleteFrames", (int)_NbCompleteFrames);
+  ioShader.SetUniform("u_AdaptiveSampling", AdaptiveSampling() ? ( 1 ) : ( 0 ));
 
   if ( _DirtyStates & (unsigned long)DirtyState::RenderSettings )
   {
-    _PathTraceShader -> SetUniform("u_NbBounces", _Settings._Bounces);
-    _PathTraceShader -> SetUniform("u_NbSamplesPerPixel", _Settings._NbSamplesPerPixel);
-    _PathTraceShader -> SetUniform("u_RussianRoulette", (int)_Settings._RussianRoulette);
-    _PathTraceShader -> SetUniform("u_BackgroundColor", _Settings._BackgroundColor);
-    _PathTraceShader -> SetUniform("u_EnableEnvMap", (int)_Settings._EnableSkybox);
-    _PathTraceShader -> SetUniform("u_EnableBackground" , (int)_Settings._EnableBackGround);
-    _PathTraceShader -> SetUniform("u_EnvMapRotation", _Settings._SkyBoxRotation / 360.f);
-    _PathTraceShader -> SetUniform("u_EnvMapRes", (float)_Scene.GetEnvMap().GetWidth(), (float)_Scene.GetEnvMap().GetHeight());
-    _PathTraceShader -> SetUniform("u_EnvMap", (int)PathTracerTexSlot::_EnvMap);
-    _PathTraceShader -> SetUniform("u_EnvMapCDF", (int)PathTracerTexSlot::_EnvMapCDF);
-    _PathTraceShader -> SetUniform("u_EnvMapTotalWeight", _Scene.GetEnvMap().GetTotalWeight());
-    _PathTraceShader -> SetUniform("u_Gamma", _Settings._Gamma);
-    _PathTraceShader -> SetUniform("u_Exposure", _Settings._Exposure);
-    _PathTraceShader -> SetUniform("u_ToneMapping", ( _Settings._ToneMapping ? 1 : 0 ));
-    //_PathTraceShader -> SetUniform("u_ToneMapping", 0);
-    _PathTraceShader -> SetUniform("u_DebugMode" , _DebugMode );
+    ioShader.SetUniform("u_SampleMoments", (int)PathTracerTexSlot::_AccumulateMoments);
+    ioShader.SetUniform("u_NbBounces", _Settings._Bounces);
+    ioShader.SetUniform("u_NbSamplesPerPixel", _Settings._NbSamplesPerPixel);
+    ioShader.SetUniform("u_RussianRoulette", (int)_Settings._RussianRoulette);
+    ioShader.SetUniform("u_BackgroundColor", _Settings._BackgroundColor);
+    ioShader.SetUniform("u_EnableEnvMap", (int)_Settings._EnableSkybox);
+    ioShader.SetUniform("u_EnableBackground" , (int)_Settings._EnableBackGround);
+    ioShader.SetUniform("u_EnvMapRotation", _Settings._SkyBoxRotation / 360.f);
+    ioShader.SetUniform("u_EnvMapRes", (float)_Scene.GetEnvMap().GetWidth(), (float)_Scene.GetEnvMap().GetHeight());
+    ioShader.SetUniform("u_EnvMap", (int)PathTracerTexSlot::_EnvMap);
+    ioShader.SetUniform("u_EnvMapAlias", (int)PathTracerTexSlot::_EnvMapAlias);
+    ioShader.SetUniform("u_EnvMapTotalWeight", _Scene.GetEnvMap().GetTotalWeight());
+    ioShader.SetUniform("u_Gamma", _Settings._Gamma);
+    ioShader.SetUniform("u_Exposure", _Settings._Exposure);
+    ioShader.SetUniform("u_ToneMapping", ( _Settings._ToneMapping ? 1 : 0 ));
+    //ioShader.SetUniform("u_ToneMapping", 0);
+    ioShader.SetUniform("u_DebugMode" , _DebugMode );
   }
 
   if ( _DirtyStates & (unsigned long)DirtyState::SceneCamera )
   {
     Camera & cam = _Scene.GetCamera();
-    _PathTraceShader -> SetUniform("u_Camera._Up", cam.GetUp());
-    _PathTraceShader -> SetUniform("u_Camera._Right", cam.GetRight());
-    _PathTraceShader -> SetUniform("u_Camera._Forward", cam.GetForward());
-    _PathTraceShader -> SetUniform("u_Camera._Pos", cam.GetPos());
-    _PathTraceShader -> SetUniform("u_Camera._FOV", cam.GetFOV());
-    _PathTraceShader -> SetUniform("u_Camera._FocalDist", cam.GetFocalDist());
-    _PathTraceShader -> SetUniform("u_Camera._LensRadius", cam.GetAperture() * .5f);
+    ioShader.SetUniform("u_Camera._Up", cam.GetUp());
+    ioShader.SetUniform("u_Camera._Right", cam.GetRight());
+    ioShader.SetUniform("u_Camera._Forward", cam.GetForward());
+    ioShader.SetUniform("u_Camera._Pos", cam.GetPos());
+    ioShader.SetUniform("u_Camera._FOV", cam.GetFOV());
+    ioShader.SetUniform("u_Camera._FocalDist", cam.GetFocalDist());
+    ioShader.SetUniform("u_Camera._LensRadius", cam.GetAperture() * .5f);
   }
 
   if ( _DirtyStates & (unsigned long)DirtyState::SceneLights )
@@ -323,37 +439,21 @@ int PathTracer::UpdatePathTraceUniforms()
       if ( !curLight )
         continue;
 
-      _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Pos"     ), curLight -> _Pos);
-      _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Emission"), curLight -> _Emission * curLight -> _Intensity);
-      _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_DirU"    ), curLight -> _DirU);
-      _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_DirV"    ), curLight -> _DirV);
-      _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Radius"  ), curLight -> _Radius);
-      _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Area"    ), curLight -> _Area);
-      _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Type"    ), curLight -> _Type);
+      ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Pos"     ), curLight -> _Pos);
+      ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Emission"), curLight -> _Emission * curLight -> _Intensity);
+      ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_DirU"    ), curLight -> _DirU);
+      ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_DirV"    ), curLight -> _DirV);
+      ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Radius"  ), curLight -> _Radius);
+      ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Area"    ), curLight -> _Area);
+      ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Lights",i,"_Type"    ), curLight -> _Type);
 
       nbLights++;
       if ( nbLights >= 32 )
         break;
     }
 
-    _PathTraceShader -> SetUniform("u_NbLights", nbLights);
-    _PathTraceShader -> SetUniform("u_ShowLights", (int)_Settings._ShowLights);
-  }
-
-  if ( _DirtyStates & (unsigned long)DirtyState::SceneMaterials )
-  {
-    GLTextureDesc materialsDesc;
-    materialsDesc._Target         = _MaterialsTEX._Target;
-    materialsDesc._Slot           = _MaterialsTEX._Slot;
-    materialsDesc._Width          = static_cast<GLsizei>((sizeof(Material) / sizeof(Vec4)) * _Scene.GetMaterials().size());
-    materialsDesc._Height         = 1;
-    materialsDesc._InternalFormat = _MaterialsTEX._InternalFormat;
-    materialsDesc._DataFormat     = _MaterialsTEX._DataFormat;
-    materialsDesc._DataType       = _MaterialsTEX._DataType;
-    materialsDesc._Data           = &_Scene.GetMaterials()[0];
-    materialsDesc._MinFilter      = GL_NEAREST;
-    materialsDesc._MagFilter      = GL_NEAREST;
-    GLUtil::CreateTexture(materialsDesc, _MaterialsTEX);
+    ioShader.SetUniform("u_NbLights", nbLights);
+    ioShader.SetUniform("u_ShowLights", (int)_Settings._ShowLights);
   }
 
   if ( _DirtyStates & (unsigned long)DirtyState::SceneInstances )
@@ -379,8 +479,8 @@ int PathTracer::UpdatePathTraceUniforms()
         Vec4 CenterRad = prim._Transform * Vec4(0.f, 0.f, 0.f, 1.f);
         CenterRad.w = curSphere -> _Radius;
 
-        _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Spheres",nbSpheres,"_MaterialID"), prim._MaterialID);
-        _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Spheres",nbSpheres,"_CenterRad"), CenterRad);
+        ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Spheres",nbSpheres,"_MaterialID"), prim._MaterialID);
+        ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Spheres",nbSpheres,"_CenterRad"), CenterRad);
         nbSpheres++;
       }
       else if ( curPrimitive -> _Type == PrimitiveType::Plane )
@@ -389,51 +489,51 @@ int PathTracer::UpdatePathTraceUniforms()
         Vec4 orig = prim._Transform * Vec4(curPlane -> _Origin.x, curPlane -> _Origin.y, curPlane -> _Origin.z, 1.f);
         Vec4 normal = glm::transpose(glm::inverse(prim._Transform)) * Vec4(curPlane -> _Normal.x, curPlane -> _Normal.y, curPlane -> _Normal.z, 1.f);
 
-       _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Planes",nbPlanes,"_MaterialID"), prim._MaterialID);
-       _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Planes",nbPlanes,"_Orig"), orig.x, orig.y, orig.z);
-       _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Planes",nbPlanes,"_Normal"), normal.x, normal.y, normal.z);
+       ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Planes",nbPlanes,"_MaterialID"), prim._MaterialID);
+       ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Planes",nbPlanes,"_Orig"), orig.x, orig.y, orig.z);
+       ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Planes",nbPlanes,"_Normal"), normal.x, normal.y, normal.z);
         nbPlanes++;
       }
       else if ( curPrimitive -> _Type == PrimitiveType::Box )
       {
         Box * curBox = (Box *) curPrimitive;
 
-        _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Boxes",nbBoxes,"_MaterialID"), prim._MaterialID);
-        _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Boxes",nbBoxes,"_Low"), curBox -> _Low);
-        _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Boxes",nbBoxes,"_High"), curBox -> _High);
-        _PathTraceShader -> SetUniform(GLUtil::UniformArrayElementName("u_Boxes",nbBoxes,"_Transfom"), prim._Transform);
+        ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Boxes",nbBoxes,"_MaterialID"), prim._MaterialID);
+        ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Boxes",nbBoxes,"_Low"), curBox -> _Low);
+        ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Boxes",nbBoxes,"_High"), curBox -> _High);
+        ioShader.SetUniform(GLUtil::UniformArrayElementName("u_Boxes",nbBoxes,"_Transfom"), prim._Transform);
         nbBoxes++;
       }
     }
 
-    _PathTraceShader -> SetUniform("u_VtxTexture",                    (int)PathTracerTexSlot::_Vertices);
-    _PathTraceShader -> SetUniform("u_VtxNormTexture",                (int)PathTracerTexSlot::_Normals);
-    _PathTraceShader -> SetUniform("u_VtxUVTexture",                  (int)PathTracerTexSlot::_UVs);
-    _PathTraceShader -> SetUniform("u_VtxIndTexture",                 (int)PathTracerTexSlot::_VertInd);
-    _PathTraceShader -> SetUniform("u_TexIndTexture",                 (int)PathTracerTexSlot::_TexInd);
-    _PathTraceShader -> SetUniform("u_TexArrayTexture",               (int)PathTracerTexSlot::_TexArray);
-    _PathTraceShader -> SetUniform("u_MeshBBoxTexture",               (int)PathTracerTexSlot::_MeshBBox);
-    _PathTraceShader -> SetUniform("u_MeshIDRangeTexture",            (int)PathTracerTexSlot::_MeshIdRange);
-    _PathTraceShader -> SetUniform("u_MaterialsTexture",              (int)PathTracerTexSlot::_Materials);
-    _PathTraceShader -> SetUniform("u_TLASNodesTexture",              (int)PathTracerTexSlot::_TLASNodes);
-    _PathTraceShader -> SetUniform("u_TLASTransformsTexture",         (int)PathTracerTexSlot::_TLASTransformsID);
-    _PathTraceShader -> SetUniform("u_TLASMeshMatIDTexture",          (int)PathTracerTexSlot::_TLASMeshMatID);
-    _PathTraceShader -> SetUniform("u_BLASNodesTexture",              (int)PathTracerTexSlot::_BLASNodes);
-    _PathTraceShader -> SetUniform("u_BLASNodesRangeTexture",         (int)PathTracerTexSlot::_BLASNodesRange);
-    _PathTraceShader -> SetUniform("u_BLASPackedIndicesTexture",      (int)PathTracerTexSlot::_BLASPackedIndices);
-    _PathTraceShader -> SetUniform("u_BLASPackedIndicesRangeTexture", (int)PathTracerTexSlot::_BLASPackedIndicesRange);
-    _PathTraceShader -> SetUniform("u_BLASPackedVtxTexture",          (int)PathTracerTexSlot::_BLASPackedVertices);
-    _PathTraceShader -> SetUniform("u_BLASPackedNormTexture",         (int)PathTracerTexSlot::_BLASPackedNormals);
-    _PathTraceShader -> SetUniform("u_BLASPackedUVTexture",           (int)PathTracerTexSlot::_BLASPackedUVs);
-
-    _PathTraceShader -> SetUniform("u_NbSpheres", nbSpheres);
-    _PathTraceShader -> SetUniform("u_NbPlanes", nbPlanes);
-    _PathTraceShader -> SetUniform("u_NbBoxes", nbBoxes);
-    _PathTraceShader -> SetUniform("u_NbTriangles", _NbTriangles);
-    _PathTraceShader -> SetUniform("u_NbMeshInstances", _NbMeshInstances);
-  }
-
-  _PathTraceShader -> StopUsing();
+    ioShader.SetUniform("u_VtxTexture",                    (int)PathTracerTexSlot::_Vertices);
+    ioShader.SetUniform("u_VtxNormTexture",                (int)PathTracerTexSlot::_Normals);
+    ioShader.SetUniform("u_VtxUVTexture",                  (int)PathTracerTexSlot::_UVs);
+    ioShader.SetUniform("u_VtxIndTexture",                 (int)PathTracerTexSlot::_VertInd);
+    ioShader.SetUniform("u_TexIndTexture",                 (int)PathTracerTexSlot::_TexInd);
+    ioShader.SetUniform("u_TexArrayTexture",               (int)PathTracerTexSlot::_TexArray);
+    ioShader.SetUniform("u_MeshBBoxTexture",               (int)PathTracerTexSlot::_MeshBBox);
+    ioShader.SetUniform("u_MeshIDRangeTexture",            (int)PathTracerTexSlot::_MeshIdRange);
+    ioShader.SetUniform("u_MaterialsTexture",              (int)PathTracerTexSlot::_Materials);
+    ioShader.SetUniform("u_TLASNodesTexture",              (int)PathTracerTexSlot::_TLASNodes);
+    ioShader.SetUniform("u_TLASTransformsTexture",         (int)PathTracerTexSlot::_TLASTransformsID);
+    ioShader.SetUniform("u_TLASMeshMatIDTexture",          (int)PathTracerTexSlot::_TLASMeshMatID);
+    ioShader.SetUniform("u_BLASNodesTexture",              (int)PathTracerTexSlot::_BLASNodes);
+    ioShader.SetUniform("u_BLASNodesRangeTexture",         (int)PathTracerTexSlot::_BLASNodesRange);
+    ioShader.SetUniform("u_BLASPackedIndicesTexture",      (int)PathTracerTexSlot::_BLASPackedIndices);
+    ioShader.SetUniform("u_BLASPackedIndicesRangeTexture", (int)PathTracerTexSlot::_BLASPackedIndicesRange);
+    ioShader.SetUniform("u_BLASPackedVtxTexture",          (int)PathTracerTexSlot::_BLASPackedVertices);
+    ioShader.SetUniform("u_BLASPackedNormTexture",         (int)PathTracerTexSlot::_BLASPackedNormals);
+    ioShader.SetUniform("u_BLASPackedUVTexture",           (int)PathTracerTexSlot::_BLASPackedUVs);
+
+    ioShader.SetUniform("u_NbSpheres", nbSpheres);
+    ioShader.SetUniform("u_NbPlanes", nbPlanes);
+    ioShader.SetUniform("u_NbBoxes", nbBoxes);
+    ioShader.SetUniform("u_NbTriangles", _NbTriangles);
+    ioShader.SetUniform("u_NbMeshInstances", _NbMeshInstances);
+  }
+
+  ioShader.StopUsing();
 
   return 0;
 }
@@ -465,12 +565,15 @@ int PathTracer::BindPathTraceTextures()
   GLUtil::ActivateTexture(_MaterialsTEX);
   GLUtil::ActivateTexture(_TLASTransformsIDTEX);
   GLUtil::ActivateTexture(_EnvMapTEX);
-  GLUtil::ActivateTexture(_EnvMapCDFTEX);
+  GLUtil::ActivateTexture(_EnvMapAliasTEX);
 
   GLUtil::ActivateTextures(_RenderTargetLowResFBO);
   GLUtil::ActivateTextures(_RenderTargetTileFBO);
   GLUtil::ActivateTextures(_RenderTargetFBO);
 
+  if ( AdaptiveSampling() )
+    GLUtil::ActivateTexture(_AccumulateMomentsTEX);
+
   return 0;
 }
 
@@ -505,6 +608,9 @@ int PathTracer::UpdateAccumulateUniforms()
   _AccumulateShader -> Use();
 
   _AccumulateShader -> SetUniform("u_PreviousFrame", (int)PathTracerTexSlot::_Accumulate);
+  _AccumulateShader -> SetUniform("u_PreviousNormals", (int)PathTracerTexSlot::_AccumulateNormals);
+  _AccumulateShader -> SetUniform("u_PreviousPos", (int)PathTracerTexSlot::_AccumulatePos);
+  _AccumulateShader -> SetUniform("u_PreviousMoments", (int)PathTracerTexSlot::_AccumulateMoments);
 
   if ( LowResPass() )
     _AccumulateShader -> SetUniform("u_NewFrame", (int)PathTracerTexSlot::_RenderTargetLowRes);
@@ -527,6 +633,10 @@ int PathTracer::UpdateAccumulateUniforms()
   _AccumulateShader -> SetUniform("u_TileOffset", TileOffset());
   _AccumulateShader -> SetUniform("u_InvNbTiles", InvNbTiles());
 
+  _AccumulateShader -> SetUniform("u_AdaptiveSampling", AdaptiveSampling() ? ( 1 ) : ( 0 ));
+  _AccumulateShader -> SetUniform("u_AdaptiveMinFrames", std::max(1, _Settings._AdaptiveMinFrames));
+  _AccumulateShader -> SetUniform("u_ConvergenceThreshold", _Settings._ConvergenceThreshold);
+
   _AccumulateShader -> SetUniform("u_DebugMode" , _DebugMode );
 
   _AccumulateShader -> StopUsing();
@@ -540,29 +650,57 @@ int PathTracer::UpdateAccumulateUniforms()
 int PathTracer::RenderToTexture()
 {
   _DenoisedThisFrame = false;
+  _WavefrontThisFrame = false;
+  _RenderedTiles.clear();
+
+  if ( TiledRendering() && !Dirty() )
+  {
+    this -> RenderTiles();
+
+    if ( Denoise() )
+      _DenoisedThisFrame = ( 0 == this -> DenoiseOutput() );
+
+    return 0;
+  }
 
   // Path trace
   BeginTimer(_PathTraceTimeId);
 
-  if ( LowResPass() )
-  {
-    glBindFramebuffer(GL_FRAMEBUFFER, _RenderTargetLowResFBO._Handle);
-    glViewport(0, 0, LowResRenderWidth(), LowResRenderHeight());
-  }
-  else if ( TiledRendering() )
+  if ( Wavefront() )
   {
-    glBindFramebuffer(GL_FRAMEBUFFER, _RenderTargetTileFBO._Handle);
-    glViewport(0, 0, TileWidth(), TileHeight());
+    this -> BindPathTraceTextures();
+
+    if ( LowResPass() )
+      this -> PathTraceWavefront(_RenderTargetLowResTEX, nullptr, nullptr, LowResRenderWidth(), LowResRenderHeight());
+    else if ( TiledRendering() )
+      this -> PathTraceWavefront(_RenderTargetTileTEX[0], &_RenderTargetTileTEX[1], &_RenderTargetTileTEX[2], TileWidth(), TileHeight());
+    else
+      this -> PathTraceWavefront(_RenderTargetTEX[0], &_RenderTargetTEX[1], &_RenderTargetTEX[2], RenderWidth(), RenderHeight());
+
+    _WavefrontThisFrame = true;
   }
   else
   {
-    glBindFramebuffer(GL_FRAMEBUFFER, _RenderTargetFBO._Handle);
-    glViewport(0, 0, RenderWidth(), RenderHeight());
-  }
+    if ( LowResPass() )
+    {
+      glBindFramebuffer(GL_FRAMEBUFFER, _RenderTargetLowResFBO._Handle);
+      glViewport(0, 0, LowResRenderWidth(), LowResRenderHeight());
+    }
+    else if ( TiledRendering() )
+    {
+      glBindFramebuffer(GL_FRAMEBUFFER, _RenderTargetTileFBO._Handle);
+      glViewport(0, 0, TileWidth(), TileHeight());
+    }
+    else
+    {
+      glBindFramebuffer(GL_FRAMEBUFFER, _RenderTargetFBO._Handle);
+      glViewport(0, 0, RenderWidth(), RenderHeight());
+    }
 
-  this -> BindPathTraceTextures();
+    this -> BindPathTraceTextures();
 
-  _Quad.Render(*_PathTraceShader);
+    _Quad.Render(*_PathTraceShader);
+  }
 
   EndTimer(_PathTraceTimeId);
   _PathTraceTimerWritten = true;
@@ -584,45 +722,469 @@ int PathTracer::RenderToTexture()
   _AccumulateTimerWritten = true;
 
   // Denoise
+  if ( !TemporalDenoise() )
+    _SVGFHistoryValid = false;
   if ( Denoise() )
     _DenoisedThisFrame = ( 0 == this -> DenoiseOutput() );
 
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// RenderTiles
+// Path traces and accumulates the tiles picked by the scheduler, as many as the frame budget allows
+// ----------------------------------------------------------------------------
+int PathTracer::RenderTiles()
+{
+  if ( _TileScheduler.GetNbTiles() != NbTiles() )
+    this -> ResetTiles();
+
+  const TileScheduler::Order order = ( _Settings._PrioritizedTiles ) ? ( TileScheduler::Order::Prioritized ) : ( TileScheduler::Order::Scanline );
+  const int nbTiles = _TileScheduler.GetTilesForBudget(1. / std::max(_Settings._TargetFPS, 1.f));
+
+  // Errors of the tiles accumulated by previous frames, as soon as the GPU got them
+  this -> ReadTileErrors();
+
+  _TileScheduler.BeginFrame();
+
+  // Every tile is accumulated right after being path traced : the path trace timer covers both passes
+  BeginTimer(_PathTraceTimeId);
+
+  for ( int i = 0; i < nbTiles; ++i )
+  {
+    const int tile = _TileScheduler.NextTile(order);
+    if ( tile < 0 )
+      break;
+
+    _CurTile = _TileScheduler.GetTileCoord(tile);
+    this -> UpdateTileUniforms(_TileScheduler.GetTileSamples(tile));
+
+    if ( Wavefront() )
+    {
+      this -> BindPathTraceTextures();
+      this -> PathTraceWavefront(_RenderTargetTileTEX[0], &_RenderTargetTileTEX[1], &_RenderTargetTileTEX[2], TileWidth(), TileHeight());
+      _WavefrontThisFrame = true;
+    }
+    else
+    {
+      glBindFramebuffer(GL_FRAMEBUFFER, _RenderTargetTileFBO._Handle);
+      glViewport(0, 0, TileWidth(), TileHeight());
+      this -> BindPathTraceTextures();
+      _Quad.Render(*_PathTraceShader);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _AccumulateFBO._Handle);
+    glViewport(_Settings._TileResolution.x * _CurTile.x, _Settings._TileResolution.y * _CurTile.y, _Settings._TileResolution.x, _Settings._TileResolution.y);
+    this -> BindAccumulateTextures();
+    _Quad.Render(*_AccumulateShader);
+
+    _RenderedTiles.push_back(tile);
+  }
+
+  EndTimer(_PathTraceTimeId);
+  _PathTraceTimerWritten = true;
+
+  for ( int tile : _RenderedTiles )
+    _TileScheduler.TileRendered(tile);
+  this -> QueueTileErrors();
+
+  _NbCompleteFrames = _TileScheduler.GetMinSamples();
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// QueueTileErrors
+// Copies the luminance moments of the tiles just accumulated into the current PBO, read back by a later frame
+// ----------------------------------------------------------------------------
+void PathTracer::QueueTileErrors()
+{
+  TileErrorSlot & slot = _TileErrorSlots[_TileErrorSlot];
+
+  // The GPU is still behind on this slot : its errors are dropped rather than waited for
+  if ( slot._Fence )
+  {
+    glDeleteSync(slot._Fence);
+    slot._Fence = nullptr;
+  }
+  slot._Tiles.clear();
+  slot._NbPixels.clear();
+
+  GLsizeiptr size = 0;
+  for ( int tile : _RenderedTiles )
+  {
+    const Vec2i coord = _TileScheduler.GetTileCoord(tile);
+    const int width = std::min(_Settings._TileResolution.x, RenderWidth() - _Settings._TileResolution.x * coord.x);
+    const int height = std::min(_Settings._TileResolution.y, RenderHeight() - _Settings._TileResolution.y * coord.y);
+    if ( ( width <= 0 ) || ( height <= 0 ) )
+      continue;
+
+    slot._Tiles.push_back(tile);
+    slot._NbPixels.push_back(width * height);
+    size += static_cast<GLsizeiptr>(width) * height * 4 * sizeof(float);
+  }
+  if ( slot._Tiles.empty() )
+    return;
+
+  if ( !slot._PBO )
+    glGenBuffers(1, &slot._PBO);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot._PBO);
+  if ( size > slot._Capacity )
+  {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    slot._Capacity = size;
+  }
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, _AccumulateFBO._Handle);
+  glReadBuffer(GL_COLOR_ATTACHMENT3);
+
+  GLsizeiptr offset = 0;
+  for ( int tile : slot._Tiles )
+  {
+    const Vec2i coord = _TileScheduler.GetTileCoord(tile);
+    const int x0 = _Settings._TileResolution.x * coord.x;
+    const int y0 = _Settings._TileResolution.y * coord.y;
+    const int width = std::min(_Settings._TileResolution.x, RenderWidth() - x0);
+    const int height = std::min(_Settings._TileResolution.y, RenderHeight() - y0);
+    glReadPixels(x0, y0, width, height, GL_RGBA, GL_FLOAT, reinterpret_cast<void *>(offset));
+    offset += static_cast<GLsizeiptr>(width) * height * 4 * sizeof(float);
+  }
+
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  slot._Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  _TileErrorSlot = ( _TileErrorSlot + 1 ) % S_NbTileErrorSlots;
+}
+
+// ----------------------------------------------------------------------------
+// ReadTileErrors
+// Relative standard errors estimated from the accumulated luminance moments of each tile.
+// Oldest slot first, stops at the first frame the GPU has not finished.
+// ----------------------------------------------------------------------------
+void PathTracer::ReadTileErrors()
+{
+  for ( int i = 0; i < S_NbTileErrorSlots; ++i )
+  {
+    TileErrorSlot & slot = _TileErrorSlots[( _TileErrorSlot + i ) % S_NbTileErrorSlots];
+    if ( !slot._Fence )
+      continue;
+
+    const GLenum status = glClientWaitSync(slot._Fence, 0, 0);
+    if ( ( GL_ALREADY_SIGNALED != status ) && ( GL_CONDITION_SATISFIED != status ) )
+      break;
+
+    glDeleteSync(slot._Fence);
+    slot._Fence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot._PBO);
+    const float * moments = static_cast<const float *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot._Capacity, GL_MAP_READ_BIT));
+    if ( moments )
+    {
+      for ( size_t t = 0; t < slot._Tiles.size(); ++t )
+      {
+        _TileScheduler.SetTileError(slot._Tiles[t], TileScheduler::EstimateError(moments, slot._NbPixels[t]));
+        moments += 4 * slot._NbPixels[t];
+      }
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// DiscardTileErrors
+// Pending errors belong to the previous accumulation
+// ----------------------------------------------------------------------------
+void PathTracer::DiscardTileErrors()
+{
+  for ( TileErrorSlot & slot : _TileErrorSlots )
+  {
+    if ( slot._Fence )
+      glDeleteSync(slot._Fence);
+    slot._Fence = nullptr;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ReleaseTileErrors
+// ----------------------------------------------------------------------------
+void PathTracer::ReleaseTileErrors()
+{
+  this -> DiscardTileErrors();
+  for ( TileErrorSlot & slot : _TileErrorSlots )
+  {
+    GLUtil::DeleteBuffer(slot._PBO);
+    slot = TileErrorSlot();
+  }
+  _TileErrorSlot = 0;
+}
+
+// ----------------------------------------------------------------------------
+// ResizeWavefrontBuffers
+// ----------------------------------------------------------------------------
+int PathTracer::ResizeWavefrontBuffers( int iCapacity, int iNbBuckets )
+{
+  if ( ( iCapacity == _WavefrontCapacity ) && ( iNbBuckets == _WavefrontNbBuckets ) && _WavefrontPathsBuffer )
+    return 0;
+
+  this -> DeleteWavefrontBuffers();
+
+  auto createBuffer = []( GLsizeiptr iSize, GLuint & oBuffer )
+  {
+    GLBufferDesc desc;
+    desc._Target = GL_SHADER_STORAGE_BUFFER;
+    desc._Size   = iSize;
+    desc._Usage  = GL_DYNAMIC_COPY;
+    GLUtil::CreateBuffer(desc, oBuffer);
+  };
+
+  // Strides of the std430 structures of Wavefront.glsl
+  const GLsizeiptr pathSize = 8 * 4 * sizeof(GLfloat);
+  const GLsizeiptr hitSize = 6 * 4 * sizeof(GLfloat);
+  const GLsizeiptr shadowRaySize = 4 * 4 * sizeof(GLfloat);
+
+  createBuffer(iCapacity * pathSize, _WavefrontPathsBuffer);
+  createBuffer(iCapacity * hitSize, _WavefrontHitsBuffer);
+  createBuffer(2 * iCapacity * sizeof(GLuint), _WavefrontRayQueuesBuffer);
+  createBuffer(iCapacity * sizeof(GLuint), _WavefrontMaterialQueueBuffer);
+  createBuffer(2 * iCapacity * shadowRaySize, _WavefrontShadowRaysBuffer);
+  createBuffer(S_CountersSize, _WavefrontCountersBuffer);
+  createBuffer(2 * iNbBuckets * sizeof(GLuint), _WavefrontBucketsBuffer);
+
+  // The bucket counts are cleared by the shaders from then on
+  const GLuint zero = 0;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, _WavefrontCountersBuffer);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, _WavefrontBucketsBuffer);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  _WavefrontCapacity = iCapacity;
+  _WavefrontNbBuckets = iNbBuckets;
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// DeleteWavefrontBuffers
+// ----------------------------------------------------------------------------
+int PathTracer::DeleteWavefrontBuffers()
+{
+  GLUtil::DeleteBuffer(_WavefrontPathsBuffer);
+  GLUtil::DeleteBuffer(_WavefrontHitsBuffer);
+  GLUtil::DeleteBuffer(_WavefrontRayQueuesBuffer);
+  GLUtil::DeleteBuffer(_WavefrontMaterialQueueBuffer);
+  GLUtil::DeleteBuffer(_WavefrontShadowRaysBuffer);
+  GLUtil::DeleteBuffer(_WavefrontCountersBuffer);
+  GLUtil::DeleteBuffer(_WavefrontBucketsBuffer);
+
+  _WavefrontCapacity = 0;
+  _WavefrontNbBuckets = 0;
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// PathTraceWavefront
+// Path traces the target with compute stages instead of the fragment megakernel :
+// generate, then per bounce extend (closest hit), material sort, shade and shadow rays.
+// The rays move between the stages through queues compacted with atomic counters,
+// every queue dispatch is sized on the GPU through the indirect arguments.
+// iNormals / iPos : nullptr when the target has no geometry attachments (low resolution pass)
+// ----------------------------------------------------------------------------
+int PathTracer::PathTraceWavefront( const GLTexture & iColor, const GLTexture * iNormals, const GLTexture * iPos, int iWidth, int iHeight )
+{
+  const int capacity = std::max({ RenderWidth() * RenderHeight(), TileWidth() * TileHeight(), LowResRenderWidth() * LowResRenderHeight() });
+  const int nbBuckets = static_cast<int>(_Scene.GetMaterials().size()) + 1;
+  this -> ResizeWavefrontBuffers(capacity, nbBuckets);
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _WavefrontPathsBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _WavefrontHitsBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _WavefrontRayQueuesBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _WavefrontMaterialQueueBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _WavefrontShadowRaysBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, _WavefrontCountersBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, _WavefrontBucketsBuffer);
+  glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, _WavefrontCountersBuffer);
+
+  glBindImageTexture(0, iColor._Handle, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+  if ( iNormals && iPos )
+  {
+    glBindImageTexture(1, iNormals -> _Handle, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    glBindImageTexture(2, iPos -> _Handle, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+  }
+
+  const Vec2i targetSize(iWidth, iHeight);
+  const GLuint nbPixelGroupsX = static_cast<GLuint>(( iWidth + 7 ) / 8);
+  const GLuint nbPixelGroupsY = static_cast<GLuint>(( iHeight + 7 ) / 8);
+  const int nbBounces = std::min(S_WavefrontMaxBounces, _Settings._Bounces + 1 + S_WavefrontExtraBounces);
+
+  std::vector<ShaderProgram *> stages = { _WavefrontGenerateShader.get(), _WavefrontExtendShader.get(), _WavefrontQueueShader.get(),
+                                          _WavefrontShadeShader.get(), _WavefrontShadowShader.get(), _WavefrontResolveShader.get() };
+  for ( ShaderProgram * stage : stages )
+  {
+    stage -> Use();
+    stage -> SetUniform("u_PathCapacity", capacity);
+    stage -> SetUniform("u_NbBuckets", nbBuckets);
+    stage -> SetUniform("u_TargetSize", targetSize);
+    stage -> SetUniform("u_RayQueue", 0);
+  }
+  _WavefrontExtendShader -> Use();
+  _WavefrontExtendShader -> SetUniform("u_StoreGeometry", ( iNormals && iPos ) ? ( 1 ) : ( 0 ));
+
+  auto runQueueStage = [&]( int iStage, int iRayQueue )
+  {
+    _WavefrontQueueShader -> Use();
+    _WavefrontQueueShader -> SetUniform("u_Stage", iStage);
+    _WavefrontQueueShader -> SetUniform("u_RayQueue", iRayQueue);
+    if ( S_QueueSort == iStage )
+      glDispatchComputeIndirect(S_ExtendArgsOffset);
+    else
+      glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+  };
+
+  for ( int sample = 0; sample < std::max(1, _Settings._NbSamplesPerPixel); ++sample )
+  {
+    // Generate : one camera ray per pixel in queue 0
+    BeginWavefrontTimer(WavefrontGenerate);
+    runQueueStage(S_QueueReset, 0);
+
+    _WavefrontGenerateShader -> Use();
+    _WavefrontGenerateShader -> SetUniform("u_SampleIndex", sample);
+    glDispatchCompute(nbPixelGroupsX, nbPixelGroupsY, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    EndWavefrontTimer(WavefrontGenerate);
+
+    int rayQueue = 0;
+    for ( int bounce = 0; bounce < nbBounces; ++bounce )
+    {
+      // Extend : closest hits of the queued rays, counted per material bucket
+      BeginWavefrontTimer(WavefrontExtend);
+      runQueueStage(S_QueueBeginBounce, rayQueue);
+
+      _WavefrontExtendShader -> Use();
+      _WavefrontExtendShader -> SetUniform("u_RayQueue", rayQueue);
+      glDispatchComputeIndirect(S_ExtendArgsOffset);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+      EndWavefrontTimer(WavefrontExtend);
+
+      // Material sort : neighbouring shade invocations evaluate the same material
+      BeginWavefrontTimer(WavefrontSort);
+      runQueueStage(S_QueueScanBuckets, rayQueue);
+      runQueueStage(S_QueueSort, rayQueue);
+      EndWavefrontTimer(WavefrontSort);
+
+      // Shade : emission, shadow rays toward the lights and next ray
+      BeginWavefrontTimer(WavefrontShade);
+      _WavefrontShadeShader -> Use();
+      _WavefrontShadeShader -> SetUniform("u_RayQueue", rayQueue);
+      glDispatchComputeIndirect(S_ShadeArgsOffset);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+      EndWavefrontTimer(WavefrontShade);
+
+      // Shadow rays : occlusion only, the unoccluded samples are added to their path
+      BeginWavefrontTimer(WavefrontShadow);
+      runQueueStage(S_QueueShadow, rayQueue);
+
+      _WavefrontShadowShader -> Use();
+      glDispatchComputeIndirect(S_ShadowArgsOffset);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+      EndWavefrontTimer(WavefrontShadow);
+
+      rayQueue = 1 - rayQueue;
+    }
+  }
+
+  // Resolve : average of the samples into the color target
+  _WavefrontResolveShader -> Use();
+  glDispatchCompute(nbPixelGroupsX, nbPixelGroupsY, 1);
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+  _WavefrontResolveShader -> StopUsing();
+
+  glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+  for ( GLuint binding = 0; binding <= 6; ++binding )
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // DenoiseOutput
 // ----------------------------------------------------------------------------
 int PathTracer::DenoiseOutput()
 {
+  if ( TemporalDenoise() )
+  {
+    BeginTimer(_DenoiseTimeId);
+    int status = this -> DenoiseTemporal();
+    EndTimer(_DenoiseTimeId);
+    _DenoiseTimerWritten = true;
+    return status;
+  }
+
   if ( !_DenoiserShader )
     return 1;
 
   BeginTimer(_DenoiseTimeId);
 
-  _DenoiserShader -> Use();
+  // Edge-aware a-trous iterations ping-pong through the wavelet targets, the last one writes the output
+  const int nbIterations = ( 2 == _Settings._DenoisingMethod ) ? ( std::max((int)_Settings._DenoiserEdgeAwareIterations, 1) ) : ( 1 );
+  const GLTexture * input = &_AccumulateTEX[0];
 
-#if defined(_WIN32) || defined(_WIN64)
-  this -> BindDenoiserImageTextures();
+  if ( _DenoiserComputeShader )
+  {
+    this -> BindDenoiserImageTextures();
 
-  // Dispatch compute shader (assuming texture size is 512x512)
-  const int workGroupSizeX = 16, workGroupSizeY = 16;
-  const int nbGroupsX = static_cast<int>(std::ceil(((float)RenderWidth()) / workGroupSizeX));
-  const int nbGroupsY = static_cast<int>(std::ceil(((float)RenderHeight())/workGroupSizeY));
-  glDispatchCompute(nbGroupsX, nbGroupsY, 1);
+    const int workGroupSize = 16;
+    const int nbGroupsX = ( RenderWidth() + workGroupSize - 1 ) / workGroupSize;
+    const int nbGroupsY = ( RenderHeight() + workGroupSize - 1 ) / workGroupSize;
 
-  // Ensure GPU has completed work before continuing
-  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-#else
-  this -> BindDenoiserTextures();
+    // The shared memory tile covers the first two iterations at once
+    for ( int iteration = 0, pass = 0; iteration < nbIterations; ++pass )
+    {
+      const int nbPassIterations = ( ( 0 == iteration ) && ( nbIterations > 1 ) ) ? ( 2 ) : ( 1 );
+      const GLTexture & output = ( iteration + nbPassIterations >= nbIterations ) ? ( _DenoisedTEX ) : ( _AtrousTEX[pass % 2] );
 
-  glBindFramebuffer(GL_FRAMEBUFFER, _DenoiseFBO._Handle);
-  glViewport(0, 0, RenderWidth(), RenderHeight());
+      glBindImageTexture(0, input -> _Handle, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+      glBindImageTexture(3, output._Handle, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
 
-  _Quad.Render(*_DenoiserShader);
-#endif
+      _DenoiserComputeShader -> Use();
+      _DenoiserComputeShader -> SetUniform("u_FirstIteration", iteration);
+      _DenoiserComputeShader -> SetUniform("u_NbIterations", nbPassIterations);
+      glDispatchCompute(nbGroupsX, nbGroupsY, 1);
+      _DenoiserComputeShader -> StopUsing();
 
-  _DenoiserShader -> StopUsing();
+      // The next pass reads this output
+      glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+      input = &output;
+      iteration += nbPassIterations;
+    }
+  }
+  else
+  {
+    this -> BindDenoiserTextures();
+
+    for ( int iteration = 0; iteration < nbIterations; ++iteration )
+    {
+      const bool last = ( iteration == nbIterations - 1 );
+
+      GLUtil::ActivateTexture(*input);
+      _DenoiserShader -> Use();
+      _DenoiserShader -> SetUniform("u_InputImage", (int)input -> _Slot);
+      _DenoiserShader -> SetUniform("u_Iteration", iteration);
+      _DenoiserShader -> StopUsing();
+
+      glBindFramebuffer(GL_FRAMEBUFFER, ( last ) ? ( _DenoiseFBO._Handle ) : ( _AtrousFBO[iteration % 2]._Handle ));
+      glViewport(0, 0, RenderWidth(), RenderHeight());
+      _Quad.Render(*_DenoiserShader);
+
+      input = &_AtrousTEX[iteration % 2];
+    }
+  }
 
   EndTimer(_DenoiseTimeId);
   _DenoiseTimerWritten = true;
@@ -630,6 +1192,89 @@ int PathTracer::DenoiseOutput()
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// DenoiseTemporal
+// SVGF : the new frame is blended with the reprojected history, then filtered
+// by a few a-trous wavelet iterations guided by the integrated variance.
+// ----------------------------------------------------------------------------
+int PathTracer::DenoiseTemporal()
+{
+  if ( !_SVGFTemporalShader || !_SVGFAtrousShader )
+    return 1;
+
+  const int current = _SVGFHistoryIndex;
+  const int previous = 1 - _SVGFHistoryIndex;
+  const Camera & cam = _Scene.GetCamera();
+
+  // Temporal accumulation
+  GLUtil::ActivateTextures(_RenderTargetFBO);
+  GLUtil::ActivateTextures(_SVGFHistoryFBO[previous]);
+
+  _SVGFTemporalShader -> Use();
+  _SVGFTemporalShader -> SetUniform("u_NewFrame", (int)_RenderTargetTEX[0]._Slot);
+  _SVGFTemporalShader -> SetUniform("u_NewFrameNormals", (int)_RenderTargetTEX[1]._Slot);
+  _SVGFTemporalShader -> SetUniform("u_NewFramePos", (int)_RenderTargetTEX[2]._Slot);
+  _SVGFTemporalShader -> SetUniform("u_HistoryColor", (int)_SVGFHistoryTEX[previous][0]._Slot);
+  _SVGFTemporalShader -> SetUniform("u_HistoryMoments", (int)_SVGFHistoryTEX[previous][1]._Slot);
+  _SVGFTemporalShader -> SetUniform("u_HistoryNormals", (int)_SVGFHistoryTEX[previous][2]._Slot);
+  _SVGFTemporalShader -> SetUniform("u_HistoryPos", (int)_SVGFHistoryTEX[previous][3]._Slot);
+  _SVGFTemporalShader -> SetUniform("u_HistoryValid", ( _SVGFHistoryValid ) ? ( 1 ) : ( 0 ));
+  _SVGFTemporalShader -> SetUniform("u_Dirty", ( Dirty() ) ? ( 1 ) : ( 0 ));
+  _SVGFTemporalShader -> SetUniform("u_Alpha", _Settings._DenoiserTemporalAlpha);
+  _SVGFTemporalShader -> SetUniform("u_Resolution", (float)RenderWidth(), (float)RenderHeight());
+  _SVGFTemporalShader -> SetUniform("u_CameraPos", cam.GetPos());
+  _SVGFTemporalShader -> SetUniform("u_PrevCameraPos", _SVGFPrevCameraPos);
+  _SVGFTemporalShader -> SetUniform("u_PrevCameraRight", _SVGFPrevCameraRight);
+  _SVGFTemporalShader -> SetUniform("u_PrevCameraUp", _SVGFPrevCameraUp);
+  _SVGFTemporalShader -> SetUniform("u_PrevCameraForward", _SVGFPrevCameraForward);
+  _SVGFTemporalShader -> SetUniform("u_PrevCameraScale", _SVGFPrevCameraScale);
+  _SVGFTemporalShader -> StopUsing();
+
+  glBindFramebuffer(GL_FRAMEBUFFER, _SVGFHistoryFBO[current]._Handle);
+  glViewport(0, 0, RenderWidth(), RenderHeight());
+  _Quad.Render(*_SVGFTemporalShader);
+
+  // A-trous iterations : ping-pong, the last one writes the denoised output
+  const int nbIterations = std::max((int)_Settings._DenoiserAtrousIterations, 1);
+  const GLTexture * input = &_SVGFHistoryTEX[current][0];
+
+  _SVGFAtrousShader -> Use();
+  _SVGFAtrousShader -> SetUniform("u_Normals", (int)_RenderTargetTEX[1]._Slot);
+  _SVGFAtrousShader -> SetUniform("u_Pos", (int)_RenderTargetTEX[2]._Slot);
+  _SVGFAtrousShader -> SetUniform("u_ImageSize", RenderWidth(), RenderHeight());
+  _SVGFAtrousShader -> SetUniform("u_CameraPos", cam.GetPos());
+  _SVGFAtrousShader -> SetUniform("u_PixelSpread", 2.f * tanf(cam.GetFOV() * .5f) / RenderHeight());
+  _SVGFAtrousShader -> StopUsing();
+
+  for ( int i = 0; i < nbIterations; ++i )
+  {
+    const bool last = ( i == nbIterations - 1 );
+
+    GLUtil::ActivateTexture(*input);
+    _SVGFAtrousShader -> Use();
+    _SVGFAtrousShader -> SetUniform("u_Input", (int)input -> _Slot);
+    _SVGFAtrousShader -> SetUniform("u_StepSize", 1 << i);
+    _SVGFAtrousShader -> StopUsing();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, ( last ) ? ( _DenoiseFBO._Handle ) : ( _AtrousFBO[i % 2]._Handle ));
+    glViewport(0, 0, RenderWidth(), RenderHeight());
+    _Quad.Render(*_SVGFAtrousShader);
+
+    input = &_AtrousTEX[i % 2];
+  }
+
+  // The history just written is reprojected with this camera next frame
+  _SVGFPrevCameraPos     = cam.GetPos();
+  _SVGFPrevCameraRight   = cam.GetRight();
+  _SVGFPrevCameraUp      = cam.GetUp();
+  _SVGFPrevCameraForward = cam.GetForward();
+  _SVGFPrevCameraScale   = tanf(cam.GetFOV() * .5f);
+  _SVGFHistoryValid      = true;
+  _SVGFHistoryIndex      = previous;
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // UpdateDenoiserUniforms
 // ----------------------------------------------------------------------------
@@ -638,23 +1283,27 @@ int PathTracer::UpdateDenoiserUniforms()
   if ( !_DenoiserShader )
     return 1;
 
-  _DenoiserShader -> Use();
+  for ( ShaderProgram * shader : { _DenoiserShader.get(), _DenoiserComputeShader.get() } )
+  {
+    if ( !shader )
+      continue;
+
+    shader -> Use();
+    shader -> SetUniform("u_DenoisingMethod", (int)std::min(_Settings._DenoisingMethod, 2u)); // 0: Bilateral, 1: Wavelet, 2: Edge-aware. SVGF falls back to edge-aware with tiles
+    shader -> SetUniform("u_SigmaSpatial", _Settings._DenoiserSigmaSpatial);       // Bilateral
+    shader -> SetUniform("u_SigmaRange", _Settings._DenoiserSigmaRange);           // Bilateral
+    shader -> SetUniform("u_Threshold", _Settings._DenoiserThreshold);             // Wavelet
+    shader -> SetUniform("u_WaveletScale", (int)_Settings._DenoisingWaveletScale); // Wavelet
+    shader -> SetUniform("u_ColorPhi", _Settings._DenoiserColorPhi);               // Edge-aware
+    shader -> SetUniform("u_NormalPhi", _Settings._DenoiserNormalPhi);             // Edge-aware
+    shader -> SetUniform("u_PositionPhi", _Settings._DenoiserPositionPhi);         // Edge-aware
+    shader -> StopUsing();
+  }
 
-  _DenoiserShader -> SetUniform("u_DenoisingMethod", (int)_Settings._DenoisingMethod);    // 0: Bilateral, 1: Wavelet, 2: Edge-aware
-  _DenoiserShader -> SetUniform("u_SigmaSpatial", _Settings._DenoiserSigmaSpatial);       // Bilateral
-  _DenoiserShader -> SetUniform("u_SigmaRange", _Settings._DenoiserSigmaRange);           // Bilateral
-  _DenoiserShader -> SetUniform("u_Threshold", _Settings._DenoiserThreshold);             // Wavelet
-  _DenoiserShader -> SetUniform("u_WaveletScale", (int)_Settings._DenoisingWaveletScale); // Wavelet
-  _DenoiserShader -> SetUniform("u_ColorPhi", _Settings._DenoiserColorPhi);               // Edge-aware
-  _DenoiserShader -> SetUniform("u_NormalPhi", _Settings._DenoiserNormalPhi);             // Edge-aware
-  _DenoiserShader -> SetUniform("u_PositionPhi", _Settings._DenoiserPositionPhi);         // Edge-aware
-#if !defined(_WIN32) && !defined(_WIN64)
-  _DenoiserShader -> SetUniform("u_InputImage", (int)PathTracerTexSlot::_Accumulate);
+  _DenoiserShader -> Use();
   _DenoiserShader -> SetUniform("u_InputNormals", (int)PathTracerTexSlot::_AccumulateNormals);
   _DenoiserShader -> SetUniform("u_InputPos", (int)PathTracerTexSlot::_AccumulatePos);
   _DenoiserShader -> SetUniform("u_ImageSize", RenderWidth(), RenderHeight());
-#endif
-
   _DenoiserShader -> StopUsing();
 
   return 0;
@@ -675,13 +1324,39 @@ int PathTracer::BindDenoiserTextures()
 // ----------------------------------------------------------------------------
 int PathTracer::BindDenoiserImageTextures()
 {
-  if ( 3 == _AccumulateFBO._Tex.size() )
+  // Color input and output change with every pass : bound by DenoiseOutput
+  if ( _AccumulateFBO._Tex.size() >= 3 )
   {
-    glBindImageTexture(0, _AccumulateTEX[0]._Handle, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
     glBindImageTexture(1, _AccumulateTEX[1]._Handle, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
     glBindImageTexture(2, _AccumulateTEX[2]._Handle, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
   }
-  glBindImageTexture(3, _DenoisedTEX._Handle, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// UpdateTileUniforms
+// Tiles hold their own sample count : iTileSamples frames are already accumulated in the current tile
+// ----------------------------------------------------------------------------
+int PathTracer::UpdateTileUniforms( unsigned int iTileSamples )
+{
+  for ( ShaderProgram * shader : { _PathTraceShader.get(), _WavefrontGenerateShader.get(), _WavefrontExtendShader.get(), _WavefrontQueueShader.get(),
+                                   _WavefrontShadeShader.get(), _WavefrontShadowShader.get(), _WavefrontResolveShader.get() } )
+  {
+    if ( !shader )
+      continue;
+
+    shader -> Use();
+    shader -> SetUniform("u_TileOffset", TileOffset());
+    shader -> SetUniform("u_FrameNum", (int)iTileSamples);
+    shader -> StopUsing();
+  }
+
+  _AccumulateShader -> Use();
+  _AccumulateShader -> SetUniform("u_TileOffset", TileOffset());
+  _AccumulateShader -> SetUniform("u_NbCompleteFrames", (int)iTileSamples);
+  _AccumulateShader -> SetUniform("u_Accumulate", ( _Settings._Accumulate && ( iTileSamples > 0 ) ) ? ( 1 ) : ( 0 ));
+  _AccumulateShader -> StopUsing();
 
   return 0;
 }
@@ -703,6 +1378,9 @@ int PathTracer::UpdateRenderToScreenUniforms()
   //_RenderToScreenShader -> SetUniform("u_ToneMapping", ( _Settings._ToneMapping ? 1 : 0 ));
   _RenderToScreenShader -> SetUniform("u_ToneMapping", 0);
   _RenderToScreenShader -> SetUniform("u_FXAA", (_Settings._FXAA ?  1 : 0 ));
+  _RenderToScreenShader -> SetUniform("u_SampleMoments", (int)PathTracerTexSlot::_AccumulateMoments);
+  _RenderToScreenShader -> SetUniform("u_NbCompleteFrames", (int)( ( TiledRendering() ) ? ( _TileScheduler.GetMaxSamples() ) : ( _NbCompleteFrames ) )); // Sample heatmap scale
+  _RenderToScreenShader -> SetUniform("u_DebugMode", _DebugMode);
 
   _RenderToScreenShader -> StopUsing();
 
@@ -719,6 +1397,9 @@ int PathTracer::BindRenderToScreenTextures()
   else
     GLUtil::ActivateTextures(_AccumulateFBO);
 
+  if ( 8 == _DebugMode )
+    GLUtil::ActivateTexture(_AccumulateMomentsTEX);
+
   return 0;
 }
 
@@ -764,6 +1445,161 @@ int PathTracer::ReadbackFinalColor( RenderImage & oImage )
   return ( GL_NO_ERROR == glGetError() ) ? 0 : 1;
 }
 
+// ----------------------------------------------------------------------------
+// FillCheckpoint
+// Everything but the layers
+// ----------------------------------------------------------------------------
+void PathTracer::FillCheckpoint( AccumulationCheckpoint & oCheckpoint ) const
+{
+  const Camera & cam = _Scene.GetCamera();
+
+  oCheckpoint = AccumulationCheckpoint();
+  oCheckpoint._Resolution        = Vec2i(RenderWidth(), RenderHeight());
+  oCheckpoint._NbCompleteFrames  = _NbCompleteFrames;
+  oCheckpoint._FrameNum          = _FrameNum;
+  oCheckpoint._NbRenderedFrames  = _NbRenderedFrames;
+  oCheckpoint._NbSamplesPerPixel = _Settings._NbSamplesPerPixel;
+  oCheckpoint._Bounces           = _Settings._Bounces;
+  oCheckpoint._TiledRendering    = TiledRendering();
+  oCheckpoint._CameraPos         = cam.GetPos();
+  oCheckpoint._CameraForward     = cam.GetForward();
+  oCheckpoint._CameraFOV         = cam.GetFOV();
+
+  if ( TiledRendering() )
+  {
+    oCheckpoint._NbTiles     = NbTiles();
+    oCheckpoint._TileSamples = _TileScheduler.GetSamples();
+    oCheckpoint._TileErrors  = _TileScheduler.GetErrors();
+    oCheckpoint._TileCursor  = _TileScheduler.GetScanlineCursor();
+
+    // Nothing rendered since the last reset
+    if ( _TileScheduler.GetNbTiles() != NbTiles() )
+    {
+      const size_t nbTiles = (size_t)oCheckpoint._NbTiles.x * (size_t)oCheckpoint._NbTiles.y;
+      oCheckpoint._TileSamples.assign(nbTiles, 0);
+      oCheckpoint._TileErrors.assign(nbTiles, 0.f);
+      oCheckpoint._TileCursor = -1;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// SaveCheckpoint
+// ----------------------------------------------------------------------------
+int PathTracer::SaveCheckpoint( const fs::path & iPath )
+{
+  // A pending change resets the accumulation at the next update
+  if ( Dirty() )
+  {
+    std::cout << "PathTracer : No accumulation to save in " << iPath << std::endl;
+    return 1;
+  }
+
+  AccumulationCheckpoint checkpoint;
+  FillCheckpoint(checkpoint);
+
+  AccumulationCheckpointWriter writer;
+  if ( !writer.Open(iPath, checkpoint) )
+  {
+    std::cout << "PathTracer : ERROR. Unable to write the checkpoint " << fs::absolute(iPath) << std::endl;
+    return 1;
+  }
+
+  // One layer in memory at a time
+  const GLTexture * layers[AccumulationCheckpoint::_NbLayers] = { &_AccumulateTEX[0], &_AccumulateTEX[1], &_AccumulateTEX[2], &_AccumulateMomentsTEX };
+  std::vector<float> pixels(checkpoint.GetLayerSize());
+
+  while ( GL_NO_ERROR != glGetError() ) {}
+  bool saved = true;
+  for ( const GLTexture * layer : layers )
+  {
+    glBindTexture(GL_TEXTURE_2D, layer -> _Handle);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, pixels.data());
+    saved = ( GL_NO_ERROR == glGetError() ) && writer.WriteLayer(pixels.data());
+    if ( !saved )
+      break;
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  if ( !saved || !writer.Close() )
+  {
+    std::cout << "PathTracer : ERROR. Unable to write the checkpoint " << fs::absolute(iPath) << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// LoadCheckpoint
+// The scene, camera and settings must be the ones of the saved render
+// ----------------------------------------------------------------------------
+int PathTracer::LoadCheckpoint( const fs::path & iPath )
+{
+  AccumulationCheckpoint checkpoint;
+  AccumulationCheckpointReader reader;
+  if ( !reader.Open(iPath, checkpoint) )
+  {
+    std::cout << "PathTracer : ERROR. Unable to read the checkpoint " << fs::absolute(iPath) << std::endl;
+    return 1;
+  }
+
+  // Pending changes first : they would reset the restored accumulation
+  if ( Dirty() )
+  {
+    if ( 0 != this -> Update() )
+      return 1;
+    CleanStates();
+  }
+
+  AccumulationCheckpoint current;
+  FillCheckpoint(current);
+  std::string reason;
+  if ( !checkpoint.IsCompatible(current, reason) )
+  {
+    std::cout << "PathTracer : ERROR. The checkpoint " << iPath << " was rendered with another " << reason << std::endl;
+    return 1;
+  }
+
+  // Every layer is read before the first upload : a damaged file leaves the accumulation untouched
+  std::vector<float> layers[AccumulationCheckpoint::_NbLayers];
+  for ( int i = 0; i < AccumulationCheckpoint::_NbLayers; ++i )
+  {
+    if ( !reader.ReadLayer(layers[i]) )
+    {
+      std::cout << "PathTracer : ERROR. The checkpoint " << fs::absolute(iPath) << " is damaged" << std::endl;
+      return 1;
+    }
+  }
+
+  this -> DiscardTileErrors();
+  if ( checkpoint._TiledRendering && !_TileScheduler.Restore(checkpoint._NbTiles, checkpoint._TileSamples, checkpoint._TileErrors, checkpoint._TileCursor) )
+  {
+    std::cout << "PathTracer : ERROR. The checkpoint " << fs::absolute(iPath) << " is damaged" << std::endl;
+    return 1;
+  }
+
+  const GLTexture * textures[AccumulationCheckpoint::_NbLayers] = { &_AccumulateTEX[0], &_AccumulateTEX[1], &_AccumulateTEX[2], &_AccumulateMomentsTEX };
+  while ( GL_NO_ERROR != glGetError() ) {}
+  for ( int i = 0; i < AccumulationCheckpoint::_NbLayers; ++i )
+  {
+    glBindTexture(GL_TEXTURE_2D, textures[i] -> _Handle);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, checkpoint._Resolution.x, checkpoint._Resolution.y, GL_RGBA, GL_FLOAT, layers[i].data());
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+  if ( GL_NO_ERROR != glGetError() )
+    return 1;
+
+  _NbCompleteFrames = checkpoint._NbCompleteFrames;
+  _FrameNum = checkpoint._FrameNum;
+  _NbRenderedFrames = checkpoint._NbRenderedFrames;
+  _SVGFHistoryValid = false;
+
+  std::cout << "PathTracer : Resumed " << _NbCompleteFrames << " accumulated frames from " << fs::absolute(iPath) << std::endl;
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // RenderToFile
 // ----------------------------------------------------------------------------
@@ -853,6 +1689,12 @@ int PathTracer::ResizeRenderTarget()
   GLUtil::ResizeFBO(_RenderTargetTileFBO, TileWidth(), TileHeight());
   GLUtil::ResizeFBO(_RenderTargetLowResFBO, LowResRenderWidth(), LowResRenderHeight());
   GLUtil::ResizeFBO(_AccumulateFBO, RenderWidth(), RenderHeight());
+  for ( int i = 0; i < 2; ++i )
+  {
+    GLUtil::ResizeFBO(_SVGFHistoryFBO[i], RenderWidth(), RenderHeight());
+    GLUtil::ResizeFBO(_AtrousFBO[i], RenderWidth(), RenderHeight());
+  }
+  _SVGFHistoryValid = false;
 
   GLUtil::ResizeTexture(_DenoisedTEX, RenderWidth(), RenderHeight());
   glBindFramebuffer(GL_FRAMEBUFFER, _DenoiseFBO._Handle);
@@ -909,9 +1751,28 @@ int PathTracer::InitializeFrameBuffers()
   if ( !GLUtil::CreateFrameBuffer(lowResFBODesc, _RenderTargetLowResFBO) )
     return 1;
 
+  // Accumulated color, normals, positions and the luminance moments driving adaptive sampling
   for ( int i = 0; i < 3; ++i )
     createRenderTexture(_AccumulateTEX[i], RenderWidth(), RenderHeight());
-  if ( !createTripleFBO(_AccumulateTEX, _AccumulateFBO) )
+
+  GLTextureDesc momentsDesc;
+  momentsDesc._Target         = _AccumulateMomentsTEX._Target;
+  momentsDesc._Slot           = _AccumulateMomentsTEX._Slot;
+  momentsDesc._Width          = RenderWidth();
+  momentsDesc._Height         = RenderHeight();
+  momentsDesc._InternalFormat = _AccumulateMomentsTEX._InternalFormat;
+  momentsDesc._DataFormat     = _AccumulateMomentsTEX._DataFormat;
+  momentsDesc._DataType       = _AccumulateMomentsTEX._DataType;
+  momentsDesc._MinFilter      = GL_NEAREST;
+  momentsDesc._MagFilter      = GL_NEAREST;
+  GLUtil::CreateTexture(momentsDesc, _AccumulateMomentsTEX);
+
+  GLFrameBufferDesc accumulateFBODesc;
+  accumulateFBODesc._Attachments.push_back({ GL_COLOR_ATTACHMENT0, &_AccumulateTEX[0] });
+  accumulateFBODesc._Attachments.push_back({ GL_COLOR_ATTACHMENT1, &_AccumulateTEX[1] });
+  accumulateFBODesc._Attachments.push_back({ GL_COLOR_ATTACHMENT2, &_AccumulateTEX[2] });
+  accumulateFBODesc._Attachments.push_back({ GL_COLOR_ATTACHMENT3, &_AccumulateMomentsTEX });
+  if ( !GLUtil::CreateFrameBuffer(accumulateFBODesc, _AccumulateFBO) )
     return 1;
 
   GLTextureDesc denoisedDesc;
@@ -933,6 +1794,27 @@ int PathTracer::InitializeFrameBuffers()
   if ( !GLUtil::CreateFrameBuffer(denoiseFBODesc, _DenoiseFBO) )
     return 1;
 
+  // SVGF ping-pong histories (color + variance, moments, normals, positions)
+  // and a-trous targets, shared by SVGF and the edge-aware iterations
+  for ( int i = 0; i < 2; ++i )
+  {
+    GLFrameBufferDesc historyFBODesc;
+    for ( int j = 0; j < 4; ++j )
+    {
+      createRenderTexture(_SVGFHistoryTEX[i][j], RenderWidth(), RenderHeight());
+      historyFBODesc._Attachments.push_back({ (GLenum)( GL_COLOR_ATTACHMENT0 + j ), &_SVGFHistoryTEX[i][j] });
+    }
+    if ( !GLUtil::CreateFrameBuffer(historyFBODesc, _SVGFHistoryFBO[i]) )
+      return 1;
+
+    createRenderTexture(_AtrousTEX[i], RenderWidth(), RenderHeight());
+    GLFrameBufferDesc atrousFBODesc;
+    atrousFBODesc._Attachments.push_back({ GL_COLOR_ATTACHMENT0, &_AtrousTEX[i] });
+    if ( !GLUtil::CreateFrameBuffer(atrousFBODesc, _AtrousFBO[i]) )
+      return 1;
+  }
+  _SVGFHistoryValid = false;
+
   return 0;
 }
 
@@ -961,19 +1843,48 @@ int PathTracer::RecompileShaders()
     return 1;
   _RenderToScreenShader.reset(newShader);
 
-#if defined(_WIN32) || defined(_WIN64)
-  ShaderSource computeShaderSrc = Shader::LoadShader(PathUtils::GetShaderPath("compute_Denoiser.glsl"));
-  newShader = ShaderProgram::LoadShaders(computeShaderSrc);
+  fragmentShaderSrc = Shader::LoadShader(PathUtils::GetShaderPath("fragment_DenoiserPathTracer.glsl"));
+  newShader = ShaderProgram::LoadShaders(vertexShaderSrc, fragmentShaderSrc);
   if ( !newShader )
     return 1;
   _DenoiserShader.reset(newShader);
-#else
-  fragmentShaderSrc = Shader::LoadShader(PathUtils::GetShaderPath("fragment_DenoiserPathTracer.glsl"));
+
+  fragmentShaderSrc = Shader::LoadShader(PathUtils::GetShaderPath("fragment_SVGFTemporal.glsl"));
   newShader = ShaderProgram::LoadShaders(vertexShaderSrc, fragmentShaderSrc);
   if ( !newShader )
     return 1;
-  _DenoiserShader.reset(newShader);
-#endif
+  _SVGFTemporalShader.reset(newShader);
+
+  fragmentShaderSrc = Shader::LoadShader(PathUtils::GetShaderPath("fragment_SVGFAtrous.glsl"));
+  newShader = ShaderProgram::LoadShaders(vertexShaderSrc, fragmentShaderSrc);
+  if ( !newShader )
+    return 1;
+  _SVGFAtrousShader.reset(newShader);
+
+  // Compute shaders : optional, the fragment passes stay available on OpenGL 4.1
+  _WavefrontSupported = false;
+  _DenoiserComputeShader.reset();
+  if ( GLEW_VERSION_4_3 )
+  {
+    auto loadComputeShader = []( const char * iFileName, std::unique_ptr<ShaderProgram> & oShader )
+    {
+      ShaderSource computeSrc = Shader::LoadShader(PathUtils::GetShaderPath(iFileName));
+      oShader.reset(ShaderProgram::LoadShaders(computeSrc));
+      return ( nullptr != oShader );
+    };
+
+    if ( !loadComputeShader("compute_Denoiser.glsl", _DenoiserComputeShader) )
+      std::cout << "PathTracer : Compute denoiser unavailable, using the fragment denoiser" << std::endl;
+
+    _WavefrontSupported = loadComputeShader("compute_WavefrontGenerate.glsl", _WavefrontGenerateShader)
+                       && loadComputeShader("compute_WavefrontExtend.glsl", _WavefrontExtendShader)
+                       && loadComputeShader("compute_WavefrontQueue.glsl", _WavefrontQueueShader)
+                       && loadComputeShader("compute_WavefrontShade.glsl", _WavefrontShadeShader)
+                       && loadComputeShader("compute_WavefrontShadow.glsl", _WavefrontShadowShader)
+                       && loadComputeShader("compute_WavefrontResolve.glsl", _WavefrontResolveShader);
+    if ( !_WavefrontSupported )
+      std::cout << "PathTracer : Wavefront shaders unavailable, using the fragment path tracer" << std::endl;
+  }
 
   return 0;
 }
@@ -995,6 +1906,7 @@ int PathTracer::UnloadScene( bool iDeleteOutputTextures )
   GLUtil::DeleteTBO(_MeshIdRangeTBO);
   GLUtil::DeleteTBO(_TLASNodesTBO);
   GLUtil::DeleteTBO(_TLASMeshMatIDTBO);
+  _TLASStaging.Release();
   GLUtil::DeleteTBO(_BLASNodesTBO);
   GLUtil::DeleteTBO(_BLASNodesRangeTBO);
   GLUtil::DeleteTBO(_BLASPackedIndicesTBO);
@@ -1016,9 +1928,17 @@ int PathTracer::UnloadScene( bool iDeleteOutputTextures )
       GLUtil::DeleteTEX(_AccumulateTEX[i]);
     }
     GLUtil::DeleteTEX(_RenderTargetLowResTEX);
+    GLUtil::DeleteTEX(_AccumulateMomentsTEX);
     GLUtil::DeleteTEX(_DenoisedTEX);
+    for ( int i = 0; i < 2; ++i )
+    {
+      for ( int j = 0; j < 4; ++j )
+        GLUtil::DeleteTEX(_SVGFHistoryTEX[i][j]);
+      GLUtil::DeleteTEX(_AtrousTEX[i]);
+    }
     GLUtil::DeleteTEX(_EnvMapTEX);
-    GLUtil::DeleteTEX(_EnvMapCDFTEX);
+    GLUtil::DeleteTEX(_EnvMapAliasTEX);
+    DeleteWavefrontBuffers();
   }
 
   _FrameNum = 0;
@@ -1040,6 +1960,7 @@ int PathTracer::ReloadScene()
 
   _NbTriangles = _Scene.GetNbFaces();
   _NbMeshInstances = static_cast<int>(_Scene.GetTLASPackedMeshMatID().size());
+  _SyncedMeshInstanceGeneration = _Scene.GetMeshInstanceGeneration();
 
   if ( _NbTriangles )
   {
@@ -1112,19 +2033,26 @@ int PathTracer::ReloadScene()
 // ----------------------------------------------------------------------------
 int PathTracer::ReloadSceneInstances()
 {
-  if ( 0 != _Scene.RebuildTLASData() )
+  // Instance edits refit the uploaded TLAS, structural changes rebuild and reupload it
+  bool refitted = false;
+  if ( _NbTriangles && _Scene.GetDirtyMeshInstances(_SyncedMeshInstanceGeneration, _DirtyInstanceIDs) )
+    refitted = ( 0 == _Scene.RefitTLASData(_DirtyInstanceIDs, _DirtyTLASNodes, _DirtyTLASInstances) );
+
+  if ( !refitted && ( 0 != _Scene.RebuildTLASData() ) )
     return 1;
 
   _NbMeshInstances = static_cast<int>(_Scene.GetTLASPackedMeshMatID().size());
+  _SyncedMeshInstanceGeneration = _Scene.GetMeshInstanceGeneration();
 
   if ( _NbTriangles )
   {
-    if ( 0 != this -> UploadTLASData() )
+    if ( 0 != ( ( refitted ) ? ( this -> UploadTLASRanges() ) : ( this -> UploadTLASData() ) ) )
       return 1;
   }
 
   _FrameNum = 0;
   _NbCompleteFrames = 0;
+  _NbRenderedFrames = 0;
 
   return 0;
 }
@@ -1199,6 +2127,76 @@ int PathTracer::UploadTLASTransforms()
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// UploadTLASRanges
+// Uploads the refitted nodes and the changed packed instances only
+// ----------------------------------------------------------------------------
+int PathTracer::UploadTLASRanges()
+{
+  const std::vector<GpuBvh::Node> & TLASNodes = _Scene.GetTLASNode();
+  const std::vector<Mat4x4>       & TLASTransforms = _Scene.GetTLASPackedTransforms();
+  const std::vector<Vec2i>        & TLASMeshMatID = _Scene.GetTLASPackedMeshMatID();
+
+  if ( !_TLASNodesTBO._Handle || !_TLASMeshMatIDTBO._Handle || !_TLASTransformsIDTEX._Handle )
+    return this -> UploadTLASData();
+
+  // The ring slot holds a whole TLAS : a frame moving every instance still fits
+  const GLsizeiptr TLASSize = static_cast<GLsizeiptr>(sizeof(GpuBvh::Node) * TLASNodes.size() + ( sizeof(Mat4x4) + sizeof(Vec2i) ) * TLASTransforms.size());
+  if ( GLStagingBuffer::IsSupported() && ( _TLASStaging.GetSlotSize() < TLASSize ) )
+    _TLASStaging.Initialize(2 * TLASSize);
+
+  _TLASStaging.BeginFrame();
+
+  GLStagingBuffer::Coalesce(_DirtyTLASNodes, S_TLASRangeMaxGap, _DirtyTLASRanges);
+  for ( const Vec2i & range : _DirtyTLASRanges )
+    this -> UploadBufferRange(_TLASNodesTBO._Handle, sizeof(GpuBvh::Node) * range.x, sizeof(GpuBvh::Node) * range.y, &TLASNodes[range.x]);
+
+  GLStagingBuffer::Coalesce(_DirtyTLASInstances, S_TLASRangeMaxGap, _DirtyTLASRanges);
+  for ( const Vec2i & range : _DirtyTLASRanges )
+    this -> UploadBufferRange(_TLASMeshMatIDTBO._Handle, sizeof(Vec2i) * range.x, sizeof(Vec2i) * range.y, &TLASMeshMatID[range.x]);
+
+  // One matrix is 4 texels of the transforms row
+  glBindTexture(GL_TEXTURE_2D, _TLASTransformsIDTEX._Handle);
+  for ( const Vec2i & range : _DirtyTLASRanges )
+  {
+    const GLsizeiptr size = sizeof(Mat4x4) * range.y;
+    const GLintptr stagingOffset = _TLASStaging.Write(&TLASTransforms[range.x], size);
+    if ( stagingOffset >= 0 )
+    {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _TLASStaging.GetHandle());
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 4 * range.x, 0, 4 * range.y, 1, GL_RGBA, GL_FLOAT, reinterpret_cast<const void*>(stagingOffset));
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 4 * range.x, 0, 4 * range.y, 1, GL_RGBA, GL_FLOAT, &TLASTransforms[range.x]);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  _TLASStaging.EndFrame();
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// UploadBufferRange
+// Copied from the staging ring on the GPU, or written directly when the ring is not available
+// ----------------------------------------------------------------------------
+void PathTracer::UploadBufferRange( GLuint iBuffer, GLintptr iOffset, GLsizeiptr iSize, const void * iData )
+{
+  const GLintptr stagingOffset = _TLASStaging.Write(iData, iSize);
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, iBuffer);
+  if ( stagingOffset >= 0 )
+  {
+    glBindBuffer(GL_COPY_READ_BUFFER, _TLASStaging.GetHandle());
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, stagingOffset, iOffset, iSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  }
+  else
+    glBufferSubData(GL_COPY_WRITE_BUFFER, iOffset, iSize, iData);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
 // ----------------------------------------------------------------------------
 // UploadOrCreateTBO
 // ----------------------------------------------------------------------------
@@ -1225,7 +2223,7 @@ int PathTracer::UploadOrCreateTBO( GLTextureBuffer & ioTBO, GLsizeiptr iSize, co
 int PathTracer::ReloadEnvMap()
 {
   GLUtil::DeleteTEX(_EnvMapTEX);
-  GLUtil::DeleteTEX(_EnvMapCDFTEX);
+  GLUtil::DeleteTEX(_EnvMapAliasTEX);
 
   if ( _Scene.GetEnvMap().IsInitialized() )
   {
@@ -1244,18 +2242,19 @@ int PathTracer::ReloadEnvMap()
 
     _Scene.GetEnvMap().SetHandle(_EnvMapTEX._Handle);
 
-    GLTextureDesc cdfDesc;
-    cdfDesc._Target         = _EnvMapCDFTEX._Target;
-    cdfDesc._Slot           = _EnvMapCDFTEX._Slot;
-    cdfDesc._Width          = _Scene.GetEnvMap().GetWidth();
-    cdfDesc._Height         = _Scene.GetEnvMap().GetHeight();
-    cdfDesc._InternalFormat = _EnvMapCDFTEX._InternalFormat;
-    cdfDesc._DataFormat     = _EnvMapCDFTEX._DataFormat;
-    cdfDesc._DataType       = _EnvMapCDFTEX._DataType;
-    cdfDesc._Data           = _Scene.GetEnvMap().GetCDF();
-    cdfDesc._MinFilter      = GL_NEAREST;
-    cdfDesc._MagFilter      = GL_NEAREST;
-    GLUtil::CreateTexture(cdfDesc, _EnvMapCDFTEX);
+    // Alias table per row, the rows alias table in the last row
+    GLTextureDesc aliasDesc;
+    aliasDesc._Target         = _EnvMapAliasTEX._Target;
+    aliasDesc._Slot           = _EnvMapAliasTEX._Slot;
+    aliasDesc._Width          = _Scene.GetEnvMap().GetAliasTableWidth();
+    aliasDesc._Height         = _Scene.GetEnvMap().GetAliasTableHeight();
+    aliasDesc._InternalFormat = _EnvMapAliasTEX._InternalFormat;
+    aliasDesc._DataFormat     = _EnvMapAliasTEX._DataFormat;
+    aliasDesc._DataType       = _EnvMapAliasTEX._DataType;
+    aliasDesc._Data           = _Scene.GetEnvMap().GetAliasTable();
+    aliasDesc._MinFilter      = GL_NEAREST;
+    aliasDesc._MagFilter      = GL_NEAREST;
+    GLUtil::CreateTexture(aliasDesc, _EnvMapAliasTEX);
   }
   else
     _Settings._EnableSkybox = false;
@@ -1263,25 +2262,6 @@ int PathTracer::ReloadEnvMap()
   return 0;
 }
 
-// ----------------------------------------------------------------------------
-// NextTile
-// ----------------------------------------------------------------------------
-void PathTracer::NextTile()
-{
-  _CurTile.x++;
-  if ( _CurTile.x >= NbTiles().x )
-  {
-    _CurTile.x = 0;
-    _CurTile.y--;
-    if ( _CurTile.y < 0 )
-    {
-      _CurTile.x = 0;
-      _CurTile.y = NbTiles().y - 1;
-      _NbCompleteFrames++;
-    }
-  }
-}
-
 // ----------------------------------------------------------------------------
 // ResetTiles
 // ----------------------------------------------------------------------------
@@ -1289,7 +2269,9 @@ void PathTracer::ResetTiles()
 {
   _CurTile.x = -1;
   _CurTile.y = NbTiles().y - 1;
+  _TileScheduler.Reset(( TiledRendering() ) ? ( NbTiles() ) : ( Vec2i(0) ));
   _NbCompleteFrames = 0;
+  this -> DiscardTileErrors();
 }
 
 }
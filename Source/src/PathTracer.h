@@ -5,15 +5,21 @@
 #include "RenderSettings.h"
 #include "QuadMesh.h"
 #include "GLUtil.h"
+#include "GLStagingBuffer.h"
+#include "TileScheduler.h"
 
 #include "GL/glew.h"
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace RTRT
 {
 
 class Scene;
+struct AccumulationCheckpoint;
 
 struct PathTracerTexSlot
 {
@@ -46,8 +52,13 @@ struct PathTracerTexSlot
   static const TextureSlot _BLASPackedNormals       = 26;
   static const TextureSlot _BLASPackedUVs           = 27;
   static const TextureSlot _EnvMap                  = 28;
-  static const TextureSlot _EnvMapCDF               = 29;
+  static const TextureSlot _EnvMapAlias             = 29;
+  static const TextureSlot _AccumulateMoments       = 30;
   static const TextureSlot _Temporary               = 31;
+  static const TextureSlot _SVGFHistory0            = 32; // 4 slots : color, moments, normals, positions
+  static const TextureSlot _SVGFHistory1            = 36; // 4 slots
+  static const TextureSlot _Atrous0                 = 40;
+  static const TextureSlot _Atrous1                 = 41;
 };
 
 class PathTracer : public Renderer
@@ -62,18 +73,26 @@ public:
 
   virtual int RenderToTexture() override;
   virtual int DenoiseOutput();
+  int DenoiseTemporal();
   virtual int RenderToScreen() override;
   virtual int RenderToFile( const std::filesystem::path & iFilePath ) override;
   virtual int ReadbackFinalColor( RenderImage & oImage ) override;
 
   unsigned int GetNbCompleteFrames()  const { return _NbCompleteFrames; }
   unsigned int GetFrameNum()          const { return _FrameNum; }
+  unsigned int GetNbRenderedFrames()  const { return _NbRenderedFrames; }
   double GetPathTraceTime()           const { return _PathTraceTime; }
   double GetAccumulateTime()          const { return _AccumulateTime; }
   double GetDenoiseTime()             const { return _DenoiseTime; }
   double GetRenderToScreenTime()      const { return _RenderToScreenTime; }
+  const TileScheduler & GetTileScheduler() const { return _TileScheduler; }
+  int GetNbTilesThisFrame()           const { return (int)_RenderedTiles.size(); }
   virtual int GetRenderPassTimings( std::vector<RenderPassTiming> & oTimings ) const override;
 
+  // Accumulation checkpoints : accumulation layers, sample and frame counts and RNG frame index. A resumed render continues with the same samples.
+  int SaveCheckpoint( const std::filesystem::path & iPath );
+  int LoadCheckpoint( const std::filesystem::path & iPath );
+
   virtual PathTracer * AsPathTracer() override { return this; }
 
 protected:
@@ -91,12 +110,16 @@ protected:
 
   int UploadTLASData();
   int UploadTLASTransforms();
+  int UploadTLASRanges();
+  void UploadBufferRange( GLuint iBuffer, GLintptr iOffset, GLsizeiptr iSize, const void * iData );
   int UploadOrCreateTBO( GLTextureBuffer & ioTBO, GLsizeiptr iSize, const void * iData, GLenum iInternalformat );
 
   int UpdatePathTraceUniforms();
+  int UpdatePathTraceUniforms( ShaderProgram & ioShader );
   int UpdateAccumulateUniforms();
   int UpdateDenoiserUniforms();
   int UpdateRenderToScreenUniforms();
+  int UpdateTileUniforms( unsigned int iTileSamples );
 
   int BindPathTraceTextures();
   int BindAccumulateTextures();
@@ -104,27 +127,51 @@ protected:
   int BindDenoiserImageTextures();
   int BindRenderToScreenTextures();
 
+  int ResizeWavefrontBuffers( int iCapacity, int iNbBuckets );
+  int DeleteWavefrontBuffers();
+  int PathTraceWavefront( const GLTexture & iColor, const GLTexture * iNormals, const GLTexture * iPos, int iWidth, int iHeight );
+
+  int RenderTiles();
+  void QueueTileErrors();
+  void ReadTileErrors();
+  void DiscardTileErrors();
+  void ReleaseTileErrors();
+
+  void FillCheckpoint( AccumulationCheckpoint & oCheckpoint ) const;
+
   int InitializeStats();
   int UpdateStats();
   void BeginTimer( GLuint iTimerId[2] );
   void EndTimer( GLuint iTimerId[2] );
   double ReadTimer( GLuint iTimerId[2] );
+  void BeginWavefrontTimer( int iStage );
+  void EndWavefrontTimer( int iStage );
 
   float LowResRenderScale() const { return ( RenderScale() * _Settings._LowResRatio ); }
 
-  bool LowResPass()         const { return ( Dirty() && !_Settings._AutoScale ); }
+  bool LowResPass()         const { return ( Dirty() && !_Settings._AutoScale && !TemporalDenoise() ); }
   int LowResRenderWidth()   const { return std::max(int( _Settings._RenderResolution.x * LowResRenderScale() ), 32); }
   int LowResRenderHeight()  const { return std::max(int( _Settings._RenderResolution.y * LowResRenderScale() ), 32); }
 
   bool Denoise()            const { return (_Settings._Denoise); }// && !LowResPass());}
 
+  // SVGF integrates full resolution frames over time : no low resolution pass, no tiles, no skipped pixels
+  bool TemporalDenoise()    const { return ( Denoise() && ( 3 == _Settings._DenoisingMethod ) && !TiledRendering() ); }
+
+  // Accumulated samples seed the RNG : the n-th sample of a pixel does not depend on the frames rendered before, nor on a resume
+  unsigned int RNGFrameIndex() const { return ( Dirty() ) ? ( _FrameNum ) : ( _NbCompleteFrames ); }
+
+  bool AdaptiveSampling()   const { return ( _Settings._AdaptiveSampling && _Settings._Accumulate && !Dirty() && ( _NbCompleteFrames > 0 ) && !TemporalDenoise() ); }
+
+  // The debug views 2..7 are only drawn by the fragment path tracer
+  bool Wavefront()          const { return ( _Settings._WavefrontPathTracing && _WavefrontSupported && ( ( _DebugMode < 2 ) || ( _DebugMode > 7 ) ) ); }
+
   bool TiledRendering()     const { return _Settings._TiledRendering; }
   int TileWidth()           const { return ( _Settings._TileResolution.x > 0 ) ? ( _Settings._TileResolution.x ) : ( 64 ); }
   int TileHeight()          const { return ( _Settings._TileResolution.y > 0 ) ? ( _Settings._TileResolution.y ) : ( 64 ); }
   Vec2i NbTiles()           const { return Vec2i(std::ceil(((float)RenderWidth())/_Settings._TileResolution.x), std::ceil(((float)RenderHeight())/_Settings._TileResolution.y)); }
   Vec2  TileOffset()        const { return Vec2(_CurTile.x * InvNbTiles().x, _CurTile.y * InvNbTiles().y); }
   Vec2  InvNbTiles()        const { return Vec2(((float)_Settings._TileResolution.x)/RenderWidth(), ((float)_Settings._TileResolution.y)/RenderHeight()); }
-  void  NextTile();
   void  ResetTiles();
 
 protected:
@@ -137,6 +184,8 @@ protected:
   GLFrameBuffer _RenderTargetTileFBO;
   GLFrameBuffer _AccumulateFBO;
   GLFrameBuffer _DenoiseFBO;
+  GLFrameBuffer _SVGFHistoryFBO[2];
+  GLFrameBuffer _AtrousFBO[2];
 
   // Texture buffers
   GLTextureBuffer _VtxTBO                     = { 0, { 0, GL_TEXTURE_BUFFER, PathTracerTexSlot::_Vertices               } };
@@ -176,26 +225,97 @@ protected:
     { 0, GL_TEXTURE_2D, PathTracerTexSlot::_AccumulateNormals, GL_RGBA32F, GL_RGBA, GL_FLOAT },
     { 0, GL_TEXTURE_2D, PathTracerTexSlot::_AccumulatePos,     GL_RGBA32F, GL_RGBA, GL_FLOAT }
   };
+  GLTexture _AccumulateMomentsTEX = { 0, GL_TEXTURE_2D, PathTracerTexSlot::_AccumulateMoments, GL_RGBA32F, GL_RGBA, GL_FLOAT };
   GLTexture _DenoisedTEX         = { 0, GL_TEXTURE_2D, PathTracerTexSlot::_Denoised,         GL_RGBA32F, GL_RGBA, GL_FLOAT };
   GLTexture _TexArrayTEX         = { 0, GL_TEXTURE_2D_ARRAY, PathTracerTexSlot::_TexArray,   GL_RGBA8,   GL_RGBA, GL_UNSIGNED_BYTE };
   GLTexture _MaterialsTEX        = { 0, GL_TEXTURE_2D, PathTracerTexSlot::_Materials,        GL_RGBA32F, GL_RGBA, GL_FLOAT };
   GLTexture _TLASTransformsIDTEX = { 0, GL_TEXTURE_2D, PathTracerTexSlot::_TLASTransformsID, GL_RGBA32F, GL_RGBA, GL_FLOAT };
   GLTexture _EnvMapTEX           = { 0, GL_TEXTURE_2D, PathTracerTexSlot::_EnvMap,           GL_RGB32F,  GL_RGB,  GL_FLOAT };
-  GLTexture _EnvMapCDFTEX        = { 0, GL_TEXTURE_2D, PathTracerTexSlot::_EnvMapCDF,        GL_R32F,    GL_RED,  GL_FLOAT };
+  GLTexture _EnvMapAliasTEX      = { 0, GL_TEXTURE_2D, PathTracerTexSlot::_EnvMapAlias,      GL_RG32F,   GL_RG,   GL_FLOAT };
+  GLTexture _SVGFHistoryTEX[2][4] =
+  {
+    {
+      { 0, GL_TEXTURE_2D, PathTracerTexSlot::_SVGFHistory0,     GL_RGBA32F, GL_RGBA, GL_FLOAT },
+      { 0, GL_TEXTURE_2D, PathTracerTexSlot::_SVGFHistory0 + 1, GL_RGBA32F, GL_RGBA, GL_FLOAT },
+      { 0, GL_TEXTURE_2D, PathTracerTexSlot::_SVGFHistory0 + 2, GL_RGBA32F, GL_RGBA, GL_FLOAT },
+      { 0, GL_TEXTURE_2D, PathTracerTexSlot::_SVGFHistory0 + 3, GL_RGBA32F, GL_RGBA, GL_FLOAT }
+    },
+    {
+      { 0, GL_TEXTURE_2D, PathTracerTexSlot::_SVGFHistory1,     GL_RGBA32F, GL_RGBA, GL_FLOAT },
+      { 0, GL_TEXTURE_2D, PathTracerTexSlot::_SVGFHistory1 + 1, GL_RGBA32F, GL_RGBA, GL_FLOAT },
+      { 0, GL_TEXTURE_2D, PathTracerTexSlot::_SVGFHistory1 + 2, GL_RGBA32F, GL_RGBA, GL_FLOAT },
+      { 0, GL_TEXTURE_2D, PathTracerTexSlot::_SVGFHistory1 + 3, GL_RGBA32F, GL_RGBA, GL_FLOAT }
+    }
+  };
+  GLTexture _AtrousTEX[2] =
+  {
+    { 0, GL_TEXTURE_2D, PathTracerTexSlot::_Atrous0, GL_RGBA32F, GL_RGBA, GL_FLOAT },
+    { 0, GL_TEXTURE_2D, PathTracerTexSlot::_Atrous1, GL_RGBA32F, GL_RGBA, GL_FLOAT }
+  };
 
   // Shaders
   std::unique_ptr<ShaderProgram> _PathTraceShader;
   std::unique_ptr<ShaderProgram> _AccumulateShader;
   std::unique_ptr<ShaderProgram> _DenoiserShader;
+  std::unique_ptr<ShaderProgram> _DenoiserComputeShader; // OpenGL 4.3
   std::unique_ptr<ShaderProgram> _RenderToScreenShader;
+  std::unique_ptr<ShaderProgram> _SVGFTemporalShader;
+  std::unique_ptr<ShaderProgram> _SVGFAtrousShader;
+
+  // Wavefront path tracing
+  enum WavefrontStage { WavefrontGenerate = 0, WavefrontExtend, WavefrontSort, WavefrontShade, WavefrontShadow, WavefrontStageCount };
+
+  std::unique_ptr<ShaderProgram> _WavefrontGenerateShader;
+  std::unique_ptr<ShaderProgram> _WavefrontExtendShader;
+  std::unique_ptr<ShaderProgram> _WavefrontQueueShader;
+  std::unique_ptr<ShaderProgram> _WavefrontShadeShader;
+  std::unique_ptr<ShaderProgram> _WavefrontShadowShader;
+  std::unique_ptr<ShaderProgram> _WavefrontResolveShader;
+  bool         _WavefrontSupported     = false;
+  bool         _WavefrontThisFrame     = false;
+
+  GLuint       _WavefrontPathsBuffer         = 0; // One path per pixel of the target
+  GLuint       _WavefrontHitsBuffer          = 0;
+  GLuint       _WavefrontRayQueuesBuffer     = 0; // Two ray queues, ping-ponged every bounce
+  GLuint       _WavefrontMaterialQueueBuffer = 0;
+  GLuint       _WavefrontShadowRaysBuffer    = 0; // Two shadow rays per path at most
+  GLuint       _WavefrontCountersBuffer      = 0; // Queue sizes and indirect dispatch arguments
+  GLuint       _WavefrontBucketsBuffer       = 0; // Material bucket counts and offsets
+  int          _WavefrontCapacity            = 0;
+  int          _WavefrontNbBuckets           = 0;
+
+  // SVGF : history written this frame, read from the other one, and the camera it was rendered with
+  int          _SVGFHistoryIndex      = 0;
+  bool         _SVGFHistoryValid      = false;
+  Vec3         _SVGFPrevCameraPos;
+  Vec3         _SVGFPrevCameraRight;
+  Vec3         _SVGFPrevCameraUp;
+  Vec3         _SVGFPrevCameraForward;
+  float        _SVGFPrevCameraScale   = 1.f;
 
   // Tiled rendering
   Vec2i        _CurTile;
   Vec2i        _NbTiles;
+  TileScheduler _TileScheduler;
+  std::vector<int> _RenderedTiles;  // Tiles rendered during the current frame
+
+  // Tile error readback : luminance moments copied into a PBO ring, mapped once the GPU is done
+  struct TileErrorSlot
+  {
+    GLuint           _PBO      = 0;
+    GLsync           _Fence    = nullptr;
+    GLsizeiptr       _Capacity = 0;
+    std::vector<int> _Tiles;
+    std::vector<int> _NbPixels;
+  };
+  static constexpr int S_NbTileErrorSlots = 3;
+  std::array<TileErrorSlot, S_NbTileErrorSlots> _TileErrorSlots;
+  int _TileErrorSlot = 0;  // Written by the current frame
 
   // Accumulate
   unsigned int _FrameNum          = 1;
   unsigned int _NbCompleteFrames  = 0;
+  unsigned int _NbRenderedFrames  = 0;        // Since the accumulation was reset, tiled rendering included
   bool         _DenoisedThisFrame = false;
   bool         _PathTraceTimerWritten = false;
   bool         _AccumulateTimerWritten = false;
@@ -205,18 +325,31 @@ protected:
   // Scene data
   int _NbTriangles     = 0;
   int _NbMeshInstances = 0;
+  std::uint64_t _SyncedMeshInstanceGeneration = 0;
+
+  // Incremental TLAS upload : refitted node and packed instance ranges go through the staging ring
+  GLStagingBuffer    _TLASStaging;
+  std::vector<int>   _DirtyInstanceIDs;
+  std::vector<int>   _DirtyTLASNodes;
+  std::vector<int>   _DirtyTLASInstances;
+  std::vector<Vec2i> _DirtyTLASRanges;
 
   // Stats
   double _PathTraceTime      = 0.;
   double _AccumulateTime     = 0.;
   double _DenoiseTime        = 0.;
   double _RenderToScreenTime = 0.;
+  double _WavefrontTime[WavefrontStageCount] = {};
 
   GLuint _PathTraceTimeId[2]      = { 0, 0 };
   GLuint _AccumulateTimeId[2]     = { 0, 0 };
   GLuint _DenoiseTimeId[2]        = { 0, 0 };
   GLuint _RenderToScreenTimeId[2] = { 0, 0 };
 
+  // Wavefront stages run once per bounce : one timer pair per dispatch, summed by UpdateStats
+  std::vector<GLuint> _WavefrontTimeIds[WavefrontStageCount];
+  int                 _NbWavefrontTimers[WavefrontStageCount] = {};
+
 };
 
 }
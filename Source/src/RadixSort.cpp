@@ -0,0 +1,122 @@
+#include "RadixSort.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace RTRT
+{
+
+static const int S_RadixBits      = 8;
+static const int S_RadixSize      = 1 << S_RadixBits;
+static const int S_MinItemsPerJob = 16384;
+
+// ----------------------------------------------------------------------------
+// Local helpers
+// ----------------------------------------------------------------------------
+template <typename Func>
+static void RunJobs( int iNbJobs, const Func & iFunc )
+{
+  if ( iNbJobs <= 1 )
+  {
+    iFunc(0);
+    return;
+  }
+
+  for ( int job = 1; job < iNbJobs; ++job )
+    JobSystem::Get().Execute([&iFunc, job]() { iFunc(job); });
+  iFunc(0);
+  JobSystem::Get().Wait();
+}
+
+// ----------------------------------------------------------------------------
+// Sort
+// ----------------------------------------------------------------------------
+int RadixSorter::Sort( std::vector<uint32_t> & ioKeys, std::vector<int> & ioValues, int iKeyBits )
+{
+  const int nbItems = static_cast<int>(ioKeys.size());
+  if ( nbItems != static_cast<int>(ioValues.size()) )
+    return 1;
+
+  _LastNbJobs = 0;
+  if ( nbItems < 2 )
+    return 0;
+
+  int nbJobs = 1;
+  if ( _AllowJobs && JobSystem::Get().IsInitialized() )
+    nbJobs = std::clamp(nbItems / S_MinItemsPerJob, 1, static_cast<int>(JobSystem::Get().GetThreadCount()));
+  const int itemsPerJob = ( nbItems + nbJobs - 1 ) / nbJobs;
+  _LastNbJobs = nbJobs;
+
+  _TmpKeys.resize(nbItems);
+  _TmpValues.resize(nbItems);
+  _Histograms.resize(nbJobs);
+
+  uint32_t * srcKeys = ioKeys.data();
+  int * srcValues = ioValues.data();
+  uint32_t * dstKeys = _TmpKeys.data();
+  int * dstValues = _TmpValues.data();
+
+  const int nbPasses = ( std::clamp(iKeyBits, 1, 32) + S_RadixBits - 1 ) / S_RadixBits;
+  for ( int pass = 0; pass < nbPasses; ++pass )
+  {
+    const int shift = pass * S_RadixBits;
+
+    RunJobs(nbJobs, [&]( int iJob )
+    {
+      std::array<uint32_t, 256> & histogram = _Histograms[iJob];
+      histogram.fill(0u);
+      const int first = iJob * itemsPerJob;
+      const int last = std::min(nbItems, first + itemsPerJob);
+      for ( int i = first; i < last; ++i )
+        histogram[( srcKeys[i] >> shift ) & ( S_RadixSize - 1 )]++;
+    });
+
+    // Bin-major, then job order : every job scatters after the previous ones, which keeps the sort stable
+    uint32_t offset = 0;
+    bool singleBin = false;
+    for ( int bin = 0; bin < S_RadixSize; ++bin )
+    {
+      uint32_t binCount = 0;
+      for ( int job = 0; job < nbJobs; ++job )
+      {
+        const uint32_t count = _Histograms[job][bin];
+        _Histograms[job][bin] = offset;
+        offset += count;
+        binCount += count;
+      }
+      if ( binCount == static_cast<uint32_t>(nbItems) )
+        singleBin = true;
+    }
+
+    // Every key shares this digit : the pass would copy the input as is
+    if ( singleBin )
+      continue;
+
+    RunJobs(nbJobs, [&]( int iJob )
+    {
+      std::array<uint32_t, 256> & offsets = _Histograms[iJob];
+      const int first = iJob * itemsPerJob;
+      const int last = std::min(nbItems, first + itemsPerJob);
+      for ( int i = first; i < last; ++i )
+      {
+        const uint32_t dst = offsets[( srcKeys[i] >> shift ) & ( S_RadixSize - 1 )]++;
+        dstKeys[dst] = srcKeys[i];
+        dstValues[dst] = srcValues[i];
+      }
+    });
+
+    std::swap(srcKeys, dstKeys);
+    std::swap(srcValues, dstValues);
+  }
+
+  if ( srcKeys != ioKeys.data() )
+  {
+    std::copy(srcKeys, srcKeys + nbItems, ioKeys.data());
+    std::copy(srcValues, srcValues + nbItems, ioValues.data());
+  }
+
+  return 0;
+}
+
+}
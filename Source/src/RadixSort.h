@@ -0,0 +1,33 @@
+#ifndef _RadixSort_
+#define _RadixSort_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace RTRT
+{
+
+// Stable LSD radix sort of key/value pairs, 8 bits per pass.
+// Equal keys keep their input order : feeding the previous order keeps ties stable between frames.
+// Large inputs split every pass over the JobSystem workers (per-job histograms, then per-job scatter).
+class RadixSorter
+{
+public:
+  int Sort( std::vector<uint32_t> & ioKeys, std::vector<int> & ioValues, int iKeyBits = 32 );
+
+  void SetAllowJobs( bool iAllow ) { _AllowJobs = iAllow; }
+  bool GetAllowJobs() const { return _AllowJobs; }
+  int GetLastNbJobs() const { return _LastNbJobs; }
+
+protected:
+  std::vector<uint32_t>                  _TmpKeys;
+  std::vector<int>                       _TmpValues;
+  std::vector<std::array<uint32_t, 256>> _Histograms; // Per job counts, then per job scatter offsets
+  bool                                   _AllowJobs = true;
+  int                                    _LastNbJobs = 0;
+};
+
+}
+
+#endif /* _RadixSort_ */
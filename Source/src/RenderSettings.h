@@ -20,6 +20,25 @@ enum class SamplingMode
   Trilinear
 };
 
+enum class EffectResolution
+{
+  Full = 0,
+  Half,
+  Quarter
+};
+
+enum class SSRTraceMode
+{
+  Linear = 0, // Fixed world space steps
+  HiZ         // Min-depth pyramid traversal
+};
+
+enum class TransparencyMode
+{
+  Sorted = 0,     // Back-to-front instances and triangles
+  WeightedBlended // Order independent, no sorting
+};
+
 struct RenderSettings
 {
   Vec2i        _RenderResolution      = { 0, 0 };
@@ -28,6 +47,7 @@ struct RenderSettings
   Vec3         _BackgroundColor       = { 0.f, 0.f, 0.f };
   Vec3         _UniformLightCol       = { .3f, .3f, .3f };
   Vec2i        _TextureSize           = { 2048, 2048 };
+  Vec3i        _LightClusterGrid      = { 16, 9, 24 };          // Deferred renderer. Screen tiles along x and y, depth slices.
   bool         _ShowLights            = false;                  // PathTracer
   bool         _EnableBackGround      = true;
   bool         _EnableSkybox          = true;
@@ -38,32 +58,46 @@ struct RenderSettings
   bool         _FXAA                  = false;
   bool         _Accumulate            = true;                   // PathTracer
   bool         _Denoise               = false;                  // PathTracer
+  bool         _AdaptiveSampling      = false;                  // PathTracer. Converged pixels stop being traced.
+  bool         _WavefrontPathTracing  = false;                  // PathTracer. Compute shader stages, needs OpenGL 4.3.
   bool         _TiledRendering        = false;
+  bool         _PrioritizedTiles      = true;                   // PathTracer. Tiles ordered by estimated error and distance to the screen center.
   bool         _ShadowMapping         = true;                   // Deferred renderer
   bool         _ShowShadowMap         = false;                  // Deferred renderer debug
   bool         _SSAO                  = true;                   // Deferred renderer
   bool         _SSAOBlur              = true;                   // Deferred renderer
   bool         _SSR                   = true;                   // Deferred renderer
+  EffectResolution _SSAOResolution    = EffectResolution::Full; // Deferred renderer
+  EffectResolution _SSRResolution     = EffectResolution::Full; // Deferred renderer
+  SSRTraceMode _SSRTraceMode          = SSRTraceMode::Linear;   // Deferred renderer
   bool         _SpecularIBL           = true;                   // Deferred renderer
   bool         _PBRDirectLighting     = true;                   // Deferred renderer
+  bool         _LightClustering       = false;                  // Deferred renderer
+  bool         _CompactGBuffer        = false;                  // Deferred renderer. Octahedral normals, positions rebuilt from depth.
   bool         _Transparency          = true;                   // Deferred and software renderers
+  TransparencyMode _TransparencyMode  = TransparencyMode::Sorted; // Deferred renderer
   SamplingMode _Sampling              = SamplingMode::Bilinear; // Raster
   bool         _WBuffer               = true;                   // Raster
   ShadingType  _ShadingType           = ShadingType::Phong;     // Raster
   int          _Bounces               = 1;                      // PathTracer
   int          _NbSamplesPerPixel     = 1;                      // PathTracer
+  int          _AdaptiveMinFrames     = 16;                     // PathTracer. Accumulated frames before a pixel may converge.
   int          _RenderScale           = 100;
   int          _ShadowMapResolution   = 1024;                   // Deferred renderer
   int          _MaxShadowCastingLights = 4;                     // Deferred renderer
+  int          _ShadowCascades        = 1;                      // Deferred renderer. Distant light cascades, 1 fits the whole scene.
   int          _SSAOKernelSize        = 16;                     // Deferred renderer
   int          _SSRMaxSteps           = 48;                     // Deferred renderer
   float        _LowResRatio           = 0.1f;                   // PathTracer
+  float        _ConvergenceThreshold  = 0.02f;                  // PathTracer. Relative standard error of the pixel luminance.
   float        _TargetFPS             = 60.f;
   float        _Gamma                 = 2.f;
   float        _Exposure              = 1.5f;
   float        _SkyBoxRotation        = 0.f;
   float        _ShadowBias            = 0.02f;                  // Deferred renderer
   float        _ShadowFar             = 0.f;                    // Deferred renderer. Auto-fit when <= 0.
+  float        _ShadowCascadeSplitLambda = 0.75f;               // Deferred renderer. 0 : uniform splits, 1 : logarithmic splits.
+  float        _ShadowCascadeDistance = 0.f;                    // Deferred renderer. Auto-fit when <= 0.
   float        _SSAORadius            = 0.5f;                   // Deferred renderer
   float        _SSAOBias              = 0.025f;                 // Deferred renderer
   float        _SSAOIntensity         = 1.0f;                   // Deferred renderer
@@ -76,14 +110,18 @@ struct RenderSettings
   float        _SpecularIBLIntensity  = 0.5f;                   // Deferred renderer
   float        _SpecularIBLMaxRoughness = 0.5f;                 // Deferred renderer
   float        _DirectLightIntensity  = 1.0f;                   // Deferred renderer
+  float        _LightClusterThreshold = 0.01f;                  // Deferred renderer. Radiance where a local light range ends.
   float        _DenoiserThreshold     = 0.05f;                  // PathTracer
   float        _DenoiserSigmaSpatial  = 2.0f;                   // PathTracer
   float        _DenoiserSigmaRange    = 0.1f;                   // PathTracer
   float        _DenoiserColorPhi      = 0.9f;                   // PathTracer
   float        _DenoiserNormalPhi     = 0.3f;                   // PathTracer
   float        _DenoiserPositionPhi   = 0.6f;                   // PathTracer
+  float        _DenoiserTemporalAlpha = 0.2f;                   // PathTracer. SVGF : minimum weight of a new frame while the view changes.
   unsigned int _DenoisingWaveletScale = 1;                      // PathTracer
-  unsigned int _DenoisingMethod       = 0;                      // PathTracer. 0: Bilateral, 1: Wavelet, 2: Edge-aware
+  unsigned int _DenoiserAtrousIterations = 4;                   // PathTracer. SVGF wavelet iterations.
+  unsigned int _DenoiserEdgeAwareIterations = 1;                // PathTracer. Edge-aware a-trous iterations.
+  unsigned int _DenoisingMethod       = 0;                      // PathTracer. 0: Bilateral, 1: Wavelet, 2: Edge-aware, 3: SVGF (temporal)
   unsigned int _NbThreads             = 1;                      // Raster
 
 };
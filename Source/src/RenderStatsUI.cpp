@@ -85,6 +85,9 @@ void DrawRenderPassTimings( Renderer * ioRenderer )
     }
     else
       ImGui::Text("%-24s : -- [%s]", timing._Name, timing._GPU ? "GPU" : "CPU");
+
+    if ( timing._Enabled && ( timing._NbTested > 0 ) )
+      ImGui::Text("  %-22s : %d / %d instances", "culled", timing._NbCulled, timing._NbTested);
   }
 
   ImGui::Text("CPU pass total        : %.3f ms", cpuTotal * 1000.);
@@ -103,6 +106,13 @@ void DrawPathTracerStats( Renderer * ioRenderer )
   ImGui::Separator();
   ImGui::Text("Frame number          : %d", pathTracer -> GetFrameNum());
   ImGui::Text("Nb complete frames    : %d", pathTracer -> GetNbCompleteFrames());
+
+  const TileScheduler & tiles = pathTracer -> GetTileScheduler();
+  if ( !tiles.GetSamples().empty() )
+  {
+    ImGui::Text("Tiles per frame       : %d", pathTracer -> GetNbTilesThisFrame());
+    ImGui::Text("Tile samples          : %u - %u", tiles.GetMinSamples(), tiles.GetMaxSamples());
+  }
 }
 
 void DrawSceneStats( Scene * ioScene )
@@ -32,6 +32,8 @@ struct RenderPassTiming
   bool         _GPU = false;
   bool         _Enabled = false;
   bool         _Inclusive = false;
+  int          _NbTested = 0; // Instances submitted to the pass culling, 0 when the pass does not cull
+  int          _NbCulled = 0;
 };
 
 struct RenderImage
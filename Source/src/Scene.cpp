@@ -6,6 +6,7 @@
 #include <iostream>
 #include <memory>
 #include <chrono>
+#include <cstring>
 
 namespace RTRT
 {
@@ -43,6 +44,7 @@ void Scene::Clear()
   _MeshInstances.clear();
   _PrimitiveNames.clear();
   _PrimitiveInstances.clear();
+  MarkAllMeshInstancesDirty();
 
   _NbFaces = 0;
   _Vertices.clear();
@@ -200,9 +202,75 @@ int Scene::AddMeshInstance( MeshInstance & iMeshInstance )
 {
   int instanceID = static_cast<int>(_MeshInstances.size());
   _MeshInstances.push_back(iMeshInstance);
+  MarkAllMeshInstancesDirty();
   return instanceID;
 }
 
+void Scene::SetMeshInstanceTransform( int iInstanceID, const Mat4x4 & iTransform )
+{
+  if ( ( iInstanceID < 0 ) || ( iInstanceID >= static_cast<int>(_MeshInstances.size()) ) )
+    return;
+
+  Mat4x4 & transform = _MeshInstances[iInstanceID]._Transform;
+  if ( 0 == std::memcmp(&transform, &iTransform, sizeof(Mat4x4)) )
+    return;
+
+  transform = iTransform;
+  MarkMeshInstanceDirty(iInstanceID);
+}
+
+void Scene::SetMeshInstanceVisible( int iInstanceID, bool iVisible )
+{
+  if ( ( iInstanceID < 0 ) || ( iInstanceID >= static_cast<int>(_MeshInstances.size()) ) )
+    return;
+
+  if ( _MeshInstances[iInstanceID]._Visible == iVisible )
+    return;
+
+  _MeshInstances[iInstanceID]._Visible = iVisible;
+  MarkMeshInstanceDirty(iInstanceID);
+}
+
+void Scene::MarkMeshInstanceDirty( int iInstanceID )
+{
+  if ( ( iInstanceID < 0 ) || ( iInstanceID >= static_cast<int>(_MeshInstances.size()) ) )
+    return;
+
+  // Instances were erased without MarkAllMeshInstancesDirty() : the stamps cannot be trusted anymore
+  if ( _MeshInstanceStamps.size() != _MeshInstances.size() )
+  {
+    MarkAllMeshInstancesDirty();
+    return;
+  }
+
+  _MeshInstanceGeneration++;
+  if ( _MeshInstanceStamps[iInstanceID] <= _DirtyHistoryGeneration )
+    _DirtyMeshInstances.push_back(iInstanceID);
+  _MeshInstanceStamps[iInstanceID] = _MeshInstanceGeneration;
+}
+
+void Scene::MarkAllMeshInstancesDirty()
+{
+  _MeshInstanceStamps.resize(_MeshInstances.size(), 0);
+  _MeshInstanceGeneration++;
+  _DirtyHistoryGeneration = _MeshInstanceGeneration;
+  _DirtyMeshInstances.clear();
+}
+
+bool Scene::GetDirtyMeshInstances( uint64_t iSinceGeneration, std::vector<int> & oInstanceIDs ) const
+{
+  oInstanceIDs.clear();
+  if ( ( iSinceGeneration < _DirtyHistoryGeneration ) || ( _MeshInstanceStamps.size() != _MeshInstances.size() ) )
+    return false;
+
+  for ( int instanceID : _DirtyMeshInstances )
+  {
+    if ( _MeshInstanceStamps[instanceID] > iSinceGeneration )
+      oInstanceIDs.push_back(instanceID);
+  }
+  return true;
+}
+
 int Scene::FindMaterialID( const std::string & iMateralName ) const
 {
   int matID = -1;
@@ -354,6 +422,21 @@ int Scene::RebuildTLASData()
   return 0;
 }
 
+int Scene::RefitTLASData( const std::vector<int> & iInstanceIDs, std::vector<int> & oNodeIDs, std::vector<int> & oPackedIDs )
+{
+  if ( 0 != _TLAS.Refit(_Meshes, _MeshInstances, iInstanceIDs, oNodeIDs, oPackedIDs) )
+    return 1;
+
+  const std::vector<MeshInstance> & packedInstances = _TLAS.GetPackedMeshInstances();
+  for ( int packedID : oPackedIDs )
+  {
+    _TLASPackedTransforms[packedID] = packedInstances[packedID]._Transform;
+    _TLASPackedMeshMatID[packedID]  = Vec2i(packedInstances[packedID]._MeshID, packedInstances[packedID]._MaterialID);
+  }
+
+  return 0;
+}
+
 void Scene::CompileMeshData( Vec2i iTextureArraySize, bool iBuildTextureArray, bool iBuildBVH )
 {
   auto startTime = std::chrono::system_clock::now();
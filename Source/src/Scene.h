@@ -13,6 +13,7 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <cstdint>
 
 namespace RTRT
 {
@@ -37,6 +38,16 @@ public:
   int AddMesh( const std::string& iFilename );
   int AddMeshInstance( MeshInstance & iMeshInstance );
 
+  // Mesh instance change tracking.
+  // The setters only flag an instance when its value actually changes; code writing through GetMeshInstances()
+  // must call MarkMeshInstanceDirty() for each edited instance, or MarkAllMeshInstancesDirty() after structural edits.
+  void SetMeshInstanceTransform( int iInstanceID, const Mat4x4 & iTransform );
+  void SetMeshInstanceVisible( int iInstanceID, bool iVisible );
+  void MarkMeshInstanceDirty( int iInstanceID );
+  void MarkAllMeshInstancesDirty();
+  uint64_t GetMeshInstanceGeneration() const { return _MeshInstanceGeneration; }
+  bool GetDirtyMeshInstances( uint64_t iSinceGeneration, std::vector<int> & oInstanceIDs ) const; // false : history lost, rescan everything
+
   int AddPrimitive( const Primitive & iPrimitive );
   int AddPrimitiveInstance( PrimitiveInstance & iPrimitiveInstance );
   int AddPrimitiveInstance( int iPrimitiveID, int iMaterialID, const Mat4x4 & iTransform );
@@ -78,6 +89,7 @@ public:
   // Compiled data
   void CompileMeshData( Vec2i iTextureArraySize = Vec2i(0), bool iBuildTextureArray = true, bool iBuildBVH = true );
   int RebuildTLASData();
+  int RefitTLASData( const std::vector<int> & iInstanceIDs, std::vector<int> & oNodeIDs, std::vector<int> & oPackedIDs ); // 1 : call RebuildTLASData()
   int GetNbFaces() const { return _NbFaces; }
   int GetNbCompiledTex() const { return _NbCompiledTex; }
   const std::vector<Vec3>          & GetVertices()               const { return _Vertices;                }
@@ -108,6 +120,12 @@ private:
   std::map<std::string,int>      _MaterialIDs;
   std::vector<MeshInstance>      _MeshInstances;
   std::map<std::string,int>      _PrimitiveNames;
+
+  // Instance change tracking
+  uint64_t                       _MeshInstanceGeneration = 1;
+  uint64_t                       _DirtyHistoryGeneration = 1; // Oldest generation the dirty list can answer for
+  std::vector<uint64_t>          _MeshInstanceStamps;         // Generation of the last change, per instance
+  std::vector<int>               _DirtyMeshInstances;         // Instances changed since _DirtyHistoryGeneration
   std::vector<PrimitiveInstance> _PrimitiveInstances;
 
   std::vector<Texture*>          _Textures;
@@ -0,0 +1,314 @@
+#include "ScenePicker.h"
+
+#include "Mesh.h"
+#include "Scene.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace RTRT
+{
+
+static const int S_StackCapacity = 64; // Initial traversal stack, grows on deeper trees
+
+// ----------------------------------------------------------------------------
+// Local helpers
+// ----------------------------------------------------------------------------
+static AABB<Vec3> TransformBounds( const AABB<Vec3> & iBounds, const Mat4x4 & iTransform )
+{
+  Vec3 corners[8];
+  iBounds.Corners(corners);
+
+  AABB<Vec3> bounds;
+  for ( const Vec3 & corner : corners )
+    bounds.Insert(MathUtil::TransformPoint(corner, iTransform));
+  return bounds;
+}
+
+static bool IsBoxOutsidePlanes( const Vec4 iPlanes[6], const Vec3 & iLow, const Vec3 & iHigh )
+{
+  for ( int i = 0; i < 6; ++i )
+  {
+    const Vec3 normal(iPlanes[i]);
+    const Vec3 farthest(( normal.x >= 0.f ) ? iHigh.x : iLow.x,
+                        ( normal.y >= 0.f ) ? iHigh.y : iLow.y,
+                        ( normal.z >= 0.f ) ? iHigh.z : iLow.z);
+    if ( glm::dot(normal, farthest) + iPlanes[i].w < 0.f )
+      return true;
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// Update
+// ----------------------------------------------------------------------------
+int ScenePicker::Update( Scene & ioScene )
+{
+  if ( &ioScene == _SyncedScene )
+  {
+    if ( ioScene.GetMeshInstanceGeneration() == _SyncedGeneration )
+      return 0;
+
+    // Instance edits refit the leaves they touch, structural changes rebuild the TLAS
+    if ( ioScene.GetDirtyMeshInstances(_SyncedGeneration, _DirtyInstanceIDs)
+      && ( 0 == _TLAS.Refit(ioScene.GetMeshes(), ioScene.GetMeshInstances(), _DirtyInstanceIDs, _DirtyNodeIDs, _DirtyPackedIDs) ) )
+    {
+      for ( int packedID : _DirtyPackedIDs )
+        SyncPackedInstance(ioScene.GetMeshes(), packedID);
+
+      _SyncedGeneration = ioScene.GetMeshInstanceGeneration();
+      return 0;
+    }
+  }
+
+  Reset();
+
+  std::vector<Mesh*> & meshes = ioScene.GetMeshes();
+  std::vector<MeshInstance> & meshInstances = ioScene.GetMeshInstances();
+  if ( 0 != _TLAS.Build(meshes, meshInstances) )
+    return 1;
+
+  const int nbPacked = static_cast<int>(_TLAS.GetPackedMeshInstances().size());
+  _PackedInstanceIDs = _TLAS.GetPackedMeshInstanceIDs();
+  _PackedMeshes.resize(nbPacked, nullptr);
+  _PackedInvTransforms.resize(nbPacked);
+  _PackedBounds.resize(nbPacked);
+
+  for ( int i = 0; i < nbPacked; ++i )
+    SyncPackedInstance(meshes, i);
+
+  _SyncedScene = &ioScene;
+  _SyncedGeneration = ioScene.GetMeshInstanceGeneration();
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// SyncPackedInstance
+// ----------------------------------------------------------------------------
+void ScenePicker::SyncPackedInstance( std::vector<Mesh*> & iMeshes, int iPackedIndex )
+{
+  const MeshInstance & instance = _TLAS.GetPackedMeshInstances()[iPackedIndex];
+  Mesh * mesh = iMeshes[instance._MeshID];
+
+  // Meshes only get a BLAS when the scene was compiled for ray tracing
+  std::shared_ptr<GpuBLAS> & blas = mesh -> GetBvh();
+  if ( blas && blas -> _Nodes.empty() && mesh -> GetNbFaces() )
+    mesh -> BuildBvh();
+
+  _PackedMeshes[iPackedIndex] = mesh;
+  _PackedInvTransforms[iPackedIndex] = glm::inverse(instance._Transform);
+  _PackedBounds[iPackedIndex] = TransformBounds(mesh -> GetBoundingBox(), instance._Transform);
+}
+
+// ----------------------------------------------------------------------------
+// Reset
+// ----------------------------------------------------------------------------
+void ScenePicker::Reset()
+{
+  _TLAS.Clear();
+  _PackedInstanceIDs.clear();
+  _PackedMeshes.clear();
+  _PackedInvTransforms.clear();
+  _PackedBounds.clear();
+  _SyncedScene = nullptr;
+  _SyncedGeneration = 0;
+}
+
+// ----------------------------------------------------------------------------
+// CastRay
+// ----------------------------------------------------------------------------
+bool ScenePicker::CastRay( const Vec3 & iRayOrigin, const Vec3 & iRayDir, ScenePickHit & oHit, const std::vector<unsigned char> * iPickable ) const
+{
+  oHit = ScenePickHit();
+
+  const std::vector<GpuBvh::Node> & nodes = _TLAS._Nodes;
+  if ( nodes.empty() )
+    return false;
+
+  std::vector<int> stack;
+  stack.reserve(S_StackCapacity);
+  stack.push_back(0);
+
+  while ( !stack.empty() )
+  {
+    const GpuBvh::Node & node = nodes[stack.back()];
+    stack.pop_back();
+
+    AABB<Vec3> nodeBounds;
+    nodeBounds._Low = node._BBoxMin;
+    nodeBounds._High = node._BBoxMax;
+    float boxHitT = 0.f;
+    if ( !MathUtil::IntersectRayAABB(iRayOrigin, iRayDir, nodeBounds, boxHitT) || ( boxHitT > oHit._Distance ) )
+      continue;
+
+    if ( node._LcRcLeaf.z < 0.f )
+    {
+      const int first = static_cast<int>(node._LcRcLeaf.x);
+      const int count = static_cast<int>(node._LcRcLeaf.y);
+      for ( int i = first; i < first + count; ++i )
+      {
+        const int instanceID = _PackedInstanceIDs[i];
+        if ( iPickable && ( ( instanceID >= static_cast<int>(iPickable -> size()) ) || !( *iPickable )[instanceID] ) )
+          continue;
+
+        IntersectInstance(i, iRayOrigin, iRayDir, oHit);
+      }
+    }
+    else
+    {
+      stack.push_back(static_cast<int>(node._LcRcLeaf.x));
+      stack.push_back(static_cast<int>(node._LcRcLeaf.y));
+    }
+  }
+
+  if ( oHit._InstanceID < 0 )
+    return false;
+
+  oHit._Position = iRayOrigin + iRayDir * oHit._Distance;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// IntersectInstance
+// ----------------------------------------------------------------------------
+bool ScenePicker::IntersectInstance( int iPackedIndex, const Vec3 & iRayOrigin, const Vec3 & iRayDir, ScenePickHit & ioHit ) const
+{
+  float boxHitT = 0.f;
+  if ( !MathUtil::IntersectRayAABB(iRayOrigin, iRayDir, _PackedBounds[iPackedIndex], boxHitT) || ( boxHitT > ioHit._Distance ) )
+    return false;
+
+  Mesh * mesh = _PackedMeshes[iPackedIndex];
+  const std::shared_ptr<GpuBLAS> & blas = mesh -> GetBvh();
+  if ( !blas || blas -> _Nodes.empty() )
+    return false;
+
+  // The local direction is not renormalized : hit distances stay in world units
+  const Mat4x4 & invTransform = _PackedInvTransforms[iPackedIndex];
+  const Vec3 localOrigin = Vec3(invTransform * Vec4(iRayOrigin, 1.f));
+  const Vec3 localDir = Vec3(invTransform * Vec4(iRayDir, 0.f));
+
+  const std::vector<GpuBvh::Node> & nodes = blas -> _Nodes;
+  const std::vector<Vec3i> & packedIndices = blas -> GetPackedTriangleIdx();
+  const std::vector<int> & packedTriangleIDs = blas -> GetPackedTriangleIDs();
+  const std::vector<Vec3> & vertices = mesh -> GetVertices();
+
+  bool hit = false;
+  std::vector<int> stack;
+  stack.reserve(S_StackCapacity);
+  stack.push_back(0);
+
+  while ( !stack.empty() )
+  {
+    const GpuBvh::Node & node = nodes[stack.back()];
+    stack.pop_back();
+
+    AABB<Vec3> nodeBounds;
+    nodeBounds._Low = node._BBoxMin;
+    nodeBounds._High = node._BBoxMax;
+    float nodeHitT = 0.f;
+    if ( !MathUtil::IntersectRayAABB(localOrigin, localDir, nodeBounds, nodeHitT) || ( nodeHitT > ioHit._Distance ) )
+      continue;
+
+    if ( node._LcRcLeaf.z > 0.f )
+    {
+      const int first = static_cast<int>(node._LcRcLeaf.x);
+      const int count = static_cast<int>(node._LcRcLeaf.y);
+      for ( int tri = first; tri < first + count; ++tri )
+      {
+        const Vec3i & i0 = packedIndices[tri * 3 + 0];
+        const Vec3i & i1 = packedIndices[tri * 3 + 1];
+        const Vec3i & i2 = packedIndices[tri * 3 + 2];
+
+        float triHitT = 0.f;
+        if ( !MathUtil::IntersectRayTriangle(localOrigin, localDir, vertices[i0.x], vertices[i1.x], vertices[i2.x], triHitT) )
+          continue;
+        if ( triHitT >= ioHit._Distance )
+          continue;
+
+        ioHit._Distance = triHitT;
+        ioHit._InstanceID = _PackedInstanceIDs[iPackedIndex];
+        ioHit._TriangleID = ( tri < static_cast<int>(packedTriangleIDs.size()) ) ? packedTriangleIDs[tri] : tri;
+        hit = true;
+      }
+    }
+    else
+    {
+      stack.push_back(static_cast<int>(node._LcRcLeaf.x));
+      stack.push_back(static_cast<int>(node._LcRcLeaf.y));
+    }
+  }
+
+  return hit;
+}
+
+// ----------------------------------------------------------------------------
+// SelectFrustum
+// ----------------------------------------------------------------------------
+int ScenePicker::SelectFrustum( const Mat4x4 & iViewProjection, std::vector<int> & oInstanceIDs, const std::vector<unsigned char> * iPickable ) const
+{
+  oInstanceIDs.clear();
+
+  const std::vector<GpuBvh::Node> & nodes = _TLAS._Nodes;
+  if ( nodes.empty() )
+    return 0;
+
+  // Clip planes, pointing inside : left, right, bottom, top, near, far
+  const Vec4 row0(iViewProjection[0][0], iViewProjection[1][0], iViewProjection[2][0], iViewProjection[3][0]);
+  const Vec4 row1(iViewProjection[0][1], iViewProjection[1][1], iViewProjection[2][1], iViewProjection[3][1]);
+  const Vec4 row2(iViewProjection[0][2], iViewProjection[1][2], iViewProjection[2][2], iViewProjection[3][2]);
+  const Vec4 row3(iViewProjection[0][3], iViewProjection[1][3], iViewProjection[2][3], iViewProjection[3][3]);
+  const Vec4 planes[6] = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+
+  std::vector<int> stack;
+  stack.reserve(S_StackCapacity);
+  stack.push_back(0);
+
+  while ( !stack.empty() )
+  {
+    const GpuBvh::Node & node = nodes[stack.back()];
+    stack.pop_back();
+    if ( IsBoxOutsidePlanes(planes, node._BBoxMin, node._BBoxMax) )
+      continue;
+
+    if ( node._LcRcLeaf.z < 0.f )
+    {
+      const int first = static_cast<int>(node._LcRcLeaf.x);
+      const int count = static_cast<int>(node._LcRcLeaf.y);
+      for ( int i = first; i < first + count; ++i )
+      {
+        const int instanceID = _PackedInstanceIDs[i];
+        if ( iPickable && ( ( instanceID >= static_cast<int>(iPickable -> size()) ) || !( *iPickable )[instanceID] ) )
+          continue;
+        if ( IsBoxOutsidePlanes(planes, _PackedBounds[i]._Low, _PackedBounds[i]._High) )
+          continue;
+
+        oInstanceIDs.push_back(instanceID);
+      }
+    }
+    else
+    {
+      stack.push_back(static_cast<int>(node._LcRcLeaf.x));
+      stack.push_back(static_cast<int>(node._LcRcLeaf.y));
+    }
+  }
+
+  std::sort(oInstanceIDs.begin(), oInstanceIDs.end());
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// BuildRegionMatrix
+// ----------------------------------------------------------------------------
+Mat4x4 ScenePicker::BuildRegionMatrix( const Vec2 & iNdcMin, const Vec2 & iNdcMax )
+{
+  const Vec2 size = glm::max(iNdcMax - iNdcMin, Vec2(1e-6f));
+
+  Mat4x4 region(1.f);
+  region[0][0] = 2.f / size.x;
+  region[1][1] = 2.f / size.y;
+  region[3][0] = -( iNdcMin.x + iNdcMax.x ) / size.x;
+  region[3][1] = -( iNdcMin.y + iNdcMax.y ) / size.y;
+  return region;
+}
+
+}
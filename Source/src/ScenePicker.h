@@ -0,0 +1,61 @@
+#ifndef _ScenePicker_
+#define _ScenePicker_
+
+#include "GpuBvh.h"
+#include "MathUtil.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace RTRT
+{
+
+class Scene;
+class Mesh;
+
+struct ScenePickHit
+{
+  int   _InstanceID = -1;
+  int   _TriangleID = -1; // Triangle index in the instance mesh
+  float _Distance = MAX_FLOAT;
+  Vec3  _Position = Vec3(0.f);
+};
+
+// Picking queries over the scene mesh instances.
+// A TLAS over the visible instances narrows the candidates, then the mesh BLAS gives the exact triangle hit.
+// Update() refits the TLAS for the instances changed since the last sync and rebuilds it after structural changes.
+class ScenePicker
+{
+public:
+  int Update( Scene & ioScene );
+  void Reset();
+
+  // iPickable, when given, is indexed by instance ID : instances set to 0 are ignored
+  bool CastRay( const Vec3 & iRayOrigin, const Vec3 & iRayDir, ScenePickHit & oHit, const std::vector<unsigned char> * iPickable = nullptr ) const;
+  int SelectFrustum( const Mat4x4 & iViewProjection, std::vector<int> & oInstanceIDs, const std::vector<unsigned char> * iPickable = nullptr ) const;
+
+  // Maps the [iNdcMin, iNdcMax] screen region to the whole clip space : region * viewProjection is a selection frustum
+  static Mat4x4 BuildRegionMatrix( const Vec2 & iNdcMin, const Vec2 & iNdcMax );
+
+  int GetNbInstances() const { return static_cast<int>(_PackedInstanceIDs.size()); }
+
+protected:
+  void SyncPackedInstance( std::vector<Mesh*> & iMeshes, int iPackedIndex );
+  bool IntersectInstance( int iPackedIndex, const Vec3 & iRayOrigin, const Vec3 & iRayDir, ScenePickHit & ioHit ) const;
+
+protected:
+  GpuTLAS                 _TLAS;
+  std::vector<int>        _PackedInstanceIDs;
+  std::vector<Mesh*>      _PackedMeshes;
+  std::vector<Mat4x4>     _PackedInvTransforms;
+  std::vector<AABB<Vec3>> _PackedBounds;
+  std::vector<int>        _DirtyInstanceIDs;
+  std::vector<int>        _DirtyNodeIDs;
+  std::vector<int>        _DirtyPackedIDs;
+  const Scene *           _SyncedScene = nullptr;
+  uint64_t                _SyncedGeneration = 0;
+};
+
+}
+
+#endif /* _ScenePicker_ */
@@ -169,6 +169,8 @@ int SoftwareRasterizer::Initialize()
     return 1;
   }
 
+  _Quad = std::make_unique<QuadMesh>();
+
   if (0 != InitializeFrameBuffers())
   {
     std::cout << "SoftwareRasterizer : Failed to initialize frame buffers !" << std::endl;
@@ -184,6 +186,20 @@ int SoftwareRasterizer::Initialize()
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// InitializeCPU
+// ----------------------------------------------------------------------------
+int SoftwareRasterizer::InitializeCPU()
+{
+  if (0 != ReloadScene())
+  {
+    std::cout << "SoftwareRasterizer : Failed to load scene !" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // Initialize
 // ----------------------------------------------------------------------------
@@ -262,11 +278,23 @@ int SoftwareRasterizer::Update()
   if (_DirtyStates & (unsigned long)DirtyState::SceneEnvMap)
     this->ReloadEnvMap();
 
-  if (_DirtyStates & (unsigned long)DirtyState::SceneInstances)
+  const std::uint64_t instanceGeneration = _Scene.GetMeshInstanceGeneration();
+  if ( ( _DirtyStates & (unsigned long)DirtyState::SceneInstances ) && ( instanceGeneration != _SyncedMeshInstanceGeneration ) )
   {
     const double refreshStartTime = glfwGetTime();
     _PassEnabled[TimingInstanceRefresh] = true;
-    if ( CanRefreshSceneInstanceTransforms() )
+    if ( _EnableIncrementalRefresh && _Scene.GetDirtyMeshInstances(_SyncedMeshInstanceGeneration, _DirtyMeshInstanceIDs) )
+    {
+      // Only the instances flagged since the last sync are re-transformed and re-bounded
+      if ( CanRefreshSceneInstanceTransforms(_DirtyMeshInstanceIDs) )
+      {
+        if ( 0 != this->RefreshSceneInstanceTransforms(_DirtyMeshInstanceIDs) )
+          return 1;
+      }
+      else if ( 0 != this->ReloadScene() )
+        return 1;
+    }
+    else if ( CanRefreshSceneInstanceTransforms() )
     {
       const int refreshResult = _EnableIncrementalRefresh ? this->RefreshSceneInstanceTransforms() : this->RefreshAllSceneInstanceTransforms();
       if ( 0 != refreshResult )
@@ -274,6 +302,7 @@ int SoftwareRasterizer::Update()
     }
     else if ( 0 != this->ReloadScene() )
       return 1;
+    _SyncedMeshInstanceGeneration = instanceGeneration;
     _PassTimes[TimingInstanceRefresh] = glfwGetTime() - refreshStartTime;
   }
 
@@ -604,7 +633,7 @@ int SoftwareRasterizer::RenderToTexture()
 
   this->BindRenderToTextureTextures();
 
-  _Quad.Render(*_RenderToTextureShader);
+  _Quad->Render(*_RenderToTextureShader);
 
   EndTimer(TimingCopyToRenderTarget);
 
@@ -652,7 +681,7 @@ int SoftwareRasterizer::RenderToScreen()
 
   this->BindRenderToScreenTextures();
 
-  _Quad.Render(*_RenderToScreenShader);
+  _Quad->Render(*_RenderToScreenShader);
 
   EndTimer(TimingCompositeScreen);
 
@@ -692,6 +721,67 @@ int SoftwareRasterizer::ReadbackFinalColor( RenderImage & oImage )
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// RenderRegions
+// ----------------------------------------------------------------------------
+int SoftwareRasterizer::RenderRegions( const std::vector<Vec4i> & iRegions )
+{
+  if ( ( RenderWidth() <= 0 ) || ( RenderHeight() <= 0 ) )
+    return 1;
+
+  // Tiles are rendered independently : a region comes out the same as in a full frame
+  _TileMask.clear();
+  if ( TiledRendering() && !iRegions.empty() )
+  {
+    const int tileSize = static_cast<int>(_TileSize);
+    _TileMask.assign(_Tiles.size(), 0);
+    for ( const Vec4i & region : iRegions )
+    {
+      const int tileXMin = std::max(0, region.x / tileSize);
+      const int tileYMin = std::max(0, region.y / tileSize);
+      const int tileXMax = std::min(_TileCountX - 1, ( region.x + region.z - 1 ) / tileSize);
+      const int tileYMax = std::min(_TileCountY - 1, ( region.y + region.w - 1 ) / tileSize);
+      for ( int ty = tileYMin; ty <= tileYMax; ++ty )
+      {
+        for ( int tx = tileXMin; tx <= tileXMax; ++tx )
+          _TileMask[ty * _TileCountX + tx] = 1;
+      }
+    }
+  }
+
+  const int result = this->UpdateImageBuffer();
+  _TileMask.clear();
+
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// ReadRegion
+// ----------------------------------------------------------------------------
+int SoftwareRasterizer::ReadRegion( const Vec4i & iRegion, std::vector<float> & oPixels ) const
+{
+  if ( ( iRegion.x < 0 ) || ( iRegion.y < 0 ) || ( iRegion.z <= 0 ) || ( iRegion.w <= 0 )
+    || ( iRegion.x + iRegion.z > RenderWidth() ) || ( iRegion.y + iRegion.w > RenderHeight() )
+    || ( _ImageBuffer._ColorBuffer.size() < (size_t)RenderWidth() * (size_t)RenderHeight() ) )
+    return 1;
+
+  oPixels.resize((size_t)iRegion.z * (size_t)iRegion.w * 4u);
+  for ( int y = 0; y < iRegion.w; ++y )
+  {
+    for ( int x = 0; x < iRegion.z; ++x )
+    {
+      const RGBA8 & color = _ImageBuffer._ColorBuffer[(size_t)(iRegion.y + y) * (size_t)RenderWidth() + (size_t)(iRegion.x + x)];
+      const size_t pixelIndex = ((size_t)y * (size_t)iRegion.z + (size_t)x) * 4u;
+      oPixels[pixelIndex + 0] = color._R / 255.f;
+      oPixels[pixelIndex + 1] = color._G / 255.f;
+      oPixels[pixelIndex + 2] = color._B / 255.f;
+      oPixels[pixelIndex + 3] = color._A / 255.f;
+    }
+  }
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // RenderToFile
 // ----------------------------------------------------------------------------
@@ -730,7 +820,7 @@ int SoftwareRasterizer::RenderToFile(const fs::path& iFilePath)
     glBindTexture(GL_TEXTURE_2D, temporaryTEX._Handle);
     this->BindRenderToScreenTextures();
 
-    _Quad.Render(*_RenderToScreenShader);
+    _Quad->Render(*_RenderToScreenShader);
   }
 
   // Retrieve image et save to file
@@ -896,6 +986,7 @@ int SoftwareRasterizer::ReloadScene()
 
   _CachedMeshInstanceCount = static_cast<int>(meshInstances.size());
   _CachedVisibleMeshInstanceCount = 0;
+  _SyncedMeshInstanceGeneration = _Scene.GetMeshInstanceGeneration();
   _InstanceRanges.resize(meshInstances.size());
   _Stats._InputInstances = meshInstances.size();
 
@@ -1057,72 +1148,147 @@ bool SoftwareRasterizer::CanRefreshSceneInstanceTransforms() const
 }
 
 // ----------------------------------------------------------------------------
-// RefreshSceneInstanceTransforms
+// CanRefreshSceneInstanceTransforms
 // ----------------------------------------------------------------------------
-int SoftwareRasterizer::RefreshSceneInstanceTransforms()
+bool SoftwareRasterizer::CanRefreshSceneInstanceTransforms( const std::vector<int> & iInstanceIDs ) const
 {
+  if ( _VertexSources.size() != _VertexBuffer.size() )
+    return false;
+
+  if ( _CachedMeshInstanceCount != _Scene.GetNbMeshInstances() )
+    return false;
+
+  if ( _InstanceRanges.size() != static_cast<size_t>(_CachedMeshInstanceCount) )
+    return false;
+
+  // Untouched instances still match the compiled ranges : checking the flagged ones is enough
   const std::vector<MeshInstance> & meshInstances = _Scene.GetMeshInstances();
   const std::vector<Mesh*>        & meshes        = _Scene.GetMeshes();
+  for ( int instID : iInstanceIDs )
+  {
+    const MeshInstance & meshInst = meshInstances[instID];
+    const CompiledInstanceRange & instanceRange = _InstanceRanges[instID];
+    if ( meshInst._Visible != instanceRange._Visible )
+      return false;
+    if ( meshInst._MeshID != instanceRange._MeshID )
+      return false;
+    if ( !meshInst._Visible )
+      continue;
+    if ( ( meshInst._MeshID < 0 ) || ( meshInst._MeshID >= static_cast<int>(meshes.size()) ) )
+      return false;
+    if ( !meshes[meshInst._MeshID] )
+      return false;
+  }
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// RefreshSceneInstanceTransforms
+// ----------------------------------------------------------------------------
+int SoftwareRasterizer::RefreshSceneInstanceTransforms( const std::vector<int> & iInstanceIDs )
+{
+  _Stats._ChangedInstances = 0;
+  _Stats._RefreshedVertices = 0;
+  _Stats._RefreshedTriangles = 0;
+
+  for ( int instID : iInstanceIDs )
+  {
+    if ( RefreshSceneInstance(instID) )
+      _Stats._ChangedInstances++;
+  }
+
+  if ( _Stats._ChangedInstances )
+    _FrameNum = 0;
+
+  return 0;
+}
 
+// ----------------------------------------------------------------------------
+// RefreshSceneInstanceTransforms
+// ----------------------------------------------------------------------------
+int SoftwareRasterizer::RefreshSceneInstanceTransforms()
+{
   _Stats._ChangedInstances = 0;
   _Stats._RefreshedVertices = 0;
   _Stats._RefreshedTriangles = 0;
 
   for ( int instID = 0; instID < static_cast<int>(_InstanceRanges.size()); ++instID )
   {
-    CompiledInstanceRange & instanceRange = _InstanceRanges[instID];
-    const MeshInstance & meshInst = meshInstances[instID];
-    const bool transformChanged = 0 != std::memcmp(&instanceRange._Transform, &meshInst._Transform, sizeof(Mat4x4));
-    const bool materialChanged = instanceRange._MaterialID != meshInst._MaterialID;
-    if ( !transformChanged && !materialChanged )
-      continue;
+    if ( RefreshSceneInstance(instID) )
+      _Stats._ChangedInstances++;
+  }
 
-    _Stats._ChangedInstances++;
-    Mesh * curMesh = meshes[meshInst._MeshID];
+  _FrameNum = 0;
 
-    const std::vector<Vec3> & vertices = curMesh -> GetVertices();
-    const std::vector<Vec3> & normals = curMesh -> GetNormals();
-    const Mat4x4 trInvTransfo = transformChanged ? glm::transpose(glm::inverse(meshInst._Transform)) : Mat4x4(1.f);
+  return 0;
+}
 
-    if ( transformChanged )
+// ----------------------------------------------------------------------------
+// RefreshSceneInstance
+// ----------------------------------------------------------------------------
+bool SoftwareRasterizer::RefreshSceneInstance( int iInstanceID )
+{
+  const std::vector<MeshInstance> & meshInstances = _Scene.GetMeshInstances();
+  const std::vector<Mesh*>        & meshes        = _Scene.GetMeshes();
+
+  CompiledInstanceRange & instanceRange = _InstanceRanges[iInstanceID];
+  const MeshInstance & meshInst = meshInstances[iInstanceID];
+  const bool transformChanged = 0 != std::memcmp(&instanceRange._Transform, &meshInst._Transform, sizeof(Mat4x4));
+  const bool materialChanged = instanceRange._MaterialID != meshInst._MaterialID;
+  if ( !transformChanged && !materialChanged )
+    return false;
+
+  // Hidden instances have no compiled geometry
+  if ( !instanceRange._VertexCount )
+  {
+    instanceRange._Transform = meshInst._Transform;
+    instanceRange._MaterialID = meshInst._MaterialID;
+    return true;
+  }
+
+  Mesh * curMesh = meshes[meshInst._MeshID];
+
+  const std::vector<Vec3> & vertices = curMesh -> GetVertices();
+  const std::vector<Vec3> & normals = curMesh -> GetNormals();
+  const Mat4x4 trInvTransfo = transformChanged ? glm::transpose(glm::inverse(meshInst._Transform)) : Mat4x4(1.f);
+
+  if ( transformChanged )
+  {
+    for ( int i = instanceRange._VertexStart; i < instanceRange._VertexStart + instanceRange._VertexCount; ++i )
     {
-      for ( int i = instanceRange._VertexStart; i < instanceRange._VertexStart + instanceRange._VertexCount; ++i )
+      const RasterSourceVertex & sourceVertex = _VertexSources[i];
+      Vec4 transformedVtx = meshInst._Transform * Vec4(vertices[sourceVertex._VertexID], 1.f);
+      _VertexBuffer[i]._WorldPos = Vec3(transformedVtx);
+      if ( ( sourceVertex._NormalID >= 0 ) && ( sourceVertex._NormalID < static_cast<int>(normals.size()) ) )
       {
-        const RasterSourceVertex & sourceVertex = _VertexSources[i];
-        Vec4 transformedVtx = meshInst._Transform * Vec4(vertices[sourceVertex._VertexID], 1.f);
-        _VertexBuffer[i]._WorldPos = Vec3(transformedVtx);
-        if ( ( sourceVertex._NormalID >= 0 ) && ( sourceVertex._NormalID < static_cast<int>(normals.size()) ) )
-        {
-          Vec4 transformedNormal = trInvTransfo * Vec4(normals[sourceVertex._NormalID], 0.f);
-          _VertexBuffer[i]._Normal = glm::normalize(Vec3(transformedNormal));
-        }
+        Vec4 transformedNormal = trInvTransfo * Vec4(normals[sourceVertex._NormalID], 0.f);
+        _VertexBuffer[i]._Normal = glm::normalize(Vec3(transformedNormal));
       }
-      _Stats._RefreshedVertices += instanceRange._VertexCount;
     }
+    _Stats._RefreshedVertices += instanceRange._VertexCount;
+  }
 
-    for ( int i = instanceRange._TriangleStart; i < instanceRange._TriangleStart + instanceRange._TriangleCount; ++i )
+  for ( int i = instanceRange._TriangleStart; i < instanceRange._TriangleStart + instanceRange._TriangleCount; ++i )
+  {
+    RasterData::Triangle & tri = _Triangles[i];
+    if ( transformChanged )
     {
-      RasterData::Triangle & tri = _Triangles[i];
-      if ( transformChanged )
-      {
-        const Vec3 & p0 = _VertexBuffer[tri._Indices[0]]._WorldPos;
-        const Vec3 & p1 = _VertexBuffer[tri._Indices[1]]._WorldPos;
-        const Vec3 & p2 = _VertexBuffer[tri._Indices[2]]._WorldPos;
-        tri._Normal = glm::normalize(glm::cross(p1 - p0, p2 - p0));
-      }
-      if ( materialChanged )
-        tri._MatID = meshInst._MaterialID;
+      const Vec3 & p0 = _VertexBuffer[tri._Indices[0]]._WorldPos;
+      const Vec3 & p1 = _VertexBuffer[tri._Indices[1]]._WorldPos;
+      const Vec3 & p2 = _VertexBuffer[tri._Indices[2]]._WorldPos;
+      tri._Normal = glm::normalize(glm::cross(p1 - p0, p2 - p0));
     }
-    _Stats._RefreshedTriangles += instanceRange._TriangleCount;
-    instanceRange._Transform = meshInst._Transform;
-    instanceRange._MaterialID = meshInst._MaterialID;
-    if ( transformChanged )
-      UpdateInstanceBounds(instanceRange);
+    if ( materialChanged )
+      tri._MatID = meshInst._MaterialID;
   }
+  _Stats._RefreshedTriangles += instanceRange._TriangleCount;
+  instanceRange._Transform = meshInst._Transform;
+  instanceRange._MaterialID = meshInst._MaterialID;
+  if ( transformChanged )
+    UpdateInstanceBounds(instanceRange);
 
-  _FrameNum = 0;
-
-  return 0;
+  return true;
 }
 
 // ----------------------------------------------------------------------------
@@ -1538,8 +1704,11 @@ int SoftwareRasterizer::RenderBackground(float iTop, float iRight)
 
     if (TiledRendering())
     {
-      for ( auto & tile : _Tiles )
-        JobSystem::Get().Execute([this, bottomLeft, dX, dY, &tile]() { this->RenderBackground(bottomLeft, dX, dY, tile); });
+      for ( unsigned int i = 0; i < _Tiles.size(); ++i )
+      {
+        if ( !IsTileSkipped(i) )
+          JobSystem::Get().Execute([this, bottomLeft, dX, dY, i]() { this->RenderBackground(bottomLeft, dX, dY, _Tiles[i]); });
+      }
       JobSystem::Get().Wait();
       _Stats._TileJobs += _Tiles.size();
     }
@@ -1576,6 +1745,8 @@ int SoftwareRasterizer::RenderUncoveredBackground(float iTop, float iRight)
   const auto renderTiles = [this, bottomLeft, dX, dY, backgroundColor](unsigned int iBegin, unsigned int iEnd) {
     for ( unsigned int tileIndex = iBegin; tileIndex < iEnd; ++tileIndex )
     {
+      if ( IsTileSkipped(tileIndex) )
+        continue;
       const rd::Tile & tile = _Tiles[tileIndex];
       for ( int y = 0; y < tile._Height; ++y )
       {
@@ -2917,6 +3088,8 @@ int SoftwareRasterizer::ProcessFragments()
     const auto processTiles = [this, &uniforms](unsigned int iBegin, unsigned int iEnd) {
       for ( unsigned int i = iBegin; i < iEnd; ++i )
       {
+        if ( IsTileSkipped(i) )
+          continue;
         if ( _Tiles[i]._Fragments.size() )
           this->ProcessFragments(_Tiles[i], uniforms);
         else
@@ -3192,6 +3365,8 @@ void SoftwareRasterizer::BinTrianglesToTiles(unsigned int iBufferIndex)
         if ((tx < _TileCountX) && (ty < _TileCountY))
         {
           int tileIndex = ty * _TileCountX + tx;
+          if ( IsTileSkipped(tileIndex) )
+            continue;
           rd::Tile& curTile = _Tiles[tileIndex];
           curTile._RasterTrisBins[iBufferIndex].push_back(&tri);
         }
@@ -114,6 +114,13 @@ public:
   void SetGenerateMipMaps(bool iGenerate);
   bool GetGenerateMipMaps() const { return _GenerateMipMaps; }
 
+  // CPU frame only, no OpenGL context needed : the distributed tile workers.
+  // Regions are (x, y, width, height) rectangles, only the raster tiles they overlap are rendered. Every tile when empty.
+  int InitializeCPU();
+  int RenderRegions( const std::vector<Vec4i> & iRegions );
+  // Colour buffer of a region, as ReadbackFinalColor but with rows from the bottom
+  int ReadRegion( const Vec4i & iRegion, std::vector<float> & oPixels ) const;
+
 protected:
 
   struct CompiledInstanceRange;
@@ -131,8 +138,11 @@ protected:
   int UnloadScene();
   int ReloadScene();
   int RefreshSceneInstanceTransforms();
+  int RefreshSceneInstanceTransforms( const std::vector<int> & iInstanceIDs );
   int RefreshAllSceneInstanceTransforms();
+  bool RefreshSceneInstance( int iInstanceID );
   bool CanRefreshSceneInstanceTransforms() const;
+  bool CanRefreshSceneInstanceTransforms( const std::vector<int> & iInstanceIDs ) const;
   int ReloadEnvMap();
 
   int UpdateTextures();
@@ -148,6 +158,7 @@ protected:
   void CopyTileToMainBuffer(const RasterData::Tile& iTile);
   void CopyTileToMainBuffer1x(const RasterData::Tile& iTile);
   bool TiledRendering()     const { return _Settings._TiledRendering; }
+  bool IsTileSkipped( unsigned int iTile ) const { return !_TileMask.empty() && !_TileMask[iTile]; }
   int TileWidth()           const { return (_Settings._TileResolution.x > 0) ? (_Settings._TileResolution.x) : (64); }
   int TileHeight()          const { return (_Settings._TileResolution.y > 0) ? (_Settings._TileResolution.y) : (64); }
   Vec2i NbTiles()           const { return Vec2i(std::ceil(((float)RenderWidth()) / _Settings._TileResolution.x), std::ceil(((float)RenderHeight()) / _Settings._TileResolution.y)); }
@@ -232,7 +243,7 @@ protected:
     AABB<Vec3> _WorldBounds;
   };
 
-  QuadMesh _Quad;
+  std::unique_ptr<QuadMesh> _Quad; // Created by Initialize : InitializeCPU runs without OpenGL context
 
   // Frame buffers
   GLFrameBuffer _RenderTargetFBO;
@@ -256,6 +267,7 @@ protected:
   int _TileCountX, _TileCountY;
   std::vector<RasterData::Tile> _Tiles;
   unsigned int _TileSize = 64;
+  std::vector<unsigned char> _TileMask; // RenderRegions : tiles to render, empty for all
   bool _EnableIncrementalRefresh = true;
   bool _EnableCompactHits = true;
   bool _EnableDirectColorWrites = true;
@@ -305,6 +317,8 @@ protected:
 
   // Scene data
   int                                                  _CachedMeshInstanceCount = 0;
+  std::uint64_t                                        _SyncedMeshInstanceGeneration = 0;
+  std::vector<int>                                     _DirtyMeshInstanceIDs;
   int                                                  _CachedVisibleMeshInstanceCount = 0;
   std::vector<RasterData::Vertex>                      _VertexBuffer;
   std::vector<RasterSourceVertex>                      _VertexSources;
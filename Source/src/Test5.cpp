@@ -373,6 +373,8 @@ int Test5::DrawUI()
 // ----------------------------------------------------------------------------
 void Test5::NotifyMeshInstanceEdited()
 {
+  if ( _Scene )
+    _Scene -> MarkMeshInstanceDirty(_SelectedMeshInstanceID);
   if ( _Renderer )
     _Renderer -> Notify(DirtyState::SceneInstances);
 }
@@ -569,9 +571,27 @@ int Test5::DrawSettingsUI()
       if ( ImGui::Checkbox( "Russian Roulette", &_Settings._RussianRoulette) )
         _Renderer -> Notify(DirtyState::RenderSettings);
 
+      if ( ImGui::Checkbox( "Wavefront (compute)", &_Settings._WavefrontPathTracing ) )
+        _Renderer -> Notify(DirtyState::RenderSettings);
+
       if ( ImGui::Checkbox( "Accumulate", &_Settings._Accumulate ) )
         _Renderer -> Notify(DirtyState::RenderSettings);
 
+      if ( _Settings._Accumulate )
+      {
+        if ( ImGui::Checkbox( "Adaptive sampling", &_Settings._AdaptiveSampling ) )
+          _Renderer -> Notify(DirtyState::RenderSettings);
+
+        if ( _Settings._AdaptiveSampling )
+        {
+          if ( ImGui::SliderFloat( "Convergence threshold", &_Settings._ConvergenceThreshold, 0.001f, 0.2f, "%.3f", ImGuiSliderFlags_Logarithmic ) )
+            _Renderer -> Notify(DirtyState::RenderSettings);
+
+          if ( ImGui::SliderInt( "Min frames", &_Settings._AdaptiveMinFrames, 1, 128 ) )
+            _Renderer -> Notify(DirtyState::RenderSettings);
+        }
+      }
+
       if ( ImGui::Checkbox( "Tiled rendering", &_Settings._TiledRendering ) )
       {
         if ( _Settings._TiledRendering && ( ( _Settings._TileResolution.x <= 0 ) || ( _Settings._TileResolution.y <= 0 ) ) )
@@ -587,6 +607,13 @@ int Test5::DrawSettingsUI()
           _Settings._TileResolution = Vec2i(tileSize);
           _Renderer -> Notify(DirtyState::RenderSettings);
         }
+
+        if ( ImGui::Checkbox("Prioritized tiles", &_Settings._PrioritizedTiles) )
+        {}
+
+        int targetFPS = (int)_Settings._TargetFPS;
+        if ( ImGui::SliderInt("Target FPS", &targetFPS, 1, 120) )
+          _Settings._TargetFPS = (float)targetFPS;
       }
 
       if ( ImGui::Checkbox( "Denoise", &_Settings._Denoise ) )
@@ -594,9 +621,9 @@ int Test5::DrawSettingsUI()
 
       if ( _Settings._Denoise )
       {
-        static const char * DENOISING_METHODS[] = { "Bilateral", "Wavelet", "Edge-aware" };
+        static const char * DENOISING_METHODS[] = { "Bilateral", "Wavelet", "Edge-aware", "SVGF (temporal)" };
         int denoisingMethod = (int)_Settings._DenoisingMethod;
-        if ( ImGui::Combo( "Denoising method", &denoisingMethod, DENOISING_METHODS, 3 ) )
+        if ( ImGui::Combo( "Denoising method", &denoisingMethod, DENOISING_METHODS, 4 ) )
         {
           _Settings._DenoisingMethod = denoisingMethod;
         }
@@ -627,6 +654,17 @@ int Test5::DrawSettingsUI()
 
           if ( ImGui::SliderFloat( "Position phi", &_Settings._DenoiserPositionPhi, 0.01f, 1.f ) )
           {}
+
+          if ( ImGui::SliderInt( "Iterations", (int*)&_Settings._DenoiserEdgeAwareIterations, 1, 5 ) )
+          {}
+        }
+        else if ( 3 == _Settings._DenoisingMethod )
+        {
+          if ( ImGui::SliderFloat( "Temporal alpha", &_Settings._DenoiserTemporalAlpha, 0.05f, 1.f ) )
+          {}
+
+          if ( ImGui::SliderInt( "A-trous iterations", (int*)&_Settings._DenoiserAtrousIterations, 1, 6 ) )
+          {}
         }
       }
     }
@@ -674,6 +712,33 @@ int Test5::DrawSettingsUI()
         if ( ImGui::SliderInt( "Anisotropic level", &anisoLevel, 1, 16 ) )
           deferredRenderer -> SetAnisotropicLevel(anisoLevel);
 
+        bool multiDrawIndirect = deferredRenderer -> GetEnableMultiDrawIndirect();
+        ImGui::BeginDisabled( !deferredRenderer -> IsMultiDrawIndirectSupported() );
+        if ( ImGui::Checkbox( "Multi-draw indirect", &multiDrawIndirect ) )
+          deferredRenderer -> SetEnableMultiDrawIndirect(multiDrawIndirect);
+        ImGui::EndDisabled();
+        ImGui::Text( "Draw calls %d", deferredRenderer -> GetNbDrawCalls() );
+
+        bool frustumCulling = deferredRenderer -> GetEnableFrustumCulling();
+        if ( ImGui::Checkbox( "Frustum culling", &frustumCulling ) )
+          deferredRenderer -> SetEnableFrustumCulling(frustumCulling);
+
+        bool occlusionCulling = deferredRenderer -> GetEnableOcclusionCulling();
+        ImGui::BeginDisabled( !deferredRenderer -> IsGpuCullingSupported() || !multiDrawIndirect );
+        if ( ImGui::Checkbox( "Occlusion culling (HiZ)", &occlusionCulling ) )
+          deferredRenderer -> SetEnableOcclusionCulling(occlusionCulling);
+        ImGui::EndDisabled();
+
+        float transparentSortThreshold = deferredRenderer -> GetTransparentSortThreshold();
+        if ( ImGui::SliderFloat( "Transparent re-sort angle", &transparentSortThreshold, 0.f, 5.f, "%.2f deg" ) )
+          deferredRenderer -> SetTransparentSortThreshold(transparentSortThreshold);
+        ImGui::Text( "Transparent meshes sorted %d", deferredRenderer -> GetNbTransparentSorts() );
+
+        bool shadowCache = deferredRenderer -> GetEnableShadowCache();
+        if ( ImGui::Checkbox( "Shadow map cache", &shadowCache ) )
+          deferredRenderer -> SetEnableShadowCache(shadowCache);
+        ImGui::Text( "Shadow layers rendered %d, cached %d", deferredRenderer -> GetNbShadowLayersRendered(), deferredRenderer -> GetNbShadowCacheHits() );
+
         if ( ImGui::Checkbox( "Shadow mapping", &_Settings._ShadowMapping ) )
           _Renderer -> Notify(DirtyState::RenderSettings);
 
@@ -707,6 +772,18 @@ int Test5::DrawSettingsUI()
           _Renderer -> Notify(DirtyState::RenderSettings);
         }
 
+        if ( ImGui::SliderInt( "Distant light cascades", &_Settings._ShadowCascades, 1, 4 ) )
+          _Renderer -> Notify(DirtyState::RenderSettings);
+
+        if ( _Settings._ShadowCascades > 1 )
+        {
+          if ( ImGui::SliderFloat( "Cascade split lambda", &_Settings._ShadowCascadeSplitLambda, 0.f, 1.f ) )
+            _Renderer -> Notify(DirtyState::RenderSettings);
+
+          if ( ImGui::SliderFloat( "Cascade distance (0 : auto)", &_Settings._ShadowCascadeDistance, 0.f, 500.f ) )
+            _Renderer -> Notify(DirtyState::RenderSettings);
+        }
+
         if ( ImGui::Checkbox( "SSAO", &_Settings._SSAO ) )
           _Renderer -> Notify(DirtyState::RenderSettings);
 
@@ -729,6 +806,14 @@ int Test5::DrawSettingsUI()
           _Renderer -> Notify(DirtyState::RenderSettings);
         }
 
+        static const char * EFFECT_RESOLUTIONS[] = { "Full", "Half", "Quarter" };
+        int ssaoResolution = (int)_Settings._SSAOResolution;
+        if ( ImGui::Combo( "SSAO resolution", &ssaoResolution, EFFECT_RESOLUTIONS, 3 ) )
+        {
+          _Settings._SSAOResolution = (EffectResolution)ssaoResolution;
+          _Renderer -> Notify(DirtyState::RenderSettings);
+        }
+
         if ( ImGui::Checkbox( "SSR", &_Settings._SSR ) )
           _Renderer -> Notify(DirtyState::RenderSettings);
 
@@ -757,6 +842,21 @@ int Test5::DrawSettingsUI()
         if ( ImGui::SliderFloat( "SSR edge fade", &_Settings._SSRFade, 0.01f, 0.5f ) )
           _Renderer -> Notify(DirtyState::RenderSettings);
 
+        int ssrResolution = (int)_Settings._SSRResolution;
+        if ( ImGui::Combo( "SSR resolution", &ssrResolution, EFFECT_RESOLUTIONS, 3 ) )
+        {
+          _Settings._SSRResolution = (EffectResolution)ssrResolution;
+          _Renderer -> Notify(DirtyState::RenderSettings);
+        }
+
+        static const char * SSR_TRACE_MODES[] = { "Linear", "Hierarchical Z" };
+        int ssrTraceMode = (int)_Settings._SSRTraceMode;
+        if ( ImGui::Combo( "SSR tracing", &ssrTraceMode, SSR_TRACE_MODES, 2 ) )
+        {
+          _Settings._SSRTraceMode = (SSRTraceMode)ssrTraceMode;
+          _Renderer -> Notify(DirtyState::RenderSettings);
+        }
+
         if ( ImGui::Checkbox( "Specular IBL", &_Settings._SpecularIBL ) )
           _Renderer -> Notify(DirtyState::RenderSettings);
 
@@ -772,9 +872,34 @@ int Test5::DrawSettingsUI()
         if ( ImGui::SliderFloat( "Direct light intensity", &_Settings._DirectLightIntensity, 0.f, 8.f ) )
           _Renderer -> Notify(DirtyState::RenderSettings);
 
+        if ( ImGui::Checkbox( "Clustered lighting", &_Settings._LightClustering ) )
+          _Renderer -> Notify(DirtyState::RenderSettings);
+
+        if ( _Settings._LightClustering )
+        {
+          if ( ImGui::SliderInt3( "Cluster grid", &_Settings._LightClusterGrid.x, 1, S_MaxDeferredLightClusterDim ) )
+            _Renderer -> Notify(DirtyState::RenderSettings);
+
+          if ( ImGui::SliderFloat( "Light cull threshold", &_Settings._LightClusterThreshold, 0.0001f, 0.1f, "%.4f", ImGuiSliderFlags_Logarithmic ) )
+            _Renderer -> Notify(DirtyState::RenderSettings);
+
+          ImGui::Text( "Cluster light refs %d, max per cluster %d", deferredRenderer -> GetNbLightClusterRefs(), deferredRenderer -> GetMaxLightsPerCluster() );
+        }
+
+        if ( ImGui::Checkbox( "Compact G-buffer", &_Settings._CompactGBuffer ) )
+          _Renderer -> Notify(DirtyState::RenderSettings);
+
         if ( ImGui::Checkbox( "Transparency", &_Settings._Transparency ) )
           _Renderer -> Notify(DirtyState::RenderSettings);
 
+        static const char * TRANSPARENCY_MODES[] = { "Sorted", "Weighted blended OIT" };
+        int transparencyMode = (int)_Settings._TransparencyMode;
+        if ( ImGui::Combo( "Transparency mode", &transparencyMode, TRANSPARENCY_MODES, 2 ) )
+        {
+          _Settings._TransparencyMode = (TransparencyMode)transparencyMode;
+          _Renderer -> Notify(DirtyState::RenderSettings);
+        }
+
       }
     }
 
@@ -795,8 +920,8 @@ int Test5::DrawSettingsUI()
 
     if ( RendererType::PathTracer == _RendererType )
     {
-      static const char * PATH_TRACE_DEBUG_MODES[] = { "Off", "Tiles", "Albedo", "Metalness", "Roughness", "Normals", "UV", "BLAS"};
-      if ( ImGui::Combo( "Debug view", &g_DebugMode, PATH_TRACE_DEBUG_MODES, 8 ) )
+      static const char * PATH_TRACE_DEBUG_MODES[] = { "Off", "Tiles", "Albedo", "Metalness", "Roughness", "Normals", "UV", "BLAS", "Sample heatmap"};
+      if ( ImGui::Combo( "Debug view", &g_DebugMode, PATH_TRACE_DEBUG_MODES, 9 ) )
         _Renderer -> Notify(DirtyState::RenderSettings);
     }
     else if ( ( RendererType::SoftwareRasterizer == _RendererType ) || ( RendererType::OpenGLRasterizer == _RendererType ) )
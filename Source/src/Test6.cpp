@@ -74,6 +74,9 @@ static void ApplyMapRenderSettings( const FpsGameMap & iMap, FpsGameSettings & i
   ioRenderSettings._ShadowMapResolution = std::max(256, settings._ShadowMapResolution);
   ioRenderSettings._ShadowBias = std::max(0.f, settings._ShadowBias);
   ioRenderSettings._MaxShadowCastingLights = std::max(1, settings._MaxShadowCastingLights);
+  ioRenderSettings._ShadowCascades = std::clamp(settings._ShadowCascades, 1, 4);
+  ioRenderSettings._ShadowCascadeSplitLambda = std::clamp(settings._ShadowCascadeSplitLambda, 0.f, 1.f);
+  ioRenderSettings._ShadowCascadeDistance = std::max(0.f, settings._ShadowCascadeDistance);
 
   ioRenderSettings._SSAO = settings._SSAO;
   ioRenderSettings._SSAOBlur = settings._SSAOBlur;
@@ -81,6 +84,7 @@ static void ApplyMapRenderSettings( const FpsGameMap & iMap, FpsGameSettings & i
   ioRenderSettings._SSAOBias = std::max(0.f, settings._SSAOBias);
   ioRenderSettings._SSAOIntensity = std::max(0.f, settings._SSAOIntensity);
   ioRenderSettings._SSAOKernelSize = MathUtil::Clamp(settings._SSAOKernelSize, 4, 32);
+  ioRenderSettings._SSAOResolution = settings._SSAOResolution;
 
   ioRenderSettings._SSR = settings._SSR;
   ioRenderSettings._SSRIntensity = std::max(0.f, settings._SSRIntensity);
@@ -90,13 +94,23 @@ static void ApplyMapRenderSettings( const FpsGameMap & iMap, FpsGameSettings & i
   ioRenderSettings._SSRMaxDistance = std::max(0.001f, settings._SSRMaxDistance);
   ioRenderSettings._SSRThickness = std::max(0.001f, settings._SSRThickness);
   ioRenderSettings._SSRFade = MathUtil::Clamp(settings._SSRFade, 0.f, 1.f);
+  ioRenderSettings._SSRResolution = settings._SSRResolution;
+  ioRenderSettings._SSRTraceMode = settings._SSRTraceMode;
 
   ioRenderSettings._PBRDirectLighting = settings._PBRDirectLighting;
   ioRenderSettings._DirectLightIntensity = std::max(0.f, settings._DirectLightIntensity);
+  ioRenderSettings._LightClustering = settings._LightClustering;
+  ioRenderSettings._LightClusterGrid = glm::clamp(settings._LightClusterGrid, Vec3i(1), Vec3i(S_MaxDeferredLightClusterDim));
+  ioRenderSettings._LightClusterThreshold = std::max(1e-6f, settings._LightClusterThreshold);
+  ioRenderSettings._CompactGBuffer = settings._CompactGBuffer;
   ioRenderSettings._SpecularIBLMaxRoughness = MathUtil::Clamp(settings._SpecularIBLMaxRoughness, 0.f, 1.f);
 
   ioRenderSettings._Bounces = std::max(1, settings._Bounces);
   ioRenderSettings._NbSamplesPerPixel = std::max(1, settings._NbSamplesPerPixel);
+  ioRenderSettings._AdaptiveSampling = settings._AdaptiveSampling;
+  ioRenderSettings._ConvergenceThreshold = std::max(1e-4f, settings._ConvergenceThreshold);
+  ioRenderSettings._AdaptiveMinFrames = std::max(1, settings._AdaptiveMinFrames);
+  ioRenderSettings._WavefrontPathTracing = settings._WavefrontPathTracing;
   ioRenderSettings._Denoise = settings._Denoise;
 }
 
@@ -120,12 +134,16 @@ static void CaptureMapRenderSettings( FpsGameMap & ioMap, const FpsGameSettings
   settings._ShadowMapResolution = iRenderSettings._ShadowMapResolution;
   settings._ShadowBias = iRenderSettings._ShadowBias;
   settings._MaxShadowCastingLights = iRenderSettings._MaxShadowCastingLights;
+  settings._ShadowCascades = iRenderSettings._ShadowCascades;
+  settings._ShadowCascadeSplitLambda = iRenderSettings._ShadowCascadeSplitLambda;
+  settings._ShadowCascadeDistance = iRenderSettings._ShadowCascadeDistance;
   settings._SSAO = iRenderSettings._SSAO;
   settings._SSAOBlur = iRenderSettings._SSAOBlur;
   settings._SSAORadius = iRenderSettings._SSAORadius;
   settings._SSAOBias = iRenderSettings._SSAOBias;
   settings._SSAOIntensity = iRenderSettings._SSAOIntensity;
   settings._SSAOKernelSize = iRenderSettings._SSAOKernelSize;
+  settings._SSAOResolution = iRenderSettings._SSAOResolution;
   settings._SSR = iRenderSettings._SSR;
   settings._SSRIntensity = iRenderSettings._SSRIntensity;
   settings._SSRMaxRoughness = iRenderSettings._SSRMaxRoughness;
@@ -134,11 +152,21 @@ static void CaptureMapRenderSettings( FpsGameMap & ioMap, const FpsGameSettings
   settings._SSRMaxDistance = iRenderSettings._SSRMaxDistance;
   settings._SSRThickness = iRenderSettings._SSRThickness;
   settings._SSRFade = iRenderSettings._SSRFade;
+  settings._SSRResolution = iRenderSettings._SSRResolution;
+  settings._SSRTraceMode = iRenderSettings._SSRTraceMode;
   settings._PBRDirectLighting = iRenderSettings._PBRDirectLighting;
   settings._DirectLightIntensity = iRenderSettings._DirectLightIntensity;
+  settings._LightClustering = iRenderSettings._LightClustering;
+  settings._LightClusterGrid = iRenderSettings._LightClusterGrid;
+  settings._LightClusterThreshold = iRenderSettings._LightClusterThreshold;
+  settings._CompactGBuffer = iRenderSettings._CompactGBuffer;
   settings._SpecularIBLMaxRoughness = iRenderSettings._SpecularIBLMaxRoughness;
   settings._Bounces = iRenderSettings._Bounces;
   settings._NbSamplesPerPixel = iRenderSettings._NbSamplesPerPixel;
+  settings._AdaptiveSampling = iRenderSettings._AdaptiveSampling;
+  settings._ConvergenceThreshold = iRenderSettings._ConvergenceThreshold;
+  settings._AdaptiveMinFrames = iRenderSettings._AdaptiveMinFrames;
+  settings._WavefrontPathTracing = iRenderSettings._WavefrontPathTracing;
   settings._Denoise = iRenderSettings._Denoise;
 }
 
@@ -600,6 +628,8 @@ int Test6::InitializeScene()
   if ( !newScene )
     return 1;
 
+  _Simulation.Reset();
+
   const bool preserveEditorPose = _Editor.IsEnabled();
   FpsPlayer editorPlayer;
   if ( preserveEditorPose )
@@ -665,6 +695,7 @@ int Test6::InitializeScene()
     return 1;
 
   FpsGameEditorContext editorContext = MakeEditorContext();
+  _Editor.ResetPicking();
   _Editor.ApplyObjectVisibility(editorContext);
   _Editor.SetPathBuffers(_MapPath);
   _Editor.RefreshPropAssets();
@@ -880,6 +911,8 @@ int Test6::InitializeRenderer()
 // ----------------------------------------------------------------------------
 int Test6::ProcessInput()
 {
+  _BoidsSimulated = false;
+
   double curMouseX = 0., curMouseY = 0.;
   glfwGetCursorPos(_MainWindow.get(), &curMouseX, &curMouseY);
 
@@ -910,6 +943,9 @@ int Test6::ProcessInput()
 
   if ( _Editor.IsEnabled() )
   {
+    // The editor moves the player and objects directly : snap the interpolation once play resumes
+    _Simulation.Reset();
+
     if ( !ImGui::GetIO().WantCaptureKeyboard )
     {
       FpsRendererMode requestedRendererMode = _GameSettings._RendererMode;
@@ -945,8 +981,15 @@ int Test6::ProcessInput()
       && !ImGuizmo::IsOver()
       && !ImGuizmo::IsUsing() )
     {
-      _Editor.HandleMousePick(MakeEditorContext(), mouseX, mouseY);
+      const bool shiftHeld = ( GLFW_PRESS == glfwGetKey(_MainWindow.get(), GLFW_KEY_LEFT_SHIFT) )
+                          || ( GLFW_PRESS == glfwGetKey(_MainWindow.get(), GLFW_KEY_RIGHT_SHIFT) );
+      if ( shiftHeld )
+        _Editor.BeginBoxSelect(mouseX, mouseY);
+      else
+        _Editor.HandleMousePick(MakeEditorContext(), mouseX, mouseY);
     }
+    if ( _Editor.IsBoxSelecting() && _MouseInput.IsButtonReleased(GLFW_MOUSE_BUTTON_1, mouseX, mouseY) )
+      _Editor.EndBoxSelect(MakeEditorContext(), mouseX, mouseY);
 
     if ( rightMouseHeld )
     {
@@ -1083,8 +1126,38 @@ int Test6::ProcessInput()
   _LastMouseX = curMouseX;
   _LastMouseY = curMouseY;
 
-  if ( FpsRendererMode::PhotoPathTracer != _GameSettings._RendererMode )
+  if ( ( FpsRendererMode::PhotoPathTracer != _GameSettings._RendererMode ) && _GameSettings._FixedTimestep )
   {
+    if ( 0 != _Simulation.Advance(static_cast<float>(_DeltaTime), input, _GameSettings, _GameWorld, _BoidSimulations, _BoidSettings) )
+      return 1;
+    _BoidsSimulated = true;
+
+    if ( 0 != SyncSimulationBoids() )
+      return 1;
+
+    const FpsSimulationState & display = _Simulation.GetDisplayState();
+    if ( 0 != _SceneBinding.SyncCamera(*_Scene, display._Player, _GameSettings) )
+      return 1;
+
+    if ( _Renderer )
+      _Renderer -> Notify(DirtyState::SceneCamera);
+
+    // Active projectiles move every frame through interpolation, even without a new tick
+    const bool projectilesDirty = _GameWorld.ConsumeProjectilesDirty() || ( _GameWorld.GetActiveProjectileCount() > 0 );
+    if ( projectilesDirty || ( _GameSettings._ShowViewWeapon && _SceneBinding.HasViewWeapon() ) )
+    {
+      const uint64_t instanceGeneration = _Scene -> GetMeshInstanceGeneration();
+      if ( 0 != _SceneBinding.SyncTransforms(*_Scene, _GameWorld, display._Player, display._Projectiles, _GameSettings) )
+        return 1;
+
+      // The binding only flags instances that moved : a still player with idle props leaves the renderer alone
+      if ( _Renderer && ( instanceGeneration != _Scene -> GetMeshInstanceGeneration() ) )
+        _Renderer -> Notify(DirtyState::SceneInstances);
+    }
+  }
+  else if ( FpsRendererMode::PhotoPathTracer != _GameSettings._RendererMode )
+  {
+    _Simulation.Reset();
     if ( 0 != _GameWorld.Update(static_cast<float>(_DeltaTime), input, _GameSettings) )
       return 1;
 
@@ -1097,10 +1170,11 @@ int Test6::ProcessInput()
     const bool projectilesDirty = _GameWorld.ConsumeProjectilesDirty();
     if ( projectilesDirty || ( _GameSettings._ShowViewWeapon && _SceneBinding.HasViewWeapon() ) )
     {
+      const uint64_t instanceGeneration = _Scene -> GetMeshInstanceGeneration();
       if ( 0 != _SceneBinding.SyncTransforms(*_Scene, _GameWorld, _GameSettings) )
         return 1;
 
-      if ( _Renderer )
+      if ( _Renderer && ( instanceGeneration != _Scene -> GetMeshInstanceGeneration() ) )
         _Renderer -> Notify(DirtyState::SceneInstances);
     }
   }
@@ -1168,6 +1242,36 @@ int Test6::UpdateGame()
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+// SyncSimulationBoids
+// ----------------------------------------------------------------------------
+int Test6::SyncSimulationBoids()
+{
+  const std::vector<std::vector<BoidState>> & displayBoids = _Simulation.GetDisplayState()._Boids;
+  if ( ( _BoidBindings.size() != _BoidSimulations.size() ) || ( displayBoids.size() != _BoidSimulations.size() ) )
+    return 0;
+
+  BeginCpuTiming(CpuBoidsSceneSync);
+  const uint64_t instanceGeneration = _Scene -> GetMeshInstanceGeneration();
+  for ( int i = 0; i < static_cast<int>(_BoidBindings.size()); ++i )
+  {
+    if ( ( i >= static_cast<int>(_BoidSettings.size()) ) || _BoidSettings[i]._Paused )
+      continue;
+
+    if ( 0 != _BoidBindings[i].SyncTransforms(*_Scene, displayBoids[i], _BoidSettings[i]) )
+    {
+      EndCpuTiming(CpuBoidsSceneSync);
+      return 1;
+    }
+  }
+  EndCpuTiming(CpuBoidsSceneSync);
+
+  if ( ( instanceGeneration != _Scene -> GetMeshInstanceGeneration() ) && _Renderer )
+    _Renderer -> Notify(DirtyState::SceneInstances);
+
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 // UpdateBoids
 // ----------------------------------------------------------------------------
@@ -1182,6 +1286,13 @@ int Test6::UpdateBoids()
     return 0;
   }
 
+  // Flocks are advanced by the fixed-step simulation and synced in ProcessInput
+  if ( _BoidsSimulated )
+  {
+    EndCpuTiming(CpuUpdateBoids);
+    return 0;
+  }
+
   if ( _BoidSimulations.size() != _BoidBindings.size() )
   {
     EndCpuTiming(CpuUpdateBoids);
@@ -1202,7 +1313,8 @@ int Test6::UpdateBoids()
       continue;
 
     BeginCpuTiming(CpuBoidsSimulation);
-    if ( 0 != _BoidSimulations[i].Update(static_cast<float>(_DeltaTime), _BoidSettings[i]) )
+    if ( ( 0 != _BoidSimulations[i].Update(static_cast<float>(_DeltaTime), _BoidSettings[i]) )
+      || ( 0 != _GameWorld.ResolveBoidCollisions(_BoidSimulations[i], _BoidSettings[i]) ) )
     {
       EndCpuTiming(CpuBoidsSimulation);
       EndCpuTiming(CpuUpdateBoids);
@@ -1397,6 +1509,47 @@ int Test6::DrawBenchmarkUI()
       if ( ImGui::Checkbox("PBO color upload", &pboUpload) )
         software -> SetEnablePBOUpload(pboUpload);
     }
+    else if ( DeferredRenderer * deferred = _Renderer -> AsDeferredRenderer() )
+    {
+      bool multiDrawIndirect = deferred -> GetEnableMultiDrawIndirect();
+      ImGui::BeginDisabled(!deferred -> IsMultiDrawIndirectSupported());
+      if ( ImGui::Checkbox("Multi-draw indirect", &multiDrawIndirect) )
+        deferred -> SetEnableMultiDrawIndirect(multiDrawIndirect);
+      ImGui::EndDisabled();
+      ImGui::Text("Draw calls: %d", deferred -> GetNbDrawCalls());
+
+      bool frustumCulling = deferred -> GetEnableFrustumCulling();
+      if ( ImGui::Checkbox("Deferred frustum culling", &frustumCulling) )
+        deferred -> SetEnableFrustumCulling(frustumCulling);
+
+      bool occlusionCulling = deferred -> GetEnableOcclusionCulling();
+      ImGui::BeginDisabled(!deferred -> IsGpuCullingSupported() || !multiDrawIndirect);
+      if ( ImGui::Checkbox("Occlusion culling (HiZ)", &occlusionCulling) )
+        deferred -> SetEnableOcclusionCulling(occlusionCulling);
+      ImGui::EndDisabled();
+
+      float transparentSortThreshold = deferred -> GetTransparentSortThreshold();
+      if ( ImGui::SliderFloat("Transparent re-sort angle", &transparentSortThreshold, 0.f, 5.f, "%.2f deg") )
+        deferred -> SetTransparentSortThreshold(transparentSortThreshold);
+      ImGui::Text("Transparent meshes sorted: %d", deferred -> GetNbTransparentSorts());
+
+      bool shadowCache = deferred -> GetEnableShadowCache();
+      if ( ImGui::Checkbox("Shadow map cache", &shadowCache) )
+        deferred -> SetEnableShadowCache(shadowCache);
+      ImGui::Text("Shadow layers rendered: %d, cached: %d", deferred -> GetNbShadowLayersRendered(), deferred -> GetNbShadowCacheHits());
+      if ( _Settings._LightClustering )
+        ImGui::Text("Cluster light refs: %d, max per cluster: %d", deferred -> GetNbLightClusterRefs(), deferred -> GetMaxLightsPerCluster());
+
+      if ( ImGui::Checkbox("Deferred transparency", &_Settings._Transparency) )
+        _Renderer -> Notify(DirtyState::RenderSettings);
+      static const char * TransparencyModes[] = { "Sorted", "Weighted blended OIT" };
+      int transparencyMode = (int)_Settings._TransparencyMode;
+      if ( ImGui::Combo("Transparency mode", &transparencyMode, TransparencyModes, 2) )
+      {
+        _Settings._TransparencyMode = (TransparencyMode)transparencyMode;
+        _Renderer -> Notify(DirtyState::RenderSettings);
+      }
+    }
   }
 
   if ( !_Benchmark.IsRunning() )
@@ -1478,6 +1631,15 @@ int Test6::DrawGameSettingsUI()
     }
   }
 
+  if ( ImGui::CollapsingHeader("Simulation") )
+  {
+    ImGui::Checkbox("Fixed timestep", &_GameSettings._FixedTimestep);
+    ImGui::SliderFloat("Tick rate", &_GameSettings._SimulationRate, 10.f, 240.f, "%.0f Hz");
+    ImGui::SliderInt("Max ticks per frame", &_GameSettings._MaxSimulationSteps, 1, 16);
+    if ( _GameSettings._FixedTimestep )
+      ImGui::Text("Ticks: %d, waves: %d, alpha %.2f", _Simulation.GetLastNbSteps(), _Simulation.GetNbWaves(), _Simulation.GetAlpha());
+  }
+
   if ( ImGui::CollapsingHeader("Projectiles") )
   {
     ImGui::Text("Active: %d / %d", _GameWorld.GetActiveProjectileCount(), (int)_GameWorld.GetProjectiles().size());
@@ -1496,9 +1658,21 @@ int Test6::DrawGameSettingsUI()
       _ReloadScene = true;
     }
 
+    // Pool size changes rebuild the projectile instances
+    if ( ImGui::Checkbox("Stress test", &_GameSettings._ProjectileStressTest) )
+      _ReloadScene = true;
+    int stressCount = _GameSettings._ProjectileStressCount;
+    if ( ImGui::SliderInt("Stress projectiles", &stressCount, 256, 16384) )
+    {
+      _GameSettings._ProjectileStressCount = std::max(1, stressCount);
+      if ( _GameSettings._ProjectileStressTest )
+        _ReloadScene = true;
+    }
+
     if ( ImGui::Button("Clear projectiles") )
     {
       _GameWorld.ClearProjectiles();
+      _Simulation.Reset();
       _SceneBinding.SyncTransforms(*_Scene, _GameWorld, _GameSettings);
       if ( _Renderer )
         _Renderer -> Notify(DirtyState::SceneInstances);
@@ -8,6 +8,7 @@
 #include "FpsGameEditor.h"
 #include "FpsGameHud.h"
 #include "FpsGameMap.h"
+#include "FpsSimulation.h"
 #include "KeyInput.h"
 #include "MouseInput.h"
 #include "Renderer.h"
@@ -58,6 +59,7 @@ protected:
   int ProcessInput();
   int UpdateGame();
   int UpdateBoids();
+  int SyncSimulationBoids();
   int UpdateCPUTime();
 
   int DrawUI();
@@ -105,6 +107,8 @@ protected:
   std::vector<BoidSettings>      _BoidSettings;
   std::vector<BoidSimulation>    _BoidSimulations;
   std::vector<BoidSceneBinding>  _BoidBindings;
+  FpsSimulation                  _Simulation;
+  bool                           _BoidsSimulated = false; // Boids were advanced by _Simulation this frame
 
   KeyInput                  _KeyInput;
   MouseInput                _MouseInput;
@@ -0,0 +1,215 @@
+#include "TileScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace RTRT
+{
+
+static const unsigned int S_MinSamplesForError  = 4;     // Fewer samples : the moments do not estimate the error yet
+static const float        S_EvenProgressPriority = 1e6f;
+static const float        S_CenterBias          = 1.f;   // Priority boost of the center tile over the corners
+static const float        S_MinLuminance        = .01f;  // Dark pixels are compared to this floor, as adaptive sampling does
+static const double       S_TileCostSmoothing   = .5;
+
+// ----------------------------------------------------------------------------
+// Reset
+// ----------------------------------------------------------------------------
+void TileScheduler::Reset( const Vec2i & iNbTiles )
+{
+  // The tile cost only depends on the tile size, kept across camera moves
+  if ( iNbTiles != _NbTiles )
+    _TileCost = 0.;
+
+  _NbTiles = Vec2i(std::max(iNbTiles.x, 0), std::max(iNbTiles.y, 0));
+  const int nbTiles = _NbTiles.x * _NbTiles.y;
+
+  _Samples.assign(nbTiles, 0);
+  _Error.assign(nbTiles, 0.f);
+  _Scheduled.assign(nbTiles, 0);
+  _CenterWeight.resize(nbTiles);
+  _ScanlineCursor = -1;
+
+  const float maxDist = std::sqrt(.5f);
+  for ( int i = 0; i < nbTiles; ++i )
+  {
+    Vec2i coord = GetTileCoord(i);
+    Vec2 center(( coord.x + .5f ) / _NbTiles.x - .5f, ( coord.y + .5f ) / _NbTiles.y - .5f);
+    _CenterWeight[i] = 1.f + S_CenterBias * ( 1.f - std::min(glm::length(center) / maxDist, 1.f) );
+  }
+}
+
+// ----------------------------------------------------------------------------
+// BeginFrame
+// ----------------------------------------------------------------------------
+void TileScheduler::BeginFrame()
+{
+  std::fill(_Scheduled.begin(), _Scheduled.end(), 0);
+}
+
+// ----------------------------------------------------------------------------
+// NextTile
+// Returns -1 once every tile was picked during the frame
+// ----------------------------------------------------------------------------
+int TileScheduler::NextTile( Order iOrder )
+{
+  const int nbTiles = (int)_Samples.size();
+  if ( !nbTiles )
+    return -1;
+
+  if ( Order::Scanline == iOrder )
+  {
+    // Rows from the top of the image, left to right
+    for ( int i = 0; i < nbTiles; ++i )
+    {
+      _ScanlineCursor = ( _ScanlineCursor + 1 ) % nbTiles;
+      int tile = ( _NbTiles.y - 1 - _ScanlineCursor / _NbTiles.x ) * _NbTiles.x + _ScanlineCursor % _NbTiles.x;
+      if ( !_Scheduled[tile] )
+      {
+        _Scheduled[tile] = 1;
+        return tile;
+      }
+    }
+    return -1;
+  }
+
+  int bestTile = -1;
+  float bestPriority = -1.f;
+  for ( int i = 0; i < nbTiles; ++i )
+  {
+    if ( _Scheduled[i] )
+      continue;
+
+    float priority = GetPriority(i);
+    if ( priority > bestPriority )
+    {
+      bestPriority = priority;
+      bestTile = i;
+    }
+  }
+
+  if ( bestTile >= 0 )
+    _Scheduled[bestTile] = 1;
+
+  return bestTile;
+}
+
+// ----------------------------------------------------------------------------
+// TileRendered
+// ----------------------------------------------------------------------------
+void TileScheduler::TileRendered( int iTile )
+{
+  if ( ( iTile < 0 ) || ( iTile >= (int)_Samples.size() ) )
+    return;
+
+  _Samples[iTile]++;
+}
+
+// ----------------------------------------------------------------------------
+// SetTileError
+// ----------------------------------------------------------------------------
+void TileScheduler::SetTileError( int iTile, float iError )
+{
+  if ( ( iTile < 0 ) || ( iTile >= (int)_Error.size() ) )
+    return;
+
+  _Error[iTile] = std::max(iError, 0.f);
+}
+
+// ----------------------------------------------------------------------------
+// Restore
+// ----------------------------------------------------------------------------
+bool TileScheduler::Restore( const Vec2i & iNbTiles, const std::vector<unsigned int> & iSamples, const std::vector<float> & iErrors, int iScanlineCursor )
+{
+  const size_t nbTiles = (size_t)std::max(iNbTiles.x, 0) * (size_t)std::max(iNbTiles.y, 0);
+  if ( ( iSamples.size() != nbTiles ) || ( iErrors.size() != nbTiles ) || ( iScanlineCursor < -1 ) || ( iScanlineCursor >= (int)nbTiles ) )
+    return false;
+
+  Reset(iNbTiles);
+  _Samples = iSamples;
+  for ( size_t i = 0; i < nbTiles; ++i )
+    _Error[i] = std::max(iErrors[i], 0.f);
+  _ScanlineCursor = iScanlineCursor;
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// GetPriority
+// Expected decrease of the relative standard error after one more sample : e * ( 1 - sqrt(n / (n + 1)) )
+// ----------------------------------------------------------------------------
+float TileScheduler::GetPriority( int iTile ) const
+{
+  // Until the moments are meaningful, tiles progress evenly from the center outwards
+  const unsigned int samples = _Samples[iTile];
+  if ( samples < S_MinSamplesForError )
+    return S_EvenProgressPriority - (float)samples + .5f * _CenterWeight[iTile];
+
+  const float n = (float)samples;
+  return _Error[iTile] * ( 1.f - std::sqrt(n / ( n + 1.f )) ) * _CenterWeight[iTile];
+}
+
+// ----------------------------------------------------------------------------
+// RecordFrameTime
+// ----------------------------------------------------------------------------
+void TileScheduler::RecordFrameTime( int iNbTiles, double iSeconds )
+{
+  if ( ( iNbTiles <= 0 ) || ( iSeconds <= 0. ) )
+    return;
+
+  const double tileCost = iSeconds / iNbTiles;
+  _TileCost = ( _TileCost > 0. ) ? ( _TileCost + ( tileCost - _TileCost ) * S_TileCostSmoothing ) : ( tileCost );
+}
+
+// ----------------------------------------------------------------------------
+// GetTilesForBudget
+// ----------------------------------------------------------------------------
+int TileScheduler::GetTilesForBudget( double iBudgetSeconds ) const
+{
+  const int nbTiles = (int)_Samples.size();
+  if ( ( _TileCost <= 0. ) || ( nbTiles <= 1 ) )
+    return 1;
+
+  const double nbTilesInBudget = std::floor(iBudgetSeconds / _TileCost);
+  return (int)std::max(1., std::min(nbTilesInBudget, (double)nbTiles));
+}
+
+// ----------------------------------------------------------------------------
+// EstimateError
+// Mean relative standard error of the pixels
+// ----------------------------------------------------------------------------
+float TileScheduler::EstimateError( const float * iMoments, int iNbPixels )
+{
+  double errorSum = 0.;
+  int nbPixels = 0;
+  for ( int i = 0; i < iNbPixels; ++i )
+  {
+    const float * moments = iMoments + 4 * i;
+    if ( moments[2] < 1.f )
+      continue;
+
+    const float variance = std::max(moments[1] - moments[0] * moments[0], 0.f);
+    errorSum += std::sqrt(variance / moments[2]) / std::max(moments[0], S_MinLuminance);
+    nbPixels++;
+  }
+
+  return ( nbPixels > 0 ) ? (float)( errorSum / nbPixels ) : ( 0.f );
+}
+
+// ----------------------------------------------------------------------------
+// GetMinSamples
+// ----------------------------------------------------------------------------
+unsigned int TileScheduler::GetMinSamples() const
+{
+  return _Samples.empty() ? 0 : *std::min_element(_Samples.begin(), _Samples.end());
+}
+
+// ----------------------------------------------------------------------------
+// GetMaxSamples
+// ----------------------------------------------------------------------------
+unsigned int TileScheduler::GetMaxSamples() const
+{
+  return _Samples.empty() ? 0 : *std::max_element(_Samples.begin(), _Samples.end());
+}
+
+}
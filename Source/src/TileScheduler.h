@@ -0,0 +1,59 @@
+#ifndef _TileScheduler_
+#define _TileScheduler_
+
+#include "MathUtil.h"
+
+#include <vector>
+
+namespace RTRT
+{
+
+// Progressive tile order for the tiled PathTracer.
+// Tiles without samples come first, from the screen center outwards. Then the tile whose next sample
+// reduces its relative standard error the most, weighted towards the screen center.
+// A tile is picked at most once per frame, the number of tiles per frame follows the measured tile cost.
+class TileScheduler
+{
+public:
+  enum class Order { Scanline, Prioritized };
+
+  void Reset( const Vec2i & iNbTiles );
+  void BeginFrame();
+  int NextTile( Order iOrder );
+  void TileRendered( int iTile );
+  // Error estimates come back from the GPU a few frames late
+  void SetTileError( int iTile, float iError );
+
+  // Progress saved by an accumulation checkpoint
+  bool Restore( const Vec2i & iNbTiles, const std::vector<unsigned int> & iSamples, const std::vector<float> & iErrors, int iScanlineCursor );
+
+  void RecordFrameTime( int iNbTiles, double iSeconds );
+  int GetTilesForBudget( double iBudgetSeconds ) const;
+
+  // iMoments : RGBA accumulated moments (mean luminance, mean squared luminance, samples, converged)
+  static float EstimateError( const float * iMoments, int iNbPixels );
+
+  float GetPriority( int iTile ) const;
+  Vec2i GetTileCoord( int iTile ) const { return Vec2i(iTile % _NbTiles.x, iTile / _NbTiles.x); }
+  const Vec2i & GetNbTiles() const { return _NbTiles; }
+  unsigned int GetTileSamples( int iTile ) const { return _Samples[iTile]; }
+  const std::vector<unsigned int> & GetSamples() const { return _Samples; }
+  const std::vector<float> & GetErrors() const { return _Error; }
+  int GetScanlineCursor() const { return _ScanlineCursor; }
+  unsigned int GetMinSamples() const;
+  unsigned int GetMaxSamples() const;
+  double GetTileCost() const { return _TileCost; }
+
+protected:
+  Vec2i                     _NbTiles = Vec2i(0);
+  std::vector<unsigned int> _Samples;
+  std::vector<float>        _Error;        // Relative standard error of the mean, after the last sample
+  std::vector<float>        _CenterWeight;
+  std::vector<char>         _Scheduled;    // Picked during the current frame
+  int                       _ScanlineCursor = -1;
+  double                    _TileCost = 0.; // Seconds per tile, smoothed over the frames
+};
+
+}
+
+#endif /* _TileScheduler_ */
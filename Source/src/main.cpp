@@ -5,6 +5,8 @@
 #include "Test5.h"
 #include "Test6.h"
 #include "PathUtils.h"
+#include "BatchRender.h"
+#include "DistributedRender.h"
 
 #include "imgui.h"
 #include "backends/imgui_impl_glfw.h"
@@ -65,6 +67,8 @@ static void PrintUsage( const char * iExeName )
   std::cout << "  " << exeName << " 6" << std::endl;
   std::cout << "  " << exeName << " Test6 --benchmark-software-control" << std::endl;
   std::cout << "  " << exeName << " Test6 --benchmark-software LABEL [scalar|simd] TILE_SIZE [OPTIMIZATION] [fixed|ground|sky]" << std::endl;
+  std::cout << "  " << exeName << " --batch [options] SCENE...   (see " << exeName << " --batch --help)" << std::endl;
+  std::cout << "  " << exeName << " --distributed [options] SCENE   (see " << exeName << " --distributed --help)" << std::endl;
 }
 
 // ----------------------------------------------------------------------------
@@ -227,6 +231,64 @@ int main(int iArgc, char** iArgv)
 
   RTRT::PathUtils::Initialize( ( iArgv ) ? ( iArgv[0] ) : nullptr );
 
+  // Offline rendering : no UI, the batch mode creates its own context
+  if ( ( iArgc >= 2 ) && iArgv && iArgv[1] && ( std::string(iArgv[1]) == "--batch" ) )
+  {
+    const char * exeName = ( iArgv[0] && iArgv[0][0] ) ? iArgv[0] : "RenderLab";
+    if ( ( iArgc >= 3 ) && iArgv[2] && ( std::string(iArgv[2]) == "--help" ) )
+    {
+      RTRT::PrintBatchUsage(exeName);
+      return 0;
+    }
+
+    RTRT::BatchRenderOptions batchOptions;
+    std::string batchError;
+    if ( !RTRT::ParseBatchArgs(iArgc, iArgv, 2, batchOptions, batchError) )
+    {
+      std::cout << "Batch : " << batchError << std::endl;
+      RTRT::PrintBatchUsage(exeName);
+      return 1;
+    }
+
+    glfwSetErrorCallback(glfw_error_callback);
+    return RTRT::RunBatchRender(batchOptions);
+  }
+
+  // CPU tile rendering across processes : no window, no OpenGL
+  if ( ( iArgc >= 2 ) && iArgv && iArgv[1] && ( std::string(iArgv[1]) == "--distributed" ) )
+  {
+    const char * exeName = ( iArgv[0] && iArgv[0][0] ) ? iArgv[0] : "RenderLab";
+    if ( ( iArgc >= 3 ) && iArgv[2] && ( std::string(iArgv[2]) == "--help" ) )
+    {
+      RTRT::PrintDistributedUsage(exeName);
+      return 0;
+    }
+
+    RTRT::DistributedRenderOptions distributedOptions;
+    std::string distributedError;
+    if ( !RTRT::ParseDistributedArgs(iArgc, iArgv, 2, distributedOptions, distributedError) )
+    {
+      std::cout << "Distributed : " << distributedError << std::endl;
+      RTRT::PrintDistributedUsage(exeName);
+      return 1;
+    }
+
+    return RTRT::RunDistributedRender(distributedOptions);
+  }
+
+  if ( ( iArgc >= 2 ) && iArgv && iArgv[1] && ( std::string(iArgv[1]) == "--tile-worker" ) )
+  {
+    RTRT::TileWorkerOptions workerOptions;
+    std::string workerError;
+    if ( !RTRT::ParseTileWorkerArgs(iArgc, iArgv, 2, workerOptions, workerError) )
+    {
+      std::cout << "TileWorker : " << workerError << std::endl;
+      return 1;
+    }
+
+    return RTRT::RunTileWorker(workerOptions);
+  }
+
   if ( ( iArgc > 3 ) && ( iArgc != 6 ) && ( iArgc != 7 ) && ( iArgc != 8 ) )
   {
     PrintUsage( ( iArgv ) ? ( iArgv[0] ) : nullptr );
@@ -0,0 +1,100 @@
+#include "RenderTestBatchUtil.h"
+
+#include "BatchRender.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace BatchTestUtil
+{
+
+static bool Parse( const std::vector<const char *> & iArgs, BatchRenderOptions & oOptions, std::string & oError )
+{
+  return ParseBatchArgs(static_cast<int>(iArgs.size()), iArgs.data(), 2, oOptions, oError);
+}
+
+bool CheckBatchArgs()
+{
+  BatchRenderOptions options;
+  std::string error;
+
+  if ( !Parse({ "RenderLab", "--batch", "--backend", "deferred", "--context", "egl", "--resolution", "320x180",
+                "--frames", "8", "--spp", "2", "--cameras", "3", "--output", "out/{backend}/{scene}_{camera}.png",
+                "--timings", "out/timings.json", "cornell_box.json", "sponza.json" }, options, error) )
+  {
+    std::cerr << "Valid batch arguments rejected : " << error << std::endl;
+    return false;
+  }
+  if ( ( RendererBackend::DeferredRenderer != options._Backend ) || ( BatchContextAPI::EGL != options._Context )
+    || ( 320 != options._Resolution.x ) || ( 180 != options._Resolution.y ) || ( 8 != options._Frames )
+    || ( 2 != options._SamplesPerPixel ) || ( 3 != options._NbCameras ) || ( "out/timings.json" != options._TimingsPath )
+    || ( 2 != options._Scenes.size() ) || ( "sponza.json" != options._Scenes[1] ) )
+  {
+    std::cerr << "Batch arguments parsed incorrectly" << std::endl;
+    return false;
+  }
+
+  const std::string output = FormatBatchOutputPath(options._OutputPattern, "Assets/cornell_box.json", 12, options._Backend);
+  if ( "out/deferred/cornell_box_0012.png" != output )
+  {
+    std::cerr << "Unexpected batch output path " << output << std::endl;
+    return false;
+  }
+
+  if ( !Parse({ "RenderLab", "--batch", "--checkpoint", "ckpt/{scene}_{camera}.rtac", "--checkpoint-every", "4", "--resume",
+                "--cameras", "2", "cornell_box.json" }, options, error)
+    || ( "ckpt/{scene}_{camera}.rtac" != options._CheckpointPattern ) || ( 4 != options._CheckpointInterval ) || !options._Resume
+    || ( 1 != options._Scenes.size() ) )
+  {
+    std::cerr << "Batch checkpoint arguments parsed incorrectly : " << error << std::endl;
+    return false;
+  }
+
+  // Defaults
+  if ( !Parse({ "RenderLab", "--batch", "cornell_box.json" }, options, error)
+    || ( RendererBackend::PathTracer != options._Backend ) || ( BatchContextAPI::Auto != options._Context )
+    || ( 0 != options._Resolution.x ) || ( 0 != options._SamplesPerPixel ) || ( 1 != options._NbCameras )
+    || !options._CheckpointPattern.empty() || options._Resume )
+  {
+    std::cerr << "Unexpected batch defaults" << std::endl;
+    return false;
+  }
+
+  const std::vector<std::vector<const char *>> invalidArgs =
+  {
+    { "RenderLab", "--batch" },
+    { "RenderLab", "--batch", "--frames", "0", "cornell_box.json" },
+    { "RenderLab", "--batch", "--resolution", "320", "cornell_box.json" },
+    { "RenderLab", "--batch", "--backend", "vulkan", "cornell_box.json" },
+    { "RenderLab", "--batch", "--spp" },
+    { "RenderLab", "--batch", "--unknown", "1", "cornell_box.json" },
+    { "RenderLab", "--batch", "--cameras", "4", "--output", "frame.png", "cornell_box.json" },
+    { "RenderLab", "--batch", "--resume", "cornell_box.json" },
+    { "RenderLab", "--batch", "--backend", "deferred", "--checkpoint", "frame.rtac", "cornell_box.json" },
+    { "RenderLab", "--batch", "--cameras", "4", "--output", "{camera}.png", "--checkpoint", "frame.rtac", "cornell_box.json" },
+    { "RenderLab", "--batch", "--checkpoint", "frame.rtac", "--checkpoint-every", "0", "cornell_box.json" }
+  };
+  for ( const auto & args : invalidArgs )
+  {
+    if ( Parse(args, options, error) || error.empty() )
+    {
+      std::cerr << "Invalid batch arguments accepted (" << args.size() << " arguments)" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}
+
+}
+
+}
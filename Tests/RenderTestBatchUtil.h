@@ -0,0 +1,21 @@
+#ifndef _RenderTestBatchUtil_
+#define _RenderTestBatchUtil_
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace BatchTestUtil
+{
+
+bool CheckBatchArgs();
+
+}
+
+}
+
+}
+
+#endif /* _RenderTestBatchUtil_ */
@@ -0,0 +1,289 @@
+#include "RenderTestCheckpointUtil.h"
+
+#include "AccumulationCheckpoint.h"
+#include "BatchRender.h"
+#include "TileScheduler.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace CheckpointTestUtil
+{
+
+static std::vector<float> MakeLayer( const AccumulationCheckpoint & iCheckpoint, int iLayer )
+{
+  std::vector<float> pixels(iCheckpoint.GetLayerSize());
+  for ( size_t i = 0; i < pixels.size(); ++i )
+    pixels[i] = iLayer * 1000.f + i * .25f;
+  return pixels;
+}
+
+static bool WriteCheckpoint( const fs::path & iPath, const AccumulationCheckpoint & iCheckpoint )
+{
+  AccumulationCheckpointWriter writer;
+  if ( !writer.Open(iPath, iCheckpoint) )
+    return false;
+  for ( int i = 0; i < AccumulationCheckpoint::_NbLayers; ++i )
+  {
+    if ( !writer.WriteLayer(MakeLayer(iCheckpoint, i).data()) )
+      return false;
+  }
+  return writer.Close();
+}
+
+static bool ReadCheckpoint( const fs::path & iPath, AccumulationCheckpoint & oCheckpoint, std::vector<std::vector<float>> & oLayers )
+{
+  AccumulationCheckpointReader reader;
+  if ( !reader.Open(iPath, oCheckpoint) )
+    return false;
+  oLayers.resize(AccumulationCheckpoint::_NbLayers);
+  for ( auto & layer : oLayers )
+  {
+    if ( !reader.ReadLayer(layer) )
+      return false;
+  }
+  return true;
+}
+
+bool CheckAccumulationCheckpoint()
+{
+  std::error_code error;
+  const fs::path directory = fs::temp_directory_path(error) / "rtrt_checkpoint_test";
+  fs::remove_all(directory, error);
+  const fs::path path = directory / "accumulation.rtac";
+
+  // Tiled render, 3 frames into its 2x2 tiles
+  TileScheduler scheduler;
+  scheduler.Reset(Vec2i(2, 2));
+  for ( int frame = 0; frame < 3; ++frame )
+  {
+    scheduler.BeginFrame();
+    for ( int tile = scheduler.NextTile(TileScheduler::Order::Prioritized); tile >= 0; tile = scheduler.NextTile(TileScheduler::Order::Prioritized) )
+    {
+      scheduler.TileRendered(tile);
+      scheduler.SetTileError(tile, .1f * ( tile + 1 ));
+    }
+  }
+
+  AccumulationCheckpoint saved;
+  saved._Resolution        = Vec2i(7, 5);
+  saved._NbCompleteFrames  = scheduler.GetMinSamples();
+  saved._FrameNum          = 42;
+  saved._NbRenderedFrames  = 3;
+  saved._NbSamplesPerPixel = 2;
+  saved._Bounces           = 3;
+  saved._TiledRendering    = true;
+  saved._NbTiles           = scheduler.GetNbTiles();
+  saved._TileSamples       = scheduler.GetSamples();
+  saved._TileErrors        = scheduler.GetErrors();
+  saved._TileCursor        = scheduler.GetScanlineCursor();
+  saved._CameraPos         = Vec3(1.f, 2.f, 3.f);
+  saved._CameraForward     = Vec3(0.f, 0.f, -1.f);
+  saved._CameraFOV         = .8f;
+
+  if ( !WriteCheckpoint(path, saved) || fs::exists(path.string() + ".tmp", error) )
+  {
+    std::cerr << "Unable to write the checkpoint " << path << std::endl;
+    return false;
+  }
+
+  AccumulationCheckpoint loaded;
+  std::vector<std::vector<float>> layers;
+  if ( !ReadCheckpoint(path, loaded, layers) )
+  {
+    std::cerr << "Unable to read back the checkpoint" << std::endl;
+    return false;
+  }
+
+  std::string reason;
+  if ( !loaded.IsCompatible(saved, reason) || ( loaded._NbCompleteFrames != saved._NbCompleteFrames ) || ( loaded._FrameNum != saved._FrameNum )
+    || ( loaded._NbRenderedFrames != saved._NbRenderedFrames ) || ( loaded._TileSamples != saved._TileSamples ) || ( loaded._TileErrors != saved._TileErrors )
+    || ( loaded._TileCursor != saved._TileCursor ) )
+  {
+    std::cerr << "Checkpoint header differs after a round trip " << reason << std::endl;
+    return false;
+  }
+  for ( int i = 0; i < AccumulationCheckpoint::_NbLayers; ++i )
+  {
+    if ( layers[i] != MakeLayer(saved, i) )
+    {
+      std::cerr << "Checkpoint layer " << i << " differs after a round trip" << std::endl;
+      return false;
+    }
+  }
+
+  // The restored scheduler picks the same tiles
+  TileScheduler restored;
+  if ( !restored.Restore(loaded._NbTiles, loaded._TileSamples, loaded._TileErrors, loaded._TileCursor) )
+  {
+    std::cerr << "Tile progress not restored" << std::endl;
+    return false;
+  }
+  scheduler.BeginFrame();
+  restored.BeginFrame();
+  for ( int i = 0; i < 4; ++i )
+  {
+    if ( scheduler.NextTile(TileScheduler::Order::Prioritized) != restored.NextTile(TileScheduler::Order::Prioritized) )
+    {
+      std::cerr << "Restored tile order differs" << std::endl;
+      return false;
+    }
+  }
+
+  // Another view or sampling is refused
+  AccumulationCheckpoint other = saved;
+  other._CameraPos.x += 1.f;
+  const bool cameraRefused = !loaded.IsCompatible(other, reason);
+  other = saved;
+  other._Resolution.x++;
+  const bool resolutionRefused = !loaded.IsCompatible(other, reason);
+  other = saved;
+  other._NbSamplesPerPixel++;
+  if ( !cameraRefused || !resolutionRefused || loaded.IsCompatible(other, reason) )
+  {
+    std::cerr << "Incompatible checkpoint accepted" << std::endl;
+    return false;
+  }
+
+  // An interrupted write keeps the previous checkpoint
+  {
+    AccumulationCheckpoint next = saved;
+    next._FrameNum = 43;
+    AccumulationCheckpointWriter writer;
+    if ( !writer.Open(path, next) || !writer.WriteLayer(MakeLayer(next, 0).data()) || writer.Close() )
+    {
+      std::cerr << "Incomplete checkpoint accepted" << std::endl;
+      return false;
+    }
+  }
+  if ( !ReadCheckpoint(path, loaded, layers) || ( 42 != loaded._FrameNum ) )
+  {
+    std::cerr << "Previous checkpoint lost by an interrupted write" << std::endl;
+    return false;
+  }
+
+  // Damaged layer
+  {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(-8, std::ios::end);
+    file.put('\x7f');
+  }
+  if ( ReadCheckpoint(path, loaded, layers) )
+  {
+    std::cerr << "Damaged checkpoint accepted" << std::endl;
+    return false;
+  }
+
+  // Truncated file
+  fs::resize_file(path, fs::file_size(path) / 2, error);
+  if ( ReadCheckpoint(path, loaded, layers) )
+  {
+    std::cerr << "Truncated checkpoint accepted" << std::endl;
+    return false;
+  }
+
+  fs::remove_all(directory, error);
+  return true;
+}
+
+}
+
+static bool SameImages( const fs::path & iActual, const fs::path & iExpected )
+{
+  int width[2] = { 0, 0 }, height[2] = { 0, 0 };
+  unsigned char * actual = stbi_load(iActual.string().c_str(), &width[0], &height[0], nullptr, 4);
+  unsigned char * expected = stbi_load(iExpected.string().c_str(), &width[1], &height[1], nullptr, 4);
+  const bool same = actual && expected && ( width[0] == width[1] ) && ( height[0] == height[1] )
+                 && std::equal(actual, actual + static_cast<size_t>(width[0]) * height[0] * 4, expected);
+  stbi_image_free(actual);
+  stbi_image_free(expected);
+  return same;
+}
+
+bool CheckBatchResume( const fs::path & iArtifactsDir )
+{
+  std::error_code error;
+  const fs::path directory = iArtifactsDir / "batch_resume";
+  fs::remove_all(directory, error);
+
+  BatchRenderOptions options;
+  options._Scenes             = { "cornell_box.scene" };
+  options._Backend            = RendererBackend::PathTracer;
+  options._Resolution         = Vec2i(32, 24);
+  options._Frames             = 6;
+  options._SamplesPerPixel    = 1;
+  options._CheckpointInterval = 2;
+  options._TimingsPath        = ( directory / "timings.json" ).string();
+
+  for ( int nbCameras = 1; nbCameras <= 2; ++nbCameras )
+  {
+    options._NbCameras = nbCameras;
+    const std::string prefix = ( directory / ( std::to_string(nbCameras) + "cam_" ) ).string();
+
+    BatchRenderOptions uninterrupted = options;
+    uninterrupted._OutputPattern = prefix + "uninterrupted_{camera}.png";
+    if ( 0 != RunBatchRender(uninterrupted) )
+    {
+      // No timings : the batch never had a context
+      if ( !fs::exists(options._TimingsPath, error) )
+      {
+        std::cerr << "Batch resume skipped : no OpenGL context" << std::endl;
+        return true;
+      }
+      std::cerr << "Uninterrupted batch failed" << std::endl;
+      return false;
+    }
+
+    // Killed in the middle of the last camera, one frame after its last checkpoint
+    BatchRenderOptions interrupted = options;
+    interrupted._OutputPattern        = prefix + "resumed_{camera}.png";
+    interrupted._CheckpointPattern    = prefix + "{camera}.rtac";
+    interrupted._InterruptAfterFrames = ( nbCameras - 1 ) * options._Frames + options._CheckpointInterval + 1;
+    if ( 0 == RunBatchRender(interrupted) )
+    {
+      std::cerr << "Interrupted batch completed" << std::endl;
+      return false;
+    }
+
+    BatchRenderOptions resumed = interrupted;
+    resumed._InterruptAfterFrames = 0;
+    resumed._Resume = true;
+    if ( 0 != RunBatchRender(resumed) )
+    {
+      std::cerr << "Resumed batch failed" << std::endl;
+      return false;
+    }
+
+    for ( int camera = 0; camera < nbCameras; ++camera )
+    {
+      const fs::path output = FormatBatchOutputPath(resumed._OutputPattern, options._Scenes[0], camera, options._Backend);
+      const fs::path reference = FormatBatchOutputPath(uninterrupted._OutputPattern, options._Scenes[0], camera, options._Backend);
+      if ( !SameImages(output, reference) )
+      {
+        std::cerr << "Resumed " << nbCameras << " camera batch differs from the uninterrupted one at camera " << camera << std::endl;
+        return false;
+      }
+    }
+  }
+
+  fs::remove_all(directory, error);
+  return true;
+}
+
+}
+
+}
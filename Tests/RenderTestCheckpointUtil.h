@@ -0,0 +1,26 @@
+#ifndef _RenderTestCheckpointUtil_
+#define _RenderTestCheckpointUtil_
+
+#include <filesystem>
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace CheckpointTestUtil
+{
+
+bool CheckAccumulationCheckpoint();
+
+// Interrupted then resumed batch jobs, one and two cameras, against an uninterrupted batch. Needs an OpenGL context, skipped without.
+bool CheckBatchResume( const std::filesystem::path & iArtifactsDir );
+
+}
+
+}
+
+}
+
+#endif /* _RenderTestCheckpointUtil_ */
@@ -0,0 +1,240 @@
+#include "RenderTestCollisionUtil.h"
+
+#include "Boids.h"
+#include "FpsBroadphase.h"
+#include "FpsCollision.h"
+#include "FpsGame.h"
+#include "MathUtil.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace CollisionTestUtil
+{
+
+float NextRandom( uint32_t & ioState )
+{
+  ioState = ioState * 1664525u + 1013904223u;
+  return static_cast<float>(ioState >> 8) / static_cast<float>(1u << 24);
+}
+
+AABB<Vec3> RandomBox( uint32_t & ioState, float iRange, float iMaxHalfExtent )
+{
+  const Vec3 center(( NextRandom(ioState) * 2.f - 1.f ) * iRange,
+                    ( NextRandom(ioState) * 2.f - 1.f ) * iRange,
+                    ( NextRandom(ioState) * 2.f - 1.f ) * iRange);
+  const Vec3 halfExtents(0.01f + NextRandom(ioState) * iMaxHalfExtent,
+                         0.01f + NextRandom(ioState) * iMaxHalfExtent,
+                         0.01f + NextRandom(ioState) * iMaxHalfExtent);
+  AABB<Vec3> box;
+  box.Insert(center - halfExtents);
+  box.Insert(center + halfExtents);
+  return box;
+}
+
+bool CheckIndices( const char * iLayer, int iQuery, const std::vector<int> & iActual, const std::vector<int> & iExpected )
+{
+  if ( iActual == iExpected )
+    return true;
+
+  std::cerr << "Broadphase mismatch in query " << iQuery << ", " << iLayer
+            << ": expected " << iExpected.size() << " hits, got " << iActual.size() << std::endl;
+  return false;
+}
+
+bool CheckBroadphaseQueries()
+{
+  uint32_t state = 12345u;
+
+  std::vector<AABB<Vec3>> objectBounds(300);
+  for ( int i = 0; i < static_cast<int>(objectBounds.size()); ++i )
+  {
+    // Every 7th object is not collidable : empty bounds must be skipped
+    if ( 0 != ( i % 7 ) )
+      objectBounds[i] = RandomBox(state, 40.f, 2.f);
+  }
+
+  std::vector<FpsCollisionObb> colliders;
+  for ( int i = 0; i < 200; ++i )
+  {
+    const AABB<Vec3> localBounds = RandomBox(state, 1.f, 1.f);
+    const Vec3 position(( NextRandom(state) * 2.f - 1.f ) * 40.f, NextRandom(state) * 10.f, ( NextRandom(state) * 2.f - 1.f ) * 40.f);
+    const Vec3 rotation(0.f, NextRandom(state) * 360.f, NextRandom(state) * 45.f);
+    colliders.push_back(FpsCollision::MakeObb(0, i, localBounds, FpsCollision::EulerTransform(position, rotation)));
+  }
+
+  FpsBroadphase broadphase;
+  if ( 0 != broadphase.Build(objectBounds, colliders) )
+    return false;
+
+  FpsBroadphaseQuery result;
+  for ( int query = 0; query < 500; ++query )
+  {
+    const AABB<Vec3> queryBounds = RandomBox(state, 45.f, 6.f);
+    broadphase.Query(queryBounds, result);
+
+    std::vector<int> expectedObjects;
+    for ( int i = 0; i < static_cast<int>(objectBounds.size()); ++i )
+    {
+      if ( ( 0 != ( i % 7 ) ) && FpsCollision::OverlapAABB(queryBounds, objectBounds[i]) )
+        expectedObjects.push_back(i);
+    }
+
+    std::vector<int> expectedColliders;
+    for ( int i = 0; i < static_cast<int>(colliders.size()); ++i )
+    {
+      if ( FpsCollision::OverlapAABB(queryBounds, colliders[i]._Bounds) )
+        expectedColliders.push_back(i);
+    }
+
+    if ( !CheckIndices("objects", query, result._Objects, expectedObjects)
+      || !CheckIndices("colliders", query, result._Colliders, expectedColliders) )
+      return false;
+  }
+
+  broadphase.Clear();
+  AABB<Vec3> unitBounds;
+  unitBounds.Insert(Vec3(-1.f));
+  unitBounds.Insert(Vec3(1.f));
+  broadphase.Query(unitBounds, result);
+  return result._Objects.empty() && result._Colliders.empty();
+}
+
+bool CheckSweptSphereObb()
+{
+  // Fast sphere crossing a thin wall in a single step must not tunnel through it
+  const Vec3 worldAxes[3] = { Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f) };
+  const FpsCollisionObb wall = FpsCollision::MakeObb(-1, -1, Vec3(0.f), worldAxes, Vec3(0.01f, 2.f, 2.f));
+  FpsCollisionSweepResult sweep;
+  if ( !FpsCollision::SweepSphereObb(Vec3(-5.f, 0.f, 0.f), Vec3(10.f, 0.f, 0.f), 0.1f, wall, sweep)
+    || ( std::fabs(sweep._Time - 0.489f) > 1.e-4f ) || ( sweep._Normal.x > -0.999f ) )
+  {
+    std::cerr << "Swept sphere tunneled through a thin wall" << std::endl;
+    return false;
+  }
+
+  // Documented approximation : passing 0.127 away from an edge, outside the rounded shape but inside the inflated box
+  const FpsCollisionObb cube = FpsCollision::MakeObb(-1, -1, Vec3(0.f), worldAxes, Vec3(1.f));
+  if ( !FpsCollision::SweepSphereObb(Vec3(1.09f, 1.09f, -5.f), Vec3(0.f, 0.f, 10.f), 0.1f, cube, sweep)
+    || FpsCollision::SweepSphereObb(Vec3(1.11f, 1.09f, -5.f), Vec3(0.f, 0.f, 10.f), 0.1f, cube, sweep) )
+  {
+    std::cerr << "Swept sphere no longer tests the box inflated by the radius" << std::endl;
+    return false;
+  }
+
+  // Batched lanes must match the scalar sweep against random oriented boxes
+  uint32_t state = 6789u;
+  for ( int iteration = 0; iteration < 200; ++iteration )
+  {
+    const AABB<Vec3> localBounds = RandomBox(state, 2.f, 2.f);
+    const Vec3 rotation(NextRandom(state) * 360.f, NextRandom(state) * 360.f, NextRandom(state) * 360.f);
+    const FpsCollisionObb obb = FpsCollision::MakeObb(0, 0, localBounds, FpsCollision::EulerTransform(Vec3(0.f), rotation));
+
+    FpsCollisionSweepBatch batch;
+    batch._Radius = 0.05f + NextRandom(state) * 0.3f;
+    batch._NbLanes = FpsCollisionSweepBatch::S_NbLanes;
+    for ( int lane = 0; lane < batch._NbLanes; ++lane )
+    {
+      const AABB<Vec3> start = RandomBox(state, 8.f, 0.01f);
+      const AABB<Vec3> end = RandomBox(state, 8.f, 0.01f);
+      const Vec3 delta = end.Center() - start.Center();
+      batch._StartX[lane] = start.Center().x;
+      batch._StartY[lane] = start.Center().y;
+      batch._StartZ[lane] = start.Center().z;
+      // Some lanes move along a single world axis to exercise the parallel slab case
+      batch._DeltaX[lane] = delta.x;
+      batch._DeltaY[lane] = ( 0 == ( lane % 4 ) ) ? 0.f : delta.y;
+      batch._DeltaZ[lane] = ( 0 == ( lane % 4 ) ) ? 0.f : delta.z;
+    }
+
+    FpsCollisionSweepBatchResult hits;
+    hits.Reset();
+    FpsCollision::SweepSphereObbBatch(batch, obb, 3, hits);
+
+    for ( int lane = 0; lane < batch._NbLanes; ++lane )
+    {
+      const Vec3 start(batch._StartX[lane], batch._StartY[lane], batch._StartZ[lane]);
+      const Vec3 delta(batch._DeltaX[lane], batch._DeltaY[lane], batch._DeltaZ[lane]);
+      const bool hit = FpsCollision::SweepSphereObb(start, delta, batch._Radius, obb, sweep) && ( sweep._Time < 1.f );
+      if ( hit != ( 3 == hits._Shape[lane] ) )
+      {
+        std::cerr << "Swept sphere batch mismatch in iteration " << iteration << ", lane " << lane << std::endl;
+        return false;
+      }
+
+      if ( hit && ( ( std::fabs(sweep._Time - hits._Time[lane]) > 1.e-4f )
+                 || ( std::fabs(sweep._Normal.x - hits._NormalX[lane]) > 1.e-4f )
+                 || ( std::fabs(sweep._Normal.y - hits._NormalY[lane]) > 1.e-4f )
+                 || ( std::fabs(sweep._Normal.z - hits._NormalZ[lane]) > 1.e-4f ) ) )
+      {
+        std::cerr << "Swept sphere batch hit differs in iteration " << iteration << ", lane " << lane << std::endl;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool CheckBoidWorldCollision()
+{
+  const Vec3 worldAxes[3] = { Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f) };
+  FpsGameWorld world;
+  world.SetPropCollisionColliders({ FpsCollision::MakeObb(0, 0, Vec3(0.f), worldAxes, Vec3(1.f)) });
+
+  BoidSettings settings;
+  settings._Count = 2;
+  settings._Scale = 0.2f;
+  BoidSimulation simulation;
+  if ( 0 != simulation.Initialize(settings) )
+    return false;
+
+  // One boid flying into the box through its +X face, one far away
+  std::vector<BoidState> & boids = simulation.GetBoids();
+  boids[0]._Position = Vec3(1.05f, 0.f, 0.f);
+  boids[0]._Velocity = Vec3(-1.f, 0.5f, 0.f);
+  boids[1]._Position = Vec3(5.f, 0.f, 0.f);
+  boids[1]._Velocity = Vec3(-1.f, 0.f, 0.f);
+  const std::vector<BoidState> initial = boids;
+
+  // Off by default : flocks keep flying through the world
+  if ( ( 0 != world.ResolveBoidCollisions(simulation, settings) )
+    || ( boids[0]._Position != initial[0]._Position ) || ( boids[0]._Velocity != initial[0]._Velocity ) )
+  {
+    std::cerr << "Boid collided with the world while collisions are disabled" << std::endl;
+    return false;
+  }
+
+  settings._CollideWithWorld = true;
+  if ( 0 != world.ResolveBoidCollisions(simulation, settings) )
+    return false;
+
+  if ( ( std::fabs(boids[0]._Position.x - 1.1f) > 1.e-4f ) || ( std::fabs(boids[0]._Position.y) > 1.e-4f )
+    || ( std::fabs(boids[0]._Velocity.x - 1.f) > 1.e-4f ) || ( std::fabs(boids[0]._Velocity.y - 0.5f) > 1.e-4f ) )
+  {
+    std::cerr << "Boid was not pushed out of the box with a reflected velocity" << std::endl;
+    return false;
+  }
+
+  if ( ( boids[1]._Position != initial[1]._Position ) || ( boids[1]._Velocity != initial[1]._Velocity ) )
+  {
+    std::cerr << "Boid away from the world was moved" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+}
+
+}
+
+}
@@ -0,0 +1,23 @@
+#ifndef _RenderTestCollisionUtil_
+#define _RenderTestCollisionUtil_
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace CollisionTestUtil
+{
+
+bool CheckBroadphaseQueries();
+bool CheckSweptSphereObb();
+bool CheckBoidWorldCollision();
+
+}
+
+}
+
+}
+
+#endif /* _RenderTestCollisionUtil_ */
@@ -0,0 +1,110 @@
+#include "RenderTestDistributedUtil.h"
+
+#include "DistributedRender.h"
+#include "Loader.h"
+#include "PathUtils.h"
+#include "Renderer.h"
+#include "RenderSettings.h"
+#include "Scene.h"
+#include "SoftwareRasterizer.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace DistributedTestUtil
+{
+
+// Coordinator and workers on the loopback, in threads : the first worker leaves after one tile
+bool CheckDistributedRender()
+{
+  DistributedRenderOptions options;
+  options._Scene = "cornell_box.scene";
+  options._Resolution = Vec2i(48, 32);
+  options._TileResolution = Vec2i(16);
+  options._NbWorkers = 0;
+  options._TilesPerRange = 2;
+  options._TimeoutSeconds = 10;
+
+  TileCoordinator coordinator;
+  if ( 0 != coordinator.Listen(0) )
+  {
+    std::cerr << "Unable to listen on the loopback" << std::endl;
+    return false;
+  }
+
+  RenderImage image;
+  RenderSettings settings;
+  int result = 1;
+  std::thread coordinatorThread([&]() { result = coordinator.Run(options, image, settings); });
+
+  TileWorkerOptions workerOptions;
+  workerOptions._Port = coordinator.GetPort();
+  workerOptions._MaxTiles = 1;
+  int faultyResult = 0;
+  std::thread faultyWorker([&]() { faultyResult = RunTileWorker(workerOptions); });
+  faultyWorker.join();
+
+  workerOptions._MaxTiles = 0;
+  int workerResult = 1;
+  std::thread worker([&]() { workerResult = RunTileWorker(workerOptions); });
+  worker.join();
+  coordinatorThread.join();
+
+  const DistributedRenderStats & stats = coordinator.GetStats();
+  if ( ( 0 != result ) || ( 0 != workerResult ) || ( 1 != faultyResult ) )
+  {
+    std::cerr << "Distributed render failed : coordinator " << result << ", workers " << faultyResult << " " << workerResult << std::endl;
+    return false;
+  }
+  if ( ( 6 != stats._NbTiles ) || ( 2 != stats._NbWorkers ) || ( 1 != stats._NbLostWorkers ) || ( 1 != stats._NbReassignedTiles ) )
+  {
+    std::cerr << "Unexpected distributed stats : " << stats._NbTiles << " tiles, " << stats._NbWorkers << " workers, "
+              << stats._NbLostWorkers << " lost, " << stats._NbReassignedTiles << " reassigned" << std::endl;
+    return false;
+  }
+
+  // Same frame rendered in a single process
+  Scene scene;
+  RenderSettings localSettings;
+  if ( !Loader::LoadScene(PathUtils::GetAssetPath(options._Scene), scene, localSettings) )
+  {
+    std::cerr << "Unable to load " << options._Scene << std::endl;
+    return false;
+  }
+  localSettings._WindowResolution = options._Resolution;
+  localSettings._RenderScale = 100;
+  localSettings._TileResolution = options._TileResolution;
+  localSettings._TiledRendering = true;
+
+  SoftwareRasterizer rasterizer(scene, localSettings);
+  RenderImage reference;
+  reference._Width = options._Resolution.x;
+  reference._Height = options._Resolution.y;
+  if ( ( 0 != rasterizer.InitializeCPU() ) || ( 0 != rasterizer.RenderRegions({}) )
+    || ( 0 != rasterizer.ReadRegion(Vec4i(0, 0, reference._Width, reference._Height), reference._Pixels) ) )
+  {
+    std::cerr << "Reference render failed" << std::endl;
+    return false;
+  }
+
+  if ( ( image._Width != reference._Width ) || ( image._Height != reference._Height ) || ( image._Pixels != reference._Pixels ) )
+  {
+    std::cerr << "Assembled frame differs from the single process render" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+}
+
+}
+
+}
@@ -0,0 +1,21 @@
+#ifndef _RenderTestDistributedUtil_
+#define _RenderTestDistributedUtil_
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace DistributedTestUtil
+{
+
+bool CheckDistributedRender();
+
+}
+
+}
+
+}
+
+#endif /* _RenderTestDistributedUtil_ */
@@ -1,6 +1,14 @@
 #include "RenderTestFramework.h"
+#include "RenderTestBatchUtil.h"
+#include "RenderTestCheckpointUtil.h"
+#include "RenderTestCollisionUtil.h"
+#include "RenderTestDistributedUtil.h"
 #include "RenderTestImageUtil.h"
+#include "RenderTestSceneUtil.h"
 #include "RenderTestSIMDUtil.h"
+#include "RenderTestSimulationUtil.h"
+#include "RenderTestSortUtil.h"
+#include "RenderTestTileUtil.h"
 
 #include "RenderSettings.h"
 #include "Scene.h"
@@ -393,6 +401,48 @@ int RunUnitTests( const std::filesystem::path & iArtifactsDir, bool iUseColor, b
   PrintSkipped("simd_loaded_scene_data");
 #endif
 
+  if ( !RunUnitTest("fps_broadphase", []() { return CollisionTestUtil::CheckBroadphaseQueries(); }) )
+    return 1;
+
+  if ( !RunUnitTest("fps_swept_sphere", []() { return CollisionTestUtil::CheckSweptSphereObb(); }) )
+    return 1;
+
+  if ( !RunUnitTest("fps_boid_collision", []() { return CollisionTestUtil::CheckBoidWorldCollision(); }) )
+    return 1;
+
+  if ( !RunUnitTest("fps_task_graph_order", []() { return SimulationTestUtil::CheckTaskGraphOrder(); }) )
+    return 1;
+
+  if ( !RunUnitTest("fps_task_graph_errors", []() { return SimulationTestUtil::CheckTaskGraphErrors(); }) )
+    return 1;
+
+  if ( !RunUnitTest("scene_instance_tracking", []() { return SceneTestUtil::CheckMeshInstanceTracking(); }) )
+    return 1;
+
+  if ( !RunUnitTest("tlas_refit", []() { return SceneTestUtil::CheckTLASRefit(); }) )
+    return 1;
+
+  if ( !RunUnitTest("picker_refit", []() { return SceneTestUtil::CheckPickerRefit(); }) )
+    return 1;
+
+  if ( !RunUnitTest("radix_sort", []() { return SortTestUtil::CheckRadixSort(); }) )
+    return 1;
+
+  if ( !RunUnitTest("tile_scheduler", []() { return TileTestUtil::CheckTileScheduler(); }) )
+    return 1;
+
+  if ( !RunUnitTest("batch_args", []() { return BatchTestUtil::CheckBatchArgs(); }) )
+    return 1;
+
+  if ( !RunUnitTest("distributed_tiles", []() { return DistributedTestUtil::CheckDistributedRender(); }) )
+    return 1;
+
+  if ( !RunUnitTest("accumulation_checkpoint", []() { return CheckpointTestUtil::CheckAccumulationCheckpoint(); }) )
+    return 1;
+
+  if ( !RunUnitTest("batch_resume", [&iArtifactsDir]() { return CheckpointTestUtil::CheckBatchResume(iArtifactsDir); }) )
+    return 1;
+
   RenderImage image;
   image._Width = 2;
   image._Height = 1;
@@ -427,6 +477,9 @@ int RunUnitTests( const std::filesystem::path & iArtifactsDir, bool iUseColor, b
   }) )
     return 1;
 
+  if ( !RunUnitTest("envmap_sampling", [&iArtifactsDir]() { return SceneTestUtil::CheckEnvMapSampling(iArtifactsDir); }) )
+    return 1;
+
   const std::string validManifest = R"({
     "version": 1,
     "profiles": {
@@ -0,0 +1,392 @@
+#include "RenderTestSceneUtil.h"
+
+#include "Scene.h"
+#include "Mesh.h"
+#include "GLStagingBuffer.h"
+#include "MeshInstance.h"
+#include "EnvMap.h"
+#include "MathUtil.h"
+#include "ScenePicker.h"
+
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace SceneTestUtil
+{
+
+bool CheckMeshInstanceTracking()
+{
+  Scene scene;
+  for ( int i = 0; i < 8; ++i )
+  {
+    MeshInstance instance("__Tracked", 0, 0, Mat4x4(1.f));
+    scene.AddMeshInstance(instance);
+  }
+
+  std::vector<int> dirty;
+  const uint64_t loaded = scene.GetMeshInstanceGeneration();
+  if ( !scene.GetDirtyMeshInstances(loaded, dirty) || !dirty.empty() )
+  {
+    std::cerr << "Fresh scene reports dirty instances" << std::endl;
+    return false;
+  }
+
+  // Writing an unchanged value must not flag anything
+  scene.SetMeshInstanceTransform(3, Mat4x4(1.f));
+  scene.SetMeshInstanceVisible(3, true);
+  if ( scene.GetMeshInstanceGeneration() != loaded )
+  {
+    std::cerr << "Unchanged instance writes bumped the generation" << std::endl;
+    return false;
+  }
+
+  const Mat4x4 moved = glm::translate(Mat4x4(1.f), Vec3(1.f, 2.f, 3.f));
+  scene.SetMeshInstanceTransform(5, moved);
+  scene.SetMeshInstanceVisible(2, false);
+  scene.SetMeshInstanceTransform(5, glm::translate(Mat4x4(1.f), Vec3(2.f, 2.f, 3.f)));
+  const uint64_t firstSync = scene.GetMeshInstanceGeneration();
+
+  if ( !scene.GetDirtyMeshInstances(loaded, dirty) )
+  {
+    std::cerr << "Dirty history lost after tracked writes" << std::endl;
+    return false;
+  }
+  std::sort(dirty.begin(), dirty.end());
+  if ( ( dirty.size() != 2 ) || ( 2 != dirty[0] ) || ( 5 != dirty[1] ) )
+  {
+    std::cerr << "Unexpected dirty instances after the first sync, count " << dirty.size() << std::endl;
+    return false;
+  }
+
+  // A consumer synced after the first batch only sees later changes
+  scene.SetMeshInstanceTransform(6, moved);
+  if ( !scene.GetDirtyMeshInstances(firstSync, dirty) || ( dirty.size() != 1 ) || ( 6 != dirty[0] ) )
+  {
+    std::cerr << "Incremental dirty query returned stale instances" << std::endl;
+    return false;
+  }
+
+  // Structural changes drop the history : consumers must rescan everything
+  MeshInstance extra("__Tracked", 0, 0, Mat4x4(1.f));
+  scene.AddMeshInstance(extra);
+  if ( scene.GetDirtyMeshInstances(firstSync, dirty) )
+  {
+    std::cerr << "Dirty history survived an instance addition" << std::endl;
+    return false;
+  }
+  const uint64_t reset = scene.GetMeshInstanceGeneration();
+  if ( !scene.GetDirtyMeshInstances(reset, dirty) || !dirty.empty() )
+  {
+    std::cerr << "Synced consumer reports dirty instances after a reset" << std::endl;
+    return false;
+  }
+
+  scene.MarkMeshInstanceDirty(8);
+  if ( !scene.GetDirtyMeshInstances(reset, dirty) || ( dirty.size() != 1 ) || ( 8 != dirty[0] ) )
+  {
+    std::cerr << "Explicitly marked instance missing from the dirty list" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static bool CheckTLASNodes( const std::vector<GpuBvh::Node> & iNodes )
+{
+  for ( const GpuBvh::Node & node : iNodes )
+  {
+    if ( node._LcRcLeaf.z < 0.f )
+      continue;
+    for ( int child = 0; child < 2; ++child )
+    {
+      const GpuBvh::Node & childNode = iNodes[static_cast<int>(node._LcRcLeaf[child])];
+      for ( int axis = 0; axis < 3; ++axis )
+      {
+        if ( ( childNode._BBoxMin[axis] < node._BBoxMin[axis] ) || ( childNode._BBoxMax[axis] > node._BBoxMax[axis] ) )
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool CheckTLASRefit()
+{
+  Scene scene;
+  std::vector<Vec3> vertices = { Vec3(-.5f, -.5f, -.5f), Vec3(.5f, -.5f, -.5f), Vec3(0.f, .5f, .5f) };
+  std::vector<Vec3i> indices = { Vec3i(0, 0, 0), Vec3i(1, 1, 1), Vec3i(2, 2, 2) };
+  std::vector<Vec3> normals(3, Vec3(0.f, 0.f, 1.f));
+  std::vector<Vec2> uvs(3, Vec2(0.f));
+  scene.AddMesh(new Mesh("__Triangle", vertices, normals, uvs, indices));
+
+  for ( int i = 0; i < 64; ++i )
+  {
+    MeshInstance instance("__Triangle", 0, 0, glm::translate(Mat4x4(1.f), Vec3(i % 8, 0.f, i / 8) * 2.f));
+    scene.AddMeshInstance(instance);
+  }
+  if ( ( 0 != scene.RebuildTLASData() ) || ( 64 != scene.GetTLASPackedTransforms().size() ) )
+  {
+    std::cerr << "TLAS could not be built" << std::endl;
+    return false;
+  }
+
+  // A small move refits the leaf and its ancestors only
+  uint64_t synced = scene.GetMeshInstanceGeneration();
+  const Mat4x4 moved = glm::translate(Mat4x4(1.f), Vec3(5.f, 1.f, 6.5f));
+  scene.SetMeshInstanceTransform(27, moved);
+
+  std::vector<int> dirty, nodeIDs, packedIDs;
+  if ( !scene.GetDirtyMeshInstances(synced, dirty) || ( 0 != scene.RefitTLASData(dirty, nodeIDs, packedIDs) ) )
+  {
+    std::cerr << "Moved instance was not refitted" << std::endl;
+    return false;
+  }
+  if ( ( 1 != packedIDs.size() ) || ( scene.GetTLASPackedTransforms()[packedIDs[0]] != moved ) )
+  {
+    std::cerr << "Refit did not update the packed transform" << std::endl;
+    return false;
+  }
+  if ( nodeIDs.empty() || ( 0 != nodeIDs[0] ) || ( nodeIDs.size() >= scene.GetTLASNode().size() / 2 ) )
+  {
+    std::cerr << "Refit touched " << nodeIDs.size() << " nodes, root included : " << ( !nodeIDs.empty() && !nodeIDs[0] ) << std::endl;
+    return false;
+  }
+  if ( !CheckTLASNodes(scene.GetTLASNode()) || ( scene.GetTLASNode()[0]._BBoxMax.y < 1.5f ) )
+  {
+    std::cerr << "Refitted node bounds do not contain their children" << std::endl;
+    return false;
+  }
+
+  // Scattering the instances degrades the tree : the refit asks for a rebuild
+  synced = scene.GetMeshInstanceGeneration();
+  for ( int i = 0; i < 64; i += 2 )
+    scene.SetMeshInstanceTransform(i, glm::translate(Mat4x4(1.f), Vec3(63 - i, 0.f, i) * 2.f));
+  if ( !scene.GetDirtyMeshInstances(synced, dirty) || ( 0 == scene.RefitTLASData(dirty, nodeIDs, packedIDs) ) )
+  {
+    std::cerr << "Scattered instances did not request a rebuild" << std::endl;
+    return false;
+  }
+
+  // Visibility changes the packed instances : rebuild
+  scene.RebuildTLASData();
+  synced = scene.GetMeshInstanceGeneration();
+  scene.SetMeshInstanceVisible(3, false);
+  if ( !scene.GetDirtyMeshInstances(synced, dirty) || ( 0 == scene.RefitTLASData(dirty, nodeIDs, packedIDs) ) )
+  {
+    std::cerr << "Hidden instance did not request a rebuild" << std::endl;
+    return false;
+  }
+
+  // Dirty indices to upload ranges
+  std::vector<int> indicesToMerge = { 20, 3, 1, 2, 3, 9 };
+  std::vector<Vec2i> ranges;
+  GLStagingBuffer::Coalesce(indicesToMerge, 4, ranges);
+  if ( ( 3 != ranges.size() ) || ( Vec2i(1, 3) != ranges[0] ) || ( Vec2i(9, 1) != ranges[1] ) || ( Vec2i(20, 1) != ranges[2] ) )
+  {
+    std::cerr << "Dirty ranges were not coalesced" << std::endl;
+    return false;
+  }
+  GLStagingBuffer::Coalesce(indicesToMerge, 5, ranges);
+  if ( ( 2 != ranges.size() ) || ( Vec2i(1, 9) != ranges[0] ) )
+  {
+    std::cerr << "Close dirty ranges were not merged" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// Instances inside the box centered on iCenter, 2 units wide
+static std::vector<int> SelectAround( const ScenePicker & iPicker, const Vec3 & iCenter )
+{
+  std::vector<int> instanceIDs;
+  iPicker.SelectFrustum(glm::translate(Mat4x4(1.f), -iCenter), instanceIDs);
+  std::sort(instanceIDs.begin(), instanceIDs.end());
+  return instanceIDs;
+}
+
+bool CheckPickerRefit()
+{
+  Scene scene;
+  std::vector<Vec3> vertices = { Vec3(-.5f, -.5f, -.5f), Vec3(.5f, -.5f, -.5f), Vec3(0.f, .5f, .5f) };
+  std::vector<Vec3i> indices = { Vec3i(0, 0, 0), Vec3i(1, 1, 1), Vec3i(2, 2, 2) };
+  std::vector<Vec3> normals(3, Vec3(0.f, 0.f, 1.f));
+  std::vector<Vec2> uvs(3, Vec2(0.f));
+  scene.AddMesh(new Mesh("__Triangle", vertices, normals, uvs, indices));
+
+  for ( int i = 0; i < 64; ++i )
+  {
+    MeshInstance instance("__Triangle", 0, 0, glm::translate(Mat4x4(1.f), Vec3(i % 8, 0.f, i / 8) * 2.f));
+    scene.AddMeshInstance(instance);
+  }
+
+  ScenePicker picker;
+  if ( ( 0 != picker.Update(scene) ) || ( 64 != picker.GetNbInstances() ) || ( std::vector<int>{ 27 } != SelectAround(picker, Vec3(6.f, 0.f, 6.f)) ) )
+  {
+    std::cerr << "Picker did not select the instance at its initial position" << std::endl;
+    return false;
+  }
+
+  // A moved instance is picked at its new position only
+  scene.SetMeshInstanceTransform(27, glm::translate(Mat4x4(1.f), Vec3(6.f, 3.f, 6.f)));
+  if ( ( 0 != picker.Update(scene) ) || ( 64 != picker.GetNbInstances() )
+    || ( std::vector<int>{ 27 } != SelectAround(picker, Vec3(6.f, 3.f, 6.f)) ) || !SelectAround(picker, Vec3(6.f, 0.f, 6.f)).empty() )
+  {
+    std::cerr << "Picker was not refitted after an instance moved" << std::endl;
+    return false;
+  }
+
+  // A hidden instance leaves the picker
+  scene.SetMeshInstanceVisible(27, false);
+  if ( ( 0 != picker.Update(scene) ) || ( 63 != picker.GetNbInstances() ) || !SelectAround(picker, Vec3(6.f, 3.f, 6.f)).empty() )
+  {
+    std::cerr << "Picker was not rebuilt after an instance was hidden" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool CheckEnvMapSampling( const std::filesystem::path & iArtifactsDir )
+{
+  // Dim background, a bright spot near the north pole and another near the horizon
+  const int width = 384, height = 192;
+  std::vector<float> pixels(width * height * 3, .1f);
+  for ( int c = 0; c < 3; ++c )
+  {
+    pixels[( 10 + 2 * width ) * 3 + c] = 2e5f;
+    pixels[( 300 + 120 * width ) * 3 + c] = 1e5f;
+  }
+
+  const std::filesystem::path envMapPath = iArtifactsDir / "unit_envmap.hdr";
+  EnvMap envMap;
+  if ( !stbi_write_hdr(envMapPath.string().c_str(), width, height, 3, pixels.data()) || !envMap.Load(envMapPath.string()) )
+  {
+    std::cerr << "Environment map could not be written and loaded back" << std::endl;
+    return false;
+  }
+
+  // Reference texel probabilities : luminance * sin(theta)
+  const float * raw = envMap.GetRawData();
+  std::vector<double> weights(width * height);
+  std::vector<double> rowWeights(height, 0.);
+  double total = 0.;
+  for ( int y = 0; y < height; ++y )
+  {
+    const double sinTheta = std::sin(( y + .5 ) / height * M_PI);
+    for ( int x = 0; x < width; ++x )
+    {
+      const int index = x + y * width;
+      weights[index] = MathUtil::Luminance(Vec3(raw[3 * index], raw[3 * index + 1], raw[3 * index + 2])) * sinTheta;
+      rowWeights[y] += weights[index];
+    }
+    total += rowWeights[y];
+  }
+
+  if ( std::abs(envMap.GetTotalWeight() - total) > 1e-4 * total )
+  {
+    std::cerr << "Environment map total weight " << envMap.GetTotalWeight() << " instead of " << total << std::endl;
+    return false;
+  }
+
+  // The CDFs end at 1 and never decrease
+  const float * marginal = envMap.GetMarginalCDF();
+  const float * conditional = envMap.GetConditionalCDF();
+  for ( int y = 0; y < height; ++y )
+  {
+    const float * row = &conditional[y * width];
+    if ( ( ( y > 0 ) && ( marginal[y] < marginal[y - 1] ) ) || ( row[width - 1] != 1.f ) || !std::is_sorted(row, row + width) )
+    {
+      std::cerr << "Environment map CDF is not monotonic at row " << y << std::endl;
+      return false;
+    }
+  }
+  if ( marginal[height - 1] != 1.f )
+  {
+    std::cerr << "Environment map marginal CDF does not end at 1" << std::endl;
+    return false;
+  }
+
+  // Each alias table gives back the probabilities it was built from
+  const float * aliasTable = envMap.GetAliasTable();
+  const int aliasWidth = envMap.GetAliasTableWidth();
+  auto checkAliasTable = [aliasTable, aliasWidth]( int iRow, int iCount, const double * iWeights, double iSum )
+  {
+    std::vector<double> probabilities(iCount, 0.);
+    for ( int i = 0; i < iCount; ++i )
+    {
+      const float threshold = aliasTable[2 * ( i + iRow * aliasWidth )];
+      const int alias = static_cast<int>(aliasTable[2 * ( i + iRow * aliasWidth ) + 1]);
+      if ( ( alias < 0 ) || ( alias >= iCount ) )
+        return false;
+      probabilities[i] += threshold / iCount;
+      probabilities[alias] += ( 1. - threshold ) / iCount;
+    }
+    for ( int i = 0; i < iCount; ++i )
+    {
+      if ( std::abs(probabilities[i] - iWeights[i] / iSum) > 1e-5 )
+        return false;
+    }
+    return true;
+  };
+
+  for ( int y = 0; y < height; ++y )
+  {
+    if ( !checkAliasTable(y, width, &weights[y * width], rowWeights[y]) )
+    {
+      std::cerr << "Environment map alias table of row " << y << " does not match its weights" << std::endl;
+      return false;
+    }
+  }
+  if ( !checkAliasTable(height, height, rowWeights.data(), total) )
+  {
+    std::cerr << "Environment map rows alias table does not match the row weights" << std::endl;
+    return false;
+  }
+
+  // CPU sampling : the bright spots get most of the samples, the pdf matches the texel weight
+  int nbBrightSamples = 0;
+  const int nbSamples = 32;
+  for ( int j = 0; j < nbSamples; ++j )
+  {
+    for ( int i = 0; i < nbSamples; ++i )
+    {
+      float pdf = 0.f;
+      Vec2 uv = envMap.ImportanceSample(Vec2(( i + .5f ) / nbSamples, ( j + .5f ) / nbSamples), pdf);
+      const int x = std::min(static_cast<int>(uv.x * width), width - 1);
+      const int y = std::min(static_cast<int>(uv.y * height), height - 1);
+      const double expectedPdf = weights[x + y * width] / total * width * height;
+      if ( std::abs(pdf - expectedPdf) > 1e-3 * expectedPdf )
+      {
+        std::cerr << "Environment map sample pdf " << pdf << " instead of " << expectedPdf << std::endl;
+        return false;
+      }
+      if ( raw[3 * ( x + y * width )] > 1.f )
+        nbBrightSamples++;
+    }
+  }
+  if ( nbBrightSamples < nbSamples * nbSamples / 2 )
+  {
+    std::cerr << "Environment map sampling missed the bright texels : " << nbBrightSamples << " samples" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+}
+
+}
+
+}
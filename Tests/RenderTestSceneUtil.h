@@ -0,0 +1,28 @@
+#ifndef _RenderTestSceneUtil_
+#define _RenderTestSceneUtil_
+
+#include <filesystem>
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace SceneTestUtil
+{
+
+bool CheckMeshInstanceTracking();
+
+bool CheckTLASRefit();
+bool CheckPickerRefit();
+
+bool CheckEnvMapSampling( const std::filesystem::path & iArtifactsDir );
+
+}
+
+}
+
+}
+
+#endif /* _RenderTestSceneUtil_ */
@@ -0,0 +1,128 @@
+#include "RenderTestSimulationUtil.h"
+
+#include "FpsSimulation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace SimulationTestUtil
+{
+
+bool CheckTaskGraphOrder()
+{
+  // Stamps record the completion order, tasks of the same wave may run on several threads
+  std::atomic<int> counter(0);
+  std::vector<int> stamps(6, -1);
+  std::vector<int> nbRuns(6, 0);
+  auto makeTask = [&]( int iTask ) { return [&, iTask]() { nbRuns[iTask]++; stamps[iTask] = counter++; return 0; }; };
+
+  // Diamond A -> B, C -> D, an independent task and a task spawning its own jobs
+  FpsSimulationGraph graph;
+  const int a = graph.AddTask("A", makeTask(0));
+  const int b = graph.AddTask("B", makeTask(1), { a });
+  const int c = graph.AddTask("C", makeTask(2), { a });
+  graph.AddTask("D", makeTask(3), { b, c });
+  graph.AddTask("E", makeTask(4));
+  graph.AddTask("F", makeTask(5), { a }, true);
+  const std::vector<std::vector<int>> dependencies = { {}, { a }, { a }, { b, c }, {}, { a } };
+
+  for ( int run = 0; run < 2; ++run )
+  {
+    counter = 0;
+    std::fill(stamps.begin(), stamps.end(), -1);
+    std::fill(nbRuns.begin(), nbRuns.end(), 0);
+
+    if ( ( 0 != graph.Execute() ) || ( 6 != graph.GetNbTasks() ) )
+    {
+      std::cerr << "Task graph failed in run " << run << std::endl;
+      return false;
+    }
+
+    for ( int task = 0; task < 6; ++task )
+    {
+      if ( 1 != nbRuns[task] )
+      {
+        std::cerr << "Task " << task << " ran " << nbRuns[task] << " times in run " << run << std::endl;
+        return false;
+      }
+      for ( int dependency : dependencies[task] )
+      {
+        if ( stamps[dependency] >= stamps[task] )
+        {
+          std::cerr << "Task " << task << " ran before its dependency " << dependency << std::endl;
+          return false;
+        }
+      }
+    }
+
+    // { A, E } then { B, C, F } then { D }
+    if ( 3 != graph.GetNbWaves() )
+    {
+      std::cerr << "Task graph ran in " << graph.GetNbWaves() << " waves, expected 3" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool CheckTaskGraphErrors()
+{
+  std::vector<int> nbRuns(3, 0);
+  FpsSimulationGraph graph;
+
+  // A failing task fails the graph but its dependents still run
+  const int failing = graph.AddTask("Failing", [&]() { nbRuns[0]++; return 1; });
+  graph.AddTask("Dependent", [&]() { nbRuns[1]++; return 0; }, { failing });
+  if ( ( 1 != graph.Execute() ) || ( 1 != nbRuns[0] ) || ( 1 != nbRuns[1] ) )
+  {
+    std::cerr << "Task graph did not report a failing task" << std::endl;
+    return false;
+  }
+
+  // Cycle : nothing is ready
+  nbRuns.assign(3, 0);
+  graph.Clear();
+  graph.AddTask("X", [&]() { nbRuns[0]++; return 0; }, { 1 });
+  graph.AddTask("Y", [&]() { nbRuns[1]++; return 0; }, { 0 });
+  graph.AddTask("Z", [&]() { nbRuns[2]++; return 0; });
+  if ( ( 1 != graph.Execute() ) || ( 0 != nbRuns[0] ) || ( 0 != nbRuns[1] ) || ( 1 != nbRuns[2] ) )
+  {
+    std::cerr << "Task graph did not reject a dependency cycle" << std::endl;
+    return false;
+  }
+
+  // Dependency on a task that does not exist
+  nbRuns.assign(3, 0);
+  graph.Clear();
+  graph.AddTask("Invalid", [&]() { nbRuns[0]++; return 0; }, { 7 });
+  if ( ( 1 != graph.Execute() ) || ( 0 != nbRuns[0] ) )
+  {
+    std::cerr << "Task graph did not reject an invalid dependency" << std::endl;
+    return false;
+  }
+
+  // Empty graph
+  graph.Clear();
+  if ( ( 0 != graph.Execute() ) || ( 0 != graph.GetNbWaves() ) )
+  {
+    std::cerr << "Empty task graph failed" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+}
+
+}
+
+}
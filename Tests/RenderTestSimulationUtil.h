@@ -0,0 +1,22 @@
+#ifndef _RenderTestSimulationUtil_
+#define _RenderTestSimulationUtil_
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace SimulationTestUtil
+{
+
+bool CheckTaskGraphOrder();
+bool CheckTaskGraphErrors();
+
+}
+
+}
+
+}
+
+#endif /* _RenderTestSimulationUtil_ */
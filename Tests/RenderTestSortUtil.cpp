@@ -0,0 +1,97 @@
+#include "RenderTestSortUtil.h"
+
+#include "JobSystem.h"
+#include "RadixSort.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace SortTestUtil
+{
+
+bool CheckRadixSort()
+{
+  // The large sizes split every pass over several jobs : needs worker threads
+  static const unsigned int S_NbTestThreads = 4;
+  if ( !JobSystem::Get().IsInitialized() || ( JobSystem::Get().GetThreadCount() < S_NbTestThreads ) )
+    JobSystem::Get().Initialize(S_NbTestThreads);
+
+  uint32_t state = 4242u;
+  RadixSorter sorter;
+
+  // Sizes around the single job threshold, and key ranges with many duplicates
+  const int sizes[] = { 0, 1, 2, 17, 1000, 40000, 100000 };
+  const int keyBits[] = { 8, 24, 32 };
+  for ( int size : sizes )
+  {
+    for ( int bits : keyBits )
+    {
+      const uint32_t keyMask = ( bits >= 32 ) ? 0xffffffffu : ( ( 1u << bits ) - 1u );
+      const uint32_t duplicateMask = ( 0 == ( size % 2 ) ) ? 0xffu : keyMask;
+
+      std::vector<uint32_t> keys(size);
+      for ( uint32_t & key : keys )
+      {
+        state = state * 1664525u + 1013904223u;
+        key = state & keyMask & duplicateMask;
+      }
+      std::vector<int> values(size);
+      std::iota(values.begin(), values.end(), 0);
+
+      std::vector<int> expected = values;
+      std::stable_sort(expected.begin(), expected.end(), [&keys]( int iLhs, int iRhs ) { return keys[iLhs] < keys[iRhs]; });
+
+      std::vector<uint32_t> sortedKeys = keys;
+      if ( 0 != sorter.Sort(sortedKeys, values, bits) )
+      {
+        std::cerr << "Radix sort failed for " << size << " items" << std::endl;
+        return false;
+      }
+      if ( ( size >= 40000 ) && ( sorter.GetLastNbJobs() < 2 ) )
+      {
+        std::cerr << "Radix sort of " << size << " items ran on a single job" << std::endl;
+        return false;
+      }
+
+      // Stable : equal keys keep their input order
+      if ( values != expected )
+      {
+        std::cerr << "Radix sort order differs for " << size << " items, " << bits << " key bits" << std::endl;
+        return false;
+      }
+      for ( int i = 0; i < size; ++i )
+      {
+        if ( sortedKeys[i] != keys[values[i]] )
+        {
+          std::cerr << "Radix sort keys and values are out of sync for " << size << " items" << std::endl;
+          return false;
+        }
+      }
+    }
+  }
+
+  std::vector<uint32_t> keys(3, 0u);
+  std::vector<int> values(2, 0);
+  if ( 0 == sorter.Sort(keys, values) )
+  {
+    std::cerr << "Radix sort accepted mismatched key and value counts" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+}
+
+}
+
+}
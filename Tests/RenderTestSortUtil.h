@@ -0,0 +1,21 @@
+#ifndef _RenderTestSortUtil_
+#define _RenderTestSortUtil_
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace SortTestUtil
+{
+
+bool CheckRadixSort();
+
+}
+
+}
+
+}
+
+#endif /* _RenderTestSortUtil_ */
@@ -0,0 +1,113 @@
+#include "RenderTestTileUtil.h"
+
+#include "TileScheduler.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace TileTestUtil
+{
+
+bool CheckTileScheduler()
+{
+  TileScheduler scheduler;
+  const Vec2i nbTiles(4, 3);
+  const int tileCount = nbTiles.x * nbTiles.y;
+
+  // Scanline : rows from the top, left to right, each tile once per frame
+  scheduler.Reset(nbTiles);
+  scheduler.BeginFrame();
+  for ( int i = 0; i < tileCount; ++i )
+  {
+    const int expected = ( nbTiles.y - 1 - i / nbTiles.x ) * nbTiles.x + i % nbTiles.x;
+    if ( scheduler.NextTile(TileScheduler::Order::Scanline) != expected )
+    {
+      std::cerr << "Scanline tile " << i << " out of order" << std::endl;
+      return false;
+    }
+  }
+  if ( scheduler.NextTile(TileScheduler::Order::Scanline) >= 0 )
+  {
+    std::cerr << "A tile was scheduled twice in a frame" << std::endl;
+    return false;
+  }
+
+  // Prioritized : center tiles first, then every tile progresses evenly until the error is estimated
+  scheduler.Reset(nbTiles);
+  scheduler.BeginFrame();
+  const Vec2i first = scheduler.GetTileCoord(scheduler.NextTile(TileScheduler::Order::Prioritized));
+  if ( ( first.y != 1 ) || ( ( first.x != 1 ) && ( first.x != 2 ) ) )
+  {
+    std::cerr << "The first prioritized tile is not at the screen center" << std::endl;
+    return false;
+  }
+
+  scheduler.Reset(nbTiles);
+  for ( int frame = 0; frame < 20; ++frame )
+  {
+    scheduler.BeginFrame();
+    for ( int i = 0; i < 5; ++i )
+    {
+      const int tile = scheduler.NextTile(TileScheduler::Order::Prioritized);
+      scheduler.TileRendered(tile);
+      scheduler.SetTileError(tile, ( 0 == tile ) ? 1.f : .01f);
+    }
+    if ( ( scheduler.GetMinSamples() < 4 ) && ( scheduler.GetMaxSamples() > scheduler.GetMinSamples() + 1 ) )
+    {
+      std::cerr << "Tiles did not progress evenly before their error was estimated" << std::endl;
+      return false;
+    }
+  }
+
+  // The noisiest tile receives the most samples, and is picked first
+  for ( int i = 1; i < tileCount; ++i )
+  {
+    if ( scheduler.GetTileSamples(i) >= scheduler.GetTileSamples(0) )
+    {
+      std::cerr << "The noisiest tile did not receive the most samples" << std::endl;
+      return false;
+    }
+  }
+  scheduler.BeginFrame();
+  if ( 0 != scheduler.NextTile(TileScheduler::Order::Prioritized) )
+  {
+    std::cerr << "The noisiest tile is not picked first" << std::endl;
+    return false;
+  }
+
+  // Frame budget
+  if ( 1 != scheduler.GetTilesForBudget(1. / 60.) )
+  {
+    std::cerr << "Tiles scheduled before the tile cost is known" << std::endl;
+    return false;
+  }
+  scheduler.RecordFrameTime(4, .004);
+  if ( 8 != scheduler.GetTilesForBudget(.008) || ( tileCount != scheduler.GetTilesForBudget(1.) ) )
+  {
+    std::cerr << "Tiles per frame do not follow the budget" << std::endl;
+    return false;
+  }
+
+  // Relative standard error : mean .5, mean square .5, 4 samples -> sqrt(.25 / 4) / .5
+  const float moments[8] = { .5f, .5f, 4.f, 0.f,   .5f, .25f, 4.f, 0.f };
+  if ( std::abs(TileScheduler::EstimateError(moments, 2) - .25f) > 1e-5f )
+  {
+    std::cerr << "Tile error estimate is wrong" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+}
+
+}
+
+}
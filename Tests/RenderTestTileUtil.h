@@ -0,0 +1,21 @@
+#ifndef _RenderTestTileUtil_
+#define _RenderTestTileUtil_
+
+namespace RTRT
+{
+
+namespace Tests
+{
+
+namespace TileTestUtil
+{
+
+bool CheckTileScheduler();
+
+}
+
+}
+
+}
+
+#endif /* _RenderTestTileUtil_ */